@@ -0,0 +1,233 @@
+// bufferarena.cpp
+//
+// See header file for details
+
+#include "bufferarena.h"
+
+#include <SDL.h>
+#include <iterator>
+#include <map>
+#include <vector>
+
+// 16-bit indices can only reach this many vertices
+#define BUFFER_ARENA_MAX_VERTICES 65536
+
+// Free ranges, by offset (the value is the size)
+typedef std::map<GLuint, GLuint> BufferArenaFreeList;
+
+typedef struct BufferArenaBlock_s {
+	GLuint vbo;
+	GLuint ibo;
+	GLuint numVertices;
+	GLuint numIndices;
+	BufferArenaFreeList freeVertices;
+	BufferArenaFreeList freeIndices;
+} BufferArenaBlock;
+
+struct BufferArena_s {
+	GLsizei vertexSize;
+	GLuint blockVertices;
+	GLuint blockIndices;
+	std::vector<BufferArenaBlock> blocks;
+	unsigned int numMeshes;
+	size_t usedBytes;
+	
+	// Reused for offsetting indices by the mesh's baseVertex
+	std::vector<GLushort> rebasedIndices;
+};
+
+/** Takes the first free range that's large enough.
+ * 
+ * @return bool true if successful
+ */
+
+static bool bufferArenaRangeAlloc(BufferArenaFreeList *freeList, GLuint size, GLuint *offset) {
+	for(BufferArenaFreeList::iterator it = freeList->begin(); it != freeList->end(); ++it) {
+		if(it->second < size) {
+			continue;
+		}
+		*offset = it->first;
+		GLuint remaining = it->second - size;
+		freeList->erase(it);
+		if(remaining > 0) {
+			(*freeList)[*offset + size] = remaining;
+		}
+		return true;
+	}
+	
+	return false;
+}
+
+/** Returns a range to the free list, merging it with the free ranges on either side.
+ */
+
+static void bufferArenaRangeFree(BufferArenaFreeList *freeList, GLuint offset, GLuint size) {
+	BufferArenaFreeList::iterator next = freeList->lower_bound(offset);
+	if(next != freeList->end() && offset + size == next->first) {
+		size += next->second;
+		next = freeList->erase(next);
+	}
+	if(next != freeList->begin()) {
+		BufferArenaFreeList::iterator prev = std::prev(next);
+		if(prev->first + prev->second == offset) {
+			prev->second += size;
+			return;
+		}
+	}
+	freeList->insert(next, BufferArenaFreeList::value_type(offset, size));
+}
+
+/** Adds a block with (at least) the given number of vertices and indices.
+ * 
+ * @return bool true if successful
+ */
+
+static bool bufferArenaBlockCreate(BufferArena *arena, GLuint numVertices, GLuint numIndices) {
+	BufferArenaBlock block;
+	block.numVertices = numVertices > arena->blockVertices ? numVertices : arena->blockVertices;
+	block.numIndices = numIndices > arena->blockIndices ? numIndices : arena->blockIndices;
+	
+	GLuint buffers[2];
+	glGenBuffers(2, buffers);
+	block.vbo = buffers[0];
+	block.ibo = buffers[1];
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block.vbo);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)block.numVertices * arena->vertexSize, NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block.ibo);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)block.numIndices * sizeof(GLushort), NULL, GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	
+	// Only checked when creating a block, as glGetError() can stall
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Creating buffer arena block failed, code %u\n", err);
+		glDeleteBuffers(2, buffers);
+		return false;
+	}
+	
+	block.freeVertices[0] = block.numVertices;
+	block.freeIndices[0] = block.numIndices;
+	arena->blocks.push_back(block);
+	
+	return true;
+}
+
+/** Allocates a mesh's ranges from a block.
+ * 
+ * @return bool true if the block had room for both
+ */
+
+static bool bufferArenaBlockAlloc(BufferArenaBlock *block, GLuint numVertices, GLuint numIndices,
+		BufferArenaMesh *mesh) {
+	if(!bufferArenaRangeAlloc(&block->freeVertices, numVertices, &mesh->baseVertex)) {
+		return false;
+	}
+	if(!bufferArenaRangeAlloc(&block->freeIndices, numIndices, &mesh->firstIndex)) {
+		bufferArenaRangeFree(&block->freeVertices, mesh->baseVertex, numVertices);
+		return false;
+	}
+	
+	return true;
+}
+
+BufferArena *bufferArenaCreate(GLsizei vertexSize, GLuint blockVertices, GLuint blockIndices) {
+	
+	BufferArena *arena = new BufferArena_s;
+	arena->vertexSize = vertexSize;
+	arena->blockVertices = blockVertices < BUFFER_ARENA_MAX_VERTICES ? blockVertices : BUFFER_ARENA_MAX_VERTICES;
+	arena->blockIndices = blockIndices;
+	arena->numMeshes = 0;
+	arena->usedBytes = 0;
+	
+	return arena;
+}
+
+void bufferArenaDestroy(BufferArena *arena) {
+	
+	if(!arena) {
+		return;
+	}
+	for(BufferArenaBlock &block : arena->blocks) {
+		GLuint buffers[2] = {block.vbo, block.ibo};
+		glDeleteBuffers(2, buffers);
+	}
+	delete arena;
+}
+
+bool bufferArenaAlloc(BufferArena *arena, const void *vertices, GLuint numVertices,
+		const GLushort *indices, GLuint numIndices, BufferArenaMesh *mesh) {
+	
+	mesh->block = -1;
+	if(numVertices == 0 || numIndices == 0 || numVertices > BUFFER_ARENA_MAX_VERTICES) {
+		SDL_Log("Can't allocate a mesh with %u vertices and %u indices\n", numVertices, numIndices);
+		return false;
+	}
+	
+	// First fit, in a new block if none of them have room
+	int blockIdx = -1;
+	for(size_t i = 0; i < arena->blocks.size() && blockIdx < 0; ++i) {
+		if(bufferArenaBlockAlloc(&arena->blocks[i], numVertices, numIndices, mesh)) {
+			blockIdx = (int)i;
+		}
+	}
+	if(blockIdx < 0) {
+		if(!bufferArenaBlockCreate(arena, numVertices, numIndices)) {
+			return false;
+		}
+		blockIdx = (int)arena->blocks.size() - 1;
+		bufferArenaBlockAlloc(&arena->blocks[blockIdx], numVertices, numIndices, mesh);
+	}
+	BufferArenaBlock *block = &arena->blocks[blockIdx];
+	mesh->vbo = block->vbo;
+	mesh->ibo = block->ibo;
+	mesh->numVertices = numVertices;
+	mesh->numIndices = numIndices;
+	mesh->block = blockIdx;
+	
+	// The indices have to point at the mesh's vertices within the block
+	arena->rebasedIndices.resize(numIndices);
+	for(GLuint i = 0; i < numIndices; ++i) {
+		arena->rebasedIndices[i] = (GLushort)(indices[i] + mesh->baseVertex);
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block->vbo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)mesh->baseVertex * arena->vertexSize,
+		(GLsizeiptr)numVertices * arena->vertexSize, vertices);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, block->ibo);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)mesh->firstIndex * sizeof(GLushort),
+		(GLsizeiptr)numIndices * sizeof(GLushort), &arena->rebasedIndices[0]);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	
+	++arena->numMeshes;
+	arena->usedBytes += (size_t)numVertices * arena->vertexSize + (size_t)numIndices * sizeof(GLushort);
+	
+	return true;
+}
+
+void bufferArenaFree(BufferArena *arena, BufferArenaMesh *mesh) {
+	
+	if(mesh->block < 0) {
+		return;
+	}
+	BufferArenaBlock *block = &arena->blocks[mesh->block];
+	bufferArenaRangeFree(&block->freeVertices, mesh->baseVertex, mesh->numVertices);
+	bufferArenaRangeFree(&block->freeIndices, mesh->firstIndex, mesh->numIndices);
+	--arena->numMeshes;
+	arena->usedBytes -= (size_t)mesh->numVertices * arena->vertexSize + (size_t)mesh->numIndices * sizeof(GLushort);
+	mesh->block = -1;
+}
+
+BufferArenaStats bufferArenaStatsGet(const BufferArena *arena) {
+	
+	BufferArenaStats stats;
+	stats.numBlocks = (unsigned int)arena->blocks.size();
+	stats.numMeshes = arena->numMeshes;
+	stats.reservedBytes = 0;
+	stats.usedBytes = arena->usedBytes;
+	stats.numFreeRanges = 0;
+	for(const BufferArenaBlock &block : arena->blocks) {
+		stats.reservedBytes += (size_t)block.numVertices * arena->vertexSize + (size_t)block.numIndices * sizeof(GLushort);
+		stats.numFreeRanges += (unsigned int)(block.freeVertices.size() + block.freeIndices.size());
+	}
+	
+	return stats;
+}
@@ -0,0 +1,117 @@
+// bufferarena.h
+
+#ifndef __BUFFERARENA_H__
+#define __BUFFERARENA_H__
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+/** Sub-allocates meshes from a few large vertex and index buffers.
+ * 
+ * vboCreate()/iboCreate() make a buffer object (and a glGetError() check)
+ * per mesh, so thousands of small meshes mean thousands of driver objects,
+ * and a buffer bind per draw. An arena reserves blocks of vertices and
+ * indices instead (a VBO and an IBO each), and hands out ranges of them with
+ * a first-fit free list, coalescing freed ranges with their neighbours.
+ * 
+ * Meshes in the same block share a VBO and IBO, so the vertex attributes only
+ * need setting up once per block. GLES 3.0 has no glDrawElementsBaseVertex(),
+ * so each mesh's indices have its baseVertex added when they're uploaded,
+ * and a block holds at most 65536 vertices (16-bit indices). Draw a mesh with:
+ * glDrawElements(GL_TRIANGLES, mesh.numIndices, GL_UNSIGNED_SHORT,
+ *     (GLvoid*)(mesh.firstIndex * sizeof(GLushort)));
+ * Meshes next to each other in the same block can be drawn with one call.
+ * 
+ * NOTE: Uploads go through GL_COPY_WRITE_BUFFER, so the GL_ARRAY_BUFFER and
+ * GL_ELEMENT_ARRAY_BUFFER bindings are left alone.
+ */
+
+typedef struct BufferArena_s BufferArena;
+
+/** A mesh allocated from a BufferArena.
+ */
+
+typedef struct BufferArenaMesh_s {
+	// The buffers to bind
+	GLuint vbo;
+	GLuint ibo;
+	
+	// The mesh's first vertex in the VBO (already added to its indices)
+	GLuint baseVertex;
+	
+	// The mesh's first index in the IBO
+	GLuint firstIndex;
+	
+	GLuint numVertices;
+	GLuint numIndices;
+	
+	// Internal state (the block it's in; -1 if not allocated)
+	int block;
+} BufferArenaMesh;
+
+/** How much of an arena is used.
+ */
+
+typedef struct BufferArenaStats_s {
+	// The number of blocks (each is a VBO and an IBO)
+	unsigned int numBlocks;
+	
+	// The number of meshes allocated
+	unsigned int numMeshes;
+	
+	// The bytes reserved in all blocks, and how many of them are in use
+	size_t reservedBytes;
+	size_t usedBytes;
+	
+	// The number of free ranges (vertex and index) in all blocks. Freed
+	// ranges are merged with their neighbours, so an empty block has one of each
+	unsigned int numFreeRanges;
+} BufferArenaStats;
+
+/** Creates a buffer arena.
+ * 
+ * @param vertexSize the size of each vertex in bytes
+ * @param blockVertices the number of vertices per block (at most 65536)
+ * @param blockIndices the number of indices per block
+ * 
+ * @return BufferArena* the arena
+ */
+
+BufferArena *bufferArenaCreate(GLsizei vertexSize, GLuint blockVertices, GLuint blockIndices);
+
+/** Destroys a buffer arena, and all of its buffers.
+ */
+
+void bufferArenaDestroy(BufferArena *arena);
+
+/** Allocates a mesh, and uploads its vertices and indices.
+ * 
+ * A new block is created if none of the existing ones have room (large
+ * enough for the mesh, if it's larger than the arena's block size).
+ * 
+ * This will print any errors to the console.
+ * 
+ * @param arena the buffer arena
+ * @param vertices the mesh's vertices
+ * @param numVertices the number of vertices (at most 65536)
+ * @param indices the mesh's indices (relative to its first vertex)
+ * @param numIndices the number of indices
+ * @param mesh where to write the mesh's handle to
+ * 
+ * @return bool true if successful
+ */
+
+bool bufferArenaAlloc(BufferArena *arena, const void *vertices, GLuint numVertices,
+	const GLushort *indices, GLuint numIndices, BufferArenaMesh *mesh);
+
+/** Frees a mesh, so its ranges can be reused.
+ */
+
+void bufferArenaFree(BufferArena *arena, BufferArenaMesh *mesh);
+
+/** Gets an arena's statistics.
+ */
+
+BufferArenaStats bufferArenaStatsGet(const BufferArena *arena);
+
+#endif
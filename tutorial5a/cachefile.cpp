@@ -0,0 +1,96 @@
+// cachefile.cpp
+//
+// See header file for details
+
+#include "cachefile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+// 64-bit FNV-1a
+static const uint64_t fnvPrime = 1099511628211ULL;
+
+uint64_t cacheHashBytes(uint64_t hash, const void *data, size_t length) {
+	const unsigned char *bytes = (const unsigned char*)data;
+	for(size_t i = 0; i < length; ++i) {
+		hash ^= bytes[i];
+		hash *= fnvPrime;
+	}
+	
+	return hash;
+}
+
+char *cacheFilePath(const char *dir, uint64_t key, const char *ext) {
+	size_t pathLength = strlen(dir) + 16 + strlen(ext) + 1;
+	char *path = (char*)malloc(pathLength);
+	if(path) {
+		snprintf(path, pathLength, "%s%016llx%s", dir, (unsigned long long)key, ext);
+	}
+	
+	return path;
+}
+
+/** Returns true if the filename has the given extension.
+ */
+
+static bool hasExt(const char *filename, const char *ext) {
+	size_t length = strlen(filename);
+	size_t extLength = strlen(ext);
+	
+	return length > extLength && strcmp(filename + length - extLength, ext) == 0;
+}
+
+/** Deletes a file in a cache directory.
+ */
+
+static void cacheRemoveFile(const char *dir, const char *filename) {
+	size_t pathLength = strlen(dir) + strlen(filename) + 1;
+	char *path = (char*)malloc(pathLength);
+	if(path) {
+		snprintf(path, pathLength, "%s%s", dir, filename);
+		remove(path);
+		free(path);
+	}
+}
+
+void cacheDirClear(const char *dir, const char *ext) {
+#ifdef _WIN32
+	size_t patternLength = strlen(dir) + 2;
+	char *pattern = (char*)malloc(patternLength);
+	if(!pattern) {
+		return;
+	}
+	snprintf(pattern, patternLength, "%s*", dir);
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA(pattern, &findData);
+	free(pattern);
+	if(find == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		if(hasExt(findData.cFileName, ext)) {
+			cacheRemoveFile(dir, findData.cFileName);
+		}
+	} while(FindNextFileA(find, &findData));
+	FindClose(find);
+#else
+	DIR *dirHandle = opendir(dir);
+	if(!dirHandle) {
+		return;
+	}
+	struct dirent *entry;
+	while((entry = readdir(dirHandle)) != NULL) {
+		if(hasExt(entry->d_name, ext)) {
+			cacheRemoveFile(dir, entry->d_name);
+		}
+	}
+	closedir(dirHandle);
+#endif
+}
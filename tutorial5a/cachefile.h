@@ -0,0 +1,45 @@
+// cachefile.h
+
+#ifndef __CACHEFILE_H__
+#define __CACHEFILE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+// Helpers shared by the on-disk caches (program binaries and encoded
+// textures), which keep one file per key in a cache directory
+
+// The starting value for cacheHashBytes()
+#define CACHE_HASH_INIT 14695981039346656037ULL
+
+/** Adds bytes to a 64-bit FNV-1a hash.
+ * 
+ * @param hash the hash so far (start with CACHE_HASH_INIT)
+ * @param data the bytes to add
+ * @param length the number of bytes
+ * 
+ * @return uint64_t the new hash
+ */
+
+uint64_t cacheHashBytes(uint64_t hash, const void *data, size_t length);
+
+/** Builds the path of a key's file in a cache directory.
+ * 
+ * @param dir the cache directory, including the trailing path separator
+ * @param key the key
+ * @param ext the file extension (e.g., ".ktx")
+ * 
+ * @return char* the path (free() it when done), or NULL if out of memory
+ */
+
+char *cacheFilePath(const char *dir, uint64_t key, const char *ext);
+
+/** Deletes every file with the given extension in a cache directory.
+ * 
+ * @param dir the cache directory, including the trailing path separator
+ * @param ext the cache files' extension
+ */
+
+void cacheDirClear(const char *dir, const char *ext);
+
+#endif
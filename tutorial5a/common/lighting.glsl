@@ -0,0 +1,19 @@
+// lighting.glsl
+//
+// The per-frame lighting inputs, shared by texture.vert and texture.frag.
+// NOTE: Must match FrameUniforms in main.cpp
+
+#ifndef LIGHTING_GLSL
+#define LIGHTING_GLSL
+
+#define MAX_LIGHTS 4
+
+layout(std140) uniform FrameData {
+	mat4 projMat;
+	vec3 lightPos[MAX_LIGHTS]; // NOTE: position in view space ( so after being
+					   //transformed by its own MV matrix)
+	vec3 ambientCol; // The light and object's combined ambient colour
+	vec3 diffuseCol; // The light and object's combined diffuse colour
+};
+
+#endif
@@ -0,0 +1,59 @@
+// cube.cpp
+//
+// See header file for details
+
+#include "cube.h"
+
+#include <cstring>
+
+void cubeCreate(float size, Vertex *vertices, GLushort *indices) {
+	
+	float cubeSize_2 = size / 2.0f; // Half the cube's size
+	const Vertex cubeVertices[CUBE_NUM_VERTICES] = {
+		// Front face
+		{{-cubeSize_2, -cubeSize_2, cubeSize_2},{0.0f, 0.0f},{0.0f,0.0f,1.0f}},
+		{{cubeSize_2, -cubeSize_2, cubeSize_2},{1.0f, 0.0f},{0.0f,0.0f,1.0f}},
+		{{cubeSize_2, cubeSize_2, cubeSize_2},{1.0f, 1.0f},{0.0f,0.0f,1.0f}},
+		{{-cubeSize_2, cubeSize_2, cubeSize_2},{0.0f, 1.0f},{0.0f,0.0f,1.0f}},
+		// Back face
+		{{cubeSize_2, -cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{0.0f,0.0f,-1.0f}},
+		{{-cubeSize_2, -cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{0.0f,0.0f,-1.0f}},
+		{{-cubeSize_2, cubeSize_2, -cubeSize_2},{1.0f, 1.0f},{0.0f,0.0f,-1.0f}},
+		{{cubeSize_2, cubeSize_2, -cubeSize_2},{0.0f, 1.0f},{0.0f,0.0f,-1.0f}},
+		// Left face
+		{{-cubeSize_2, -cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{-1.0f,0.0f,0.0f}},
+		{{-cubeSize_2, -cubeSize_2, cubeSize_2},{1.0f, 0.0f},{-1.0f,0.0f,0.0f}},
+		{{-cubeSize_2, cubeSize_2, cubeSize_2},{1.0f, 1.0f},{-1.0f,0.0f,0.0f}},
+		{{-cubeSize_2, cubeSize_2, -cubeSize_2},{0.0f, 1.0f},{-1.0f,0.0f,0.0f}},
+		// Right face
+		{{cubeSize_2, -cubeSize_2, cubeSize_2},{0.0f, 0.0f},{1.0f,0.0f,0.0f}},
+		{{cubeSize_2, -cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{1.0f,0.0f,0.0f}},
+		{{cubeSize_2, cubeSize_2, -cubeSize_2},{1.0f, 1.0f},{1.0f,0.0f,0.0f}},
+		{{cubeSize_2, cubeSize_2, cubeSize_2},{0.0f, 1.0f},{1.0f,0.0f,0.0f}},
+		// Top face
+		{{cubeSize_2, cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{0.0f,1.0f,0.0f}},
+		{{-cubeSize_2, cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{0.0f,1.0f,0.0f}},
+		{{-cubeSize_2, cubeSize_2, cubeSize_2},{1.0f, 1.0f},{0.0f,1.0f,0.0f}},
+		{{cubeSize_2, cubeSize_2, cubeSize_2},{0.0f, 1.0f},{0.0f,1.0f,0.0f}},
+		// Bottom face
+		{{-cubeSize_2, -cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{0.0f,-1.0f,0.0f}},
+		{{cubeSize_2, -cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{0.0f,-1.0f,0.0f}},
+		{{cubeSize_2, -cubeSize_2, cubeSize_2},{1.0f, 1.0f},{0.0f,-1.0f,0.0f}},
+		{{-cubeSize_2, -cubeSize_2, cubeSize_2},{0.0f, 1.0f},{0.0f,-1.0f,0.0f}}
+		};
+	memcpy(vertices, cubeVertices, sizeof(cubeVertices));
+	
+	// Two triangles per side
+	const GLushort vertsPerSide = 4;
+	const GLushort numSides = 6;
+	GLuint i = 0;
+	for(GLushort j = 0; j < numSides; ++j) {
+		GLushort sideBaseIdx = j * vertsPerSide;
+		indices[i++] = sideBaseIdx + 0;
+		indices[i++] = sideBaseIdx + 1;
+		indices[i++] = sideBaseIdx + 2;
+		indices[i++] = sideBaseIdx + 2;
+		indices[i++] = sideBaseIdx + 3;
+		indices[i++] = sideBaseIdx + 0;
+	}
+}
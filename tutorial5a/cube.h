@@ -0,0 +1,23 @@
+// cube.h
+
+#ifndef __CUBE_H__
+#define __CUBE_H__
+
+#include "vertex.h"
+
+#include <GLES3/gl3.h>
+
+// Each side has its own 4 vertices (for its own normal and texture coordinates)
+#define CUBE_NUM_VERTICES 24
+#define CUBE_NUM_INDICES 36
+
+/** Builds the demo's textured cube, centred on the origin.
+ * 
+ * @param size the length of each side
+ * @param vertices where to write the vertices to (CUBE_NUM_VERTICES)
+ * @param indices where to write the triangles' indices to (CUBE_NUM_INDICES)
+ */
+
+void cubeCreate(float size, Vertex *vertices, GLushort *indices);
+
+#endif
@@ -0,0 +1,203 @@
+// embeddedshaders.h
+//
+// Generated by tools/embedshaders.cpp. Don't edit; rerun the tool instead.
+
+#ifndef __EMBEDDEDSHADERS_H__
+#define __EMBEDDEDSHADERS_H__
+
+#include "shaderembed.h"
+
+static constexpr EmbeddedShader embeddedShaders[] = {
+	{"texture.vert",
+		"#version 300 es\n"
+		"\n"
+		"// The vertex format (see vertexformat.h). shaderProgLoadDefines() can\n"
+		"// override this default to build variants for quantized vertices:\n"
+		"// 0 = floats, 1 = normalized shorts and octahedral normals,\n"
+		"// 2 = half floats and 10-bit normals\n"
+		"#ifndef VERTEX_FORMAT\n"
+		"#define VERTEX_FORMAT 0\n"
+		"#endif\n"
+		"\n"
+		"layout(location = 0) in vec3 vertPos;\n"
+		"layout(location = 1) in vec2 vertTexCoord;\n"
+		"#if VERTEX_FORMAT == 1\n"
+		"layout(location = 2) in vec2 vertNormal; // Octahedral\n"
+		"#else\n"
+		"layout(location = 2) in vec3 vertNormal;\n"
+		"#endif\n"
+		"\n"
+		"#if VERTEX_FORMAT != 0\n"
+		"// Quantized positions and texture coordinates are relative to the mesh's\n"
+		"// bounds: value = quantized * scale + offset\n"
+		"uniform vec3 posScale;\n"
+		"uniform vec3 posOffset;\n"
+		"uniform vec2 texCoordScale;\n"
+		"uniform vec2 texCoordOffset;\n"
+		"#endif\n"
+		"\n"
+		"out vec2 texCoord;\n"
+		"out vec3 normal;\n"
+		"out vec3 viewPos;\n"
+		"\n"
+		"#include \"common/lighting.glsl\"\n"
+		"\n"
+		"// NOTE: Must match ObjectUniforms in main.cpp\n"
+		"layout(std140) uniform ObjectData {\n"
+		"\tmat4 mvMat;\n"
+		"\tmat4 normalMat;\n"
+		"};\n"
+		"\n"
+		"#if VERTEX_FORMAT == 1\n"
+		"// Decodes an octahedral normal (must match vertexOctDecode() in vertexformat.cpp)\n"
+		"vec3 octDecode(vec2 e) {\n"
+		"\tvec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+		"\tfloat t = max(-n.z, 0.0);\n"
+		"\tn.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);\n"
+		"\treturn normalize(n);\n"
+		"}\n"
+		"#endif\n"
+		"\n"
+		"void main() {\n"
+		"\t\n"
+		"#if VERTEX_FORMAT != 0\n"
+		"\t// Dequantize the position and texture coordinate\n"
+		"\tvec3 position = vertPos * posScale + posOffset;\n"
+		"\ttexCoord = vertTexCoord * texCoordScale + texCoordOffset;\n"
+		"#else\n"
+		"\tvec3 position = vertPos;\n"
+		"\t\n"
+		"\t// Pass the texture coordinate\n"
+		"\ttexCoord = vertTexCoord;\n"
+		"#endif\n"
+		"#if VERTEX_FORMAT == 1\n"
+		"\tvec3 vertNormal3 = octDecode(vertNormal);\n"
+		"#else\n"
+		"\tvec3 vertNormal3 = vertNormal;\n"
+		"#endif\n"
+		"\t\n"
+		"\t// Calc. the position in view space\n"
+		"\tvec4 viewPos4 = mvMat * vec4(position, 1.0);\n"
+		"\t\n"
+		"\t// Calc. the position\n"
+		"\tgl_Position = projMat * viewPos4;\n"
+		"\t\n"
+		"\t// Transform the normal\n"
+		"\tnormal = normalize((normalMat * vec4(vertNormal3, 1.0)).xyz);\n"
+		"\t\n"
+		"\t// Pass the view space position on, for the light vectors\n"
+		"\t// NOTE: Calculated per fragment, since the number of lights varies\n"
+		"\tviewPos = viewPos4.xyz;\n"
+		"}\n",
+		2075},
+	{"texture.frag",
+		"#version 300 es\n"
+		"\n"
+		"#ifdef GL_ES\n"
+		"precision highp float;\n"
+		"#endif\n"
+		"\n"
+		"// Shader features. shaderProgLoadDefines() can override these defaults to\n"
+		"// build specialized variants (see shadervariant.h)\n"
+		"#ifndef LIGHTING\n"
+		"#define LIGHTING 1 // Point lighting on/off\n"
+		"#endif\n"
+		"#ifndef NUM_LIGHTS\n"
+		"#define NUM_LIGHTS 1 // Number of point lights\n"
+		"#endif\n"
+		"#ifndef TEXTURED\n"
+		"#define TEXTURED 1 // Diffuse texture on/off\n"
+		"#endif\n"
+		"\n"
+		"// UBER=1 turns the features into uniforms instead, for comparing runtime\n"
+		"// branching against specialized variants\n"
+		"#ifndef UBER\n"
+		"#define UBER 0\n"
+		"#endif\n"
+		"\n"
+		"#include \"common/lighting.glsl\"\n"
+		"\n"
+		"#if NUM_LIGHTS > MAX_LIGHTS\n"
+		"#error \"NUM_LIGHTS is more than FrameData has room for\"\n"
+		"#endif\n"
+		"\n"
+		"#if UBER\n"
+		"uniform bool lighting;\n"
+		"uniform int numLights;\n"
+		"uniform bool textured;\n"
+		"#define LIGHTING_ON lighting\n"
+		"#define LIGHT_COUNT numLights\n"
+		"#define TEXTURED_ON textured\n"
+		"#else\n"
+		"#define LIGHTING_ON (LIGHTING != 0)\n"
+		"#define LIGHT_COUNT NUM_LIGHTS\n"
+		"#define TEXTURED_ON (TEXTURED != 0)\n"
+		"#endif\n"
+		"\n"
+		"in vec2 texCoord;\n"
+		"in vec3 normal;\n"
+		"in vec3 viewPos;\n"
+		"\n"
+		"out vec4 fragColour;\n"
+		"\n"
+		"uniform sampler2D texSampler;\n"
+		"\n"
+		"const float invRadiusSq = 0.00001;\n"
+		"\n"
+		"void main() {\n"
+		"\t// Base colour (from the diffuse texture)\n"
+		"\tvec4 colour = vec4(1.0);\n"
+		"\tif(TEXTURED_ON) {\n"
+		"\t\tcolour = texture(texSampler, texCoord);\n"
+		"\t}\n"
+		"\t\n"
+		"\tvec3 finalColour = colour.xyz;\n"
+		"\tif(LIGHTING_ON) {\n"
+		"\t\t// Ambient lighting (once, however many lights there are)\n"
+		"\t\tfinalColour = ambientCol * colour.xyz;\n"
+		"\t\tfor(int i = 0; i < LIGHT_COUNT; ++i) {\n"
+		"\t\t\tvec3 lightVec = lightPos[i] - viewPos;\n"
+		"\t\t\t\n"
+		"\t\t\t// Calculate the lighting attenuation, and direction\n"
+		"\t\t\tfloat distSq = dot(lightVec, lightVec);\n"
+		"\t\t\tfloat attenuation = clamp(1.0 - invRadiusSq * sqrt(distSq), 0.0, 1.0);\n"
+		"\t\t\tattenuation *= attenuation;\n"
+		"\t\t\tvec3 lightDir = lightVec * inversesqrt(distSq);\n"
+		"\t\t\t\n"
+		"\t\t\t// Diffuse lighting\n"
+		"\t\t\tvec3 diffuse = max(dot(lightDir, normal), 0.0) * diffuseCol * colour.xyz;\n"
+		"\t\t\t\n"
+		"\t\t\t// The light's contribution\n"
+		"\t\t\tfinalColour += diffuse * attenuation;\n"
+		"\t\t}\n"
+		"\t}\n"
+		"\t\n"
+		"\t// The final colour\n"
+		"\t// NOTE: Alpha channel shouldn't be affected by lights\n"
+		"\tfragColour = vec4(finalColour, colour.w);\t\n"
+		"}\n",
+		2055},
+	{"common/lighting.glsl",
+		"// lighting.glsl\n"
+		"//\n"
+		"// The per-frame lighting inputs, shared by texture.vert and texture.frag.\n"
+		"// NOTE: Must match FrameUniforms in main.cpp\n"
+		"\n"
+		"#ifndef LIGHTING_GLSL\n"
+		"#define LIGHTING_GLSL\n"
+		"\n"
+		"#define MAX_LIGHTS 4\n"
+		"\n"
+		"layout(std140) uniform FrameData {\n"
+		"\tmat4 projMat;\n"
+		"\tvec3 lightPos[MAX_LIGHTS]; // NOTE: position in view space ( so after being\n"
+		"\t\t\t\t\t   //transformed by its own MV matrix)\n"
+		"\tvec3 ambientCol; // The light and object's combined ambient colour\n"
+		"\tvec3 diffuseCol; // The light and object's combined diffuse colour\n"
+		"};\n"
+		"\n"
+		"#endif\n",
+		527}
+};
+
+#endif
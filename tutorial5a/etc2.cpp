@@ -0,0 +1,451 @@
+// etc2.cpp
+//
+// See header file for details
+
+#include "etc2.h"
+
+#include <SDL.h>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+// Don't start threads for images with fewer blocks than this (e.g., small mipmap levels)
+#define ETC2_MIN_BLOCKS_PER_THREAD 256
+
+// ETC1/ETC2 intensity modifiers for each table codeword. A pixel's index
+// selects +small, +large, -small or -large
+static const int etc1Modifiers[8][2] = {
+	{2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+};
+
+// EAC alpha modifiers for each table codeword
+static const int eacModifiers[16][8] = {
+	{-3, -6, -9, -15, 2, 5, 8, 14},
+	{-3, -7, -10, -13, 2, 6, 9, 12},
+	{-2, -5, -8, -13, 1, 4, 7, 12},
+	{-2, -4, -6, -13, 1, 3, 5, 12},
+	{-3, -6, -8, -12, 2, 5, 7, 11},
+	{-3, -7, -9, -11, 2, 6, 8, 10},
+	{-4, -7, -8, -11, 3, 6, 7, 10},
+	{-3, -5, -8, -11, 2, 4, 7, 10},
+	{-2, -6, -8, -10, 1, 5, 7, 9},
+	{-2, -5, -8, -10, 1, 4, 7, 9},
+	{-2, -4, -8, -10, 1, 3, 7, 9},
+	{-2, -5, -7, -10, 1, 4, 6, 9},
+	{-3, -4, -7, -10, 2, 3, 6, 9},
+	{-1, -2, -3, -10, 0, 1, 2, 9},
+	{-4, -6, -8, -9, 3, 5, 7, 8},
+	{-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+/** An encoded colour block and its squared error.
+ */
+
+typedef struct Etc2Candidate_s {
+	uint8_t bytes[8];
+	int error;
+} Etc2Candidate;
+
+/** Shared state of the encoding threads.
+ */
+
+typedef struct Etc2Job_s {
+	const uint8_t *pixels;
+	int width;
+	int height;
+	int pitch;
+	bool alpha;
+	uint8_t *out;
+	int blocksWide;
+	int blocksHigh;
+	
+	// The next row of blocks to encode
+	SDL_atomic_t nextRow;
+} Etc2Job;
+
+static inline int etc2Clamp(int value) {
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+static inline int etc2Expand4(int value) {
+	return (value << 4) | value;
+}
+
+static inline int etc2Expand5(int value) {
+	return (value << 3) | (value >> 2);
+}
+
+static inline int etc2Expand6(int value) {
+	return (value << 2) | (value >> 4);
+}
+
+static inline int etc2Expand7(int value) {
+	return (value << 1) | (value >> 6);
+}
+
+static inline int etc2Quantize(float value, int maxValue) {
+	int quantized = (int)(value * maxValue / 255.0f + 0.5f);
+	return quantized < 0 ? 0 : (quantized > maxValue ? maxValue : quantized);
+}
+
+/** Finds the best table and pixel indices for one half of a block.
+ * 
+ * @param block the block's pixels (RGBA, row by row)
+ * @param flip false for 2x4 halves side by side, true for 4x2 halves one above the other
+ * @param half which half (0 or 1)
+ * @param base the half's base colour (8 bits per channel)
+ * @param table where to write the best table codeword
+ * @param selectors where to write each pixel's modifier index (0-3), by pixel number
+ * 
+ * @return int the squared error
+ */
+
+static int etc1HalfFit(const uint8_t block[16][4], bool flip, int half, const int base[3],
+		int *table, int selectors[16]) {
+	int bestError = INT_MAX;
+	for(int t = 0; t < 8; ++t) {
+		const int modifiers[4] = {etc1Modifiers[t][0], etc1Modifiers[t][1],
+			-etc1Modifiers[t][0], -etc1Modifiers[t][1]};
+		int error = 0;
+		int tableSelectors[16];
+		for(int i = 0; i < 8 && error < bestError; ++i) {
+			int x = flip ? i % 4 : half * 2 + i % 2;
+			int y = flip ? half * 2 + i / 4 : i / 2;
+			const uint8_t *pixel = block[y * 4 + x];
+			int bestPixelError = INT_MAX;
+			for(int m = 0; m < 4; ++m) {
+				int dr = etc2Clamp(base[0] + modifiers[m]) - pixel[0];
+				int dg = etc2Clamp(base[1] + modifiers[m]) - pixel[1];
+				int db = etc2Clamp(base[2] + modifiers[m]) - pixel[2];
+				int pixelError = dr * dr + dg * dg + db * db;
+				if(pixelError < bestPixelError) {
+					bestPixelError = pixelError;
+					tableSelectors[y * 4 + x] = m;
+				}
+			}
+			error += bestPixelError;
+		}
+		if(error < bestError) {
+			bestError = error;
+			*table = t;
+			for(int i = 0; i < 8; ++i) {
+				int x = flip ? i % 4 : half * 2 + i % 2;
+				int y = flip ? half * 2 + i / 4 : i / 2;
+				selectors[y * 4 + x] = tableSelectors[y * 4 + x];
+			}
+		}
+	}
+	
+	return bestError;
+}
+
+/** Encodes a block in ETC1's individual (differential = false) or differential mode.
+ * 
+ * @param colours the halves' base colours (4 bits per channel if individual,
+ * 5 bits if differential; the second must be within -4..3 of the first)
+ */
+
+static Etc2Candidate etc1BlockEncode(const uint8_t block[16][4], bool flip, bool differential,
+		const int colours[2][3]) {
+	Etc2Candidate candidate;
+	int tables[2];
+	int selectors[16];
+	candidate.error = 0;
+	for(int half = 0; half < 2; ++half) {
+		int base[3];
+		for(int c = 0; c < 3; ++c) {
+			base[c] = differential ? etc2Expand5(colours[half][c]) : etc2Expand4(colours[half][c]);
+		}
+		candidate.error += etc1HalfFit(block, flip, half, base, &tables[half], selectors);
+	}
+	
+	uint64_t bits = 0;
+	for(int c = 0; c < 3; ++c) {
+		int shift = 56 - c * 8;
+		if(differential) {
+			bits |= (uint64_t)colours[0][c] << (shift + 3);
+			bits |= (uint64_t)((colours[1][c] - colours[0][c]) & 7) << shift;
+		}
+		else {
+			bits |= (uint64_t)colours[0][c] << (shift + 4);
+			bits |= (uint64_t)colours[1][c] << shift;
+		}
+	}
+	bits |= (uint64_t)tables[0] << 37;
+	bits |= (uint64_t)tables[1] << 34;
+	bits |= (uint64_t)(differential ? 1 : 0) << 33;
+	bits |= (uint64_t)(flip ? 1 : 0) << 32;
+	
+	// Pixel indices are stored column by column, as separate MSB and LSB planes
+	for(int y = 0; y < 4; ++y) {
+		for(int x = 0; x < 4; ++x) {
+			int code = selectors[y * 4 + x];
+			int bit = x * 4 + y;
+			bits |= (uint64_t)(code >> 1) << (16 + bit);
+			bits |= (uint64_t)(code & 1) << bit;
+		}
+	}
+	
+	for(int i = 0; i < 8; ++i) {
+		candidate.bytes[i] = (uint8_t)(bits >> (56 - i * 8));
+	}
+	
+	return candidate;
+}
+
+/** Encodes a block in ETC2's planar mode (a colour gradient fitted to the block).
+ */
+
+static Etc2Candidate etc2PlanarEncode(const uint8_t block[16][4]) {
+	// Least-squares fit of colour = O + x * (H - O) / 4 + y * (V - O) / 4
+	int o[3];
+	int h[3];
+	int v[3];
+	for(int c = 0; c < 3; ++c) {
+		float sum = 0.0f;
+		float sumX = 0.0f;
+		float sumY = 0.0f;
+		for(int y = 0; y < 4; ++y) {
+			for(int x = 0; x < 4; ++x) {
+				float value = block[y * 4 + x][c];
+				sum += value;
+				sumX += (x - 1.5f) * value;
+				sumY += (y - 1.5f) * value;
+			}
+		}
+		float slopeX = sumX / 20.0f;
+		float slopeY = sumY / 20.0f;
+		float origin = sum / 16.0f - 1.5f * slopeX - 1.5f * slopeY;
+		int maxValue = c == 1 ? 127 : 63;
+		o[c] = etc2Quantize(origin, maxValue);
+		h[c] = etc2Quantize(origin + 4.0f * slopeX, maxValue);
+		v[c] = etc2Quantize(origin + 4.0f * slopeY, maxValue);
+	}
+	
+	Etc2Candidate candidate;
+	candidate.error = 0;
+	for(int c = 0; c < 3; ++c) {
+		int oc = c == 1 ? etc2Expand7(o[c]) : etc2Expand6(o[c]);
+		int hc = c == 1 ? etc2Expand7(h[c]) : etc2Expand6(h[c]);
+		int vc = c == 1 ? etc2Expand7(v[c]) : etc2Expand6(v[c]);
+		for(int y = 0; y < 4; ++y) {
+			for(int x = 0; x < 4; ++x) {
+				int value = etc2Clamp((x * (hc - oc) + y * (vc - oc) + 4 * oc + 2) >> 2);
+				int diff = value - block[y * 4 + x][c];
+				candidate.error += diff * diff;
+			}
+		}
+	}
+	
+	uint8_t *bytes = candidate.bytes;
+	bytes[0] = (uint8_t)((o[0] << 1) | (o[1] >> 6));
+	bytes[1] = (uint8_t)(((o[1] & 0x3F) << 1) | (o[2] >> 5));
+	bytes[2] = (uint8_t)((((o[2] >> 3) & 3) << 3) | ((o[2] >> 1) & 3));
+	bytes[3] = (uint8_t)(((o[2] & 1) << 7) | ((h[0] >> 1) << 2) | 0x02 | (h[0] & 1));
+	bytes[4] = (uint8_t)((h[1] << 1) | (h[2] >> 5));
+	bytes[5] = (uint8_t)(((h[2] & 0x1F) << 3) | (v[0] >> 3));
+	bytes[6] = (uint8_t)(((v[0] & 7) << 5) | (v[1] >> 2));
+	bytes[7] = (uint8_t)(((v[1] & 3) << 6) | v[2]);
+	
+	// Planar mode is signalled by the differential red and green NOT
+	// overflowing while blue does, so set the unused bits accordingly
+	for(int i = 0; i < 2; ++i) {
+		int base = bytes[i] >> 3;
+		int delta = (bytes[i] & 4) ? (bytes[i] & 7) - 8 : bytes[i] & 7;
+		if(base + delta < 0 || base + delta > 31) {
+			bytes[i] |= 0x80;
+		}
+	}
+	int blueHigh = (o[2] >> 3) & 3;
+	int blueLow = (o[2] >> 1) & 3;
+	bytes[2] |= blueHigh + blueLow < 4 ? 0x04 : 0xE0;
+	
+	return candidate;
+}
+
+/** Encodes a colour block, trying each mode and keeping the best.
+ */
+
+static void etc2ColourBlockEncode(const uint8_t block[16][4], uint8_t out[8]) {
+	Etc2Candidate best = etc2PlanarEncode(block);
+	for(int flip = 0; flip < 2 && best.error > 0; ++flip) {
+		float average[2][3] = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+		for(int y = 0; y < 4; ++y) {
+			for(int x = 0; x < 4; ++x) {
+				int half = flip ? y / 2 : x / 2;
+				for(int c = 0; c < 3; ++c) {
+					average[half][c] += block[y * 4 + x][c] / 8.0f;
+				}
+			}
+		}
+		
+		int individual[2][3];
+		int differential[2][3];
+		for(int c = 0; c < 3; ++c) {
+			individual[0][c] = etc2Quantize(average[0][c], 15);
+			individual[1][c] = etc2Quantize(average[1][c], 15);
+			
+			// The second colour has to be within reach of the first
+			differential[0][c] = etc2Quantize(average[0][c], 31);
+			int delta = etc2Quantize(average[1][c], 31) - differential[0][c];
+			differential[1][c] = differential[0][c] + (delta < -4 ? -4 : (delta > 3 ? 3 : delta));
+		}
+		
+		Etc2Candidate candidate = etc1BlockEncode(block, flip != 0, false, individual);
+		if(candidate.error < best.error) {
+			best = candidate;
+		}
+		candidate = etc1BlockEncode(block, flip != 0, true, differential);
+		if(candidate.error < best.error) {
+			best = candidate;
+		}
+	}
+	
+	for(int i = 0; i < 8; ++i) {
+		out[i] = best.bytes[i];
+	}
+}
+
+/** Encodes an EAC alpha block.
+ */
+
+static void eacBlockEncode(const uint8_t block[16][4], uint8_t out[8]) {
+	int minAlpha = 255;
+	int maxAlpha = 0;
+	for(int i = 0; i < 16; ++i) {
+		minAlpha = block[i][3] < minAlpha ? block[i][3] : minAlpha;
+		maxAlpha = block[i][3] > maxAlpha ? block[i][3] : maxAlpha;
+	}
+	
+	int bestBase = minAlpha;
+	int bestMultiplier = 0;
+	int bestTable = 0;
+	int bestSelectors[16] = {0};
+	if(minAlpha != maxAlpha) {
+		// Scale each table to the block's range, and try a few bases around the middle
+		int bestError = INT_MAX;
+		for(int t = 0; t < 16 && bestError > 0; ++t) {
+			const int *modifiers = eacModifiers[t];
+			int tableRange = modifiers[7] - modifiers[3];
+			int multiplier = (maxAlpha - minAlpha + tableRange / 2) / tableRange;
+			multiplier = multiplier < 1 ? 1 : (multiplier > 15 ? 15 : multiplier);
+			int centre = (minAlpha + maxAlpha + 1) / 2 - (modifiers[7] + modifiers[3]) * multiplier / 2;
+			for(int base = centre - 1; base <= centre + 1; ++base) {
+				if(base < 0 || base > 255) {
+					continue;
+				}
+				int error = 0;
+				int selectors[16];
+				for(int i = 0; i < 16 && error < bestError; ++i) {
+					int bestPixelError = INT_MAX;
+					for(int m = 0; m < 8; ++m) {
+						int diff = etc2Clamp(base + modifiers[m] * multiplier) - block[i][3];
+						if(diff * diff < bestPixelError) {
+							bestPixelError = diff * diff;
+							selectors[i] = m;
+						}
+					}
+					error += bestPixelError;
+				}
+				if(error < bestError) {
+					bestError = error;
+					bestBase = base;
+					bestMultiplier = multiplier;
+					bestTable = t;
+					for(int i = 0; i < 16; ++i) {
+						bestSelectors[i] = selectors[i];
+					}
+				}
+			}
+		}
+	}
+	
+	// Base, multiplier and table, then 3-bit indices column by column
+	uint64_t bits = (uint64_t)bestBase << 56 | (uint64_t)bestMultiplier << 52 | (uint64_t)bestTable << 48;
+	for(int y = 0; y < 4; ++y) {
+		for(int x = 0; x < 4; ++x) {
+			bits |= (uint64_t)bestSelectors[y * 4 + x] << (45 - (x * 4 + y) * 3);
+		}
+	}
+	for(int i = 0; i < 8; ++i) {
+		out[i] = (uint8_t)(bits >> (56 - i * 8));
+	}
+}
+
+/** Encodes rows of blocks until there are none left.
+ */
+
+static int etc2Worker(void *data) {
+	Etc2Job *job = (Etc2Job*)data;
+	size_t blockSize = job->alpha ? 16 : 8;
+	int row;
+	while((row = SDL_AtomicAdd(&job->nextRow, 1)) < job->blocksHigh) {
+		uint8_t *out = job->out + (size_t)row * job->blocksWide * blockSize;
+		for(int blockX = 0; blockX < job->blocksWide; ++blockX) {
+			// Gather the block, repeating the edge pixels past the image's edges
+			uint8_t block[16][4];
+			for(int y = 0; y < 4; ++y) {
+				int srcY = row * 4 + y < job->height ? row * 4 + y : job->height - 1;
+				const uint8_t *srcRow = job->pixels + (size_t)srcY * job->pitch;
+				for(int x = 0; x < 4; ++x) {
+					int srcX = blockX * 4 + x < job->width ? blockX * 4 + x : job->width - 1;
+					for(int c = 0; c < 4; ++c) {
+						block[y * 4 + x][c] = srcRow[srcX * 4 + c];
+					}
+				}
+			}
+			
+			if(job->alpha) {
+				eacBlockEncode(block, out);
+				out += 8;
+			}
+			etc2ColourBlockEncode(block, out);
+			out += 8;
+		}
+	}
+	
+	return 0;
+}
+
+size_t etc2EncodedSize(int width, int height, bool alpha) {
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * (alpha ? 16 : 8);
+}
+
+bool etc2Encode(const void *pixels, int width, int height, int pitch, bool alpha, void *out, int numThreads) {
+	if(width <= 0 || height <= 0) {
+		SDL_Log("Can't ETC2 encode an empty image\n");
+		return false;
+	}
+	
+	Etc2Job job;
+	job.pixels = (const uint8_t*)pixels;
+	job.width = width;
+	job.height = height;
+	job.pitch = pitch;
+	job.alpha = alpha;
+	job.out = (uint8_t*)out;
+	job.blocksWide = (width + 3) / 4;
+	job.blocksHigh = (height + 3) / 4;
+	SDL_AtomicSet(&job.nextRow, 0);
+	
+	if(numThreads <= 0) {
+		numThreads = SDL_GetCPUCount();
+	}
+	int maxThreads = job.blocksWide * job.blocksHigh / ETC2_MIN_BLOCKS_PER_THREAD;
+	numThreads = numThreads < maxThreads ? numThreads : maxThreads;
+	numThreads = numThreads < 1 ? 1 : numThreads;
+	
+	// This thread works too; if a thread can't be started, the rest pick up its share
+	SDL_Thread **threads = (SDL_Thread**)calloc(numThreads, sizeof(SDL_Thread*));
+	for(int i = 1; threads && i < numThreads; ++i) {
+		threads[i] = SDL_CreateThread(etc2Worker, "etc2Encode", &job);
+	}
+	etc2Worker(&job);
+	for(int i = 1; threads && i < numThreads; ++i) {
+		SDL_WaitThread(threads[i], NULL);
+	}
+	free(threads);
+	
+	return true;
+}
@@ -0,0 +1,42 @@
+// etc2.h
+
+#ifndef __ETC2_H__
+#define __ETC2_H__
+
+#include <cstddef>
+
+/** Gets the size of an image once it's ETC2 compressed.
+ * 
+ * @param width the image's width in pixels
+ * @param height the image's height in pixels
+ * @param alpha true for GL_COMPRESSED_RGBA8_ETC2_EAC (16 bytes per 4x4 block),
+ * false for GL_COMPRESSED_RGB8_ETC2 (8 bytes per block)
+ * 
+ * @return size_t the size in bytes
+ */
+
+size_t etc2EncodedSize(int width, int height, bool alpha);
+
+/** Compresses an image to ETC2 (GL_COMPRESSED_RGB8_ETC2 or
+ * GL_COMPRESSED_RGBA8_ETC2_EAC), spreading the blocks over several threads.
+ * 
+ * Each colour block is encoded in whichever of ETC1's individual and
+ * differential modes or ETC2's planar mode (for smooth gradients) matches
+ * best. Alpha is encoded as EAC. Images that aren't a multiple of 4 pixels
+ * in size are padded by repeating the edge pixels.
+ * 
+ * @param pixels the image, in RGBA8 byte order (R, G, B, A)
+ * @param width the image's width in pixels
+ * @param height the image's height in pixels
+ * @param pitch the number of bytes per row of pixels
+ * @param alpha true to encode the alpha channel too (RGBA8_ETC2_EAC)
+ * @param out where to write the blocks to (etc2EncodedSize() bytes)
+ * @param numThreads the number of threads to use (including the calling
+ * thread), or 0 for one per CPU core
+ * 
+ * @return bool true if successful
+ */
+
+bool etc2Encode(const void *pixels, int width, int height, int pitch, bool alpha, void *out, int numThreads);
+
+#endif
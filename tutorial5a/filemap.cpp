@@ -0,0 +1,145 @@
+// filemap.cpp
+//
+// See header file for details
+
+#include "filemap.h"
+
+#include <cstdint>
+#include <SDL.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool fileMap(const char *filename, FileMap *fileMap) {
+	fileMap->data = NULL;
+	fileMap->length = 0;
+	fileMap->mapped = false;
+	
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(file == INVALID_HANDLE_VALUE) {
+		SDL_Log("Can't open file: %s\n", filename);
+		return false;
+	}
+	
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || (uint64_t)fileSize.QuadPart > SIZE_MAX) {
+		SDL_Log("Can't get the size of file %s (or it's too big to map)\n", filename);
+		CloseHandle(file);
+		return false;
+	}
+	if(fileSize.QuadPart <= FILE_MAP_SMALL_SIZE) {
+		DWORD bytesRead = 0;
+		BOOL success = ReadFile(file, fileMap->smallData, (DWORD)fileSize.QuadPart, &bytesRead, NULL);
+		CloseHandle(file);
+		if(!success) {
+			SDL_Log("Can't read file: %s\n", filename);
+			return false;
+		}
+		fileMap->data = fileMap->smallData;
+		fileMap->length = bytesRead;
+		fileMap->mapped = false;
+		return true;
+	}
+	
+	// NOTE: The view keeps the file and mapping alive, so both handles can be closed straight away
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if(!mapping) {
+		SDL_Log("Can't map file: %s\n", filename);
+		return false;
+	}
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if(!data) {
+		SDL_Log("Can't map file: %s\n", filename);
+		return false;
+	}
+	
+	fileMap->data = (const char*)data;
+	fileMap->length = (size_t)fileSize.QuadPart;
+	fileMap->mapped = true;
+	return true;
+}
+
+void fileUnmap(FileMap *fileMap) {
+	if(fileMap->mapped) {
+		UnmapViewOfFile(fileMap->data);
+	}
+	fileMap->data = NULL;
+	fileMap->length = 0;
+	fileMap->mapped = false;
+}
+
+#else
+
+bool fileMap(const char *filename, FileMap *fileMap) {
+	fileMap->data = NULL;
+	fileMap->length = 0;
+	fileMap->mapped = false;
+	
+	int fd = open(filename, O_RDONLY | O_CLOEXEC);
+	if(fd < 0) {
+		SDL_Log("Can't open file: %s\n", filename);
+		return false;
+	}
+	
+	// NOTE: st_size is an off_t, so there's no truncation to long here (unlike ftell())
+	struct stat fileStat;
+	if(fstat(fd, &fileStat) != 0 || (uint64_t)fileStat.st_size > SIZE_MAX) {
+		SDL_Log("Can't get the size of file %s (or it's too big to map)\n", filename);
+		close(fd);
+		return false;
+	}
+	if(fileStat.st_size <= FILE_MAP_SMALL_SIZE) {
+		size_t length = 0;
+		ssize_t bytesRead;
+		do {
+			bytesRead = read(fd, fileMap->smallData + length, fileStat.st_size - length);
+			length += bytesRead > 0 ? bytesRead : 0;
+		} while((bytesRead > 0 && length < (size_t)fileStat.st_size) || (bytesRead < 0 && errno == EINTR));
+		close(fd);
+		if(bytesRead < 0) {
+			SDL_Log("Can't read file %s (error %d)\n", filename, errno);
+			return false;
+		}
+		fileMap->data = fileMap->smallData;
+		fileMap->length = length;
+		fileMap->mapped = false;
+		return true;
+	}
+	
+	size_t length = (size_t)fileStat.st_size;
+	void *data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after the descriptor is closed
+	close(fd);
+	if(data == MAP_FAILED) {
+		SDL_Log("Can't map file %s (error %d)\n", filename, errno);
+		return false;
+	}
+	
+	fileMap->data = (const char*)data;
+	fileMap->length = length;
+	fileMap->mapped = true;
+	return true;
+}
+
+void fileUnmap(FileMap *fileMap) {
+	if(fileMap->mapped) {
+		munmap((void*)fileMap->data, fileMap->length);
+	}
+	fileMap->data = NULL;
+	fileMap->length = 0;
+	fileMap->mapped = false;
+}
+
+#endif
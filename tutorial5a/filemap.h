@@ -0,0 +1,52 @@
+// filemap.h
+
+#ifndef __FILEMAP_H__
+#define __FILEMAP_H__
+
+#include <cstddef>
+
+// Files up to this size are read into the FileMap itself rather than mapped
+// (mapping and unmapping pages costs more than copying a few KiB)
+#define FILE_MAP_SMALL_SIZE 16384
+
+/** A read-only, memory-mapped file.
+ * 
+ * NOTE: Don't copy a FileMap; data may point into the FileMap itself.
+ */
+
+typedef struct FileMap_s {
+	// The file's contents. NOTE: Not '\0' terminated
+	const char *data;
+	
+	// The file's length in bytes
+	size_t length;
+	
+	// Internal state
+	bool mapped;
+	char smallData[FILE_MAP_SMALL_SIZE];
+} FileMap;
+
+/** Memory-maps a whole file for reading.
+ * 
+ * This does no heap allocation. Large files are mapped, so their pages are
+ * read in by the OS as they're touched, with no copying. Small files (up to
+ * FILE_MAP_SMALL_SIZE bytes) are read into the FileMap with a single read
+ * instead, because that's cheaper than setting up a mapping. Files larger
+ * than 4 GiB work on 64-bit builds.
+ * 
+ * This will print any errors to the console.
+ * 
+ * @param filename the file's name
+ * @param fileMap the mapping to set up
+ * 
+ * @return bool true if successful
+ */
+
+bool fileMap(const char *filename, FileMap *fileMap);
+
+/** Unmaps a file mapped with fileMap().
+ */
+
+void fileUnmap(FileMap *fileMap);
+
+#endif
@@ -0,0 +1,153 @@
+// imagedecode.cpp
+//
+// See header file for details
+
+#include "imagedecode.h"
+#include "filemap.h"
+#include "texture.h"
+#include "workerpool.h"
+
+#include <string>
+#include <vector>
+#include <SDL_image.h>
+
+typedef struct ImageDecodeJob_s {
+	std::string filename;
+	size_t index;
+	SDL_Surface *surface;
+} ImageDecodeJob;
+
+struct ImageDecodePool_s {
+	ImageDecodeFunc decode;
+	void *userData;
+	WorkerPool *workers;
+	
+	// Submitting thread only
+	size_t numSubmitted;
+	size_t numPending;
+};
+
+SDL_Surface *imageDecodeSDL(const void *data, size_t size, const char *filename, void *userData) {
+	(void)userData;
+	
+	SDL_Surface *surface = IMG_Load_RW(SDL_RWFromConstMem(data, (int)size), 1);
+	if(!surface) {
+		SDL_Log("Loading image %s failed with error: %s", filename, IMG_GetError());
+	}
+	
+	return surface;
+}
+
+/** Reads and decodes an image (on a worker thread).
+ */
+
+static SDL_Surface *imageDecodeFile(ImageDecodePool *pool, const char *filename) {
+	FileMap srcMap;
+	if(!fileMap(filename, &srcMap)) {
+		return NULL;
+	}
+	SDL_Surface *surface = pool->decode(srcMap.data, srcMap.length, filename, pool->userData);
+	fileUnmap(&srcMap);
+	
+	return surface;
+}
+
+/** Decodes a job's file (on a worker thread; see WorkerPoolFunc).
+ */
+
+static void imageDecodeRun(void *job, void *userData) {
+	ImageDecodeJob *decodeJob = (ImageDecodeJob*)job;
+	decodeJob->surface = imageDecodeFile((ImageDecodePool*)userData, decodeJob->filename.c_str());
+}
+
+/** Frees a job that was never taken (see WorkerPoolFunc).
+ */
+
+static void imageDecodeDiscard(void *job, void *userData) {
+	(void)userData;
+	ImageDecodeJob *decodeJob = (ImageDecodeJob*)job;
+	SDL_FreeSurface(decodeJob->surface);
+	delete decodeJob;
+}
+
+ImageDecodePool *imageDecodePoolCreate(int numThreads, ImageDecodeFunc decode, void *userData) {
+	
+	// Must be done here, before any workers use SDL_image
+	decode = decode ? decode : imageDecodeSDL;
+	if(decode == imageDecodeSDL && !texImageLoadersInit()) {
+		return NULL;
+	}
+	
+	ImageDecodePool *pool = new ImageDecodePool_s;
+	pool->decode = decode;
+	pool->userData = userData;
+	pool->numSubmitted = 0;
+	pool->numPending = 0;
+	
+	// The calling thread usually just waits for the results, so use every core
+	if(numThreads <= 0) {
+		numThreads = SDL_GetCPUCount();
+		numThreads = numThreads > 0 ? numThreads : 1;
+	}
+	pool->workers = workerPoolCreate(numThreads, "ImageDecode", imageDecodeRun, pool);
+	if(!pool->workers) {
+		delete pool;
+		return NULL;
+	}
+	
+	return pool;
+}
+
+void imageDecodePoolDestroy(ImageDecodePool *pool) {
+	
+	if(!pool) {
+		return;
+	}
+	workerPoolDestroy(pool->workers, imageDecodeDiscard);
+	delete pool;
+}
+
+int imageDecodePoolThreads(const ImageDecodePool *pool) {
+	return workerPoolThreads(pool->workers);
+}
+
+size_t imageDecodeSubmit(ImageDecodePool *pool, const char *const *filenames, size_t numFiles) {
+	
+	size_t firstIndex = pool->numSubmitted;
+	std::vector<void*> jobs(numFiles);
+	for(size_t i = 0; i < numFiles; ++i) {
+		ImageDecodeJob *job = new ImageDecodeJob;
+		job->filename = filenames[i];
+		job->index = pool->numSubmitted++;
+		job->surface = NULL;
+		jobs[i] = job;
+	}
+	if(numFiles > 0) {
+		workerPoolSubmit(pool->workers, &jobs[0], numFiles);
+	}
+	pool->numPending += numFiles;
+	
+	return firstIndex;
+}
+
+size_t imageDecodePending(const ImageDecodePool *pool) {
+	return pool->numPending;
+}
+
+bool imageDecodeNext(ImageDecodePool *pool, ImageDecodeResult *result, bool wait) {
+	
+	if(pool->numPending == 0) {
+		return false;
+	}
+	
+	ImageDecodeJob *job = (ImageDecodeJob*)workerPoolNext(pool->workers, wait);
+	if(!job) {
+		return false;
+	}
+	result->index = job->index;
+	result->surface = job->surface;
+	delete job;
+	--pool->numPending;
+	
+	return true;
+}
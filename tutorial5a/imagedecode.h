@@ -0,0 +1,115 @@
+// imagedecode.h
+
+#ifndef __IMAGEDECODE_H__
+#define __IMAGEDECODE_H__
+
+#include <SDL.h>
+#include <cstddef>
+
+/** Decodes batches of image files in parallel, on a pool of worker threads.
+ * 
+ * texLoad() decodes one image at a time on the calling thread. Loading a
+ * level's worth of textures that way leaves the other cores idle, so submit
+ * the whole list to an ImageDecodePool instead, and upload each surface
+ * (e.g., with texCreateFromSurface()) as it comes back. Surfaces are handed
+ * back in the order they finish decoding, not the order they were submitted,
+ * so the first uploads don't wait for a large image at the head of the list.
+ * 
+ * Usage:
+ * - imageDecodePoolCreate()
+ * - imageDecodeSubmit() with a list of files
+ * - imageDecodeNext() until it returns false; free each surface with SDL_FreeSurface()
+ * - imageDecodePoolDestroy()
+ * 
+ * NOTE: Only one thread should submit to, and take results from, a pool.
+ */
+
+typedef struct ImageDecodePool_s ImageDecodePool;
+
+/** Decodes an image file (on a worker thread).
+ * 
+ * Swap in a faster PNG/JPEG decoder by passing one of these to
+ * imageDecodePoolCreate(). It must be safe to call from several threads at once.
+ * 
+ * @param data the file's contents
+ * @param size the file's length in bytes
+ * @param filename the file's name (for error messages)
+ * @param userData the userData passed to imageDecodePoolCreate()
+ * 
+ * @return SDL_Surface* the decoded image (in any pixel format
+ * texCreateFromSurface() accepts), or NULL if failed
+ */
+
+typedef SDL_Surface *(*ImageDecodeFunc)(const void *data, size_t size, const char *filename, void *userData);
+
+/** The default decoder, using SDL_image.
+ */
+
+SDL_Surface *imageDecodeSDL(const void *data, size_t size, const char *filename, void *userData);
+
+/** A decoded image.
+ */
+
+typedef struct ImageDecodeResult_s {
+	// The image's position in the submitted files (see imageDecodeSubmit())
+	size_t index;
+	
+	// The decoded image (free with SDL_FreeSurface()), or NULL if it couldn't be decoded
+	SDL_Surface *surface;
+} ImageDecodeResult;
+
+/** Creates an image decoding thread pool.
+ * 
+ * @param numThreads the number of decoding threads (0 for one per CPU core)
+ * @param decode the decoder (NULL for imageDecodeSDL())
+ * @param userData passed to the decoder
+ * 
+ * @return ImageDecodePool* the pool, or NULL if failed
+ */
+
+ImageDecodePool *imageDecodePoolCreate(int numThreads, ImageDecodeFunc decode, void *userData);
+
+/** Destroys an image decoding thread pool.
+ * Waits for the worker threads to finish the file they're decoding, and
+ * frees any surfaces that haven't been taken with imageDecodeNext().
+ */
+
+void imageDecodePoolDestroy(ImageDecodePool *pool);
+
+/** Gets the number of threads in the pool.
+ */
+
+int imageDecodePoolThreads(const ImageDecodePool *pool);
+
+/** Queues files to be decoded.
+ * 
+ * Files are numbered in the order they're submitted, starting at 0 for the
+ * pool's first file, and counting on across batches.
+ * 
+ * @param pool the image decoding thread pool
+ * @param filenames the files
+ * @param numFiles the number of files
+ * 
+ * @return size_t the index of the first file (see ImageDecodeResult)
+ */
+
+size_t imageDecodeSubmit(ImageDecodePool *pool, const char *const *filenames, size_t numFiles);
+
+/** Gets the number of files submitted that haven't been taken with imageDecodeNext() yet.
+ */
+
+size_t imageDecodePending(const ImageDecodePool *pool);
+
+/** Takes the next decoded image, in the order they finish.
+ * 
+ * @param pool the image decoding thread pool
+ * @param result where to write the decoded image to
+ * @param wait wait for an image to finish decoding if none are ready yet
+ * 
+ * @return bool true if an image was taken; false if none are ready (or
+ * pending, when waiting)
+ */
+
+bool imageDecodeNext(ImageDecodePool *pool, ImageDecodeResult *result, bool wait);
+
+#endif
@@ -0,0 +1,213 @@
+// ktx.cpp
+//
+// See header file for details
+
+#include "ktx.h"
+
+#include <SDL.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996) // Allows to use the portable fopen() function without warnings in in MVS
+#endif
+
+// File layout: identifier, KtxHeader, key/value data, then each level's size
+// (Uint32) followed by its data, padded to 4 bytes
+static const unsigned char ktxIdentifier[12] = {
+	0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+static const Uint32 ktxEndianness = 0x04030201;
+
+typedef struct KtxHeader_s {
+	Uint32 endianness;
+	Uint32 glType;
+	Uint32 glTypeSize;
+	Uint32 glFormat;
+	Uint32 glInternalFormat;
+	Uint32 glBaseInternalFormat;
+	Uint32 pixelWidth;
+	Uint32 pixelHeight;
+	Uint32 pixelDepth;
+	Uint32 numberOfArrayElements;
+	Uint32 numberOfFaces;
+	Uint32 numberOfMipmapLevels;
+	Uint32 bytesOfKeyValueData;
+} KtxHeader;
+
+static size_t ktxPad4(size_t length) {
+	return (length + 3) & ~(size_t)3;
+}
+
+/** Gets the base internal format (e.g., GL_RGBA) of a compressed format, for the header.
+ */
+
+static GLenum ktxBaseInternalFormat(const KtxImage *image) {
+	if(image->glFormat) {
+		return image->glFormat;
+	}
+	switch(image->glInternalFormat) {
+		case GL_COMPRESSED_R11_EAC:
+		case GL_COMPRESSED_SIGNED_R11_EAC:
+			return GL_RED;
+		case GL_COMPRESSED_RG11_EAC:
+		case GL_COMPRESSED_SIGNED_RG11_EAC:
+			return GL_RG;
+		case GL_COMPRESSED_RGB8_ETC2:
+		case GL_COMPRESSED_SRGB8_ETC2:
+			return GL_RGB;
+		default:
+			return GL_RGBA;
+	}
+}
+
+bool ktxParse(const void *data, size_t length, KtxImage *image) {
+	const unsigned char *bytes = (const unsigned char*)data;
+	KtxHeader header;
+	if(length < sizeof(ktxIdentifier) + sizeof(header) ||
+			memcmp(bytes, ktxIdentifier, sizeof(ktxIdentifier)) != 0) {
+		SDL_Log("Not a KTX 1.1 file\n");
+		return false;
+	}
+	memcpy(&header, bytes + sizeof(ktxIdentifier), sizeof(header));
+	if(header.endianness != ktxEndianness) {
+		SDL_Log("Can't read KTX files with the other byte order\n");
+		return false;
+	}
+	if(header.pixelHeight == 0 || header.pixelDepth > 1 || header.numberOfArrayElements > 0 ||
+			header.numberOfFaces != 1) {
+		SDL_Log("Only 2D KTX textures are supported\n");
+		return false;
+	}
+	Uint32 numLevels = header.numberOfMipmapLevels > 0 ? header.numberOfMipmapLevels : 1;
+	if(numLevels > KTX_MAX_LEVELS) {
+		SDL_Log("KTX texture has too many mipmap levels (%u)\n", numLevels);
+		return false;
+	}
+	
+	image->glInternalFormat = header.glInternalFormat;
+	image->glFormat = header.glFormat;
+	image->glType = header.glType;
+	image->width = (int)header.pixelWidth;
+	image->height = (int)header.pixelHeight;
+	image->numLevels = (int)numLevels;
+	
+	size_t offset = sizeof(ktxIdentifier) + sizeof(header) + header.bytesOfKeyValueData;
+	for(Uint32 level = 0; level < numLevels; ++level) {
+		Uint32 imageSize;
+		if(offset + sizeof(imageSize) > length) {
+			SDL_Log("KTX file is truncated\n");
+			return false;
+		}
+		memcpy(&imageSize, bytes + offset, sizeof(imageSize));
+		offset += sizeof(imageSize);
+		if(imageSize > length - offset) {
+			SDL_Log("KTX file is truncated\n");
+			return false;
+		}
+		image->levelData[level] = bytes + offset;
+		image->levelSizes[level] = imageSize;
+		offset += ktxPad4(imageSize);
+	}
+	
+	return true;
+}
+
+int ktxBytesPerPixel(GLenum glFormat, GLenum glType) {
+	if(glType != GL_UNSIGNED_BYTE) {
+		return 0;
+	}
+	switch(glFormat) {
+		case GL_RGBA:
+			return 4;
+		case GL_RGB:
+			return 3;
+		case GL_RG:
+			return 2;
+		case GL_RED:
+		case GL_LUMINANCE:
+		case GL_ALPHA:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+GLenum ktxStorageFormat(const KtxImage *image) {
+	if(!image->glFormat) {
+		return image->glInternalFormat; // Compressed
+	}
+	if(ktxBytesPerPixel(image->glFormat, image->glType) == 0) {
+		return GL_NONE;
+	}
+	switch(image->glInternalFormat) {
+		case GL_RGBA:
+		case GL_RGBA8:
+			return GL_RGBA8;
+		case GL_RGB:
+		case GL_RGB8:
+			return GL_RGB8;
+		case GL_RG:
+		case GL_RG8:
+			return GL_RG8;
+		case GL_RED:
+		case GL_R8:
+			return GL_R8;
+		default:
+			return GL_NONE;
+	}
+}
+
+bool ktxWrite(const char *filename, const KtxImage *image) {
+	if(image->numLevels < 1 || image->numLevels > KTX_MAX_LEVELS) {
+		SDL_Log("Can't write KTX file %s with %d mipmap levels\n", filename, image->numLevels);
+		return false;
+	}
+	
+	KtxHeader header;
+	header.endianness = ktxEndianness;
+	header.glType = image->glType;
+	header.glTypeSize = 1; // Compressed, or GL_UNSIGNED_BYTE
+	header.glFormat = image->glFormat;
+	header.glInternalFormat = image->glInternalFormat;
+	header.glBaseInternalFormat = ktxBaseInternalFormat(image);
+	header.pixelWidth = image->width;
+	header.pixelHeight = image->height;
+	header.pixelDepth = 0;
+	header.numberOfArrayElements = 0;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = image->numLevels;
+	header.bytesOfKeyValueData = 0;
+	
+	// Write to a temporary file first, so that a crash can't leave a truncated file behind
+	std::string tmpFilename = std::string(filename) + ".tmp";
+	FILE *file = fopen(tmpFilename.c_str(), "wb");
+	if(!file) {
+		SDL_Log("Couldn't open %s for writing\n", tmpFilename.c_str());
+		return false;
+	}
+	static const unsigned char padding[3] = {0, 0, 0};
+	bool success = fwrite(ktxIdentifier, sizeof(ktxIdentifier), 1, file) == 1 &&
+		fwrite(&header, sizeof(header), 1, file) == 1;
+	for(int level = 0; success && level < image->numLevels; ++level) {
+		Uint32 imageSize = (Uint32)image->levelSizes[level];
+		size_t paddingSize = ktxPad4(imageSize) - imageSize;
+		success = fwrite(&imageSize, sizeof(imageSize), 1, file) == 1 &&
+			fwrite(image->levelData[level], 1, imageSize, file) == imageSize &&
+			fwrite(padding, 1, paddingSize, file) == paddingSize;
+	}
+	success &= fclose(file) == 0;
+	file = NULL;
+	
+	remove(filename);
+	success = success && rename(tmpFilename.c_str(), filename) == 0;
+	if(!success) {
+		SDL_Log("Couldn't write KTX file %s\n", filename);
+		remove(tmpFilename.c_str());
+	}
+	
+	return success;
+}
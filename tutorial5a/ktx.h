@@ -0,0 +1,83 @@
+// ktx.h
+
+#ifndef __KTX_H__
+#define __KTX_H__
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+// The most mipmap levels a KtxImage can hold (enough for 32768x32768)
+#define KTX_MAX_LEVELS 16
+
+/** A 2D texture in a KTX 1.1 file (https://registry.khronos.org/KTX/specs/1.0/ktxspec.v1.html).
+ * 
+ * The level pointers point into the file's data, so they're ready to be
+ * passed to glCompressedTexImage2D()/glTexImage2D() as is.
+ */
+
+typedef struct KtxImage_s {
+	// The OpenGL format (glFormat and glType are 0 if compressed)
+	GLenum glInternalFormat;
+	GLenum glFormat;
+	GLenum glType;
+	
+	// Level 0's size in pixels
+	int width;
+	int height;
+	
+	// Each level's data and size in bytes
+	int numLevels;
+	const void *levelData[KTX_MAX_LEVELS];
+	size_t levelSizes[KTX_MAX_LEVELS];
+} KtxImage;
+
+/** Reads a KTX file's header, and finds its mipmap levels.
+ * 
+ * Only single 2D textures (no arrays, cube maps or 3D textures) in the
+ * machine's own byte order are supported. This will print any errors to the
+ * console.
+ * 
+ * @param data the file's contents (e.g., from fileMap())
+ * @param length the file's length in bytes
+ * @param image where to write the image's details to
+ * 
+ * @return bool true if successful
+ */
+
+bool ktxParse(const void *data, size_t length, KtxImage *image);
+
+/** Gets the size of an uncompressed KTX image's pixels.
+ * 
+ * Each row of an uncompressed level is padded to a multiple of 4 bytes.
+ * 
+ * @param glFormat the image's format (e.g., GL_RGBA)
+ * @param glType the image's type (only GL_UNSIGNED_BYTE is supported)
+ * 
+ * @return int the number of bytes per pixel, or 0 if the format isn't supported
+ */
+
+int ktxBytesPerPixel(GLenum glFormat, GLenum glType);
+
+/** Gets the sized internal format to allocate a KTX image's texture storage
+ * with (see glTexStorage2D()).
+ * 
+ * @return GLenum the format, or GL_NONE if it isn't supported (e.g.,
+ * GL_LUMINANCE, which has no sized format in OpenGL ES 3)
+ */
+
+GLenum ktxStorageFormat(const KtxImage *image);
+
+/** Writes a 2D texture to a KTX file.
+ * 
+ * The file is written to a temporary file first and then renamed, so a
+ * crash can't leave a truncated file behind.
+ * 
+ * @param filename the file to write
+ * @param image the texture to write (the level pointers are read from)
+ * 
+ * @return bool true if successful
+ */
+
+bool ktxWrite(const char *filename, const KtxImage *image);
+
+#endif
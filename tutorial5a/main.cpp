@@ -1,8 +1,10 @@
 #include <SDL.h>
 #include <SDL_opengles2.h>
 #include <GLES3/gl3.h>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 #define GLM_ENABLE_EXPERIMENTAL // #error "GLM: GLM_GTX_transform is an experimental extension and may change in the future. Use #define GLM_ENABLE_EXPERIMENTAL before including it, if you really want to use it."
@@ -13,17 +15,19 @@
 #include <glm/gtx/transform.hpp> // tut5a
 #include <glm/gtc/type_ptr.hpp>
 
+#include "cube.h"
+#include "samplercache.h"
 #include "shader.h"
+#include "shadercache.h"
+#include "shaderembed.h"
+#include "shaderwatch.h"
 #include "texture.h"
-
-/** Encapsulates the data for a single vertex.
- * Must match the vertex shader's input.
- */
-typedef struct Vertex_s {
-	float position[3];
-	float texCoord[2];
-	float normal[3];
-}Vertex;
+#include "texturecache.h"
+#include "textureregistry.h"
+#include "uniformblocks.h"
+#include "uniformbuffer.h"
+#include "uniforms.h"
+#include "vertex.h"
 
 GLuint vboCreate(const Vertex *vertices, GLuint numVertices) {
 	// Create the Vertex Buffer Object
@@ -61,7 +65,6 @@ using namespace std;
 const unsigned int DISP_WIDTH = 640;
 const unsigned int DISP_HEIGHT = 480;
 
-
 /**
  * Creates the Index Buffer Object (IBO) containing
  * 
@@ -101,6 +104,47 @@ const unsigned int DISP_HEIGHT = 480;
 	 glDeleteBuffers(1, &ibo);
 }
 
+/** The shader program's uniforms used by the demo.
+ * NOTE: The matrices and lights are in uniform blocks (see FrameUniforms and ObjectUniforms)
+ */
+typedef struct DemoUniforms_s {
+	ShaderUniforms *uniforms;
+	UniformID texSampler;
+} DemoUniforms;
+
+/** Reflects a shader program's uniforms, and binds its uniform blocks.
+ * 
+ * @param shaderProg the shader program
+ * @param demoUniforms where to write the uniforms to (call demoUniformsDestroy() when done)
+ * 
+ * @return bool true if all uniforms and blocks were found
+ */
+static bool demoUniformsCreate(GLuint shaderProg, DemoUniforms *demoUniforms) {
+	demoUniforms->uniforms = uniformsCreate(shaderProg);
+	if (!demoUniforms->uniforms) {
+		return false;
+	}
+	
+	bool success = true;
+	demoUniforms->texSampler = uniformsFind(demoUniforms->uniforms, "texSampler");
+	if (demoUniforms->texSampler < 0) {
+		SDL_Log("ERROR: Couldn't find uniform texSampler.");
+		success = false;
+	}
+	if (!uboBlockBind(shaderProg, "FrameData", FRAME_BINDING) ||
+			!uboBlockBind(shaderProg, "ObjectData", OBJECT_BINDING)) {
+		SDL_Log("ERROR: Couldn't find the FrameData and ObjectData uniform blocks.");
+		success = false;
+	}
+	
+	return success;
+}
+
+static void demoUniformsDestroy(DemoUniforms *demoUniforms) {
+	uniformsDestroy(demoUniforms->uniforms);
+	demoUniforms->uniforms = NULL;
+}
+
 int SDL_main(int argc, char *args[]) {
 	
 	// The window
@@ -161,10 +205,34 @@ int SDL_main(int argc, char *args[]) {
 	// Update the window
 	SDL_GL_SwapWindow(window);
 	
-
+	// Cache linked shader programs and compressed textures between runs
+	char *prefPath = SDL_GetPrefPath("GLES3-SDL2-Demos", "tutorial5a");
+	if(prefPath) {
+		shaderCacheInit(prefPath);
+		texCacheInit(prefPath);
+		SDL_free(prefPath);
+		prefPath = NULL;
+	}
+	
 	// Load the shader program and set it for use
+	// NOTE: The shaders are compiled into the executable. Set SHADER_DIR (e.g., to "./") to load
+	// them from disk instead. In development mode (--hot-reload), the program is rebuilt whenever
+	// its files change
 	
-	GLuint shaderProg = shaderProgLoad("texture.vert", "texture.frag");
+	const char *shaderDir = SDL_getenv("SHADER_DIR");
+	if(shaderDir) {
+		shaderEmbeddedOverride(shaderDir);
+	}
+	bool hotReload = argc > 1 && strcmp(args[1], "--hot-reload") == 0;
+	ShaderWatch *shaderWatch = NULL;
+	GLuint shaderProg = 0;
+	if(hotReload) {
+		shaderWatch = shaderWatchCreate("texture.vert", "texture.frag");
+		shaderProg = shaderWatch ? shaderWatchProg(shaderWatch) : 0;
+	}
+	else {
+		shaderProg = shaderProgLoadEmbedded("texture");
+	}
 	
 	if(!shaderProg){
 		// Error messages already displayed...
@@ -172,100 +240,47 @@ int SDL_main(int argc, char *args[]) {
 	}
 	glUseProgram(shaderProg);
 	
-	// Load the texture
+	// Load the texture through the registry (ETC2 compressed; encoded on the first run only)
 	
-	GLuint texture = texLoad("crate1_diffuse.png");
+	TexLoadOptions texOptions = {TEX_MIPMAP_CPU, true};
+	GLuint texture = texRegistryAcquire("crate1_diffuse.png", &texOptions);
 	if(!texture) {
 		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", "Couldn't load texture.", NULL);
 		return EXIT_FAILURE;
 	}
 	
-	// Bind the texture to unit 0
+	// Bind the texture to unit 0, with a trilinear sampler (textures hold no filter state of their own)
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, texture);
-	
-	// Bind texSampler to unit 0
-	
-	GLint texSamplerUniformLoc = glGetUniformLocation(shaderProg, "texSampler");
-	if (texSamplerUniformLoc < 0) {
-		SDL_Log("ERROR: Couldn't get texSampler's location.");
+	SamplerDesc samplerDesc = {GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT, GL_REPEAT, 1.0f};
+	GLuint sampler = samplerCacheGet(&samplerDesc);
+	if(!sampler) {
+		SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Error", "Couldn't create the texture sampler.", NULL);
 		return EXIT_FAILURE;
 	}
-	glUniform1i(texSamplerUniformLoc, 0);
+	glBindSampler(0, sampler);
 	
-	// Get other uniform locations
+	// Find the uniforms, and bind texSampler to unit 0
 	
-	GLint mvMatLoc = glGetUniformLocation(shaderProg, "mvMat");
-	if (mvMatLoc < 0) {
-		SDL_Log("ERROR: Couldn't get mvMat's location.");
+	DemoUniforms demoUniforms;
+	if(!demoUniformsCreate(shaderProg, &demoUniforms)) {
 		return EXIT_FAILURE;
 	}
+	ShaderUniforms *uniforms = demoUniforms.uniforms;
+	uniformSet1i(uniforms, demoUniforms.texSampler, 0);
 	
-	GLint normalMatLoc = glGetUniformLocation(shaderProg, "normalMat");
-	if (normalMatLoc < 0) {
-		SDL_Log("ERROR: Couldn't get normalMat's location.");
-		return EXIT_FAILURE;
-	}
-	
-	GLint projMatLoc = glGetUniformLocation(shaderProg, "projMat");
-	if (projMatLoc < 0) {
-		SDL_Log("ERROR: Couldn't get projMat's location.");
-		return EXIT_FAILURE;
-	}
-	
-	GLint lightPosLoc = glGetUniformLocation(shaderProg, "lightPos");
-	if (lightPosLoc < 0) {
-		SDL_Log("ERROR: Couldn't get lightPos' location.");
-		return EXIT_FAILURE;
-	}
-	
-	GLint ambientColLoc = glGetUniformLocation(shaderProg, "ambientCol");
-	if (ambientColLoc < 0) {
-		SDL_Log("ERROR: Couldn't get ambientCol's location.");
-		return EXIT_FAILURE;
-	}
+	// Create the uniform buffer that all uniform blocks are allocated from
 	
-	GLint diffuseColLoc = glGetUniformLocation(shaderProg, "diffuseCol");
-	if (diffuseColLoc < 0) {
-		SDL_Log("ERROR: Couldn't get diffuseCol's location.");
+	UniformBuffer *ubo = uboCreate(64 * 1024);
+	if(!ubo) {
 		return EXIT_FAILURE;
 	}
 	
 	//Create the 3D cube
 	
-	float cubeSize_2 = 100.0f / 2.0f; // Half the cube's size
-	const Vertex vertices[] = {
-		// Front face
-		{{-cubeSize_2, -cubeSize_2, cubeSize_2},{0.0f, 0.0f},{0.0f,0.0f,1.0f}},
-		{{cubeSize_2, -cubeSize_2, cubeSize_2},{1.0f, 0.0f},{0.0f,0.0f,1.0f}},
-		{{cubeSize_2, cubeSize_2, cubeSize_2},{1.0f, 1.0f},{0.0f,0.0f,1.0f}},
-		{{-cubeSize_2, cubeSize_2, cubeSize_2},{0.0f, 1.0f},{0.0f,0.0f,1.0f}},
-		// Back face
-		{{cubeSize_2, -cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{0.0f,0.0f,-1.0f}},
-		{{-cubeSize_2, -cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{0.0f,0.0f,-1.0f}},
-		{{-cubeSize_2, cubeSize_2, -cubeSize_2},{1.0f, 1.0f},{0.0f,0.0f,-1.0f}},
-		{{cubeSize_2, cubeSize_2, -cubeSize_2},{0.0f, 1.0f},{0.0f,0.0f,-1.0f}},
-		// Left face
-		{{-cubeSize_2, -cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{-1.0f,0.0f,0.0f}},
-		{{-cubeSize_2, -cubeSize_2, cubeSize_2},{1.0f, 0.0f},{-1.0f,0.0f,0.0f}},
-		{{-cubeSize_2, cubeSize_2, cubeSize_2},{1.0f, 1.0f},{-1.0f,0.0f,0.0f}},
-		{{-cubeSize_2, cubeSize_2, -cubeSize_2},{0.0f, 1.0f},{-1.0f,0.0f,0.0f}},
-		// Right face
-		{{cubeSize_2, -cubeSize_2, cubeSize_2},{0.0f, 0.0f},{1.0f,0.0f,0.0f}},
-		{{cubeSize_2, -cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{1.0f,0.0f,0.0f}},
-		{{cubeSize_2, cubeSize_2, -cubeSize_2},{1.0f, 1.0f},{1.0f,0.0f,0.0f}},
-		{{cubeSize_2, cubeSize_2, cubeSize_2},{0.0f, 1.0f},{1.0f,0.0f,0.0f}},
-		// Top face
-		{{cubeSize_2, cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{0.0f,1.0f,0.0f}},
-		{{-cubeSize_2, cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{0.0f,1.0f,0.0f}},
-		{{-cubeSize_2, cubeSize_2, cubeSize_2},{1.0f, 1.0f},{0.0f,1.0f,0.0f}},
-		{{cubeSize_2, cubeSize_2, cubeSize_2},{0.0f, 1.0f},{0.0f,1.0f,0.0f}},
-		// Bottom face
-		{{-cubeSize_2, -cubeSize_2, -cubeSize_2},{0.0f, 0.0f},{0.0f,-1.0f,0.0f}},
-		{{cubeSize_2, -cubeSize_2, -cubeSize_2},{1.0f, 0.0f},{0.0f,-1.0f,0.0f}},
-		{{cubeSize_2, -cubeSize_2, cubeSize_2},{1.0f, 1.0f},{0.0f,-1.0f,0.0f}},
-		{{-cubeSize_2, -cubeSize_2, cubeSize_2},{0.0f, 1.0f},{0.0f,-1.0f,0.0f}}
-		};
+	Vertex vertices[CUBE_NUM_VERTICES];
+	GLushort indices[CUBE_NUM_INDICES];
+	cubeCreate(100.0f, vertices, indices);
 	
 	GLsizei vertSize = sizeof(vertices[0]);
 	GLsizei numVertices = sizeof(vertices)/vertSize;
@@ -275,24 +290,7 @@ int SDL_main(int argc, char *args[]) {
 		return EXIT_FAILURE;
 	}
 	
-	// Generate the index array
-	
-	const GLsizei vertsPerSide = 4;
-	const GLsizei numSides = 6;
-	const GLsizei indicesPerSide = 6;
-	const GLsizei numIndices = indicesPerSide *numSides;
-	GLushort indices[numIndices];
-	GLuint i = 0;
-	for (GLushort j = 0; j < numSides; ++j) {
-		GLushort sideBaseIdx = j * vertsPerSide;
-		indices[i++] = sideBaseIdx + 0;
-		indices[i++] = sideBaseIdx + 1;
-		indices[i++] = sideBaseIdx + 2;
-		indices[i++] = sideBaseIdx + 2;
-		indices[i++] = sideBaseIdx + 3;
-		indices[i++] = sideBaseIdx + 0;
-	}
-	
+	const GLsizei numIndices = CUBE_NUM_INDICES;
 	GLuint ibo = iboCreate(indices, numIndices);
 	if(!ibo){
 		// Failed. Error message has already been printed, so just quit
@@ -343,13 +341,9 @@ int SDL_main(int argc, char *args[]) {
 	
 	// Upload the shader uniforms
 	glm::mat4 mvMat = viewMat * modelMat;
-	glm::mat4 normalMat = glm::inverseTranspose(mvMat);
-	glUniformMatrix4fv(mvMatLoc, 1, GL_FALSE, glm::value_ptr(mvMat));
-	glUniformMatrix4fv(normalMatLoc, 1, GL_FALSE, glm::value_ptr(normalMat));
-	glUniformMatrix4fv(projMatLoc, 1, GL_FALSE, glm::value_ptr(projMat));
-	glUniform3fv(lightPosLoc, 1, glm::value_ptr(lightPos));
-	glUniform3fv(ambientColLoc, 1, glm::value_ptr(ambientCol));
-	glUniform3fv(diffuseColLoc, 1, glm::value_ptr(diffuseCol));
+	if(!uniformBlocksUpdate(ubo, projMat, &lightPos, 1, ambientCol, diffuseCol, mvMat)) {
+		return EXIT_FAILURE;
+	}
 	
 	// Now draw!
 	
@@ -366,6 +360,9 @@ int SDL_main(int argc, char *args[]) {
 	// Main loop
 	bool quit = false;
 	Uint32 prevTime = SDL_GetTicks();
+	Uint32 statsTime = prevTime;
+	unsigned int statsFrames = 0;
+	UniformStats statsTotal = {0, 0};
 	Uint32 currTime = 0;
 	float elapsedTime = 0.0f;
 	while (!quit) {
@@ -379,15 +376,45 @@ int SDL_main(int argc, char *args[]) {
 		}
 		
 		
+		// Swap in the rebuilt shader program (development mode)
+		// Its uniforms are all reset, so the new reflection's shadow copies start out empty
+		if (shaderWatch && shaderWatchUpdate(shaderWatch)) {
+			shaderProg = shaderWatchProg(shaderWatch);
+			glUseProgram(shaderProg);
+			demoUniformsDestroy(&demoUniforms);
+			demoUniformsCreate(shaderProg, &demoUniforms);
+			uniforms = demoUniforms.uniforms;
+		}
+		
 		// Animate
 		currTime = SDL_GetTicks();
 		elapsedTime = (float)(currTime - prevTime) / 1000.0f;
 		prevTime = currTime; // Prepare for the next frame
 		modelMat = glm::rotate(cubeAngVel * elapsedTime, cubeRotAxis) * modelMat;
 		mvMat = viewMat * modelMat;
-		normalMat = glm::inverseTranspose(mvMat);
-		glUniformMatrix4fv(mvMatLoc, 1, GL_FALSE, glm::value_ptr(mvMat));
-		glUniformMatrix4fv(normalMatLoc, 1, GL_FALSE, glm::value_ptr(normalMat));
+		
+		// Set every uniform; the unchanged ones are skipped
+		if (uniforms) {
+			uniformSet1i(uniforms, demoUniforms.texSampler, 0);
+		}
+		
+		// The matrices and light go up in a single buffer write
+		uniformBlocksUpdate(ubo, projMat, &lightPos, 1, ambientCol, diffuseCol, mvMat);
+		
+		// Print the average uniform uploads per frame every 5 seconds
+		UniformStats frameStats = uniformStatsGet();
+		uniformStatsReset();
+		statsTotal.issued += frameStats.issued;
+		statsTotal.skipped += frameStats.skipped;
+		++statsFrames;
+		if (currTime - statsTime >= 5000) {
+			SDL_Log("Uniform uploads per frame: %.2f issued, %.2f skipped\n",
+				(double)statsTotal.issued / statsFrames, (double)statsTotal.skipped / statsFrames);
+			statsTime = currTime;
+			statsFrames = 0;
+			statsTotal.issued = 0;
+			statsTotal.skipped = 0;
+		}
 		
 		// Redraw
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -403,10 +430,24 @@ int SDL_main(int argc, char *args[]) {
 	// IMPORTANT! Clean-up AFTER you have done the drawcalls!
 	vboFree(triangleVBO);
 	triangleVBO = 0;
-	shaderProgDestroy(shaderProg);
+	demoUniformsDestroy(&demoUniforms);
+	uniforms = NULL;
+	uboDestroy(ubo);
+	ubo = NULL;
+	if(shaderWatch) {
+		shaderWatchDestroy(shaderWatch);
+		shaderWatch = NULL;
+	}
+	else {
+		shaderProgDestroy(shaderProg);
+	}
 	shaderProg = 0;
-	texDestroy(texture); // Delete texture
+	texRegistryRelease(texture); // Delete texture
 	texture = 0;
+	texRegistryShutdown();
+	glBindSampler(0, 0);
+	samplerCacheShutdown();
+	sampler = 0;
 	iboFree(ibo);
 	ibo = 0;
 	
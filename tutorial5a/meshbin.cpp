@@ -0,0 +1,301 @@
+// meshbin.cpp
+//
+// See header file for details
+
+#include "meshbin.h"
+#include "filemap.h"
+
+#include <SDL.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996) // Allows to use the portable fopen() function without warnings in in MVS
+#endif
+
+// File layout: MeshBinHeader, the submesh table (MeshBinSubmesh), the
+// vertices, then the indices. Each part starts on a 16-byte boundary
+#define MESH_BIN_ALIGN 16
+
+static const char meshBinIdentifier[8] = {'M', 'E', 'S', 'H', 'B', 'I', 'N', '1'};
+static const Uint32 meshBinEndianness = 0x04030201;
+
+typedef struct MeshBinHeader_s {
+	char identifier[8];
+	Uint32 endianness;
+	Uint32 vertexFormat;
+	Uint32 vertexSize;
+	Uint32 indexType;
+	Uint32 numVertices;
+	Uint32 numIndices;
+	Uint32 numSubmeshes;
+	Uint32 reserved;
+	float boundsMin[3];
+	float boundsMax[3];
+	VertexQuantParams quantParams;
+	Uint64 submeshOffset;
+	Uint64 vertexOffset;
+	Uint64 indexOffset;
+} MeshBinHeader;
+
+static_assert(sizeof(MeshBinHeader) == 128, "MeshBinHeader must have no padding");
+static_assert(sizeof(MeshBinSubmesh) == 16, "MeshBinSubmesh must have no padding");
+
+static Uint64 meshBinAlign(Uint64 offset) {
+	return (offset + MESH_BIN_ALIGN - 1) & ~(Uint64)(MESH_BIN_ALIGN - 1);
+}
+
+static size_t meshBinIndexSize(GLenum indexType) {
+	return indexType == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
+}
+
+/** Checks that a part of the file lies within it.
+ */
+
+static bool meshBinInFile(Uint64 offset, Uint64 count, Uint64 elementSize, size_t length) {
+	return offset <= length && count <= (length - offset) / elementSize;
+}
+
+bool meshBinParse(const void *data, size_t length, MeshBin *mesh) {
+	const unsigned char *bytes = (const unsigned char*)data;
+	MeshBinHeader header;
+	if(length < sizeof(header) || memcmp(bytes, meshBinIdentifier, sizeof(meshBinIdentifier)) != 0) {
+		SDL_Log("Not a cooked mesh file\n");
+		return false;
+	}
+	memcpy(&header, bytes, sizeof(header));
+	if(header.endianness != meshBinEndianness) {
+		SDL_Log("Can't read cooked meshes with the other byte order\n");
+		return false;
+	}
+	if(header.vertexFormat > VERTEX_FORMAT_HALF_1010102 ||
+			header.vertexSize != vertexFormatSize((VertexFormat)header.vertexFormat)) {
+		SDL_Log("Cooked mesh has an unknown vertex format (%u)\n", header.vertexFormat);
+		return false;
+	}
+	if(header.indexType != GL_UNSIGNED_SHORT && header.indexType != GL_UNSIGNED_INT) {
+		SDL_Log("Cooked mesh has an unknown index type (0x%X)\n", header.indexType);
+		return false;
+	}
+	size_t indexSize = meshBinIndexSize(header.indexType);
+	if(header.submeshOffset % MESH_BIN_ALIGN != 0 || header.vertexOffset % MESH_BIN_ALIGN != 0 ||
+			header.indexOffset % MESH_BIN_ALIGN != 0 ||
+			!meshBinInFile(header.submeshOffset, header.numSubmeshes, sizeof(MeshBinSubmesh), length) ||
+			!meshBinInFile(header.vertexOffset, header.numVertices, header.vertexSize, length) ||
+			!meshBinInFile(header.indexOffset, header.numIndices, indexSize, length)) {
+		SDL_Log("Cooked mesh file is truncated or corrupt\n");
+		return false;
+	}
+	const MeshBinSubmesh *submeshes = (const MeshBinSubmesh*)(bytes + header.submeshOffset);
+	for(Uint32 i = 0; i < header.numSubmeshes; ++i) {
+		const MeshBinSubmesh &submesh = submeshes[i];
+		if(submesh.firstIndex > header.numIndices || submesh.numIndices > header.numIndices - submesh.firstIndex ||
+				submesh.minVertex > submesh.maxVertex || submesh.maxVertex >= header.numVertices) {
+			SDL_Log("Cooked mesh's submesh %u is out of range\n", i);
+			return false;
+		}
+	}
+	
+	mesh->vertexFormat = (VertexFormat)header.vertexFormat;
+	mesh->vertexSize = (GLsizei)header.vertexSize;
+	mesh->quantParams = header.quantParams;
+	mesh->indexType = header.indexType;
+	memcpy(mesh->boundsMin, header.boundsMin, sizeof(mesh->boundsMin));
+	memcpy(mesh->boundsMax, header.boundsMax, sizeof(mesh->boundsMax));
+	mesh->vertices = bytes + header.vertexOffset;
+	mesh->numVertices = header.numVertices;
+	mesh->indices = bytes + header.indexOffset;
+	mesh->numIndices = header.numIndices;
+	mesh->submeshes = submeshes;
+	mesh->numSubmeshes = header.numSubmeshes;
+	
+	return true;
+}
+
+bool meshBinWrite(const char *filename, const MeshBin *mesh) {
+	
+	MeshBinHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.identifier, meshBinIdentifier, sizeof(meshBinIdentifier));
+	header.endianness = meshBinEndianness;
+	header.vertexFormat = mesh->vertexFormat;
+	header.vertexSize = mesh->vertexSize;
+	header.indexType = mesh->indexType;
+	header.numVertices = mesh->numVertices;
+	header.numIndices = mesh->numIndices;
+	header.numSubmeshes = mesh->numSubmeshes;
+	memcpy(header.boundsMin, mesh->boundsMin, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, mesh->boundsMax, sizeof(header.boundsMax));
+	header.quantParams = mesh->quantParams;
+	header.submeshOffset = meshBinAlign(sizeof(header));
+	header.vertexOffset = meshBinAlign(header.submeshOffset + (Uint64)mesh->numSubmeshes * sizeof(MeshBinSubmesh));
+	header.indexOffset = meshBinAlign(header.vertexOffset + (Uint64)mesh->numVertices * mesh->vertexSize);
+	
+	// Write to a temporary file first, so that a crash can't leave a truncated file behind
+	std::string tmpFilename = std::string(filename) + ".tmp";
+	FILE *file = fopen(tmpFilename.c_str(), "wb");
+	if(!file) {
+		SDL_Log("Couldn't open %s for writing\n", tmpFilename.c_str());
+		return false;
+	}
+	static const unsigned char padding[MESH_BIN_ALIGN] = {0};
+	const void *parts[3] = {mesh->submeshes, mesh->vertices, mesh->indices};
+	size_t partSizes[3] = {
+		mesh->numSubmeshes * sizeof(MeshBinSubmesh),
+		(size_t)mesh->numVertices * mesh->vertexSize,
+		mesh->numIndices * meshBinIndexSize(mesh->indexType)
+	};
+	Uint64 partOffsets[3] = {header.submeshOffset, header.vertexOffset, header.indexOffset};
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+	Uint64 offset = sizeof(header);
+	for(int i = 0; success && i < 3; ++i) {
+		size_t paddingSize = (size_t)(partOffsets[i] - offset);
+		success = fwrite(padding, 1, paddingSize, file) == paddingSize &&
+			(partSizes[i] == 0 || fwrite(parts[i], 1, partSizes[i], file) == partSizes[i]);
+		offset = partOffsets[i] + partSizes[i];
+	}
+	success &= fclose(file) == 0;
+	file = NULL;
+	
+	remove(filename);
+	success = success && rename(tmpFilename.c_str(), filename) == 0;
+	if(!success) {
+		SDL_Log("Couldn't write cooked mesh file %s\n", filename);
+		remove(tmpFilename.c_str());
+	}
+	
+	return success;
+}
+
+bool meshBinCook(const char *filename, VertexFormat format, const Vertex *vertices, GLuint numVertices,
+		const GLuint *indices, GLuint numIndices, const MeshBinSubmesh *submeshes, GLuint numSubmeshes) {
+	
+	if(numVertices == 0 || numIndices == 0) {
+		SDL_Log("Can't cook an empty mesh to %s\n", filename);
+		return false;
+	}
+	MeshBin mesh;
+	mesh.vertexFormat = format;
+	mesh.vertexSize = (GLsizei)vertexFormatSize(format);
+	mesh.indexType = numVertices > 65536 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+	mesh.numVertices = numVertices;
+	mesh.numIndices = numIndices;
+	
+	for(int c = 0; c < 3; ++c) {
+		mesh.boundsMin[c] = mesh.boundsMax[c] = vertices[0].position[c];
+	}
+	for(GLuint i = 1; i < numVertices; ++i) {
+		for(int c = 0; c < 3; ++c) {
+			float value = vertices[i].position[c];
+			mesh.boundsMin[c] = value < mesh.boundsMin[c] ? value : mesh.boundsMin[c];
+			mesh.boundsMax[c] = value > mesh.boundsMax[c] ? value : mesh.boundsMax[c];
+		}
+	}
+	
+	std::vector<unsigned char> encoded((size_t)numVertices * mesh.vertexSize);
+	if(!vertexQuantize(format, vertices[0].position, vertices[0].texCoord, vertices[0].normal, sizeof(Vertex),
+			numVertices, &encoded[0], &mesh.quantParams, NULL, NULL)) {
+		return false;
+	}
+	mesh.vertices = &encoded[0];
+	
+	std::vector<GLushort> shortIndices;
+	if(mesh.indexType == GL_UNSIGNED_SHORT) {
+		shortIndices.assign(indices, indices + numIndices);
+		mesh.indices = &shortIndices[0];
+	}
+	else {
+		mesh.indices = indices;
+	}
+	
+	// Find each submesh's vertex range (for glDrawRangeElements())
+	MeshBinSubmesh wholeMesh = {0, numIndices, 0, 0};
+	if(!submeshes) {
+		submeshes = &wholeMesh;
+		numSubmeshes = 1;
+	}
+	std::vector<MeshBinSubmesh> ranges(submeshes, submeshes + numSubmeshes);
+	for(MeshBinSubmesh &submesh : ranges) {
+		if(submesh.firstIndex > numIndices || submesh.numIndices > numIndices - submesh.firstIndex ||
+				submesh.numIndices == 0) {
+			SDL_Log("Can't cook %s: a submesh's indices are out of range\n", filename);
+			return false;
+		}
+		submesh.minVertex = indices[submesh.firstIndex];
+		submesh.maxVertex = indices[submesh.firstIndex];
+		for(GLuint i = submesh.firstIndex; i < submesh.firstIndex + submesh.numIndices; ++i) {
+			if(indices[i] >= numVertices) {
+				SDL_Log("Can't cook %s: index %u is out of range\n", filename, indices[i]);
+				return false;
+			}
+			submesh.minVertex = indices[i] < submesh.minVertex ? indices[i] : submesh.minVertex;
+			submesh.maxVertex = indices[i] > submesh.maxVertex ? indices[i] : submesh.maxVertex;
+		}
+	}
+	mesh.submeshes = &ranges[0];
+	mesh.numSubmeshes = numSubmeshes;
+	
+	return meshBinWrite(filename, &mesh);
+}
+
+bool meshBinLoad(const char *filename, MeshBinBuffers *buffers) {
+	
+	memset(buffers, 0, sizeof(MeshBinBuffers));
+	FileMap *meshMap = new FileMap;
+	if(!fileMap(filename, meshMap)) {
+		delete meshMap;
+		return false;
+	}
+	MeshBin mesh;
+	if(!meshBinParse(meshMap->data, meshMap->length, &mesh)) {
+		SDL_Log("Couldn't load mesh %s\n", filename);
+		fileUnmap(meshMap);
+		delete meshMap;
+		return false;
+	}
+	
+	// GL reads the vertices and indices straight from the mapping
+	GLuint names[2];
+	glGenBuffers(2, names);
+	glBindBuffer(GL_ARRAY_BUFFER, names[0]);
+	glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)mesh.numVertices * mesh.vertexSize, mesh.vertices, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, names[1]);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(mesh.numIndices * meshBinIndexSize(mesh.indexType)),
+		mesh.indices, GL_STATIC_DRAW);
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Uploading mesh %s failed, code %u\n", filename, err);
+		glDeleteBuffers(2, names);
+		fileUnmap(meshMap);
+		delete meshMap;
+		return false;
+	}
+	
+	buffers->vbo = names[0];
+	buffers->ibo = names[1];
+	buffers->vertexFormat = mesh.vertexFormat;
+	buffers->quantParams = mesh.quantParams;
+	buffers->indexType = mesh.indexType;
+	memcpy(buffers->boundsMin, mesh.boundsMin, sizeof(buffers->boundsMin));
+	memcpy(buffers->boundsMax, mesh.boundsMax, sizeof(buffers->boundsMax));
+	buffers->numVertices = mesh.numVertices;
+	buffers->numIndices = mesh.numIndices;
+	buffers->submeshes = new MeshBinSubmesh[mesh.numSubmeshes];
+	memcpy(buffers->submeshes, mesh.submeshes, mesh.numSubmeshes * sizeof(MeshBinSubmesh));
+	buffers->numSubmeshes = mesh.numSubmeshes;
+	fileUnmap(meshMap);
+	delete meshMap;
+	
+	return true;
+}
+
+void meshBinBuffersFree(MeshBinBuffers *buffers) {
+	
+	GLuint names[2] = {buffers->vbo, buffers->ibo};
+	glDeleteBuffers(2, names);
+	delete[] buffers->submeshes;
+	memset(buffers, 0, sizeof(MeshBinBuffers));
+}
@@ -0,0 +1,152 @@
+// meshbin.h
+
+#ifndef __MESHBIN_H__
+#define __MESHBIN_H__
+
+#include "vertex.h"
+#include "vertexformat.h"
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+/** A part of a cooked mesh, drawn with:
+ * glDrawRangeElements(GL_TRIANGLES, minVertex, maxVertex, numIndices, indexType,
+ *     (GLvoid*)(firstIndex * indexSize));
+ */
+
+typedef struct MeshBinSubmesh_s {
+	GLuint firstIndex;
+	GLuint numIndices;
+	
+	// The lowest and highest vertex its indices use
+	GLuint minVertex;
+	GLuint maxVertex;
+} MeshBinSubmesh;
+
+/** A mesh in the cooked binary format.
+ * 
+ * The file is a header describing the mesh, the submesh table, then the
+ * vertices and indices laid out exactly as glBufferData() takes them (in the
+ * machine's own byte order). The pointers point into the file's data, so
+ * loading one is a fileMap() and two buffer uploads, with nothing to parse or
+ * convert. Indices are absolute (not relative to each submesh), as GLES 3.0
+ * has no glDrawElementsBaseVertex().
+ */
+
+typedef struct MeshBin_s {
+	// The vertex layout, and how to dequantize it (see vertexQuantize())
+	VertexFormat vertexFormat;
+	GLsizei vertexSize;
+	VertexQuantParams quantParams;
+	
+	// GL_UNSIGNED_SHORT, or GL_UNSIGNED_INT if there are more than 65536 vertices
+	GLenum indexType;
+	
+	// The axis-aligned bounding box of all positions
+	float boundsMin[3];
+	float boundsMax[3];
+	
+	const void *vertices;
+	GLuint numVertices;
+	
+	const void *indices;
+	GLuint numIndices;
+	
+	const MeshBinSubmesh *submeshes;
+	GLuint numSubmeshes;
+} MeshBin;
+
+/** A cooked mesh loaded into buffer objects.
+ */
+
+typedef struct MeshBinBuffers_s {
+	GLuint vbo;
+	GLuint ibo;
+	
+	// The header's details (see MeshBin)
+	VertexFormat vertexFormat;
+	VertexQuantParams quantParams;
+	GLenum indexType;
+	float boundsMin[3];
+	float boundsMax[3];
+	GLuint numVertices;
+	GLuint numIndices;
+	
+	// A copy of the submesh table
+	MeshBinSubmesh *submeshes;
+	GLuint numSubmeshes;
+} MeshBinBuffers;
+
+/** Reads a cooked mesh's header, and finds its submeshes, vertices and indices.
+ * 
+ * Only the header and submesh table are checked; the indices are trusted to
+ * be in range, like a KTX file's texels. This will print any errors to the
+ * console.
+ * 
+ * @param data the file's contents (e.g., from fileMap())
+ * @param length the file's length in bytes
+ * @param mesh where to write the mesh's details to
+ * 
+ * @return bool true if successful
+ */
+
+bool meshBinParse(const void *data, size_t length, MeshBin *mesh);
+
+/** Writes a mesh in the cooked binary format.
+ * 
+ * The file is written to a temporary file first and then renamed, so a
+ * crash can't leave a truncated file behind.
+ * 
+ * @param filename the file to write
+ * @param mesh the mesh to write (the vertices, indices and submeshes are read
+ * from its pointers)
+ * 
+ * @return bool true if successful
+ */
+
+bool meshBinWrite(const char *filename, const MeshBin *mesh);
+
+/** Converts Vertex arrays to a cooked mesh file.
+ * 
+ * The vertices are encoded in the given format, and the indices are stored
+ * as 16-bit if there are 65536 vertices or fewer (32-bit otherwise). This
+ * will print any errors to the console.
+ * 
+ * @param filename the file to write
+ * @param format the vertex format to store
+ * @param vertices the vertices
+ * @param numVertices the number of vertices
+ * @param indices the triangles' indices (into vertices)
+ * @param numIndices the number of indices
+ * @param submeshes each submesh's firstIndex and numIndices (minVertex and
+ * maxVertex are filled in). NULL for a single submesh with all indices
+ * @param numSubmeshes the number of submeshes
+ * 
+ * @return bool true if successful
+ */
+
+bool meshBinCook(const char *filename, VertexFormat format, const Vertex *vertices, GLuint numVertices,
+	const GLuint *indices, GLuint numIndices, const MeshBinSubmesh *submeshes, GLuint numSubmeshes);
+
+/** Loads a cooked mesh into a VBO and IBO.
+ * 
+ * The file is memory-mapped, and its vertices and indices are uploaded
+ * straight from the mapping. The buffers are left bound to GL_ARRAY_BUFFER
+ * and GL_ELEMENT_ARRAY_BUFFER, ready for vertexFormatAttribsSet(). This will
+ * print any errors to the console.
+ * 
+ * @param filename the cooked mesh file
+ * @param buffers where to write the buffers and mesh details to (free them
+ * with meshBinBuffersFree())
+ * 
+ * @return bool true if successful
+ */
+
+bool meshBinLoad(const char *filename, MeshBinBuffers *buffers);
+
+/** Deletes a loaded mesh's buffers, and its submesh table.
+ */
+
+void meshBinBuffersFree(MeshBinBuffers *buffers);
+
+#endif
@@ -0,0 +1,321 @@
+// meshopt.cpp
+//
+// See header file for details
+
+#include "meshopt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+/** A FIFO post-transform cache, simulated with timestamps: a vertex is in the
+ * cache if fewer than cacheSize vertices have missed since it was put there.
+ */
+
+typedef struct MeshOptCache_s {
+	std::vector<size_t> timestamps;
+	size_t time;
+	size_t cacheSize;
+} MeshOptCache;
+
+static void meshOptCacheInit(MeshOptCache *cache, size_t numVertices, int cacheSize) {
+	cache->cacheSize = cacheSize > 0 ? (size_t)cacheSize : 1;
+	cache->timestamps.assign(numVertices, 0);
+	cache->time = cache->cacheSize + 1;
+}
+
+/** Empties the cache (by moving time on, so that every vertex is too old).
+ */
+
+static void meshOptCacheFlush(MeshOptCache *cache) {
+	cache->time += cache->cacheSize + 1;
+}
+
+/** Transforms a vertex (if it isn't in the cache).
+ * 
+ * @return bool true if it was a cache miss
+ */
+
+static inline bool meshOptCacheUse(MeshOptCache *cache, GLuint vertex) {
+	if(cache->time - cache->timestamps[vertex] <= cache->cacheSize) {
+		return false;
+	}
+	cache->timestamps[vertex] = cache->time++;
+	return true;
+}
+
+static inline int meshOptTriangleUse(MeshOptCache *cache, const GLuint *triangle) {
+	return meshOptCacheUse(cache, triangle[0]) + meshOptCacheUse(cache, triangle[1]) +
+		meshOptCacheUse(cache, triangle[2]);
+}
+
+MeshOptStats meshOptAnalyze(const GLuint *indices, size_t numIndices, size_t numVertices, int cacheSize) {
+	
+	MeshOptCache cache;
+	meshOptCacheInit(&cache, numVertices, cacheSize);
+	std::vector<bool> used(numVertices, false);
+	size_t numUsed = 0;
+	MeshOptStats stats;
+	stats.vertexShaderRuns = 0;
+	for(size_t i = 0; i + 2 < numIndices; i += 3) {
+		stats.vertexShaderRuns += meshOptTriangleUse(&cache, &indices[i]);
+		for(size_t c = 0; c < 3; ++c) {
+			numUsed += used[indices[i + c]] ? 0 : 1;
+			used[indices[i + c]] = true;
+		}
+	}
+	size_t numTriangles = numIndices / 3;
+	stats.acmr = numTriangles > 0 ? (float)stats.vertexShaderRuns / numTriangles : 0.0f;
+	stats.atvr = numUsed > 0 ? (float)stats.vertexShaderRuns / numUsed : 0.0f;
+	
+	return stats;
+}
+
+/** Finds a vertex with triangles left when Tipsify runs out of candidates:
+ * the latest one emitted that has any, or else the next in order.
+ * 
+ * @return long the vertex, or -1 if all triangles have been emitted
+ */
+
+static long meshOptDeadEndSkip(std::vector<GLuint> *deadEnds, const std::vector<unsigned int> &liveTriangles,
+		size_t *cursor) {
+	while(!deadEnds->empty()) {
+		GLuint vertex = deadEnds->back();
+		deadEnds->pop_back();
+		if(liveTriangles[vertex] > 0) {
+			return vertex;
+		}
+	}
+	for(; *cursor < liveTriangles.size(); ++*cursor) {
+		if(liveTriangles[*cursor] > 0) {
+			return (long)*cursor;
+		}
+	}
+	
+	return -1;
+}
+
+void meshOptVertexCache(GLuint *indices, size_t numIndices, size_t numVertices, int cacheSize) {
+	
+	size_t numTriangles = numIndices / 3;
+	if(numTriangles == 0) {
+		return;
+	}
+	std::vector<GLuint> input(indices, indices + numTriangles * 3);
+	
+	// Each vertex's triangles (adjacencyOffsets[v] to adjacencyOffsets[v + 1] in adjacency)
+	std::vector<unsigned int> liveTriangles(numVertices, 0);
+	for(size_t i = 0; i < numTriangles * 3; ++i) {
+		++liveTriangles[input[i]];
+	}
+	std::vector<size_t> adjacencyOffsets(numVertices + 1, 0);
+	for(size_t v = 0; v < numVertices; ++v) {
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+	}
+	std::vector<GLuint> adjacency(numTriangles * 3);
+	std::vector<size_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for(size_t t = 0; t < numTriangles; ++t) {
+		for(size_t c = 0; c < 3; ++c) {
+			adjacency[fill[input[t * 3 + c]]++] = (GLuint)t;
+		}
+	}
+	
+	// Timestamps as in MeshOptCache, but kept here as Tipsify scores candidates with them
+	size_t k = cacheSize > 0 ? (size_t)cacheSize : 1;
+	std::vector<size_t> timestamps(numVertices, 0);
+	size_t time = k + 1;
+	std::vector<bool> emitted(numTriangles, false);
+	std::vector<GLuint> deadEnds;
+	std::vector<GLuint> candidates;
+	size_t cursor = 0;
+	size_t out = 0;
+	long fanVertex = input[0];
+	while(fanVertex >= 0) {
+		
+		// Emit all of the fan vertex's remaining triangles
+		candidates.clear();
+		for(size_t a = adjacencyOffsets[fanVertex]; a < adjacencyOffsets[fanVertex + 1]; ++a) {
+			GLuint t = adjacency[a];
+			if(emitted[t]) {
+				continue;
+			}
+			for(size_t c = 0; c < 3; ++c) {
+				GLuint vertex = input[t * 3 + c];
+				indices[out++] = vertex;
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				--liveTriangles[vertex];
+				if(time - timestamps[vertex] > k) {
+					timestamps[vertex] = time++;
+				}
+			}
+			emitted[t] = true;
+		}
+		
+		// Pick the candidate that's been in the cache longest, as long as it'll still be in it
+		// after its own triangles are emitted (each adds at most 2 vertices)
+		long best = -1;
+		size_t bestPriority = 0;
+		for(GLuint vertex : candidates) {
+			if(liveTriangles[vertex] == 0) {
+				continue;
+			}
+			size_t priority = 0;
+			if(time - timestamps[vertex] + 2 * liveTriangles[vertex] <= k) {
+				priority = time - timestamps[vertex];
+			}
+			if(priority > bestPriority) {
+				best = vertex;
+				bestPriority = priority;
+			}
+		}
+		fanVertex = best >= 0 ? best : meshOptDeadEndSkip(&deadEnds, liveTriangles, &cursor);
+	}
+}
+
+/** A run of triangles that meshOptOverdraw() moves as a whole.
+ */
+
+typedef struct MeshOptCluster_s {
+	size_t firstTriangle;
+	size_t numTriangles;
+	float sortKey;
+} MeshOptCluster;
+
+static inline const float *meshOptPosition(const float *positions, size_t positionStride, GLuint vertex) {
+	return (const float*)((const char*)positions + vertex * positionStride);
+}
+
+void meshOptOverdraw(GLuint *indices, size_t numIndices, const float *positions, size_t positionStride,
+		size_t numVertices, int cacheSize, float threshold) {
+	
+	size_t numTriangles = numIndices / 3;
+	if(numTriangles == 0) {
+		return;
+	}
+	
+	// Hard boundaries: where the cache starts over
+	MeshOptCache cache;
+	meshOptCacheInit(&cache, numVertices, cacheSize);
+	std::vector<size_t> hardStarts(1, 0);
+	meshOptTriangleUse(&cache, &indices[0]);
+	for(size_t t = 1; t < numTriangles; ++t) {
+		if(meshOptTriangleUse(&cache, &indices[t * 3]) == 3) {
+			hardStarts.push_back(t);
+		}
+	}
+	hardStarts.push_back(numTriangles);
+	
+	// Soft boundaries: wherever a cluster (starting with an empty cache) has already got
+	// its cache miss ratio down to within threshold of its hard run's
+	std::vector<MeshOptCluster> clusters;
+	for(size_t h = 0; h + 1 < hardStarts.size(); ++h) {
+		size_t start = hardStarts[h];
+		size_t end = hardStarts[h + 1];
+		meshOptCacheFlush(&cache);
+		size_t runMisses = 0;
+		for(size_t t = start; t < end; ++t) {
+			runMisses += meshOptTriangleUse(&cache, &indices[t * 3]);
+		}
+		float maxMissesPerTriangle = threshold * runMisses / (end - start);
+		
+		MeshOptCluster cluster = {start, 0, 0.0f};
+		size_t misses = 0;
+		meshOptCacheFlush(&cache);
+		for(size_t t = start; t < end; ++t) {
+			misses += meshOptTriangleUse(&cache, &indices[t * 3]);
+			++cluster.numTriangles;
+			if(t + 1 < end && misses <= maxMissesPerTriangle * cluster.numTriangles) {
+				clusters.push_back(cluster);
+				cluster.firstTriangle = t + 1;
+				cluster.numTriangles = 0;
+				misses = 0;
+				meshOptCacheFlush(&cache);
+			}
+		}
+		clusters.push_back(cluster);
+	}
+	
+	// Each cluster's (area weighted) centre and normal. The cross product's
+	// length is twice the triangle's area, so it weights both
+	std::vector<float> centres(clusters.size() * 3, 0.0f);
+	std::vector<float> normals(clusters.size() * 3, 0.0f);
+	std::vector<float> areas(clusters.size(), 0.0f);
+	float meshCentre[3] = {0.0f, 0.0f, 0.0f};
+	float meshArea = 0.0f;
+	for(size_t i = 0; i < clusters.size(); ++i) {
+		const MeshOptCluster &cluster = clusters[i];
+		for(size_t t = cluster.firstTriangle; t < cluster.firstTriangle + cluster.numTriangles; ++t) {
+			const float *p0 = meshOptPosition(positions, positionStride, indices[t * 3]);
+			const float *p1 = meshOptPosition(positions, positionStride, indices[t * 3 + 1]);
+			const float *p2 = meshOptPosition(positions, positionStride, indices[t * 3 + 2]);
+			float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+			float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+			float normal[3] = {
+				e1[1] * e2[2] - e1[2] * e2[1],
+				e1[2] * e2[0] - e1[0] * e2[2],
+				e1[0] * e2[1] - e1[1] * e2[0]
+			};
+			float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			for(int c = 0; c < 3; ++c) {
+				float centre = (p0[c] + p1[c] + p2[c]) / 3.0f;
+				centres[i * 3 + c] += centre * area;
+				normals[i * 3 + c] += normal[c];
+				meshCentre[c] += centre * area;
+			}
+			areas[i] += area;
+			meshArea += area;
+		}
+	}
+	for(int c = 0; c < 3; ++c) {
+		meshCentre[c] = meshArea > 0.0f ? meshCentre[c] / meshArea : 0.0f;
+	}
+	for(size_t i = 0; i < clusters.size(); ++i) {
+		const float *normal = &normals[i * 3];
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if(length <= 0.0f || areas[i] <= 0.0f) {
+			continue;
+		}
+		float key = 0.0f;
+		for(int c = 0; c < 3; ++c) {
+			key += (centres[i * 3 + c] / areas[i] - meshCentre[c]) * normal[c] / length;
+		}
+		clusters[i].sortKey = key;
+	}
+	
+	// Outermost first
+	std::stable_sort(clusters.begin(), clusters.end(), [](const MeshOptCluster &a, const MeshOptCluster &b) {
+		return a.sortKey > b.sortKey;
+	});
+	std::vector<GLuint> input(indices, indices + numTriangles * 3);
+	size_t out = 0;
+	for(const MeshOptCluster &cluster : clusters) {
+		memcpy(&indices[out], &input[cluster.firstTriangle * 3], cluster.numTriangles * 3 * sizeof(GLuint));
+		out += cluster.numTriangles * 3;
+	}
+}
+
+size_t meshOptVertexFetch(GLuint *indices, size_t numIndices, void *vertices, size_t numVertices, size_t vertexSize) {
+	
+	const GLuint unused = ~(GLuint)0;
+	std::vector<GLuint> remap(numVertices, unused);
+	GLuint numUsed = 0;
+	for(size_t i = 0; i < numIndices; ++i) {
+		GLuint &newIndex = remap[indices[i]];
+		if(newIndex == unused) {
+			newIndex = numUsed++;
+		}
+		indices[i] = newIndex;
+	}
+	
+	std::vector<unsigned char> input((const unsigned char*)vertices,
+		(const unsigned char*)vertices + numVertices * vertexSize);
+	for(size_t v = 0; v < numVertices; ++v) {
+		if(remap[v] != unused) {
+			memcpy((unsigned char*)vertices + remap[v] * vertexSize, &input[v * vertexSize], vertexSize);
+		}
+	}
+	
+	return numUsed;
+}
@@ -0,0 +1,95 @@
+// meshopt.h
+
+#ifndef __MESHOPT_H__
+#define __MESHOPT_H__
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+// The post-transform vertex cache size to optimize for (in vertices). Small
+// enough that meshes optimized for it do well on GPUs with larger caches
+#define MESH_OPT_CACHE_SIZE 16
+
+/** How well an index buffer uses the post-transform vertex cache, simulated
+ * with a FIFO cache.
+ */
+
+typedef struct MeshOptStats_s {
+	// The number of times the vertex shader runs (cache misses)
+	size_t vertexShaderRuns;
+	
+	// Average cache miss ratio: vertex shader runs per triangle (0.5 is ideal
+	// for large, regular meshes; 3 means no reuse at all)
+	float acmr;
+	
+	// Average transform to vertex ratio: vertex shader runs per vertex used (1 is ideal)
+	float atvr;
+} MeshOptStats;
+
+/** Simulates drawing an index buffer with a FIFO post-transform vertex cache.
+ * 
+ * @param indices the triangles' indices
+ * @param numIndices the number of indices
+ * @param numVertices the number of vertices (all indices must be less than this)
+ * @param cacheSize the cache's size in vertices
+ * 
+ * @return MeshOptStats the statistics
+ */
+
+MeshOptStats meshOptAnalyze(const GLuint *indices, size_t numIndices, size_t numVertices, int cacheSize);
+
+/** Reorders triangles so the vertex shader's results get reused from the
+ * post-transform cache, using Tipsify (Sander, Nehab and Barczak, "Fast
+ * Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007).
+ * 
+ * Tipsify runs in linear time: it fans out around one vertex at a time,
+ * picking the next from the last triangles' vertices that still have
+ * triangles left and will still be in the cache.
+ * 
+ * @param indices the triangles' indices (reordered in place)
+ * @param numIndices the number of indices
+ * @param numVertices the number of vertices (all indices must be less than this)
+ * @param cacheSize the cache's size in vertices (e.g., MESH_OPT_CACHE_SIZE)
+ */
+
+void meshOptVertexCache(GLuint *indices, size_t numIndices, size_t numVertices, int cacheSize);
+
+/** Reorders clusters of triangles so that the ones facing outwards are drawn
+ * first, as they're the likeliest to hide the rest (less overdraw from any
+ * viewpoint). Run this after meshOptVertexCache().
+ * 
+ * The triangles are split into clusters where the cache starts over (all
+ * three vertices missed), and then wherever a cluster's cache miss ratio is
+ * within threshold of its whole run's, so that reordering them costs at most
+ * that much vertex cache efficiency. Clusters are sorted by how far their
+ * centre is in front of the mesh's centre, along their average normal.
+ * 
+ * @param indices the triangles' indices (reordered in place)
+ * @param numIndices the number of indices
+ * @param positions the first vertex's position (3 floats)
+ * @param positionStride the distance between vertices' positions, in bytes
+ * @param numVertices the number of vertices
+ * @param cacheSize the cache size that meshOptVertexCache() was given
+ * @param threshold the worst vertex cache efficiency to accept, relative to
+ * the input's (e.g., 1.05 for up to 5% more vertex shader runs)
+ */
+
+void meshOptOverdraw(GLuint *indices, size_t numIndices, const float *positions, size_t positionStride,
+	size_t numVertices, int cacheSize, float threshold);
+
+/** Reorders vertices to the order the indices first use them, so that vertex
+ * fetches walk through the VBO instead of jumping around it. Unused vertices
+ * are dropped. Run this last.
+ * 
+ * @param indices the triangles' indices (remapped in place)
+ * @param numIndices the number of indices
+ * @param vertices the vertices (reordered in place)
+ * @param numVertices the number of vertices
+ * @param vertexSize the size of each vertex in bytes
+ * 
+ * @return size_t the number of vertices left
+ */
+
+size_t meshOptVertexFetch(GLuint *indices, size_t numIndices, void *vertices, size_t numVertices, size_t vertexSize);
+
+#endif
@@ -0,0 +1,225 @@
+// mipmap.cpp
+//
+// See header file for details
+
+#include "mipmap.h"
+
+#include <SDL.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MIPMAP_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MIPMAP_NEON
+#endif
+
+// Linear values are stored in 14 bits, so that four of them add up without
+// overflowing 16-bit SIMD lanes
+#define MIPMAP_LINEAR_MAX 16383
+
+/** The sRGB <-> linear conversion tables.
+ */
+
+typedef struct MipmapTables_s {
+	uint16_t toLinear[256];
+	uint8_t toSRGB[MIPMAP_LINEAR_MAX + 1];
+} MipmapTables;
+
+static void mipmapTablesInit(MipmapTables *tables) {
+	for(int i = 0; i < 256; ++i) {
+		double c = i / 255.0;
+		double linear = c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+		tables->toLinear[i] = (uint16_t)(linear * MIPMAP_LINEAR_MAX + 0.5);
+	}
+	for(int i = 0; i <= MIPMAP_LINEAR_MAX; ++i) {
+		double linear = (double)i / MIPMAP_LINEAR_MAX;
+		double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+		tables->toSRGB[i] = (uint8_t)(c * 255.0 + 0.5);
+	}
+}
+
+/** Gets the conversion tables (built on first use; thread-safe).
+ */
+
+static const MipmapTables *mipmapTablesGet() {
+	static MipmapTables *tables = []() {
+		MipmapTables *newTables = (MipmapTables*)malloc(sizeof(MipmapTables));
+		if(newTables) {
+			mipmapTablesInit(newTables);
+		}
+		return newTables;
+	}();
+	
+	return tables;
+}
+
+/** Converts an 8-bit image to 4-channel linear.
+ */
+
+static void mipmapToLinear(const MipmapTables *tables, const uint8_t *pixels, int width, int height, int pitch,
+		int bytesPerPixel, int alphaByte, uint16_t *linear) {
+	for(int y = 0; y < height; ++y) {
+		const uint8_t *src = pixels + (size_t)y * pitch;
+		uint16_t *dst = linear + (size_t)y * width * 4;
+		for(int x = 0; x < width; ++x) {
+			for(int c = 0; c < 4; ++c) {
+				if(c >= bytesPerPixel) {
+					dst[c] = 0;
+				}
+				else if(c == alphaByte) {
+					dst[c] = (uint16_t)((src[c] * MIPMAP_LINEAR_MAX + 127) / 255);
+				}
+				else {
+					dst[c] = tables->toLinear[src[c]];
+				}
+			}
+			src += bytesPerPixel;
+			dst += 4;
+		}
+	}
+}
+
+/** Converts a 4-channel linear image back to 8-bit.
+ */
+
+static void mipmapFromLinear(const MipmapTables *tables, const uint16_t *linear, int width, int height,
+		int bytesPerPixel, int alphaByte, uint8_t *pixels, int pitch) {
+	for(int y = 0; y < height; ++y) {
+		const uint16_t *src = linear + (size_t)y * width * 4;
+		uint8_t *dst = pixels + (size_t)y * pitch;
+		for(int x = 0; x < width; ++x) {
+			for(int c = 0; c < bytesPerPixel; ++c) {
+				if(c == alphaByte) {
+					dst[c] = (uint8_t)((src[c] * 255 + MIPMAP_LINEAR_MAX / 2) / MIPMAP_LINEAR_MAX);
+				}
+				else {
+					dst[c] = tables->toSRGB[src[c]];
+				}
+			}
+			src += 4;
+			dst += bytesPerPixel;
+		}
+	}
+}
+
+/** Box filters one row of the level below from two source rows.
+ * 
+ * @param row0 the first source row
+ * @param row1 the second source row (may be the same as row0)
+ * @param srcWidth the source rows' width
+ * @param dst the destination row (max(srcWidth / 2, 1) pixels)
+ */
+
+static void mipmapRowDownsample(const uint16_t *row0, const uint16_t *row1, int srcWidth, uint16_t *dst) {
+	if(srcWidth == 1) {
+		for(int c = 0; c < 4; ++c) {
+			dst[c] = (uint16_t)((row0[c] + row1[c] + 1) >> 1);
+		}
+		return;
+	}
+	
+	int dstWidth = srcWidth / 2;
+	int x = 0;
+#if defined(MIPMAP_SSE2)
+	// Two destination pixels (four source pixels from each row) at a time
+	const __m128i rounding = _mm_set1_epi16(2);
+	for(; x + 2 <= dstWidth; x += 2) {
+		__m128i sum01 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(row0 + x * 8)),
+			_mm_loadu_si128((const __m128i*)(row1 + x * 8)));
+		__m128i sum23 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(row0 + x * 8 + 8)),
+			_mm_loadu_si128((const __m128i*)(row1 + x * 8 + 8)));
+		
+		// Add each pair of horizontally neighbouring pixels
+		__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23), _mm_unpackhi_epi64(sum01, sum23));
+		sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+		_mm_storeu_si128((__m128i*)(dst + x * 4), sum);
+	}
+#elif defined(MIPMAP_NEON)
+	for(; x + 2 <= dstWidth; x += 2) {
+		uint16x8_t sum01 = vaddq_u16(vld1q_u16(row0 + x * 8), vld1q_u16(row1 + x * 8));
+		uint16x8_t sum23 = vaddq_u16(vld1q_u16(row0 + x * 8 + 8), vld1q_u16(row1 + x * 8 + 8));
+		
+		// Add each pair of horizontally neighbouring pixels
+		uint16x8_t sum = vaddq_u16(vcombine_u16(vget_low_u16(sum01), vget_low_u16(sum23)),
+			vcombine_u16(vget_high_u16(sum01), vget_high_u16(sum23)));
+		vst1q_u16(dst + x * 4, vrshrq_n_u16(sum, 2));
+	}
+#endif
+	for(; x < dstWidth; ++x) {
+		const uint16_t *src0 = row0 + x * 8;
+		const uint16_t *src1 = row1 + x * 8;
+		for(int c = 0; c < 4; ++c) {
+			dst[x * 4 + c] = (uint16_t)((src0[c] + src0[c + 4] + src1[c] + src1[c + 4] + 2) >> 2);
+		}
+	}
+}
+
+int mipmapLevelCount(int width, int height) {
+	int numLevels = 1;
+	while(width > 1 || height > 1) {
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		++numLevels;
+	}
+	
+	return numLevels;
+}
+
+bool mipmapChainBuild(const void *pixels, int width, int height, int pitch, int bytesPerPixel, int alphaByte,
+		MipmapLevelFunc levelFunc, void *userData) {
+	if(bytesPerPixel != 3 && bytesPerPixel != 4) {
+		SDL_Log("Can't build mipmaps for %d bytes per pixel\n", bytesPerPixel);
+		return false;
+	}
+	const MipmapTables *tables = mipmapTablesGet();
+	
+	// The linear levels ping-pong between src and dst; the 8-bit output
+	// buffer is reused for every level (they're all smaller than level 1)
+	int level1Width = width > 1 ? width / 2 : 1;
+	int level1Height = height > 1 ? height / 2 : 1;
+	int level1Pitch = (level1Width * bytesPerPixel + 3) & ~3;
+	uint16_t *src = (uint16_t*)malloc((size_t)width * height * 4 * sizeof(uint16_t));
+	uint16_t *dst = (uint16_t*)malloc((size_t)level1Width * level1Height * 4 * sizeof(uint16_t));
+	uint8_t *levelPixels = (uint8_t*)malloc((size_t)level1Pitch * level1Height);
+	if(!tables || !src || !dst || !levelPixels) {
+		SDL_Log("Can't build mipmaps; out of memory\n");
+		free(src);
+		free(dst);
+		free(levelPixels);
+		return false;
+	}
+	
+	mipmapToLinear(tables, (const uint8_t*)pixels, width, height, pitch, bytesPerPixel, alphaByte, src);
+	
+	bool success = true;
+	for(int level = 1; success && (width > 1 || height > 1); ++level) {
+		int dstWidth = width > 1 ? width / 2 : 1;
+		int dstHeight = height > 1 ? height / 2 : 1;
+		for(int y = 0; y < dstHeight; ++y) {
+			const uint16_t *row0 = src + (size_t)(height > 1 ? y * 2 : 0) * width * 4;
+			const uint16_t *row1 = height > 1 ? row0 + (size_t)width * 4 : row0;
+			mipmapRowDownsample(row0, row1, width, dst + (size_t)y * dstWidth * 4);
+		}
+		
+		int levelPitch = (dstWidth * bytesPerPixel + 3) & ~3;
+		mipmapFromLinear(tables, dst, dstWidth, dstHeight, bytesPerPixel, alphaByte, levelPixels, levelPitch);
+		success = levelFunc(level, dstWidth, dstHeight, levelPixels, levelPitch, userData);
+		
+		// This level is the source for the next one
+		uint16_t *temp = src;
+		src = dst;
+		dst = temp;
+		width = dstWidth;
+		height = dstHeight;
+	}
+	
+	free(src);
+	free(dst);
+	free(levelPixels);
+	
+	return success;
+}
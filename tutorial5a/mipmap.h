@@ -0,0 +1,55 @@
+// mipmap.h
+
+#ifndef __MIPMAP_H__
+#define __MIPMAP_H__
+
+/** Receives one mipmap level from mipmapChainBuild().
+ * 
+ * @param level the level number (1 is half of the original image's size)
+ * @param width the level's width in pixels
+ * @param height the level's height in pixels
+ * @param pixels the level's pixels, in the original image's channel order
+ * @param pitch the number of bytes per row (always a multiple of 4, to match
+ * OpenGL's default GL_UNPACK_ALIGNMENT)
+ * @param userData the userData that was passed to mipmapChainBuild()
+ * 
+ * @return bool true to carry on, false to stop
+ */
+
+typedef bool (*MipmapLevelFunc)(int level, int width, int height, const void *pixels, int pitch, void *userData);
+
+/** Gets the number of levels in a full mipmap chain, including level 0.
+ */
+
+int mipmapLevelCount(int width, int height);
+
+/** Builds a full mipmap chain for an 8-bit per channel image on the CPU.
+ * 
+ * Each level is a 2x2 box filter of the previous one, done in linear light
+ * (the colour channels are treated as sRGB and converted to linear before
+ * averaging, so that minified textures don't come out darker than they
+ * should). The levels are kept at 14-bit linear precision in between, so
+ * rounding doesn't build up down the chain. The filtering is done with SSE2
+ * or NEON where available.
+ * 
+ * NOTE: Odd rows/columns are dropped by the level below (like
+ * glGenerateMipmap() on most drivers).
+ * 
+ * @param pixels the image (level 0)
+ * @param width the image's width in pixels
+ * @param height the image's height in pixels
+ * @param pitch the number of bytes per row of pixels
+ * @param bytesPerPixel the number of channels (3 or 4)
+ * @param alphaByte the alpha channel's byte offset in a pixel (alpha is
+ * averaged as is), or -1 if there isn't one
+ * @param levelFunc called with each level, from level 1 to 1x1
+ * @param userData passed on to levelFunc
+ * 
+ * @return bool true if successful, false if out of memory, the format isn't
+ * supported, or levelFunc returned false
+ */
+
+bool mipmapChainBuild(const void *pixels, int width, int height, int pitch, int bytesPerPixel, int alphaByte,
+	MipmapLevelFunc levelFunc, void *userData);
+
+#endif
@@ -0,0 +1,706 @@
+// objload.cpp
+//
+// See header file for details
+
+#include "objload.h"
+#include "filemap.h"
+
+#include <SDL.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// 16-bit indices can only reach this many vertices
+#define OBJ_MAX_SUBMESH_VERTICES 65536
+
+// Chunks smaller than this aren't worth a thread of their own
+#define OBJ_MIN_CHUNK_SIZE (256 * 1024)
+
+// The welding hash table's size (a power of two, at least twice OBJ_MAX_SUBMESH_VERTICES)
+#define OBJ_WELD_TABLE_SIZE (1 << 17)
+
+// Negative (relative) indices can't be made absolute until the number of
+// vertices in the chunks before is known, so they're stored as the chunk-local
+// index minus this. Anything below -1 is relative; -1 means "none"
+#define OBJ_RELATIVE_BIAS (1 << 30)
+
+/** A face corner's position, texture coordinate and normal indices (0-based; -1 for none).
+ */
+
+typedef struct ObjCorner_s {
+	int position;
+	int texCoord;
+	int normal;
+} ObjCorner;
+
+/** The attributes of all chunks, concatenated.
+ */
+
+typedef struct ObjAttribs_s {
+	const float *positions;
+	size_t numPositions;
+	const float *texCoords;
+	size_t numTexCoords;
+	const float *normals;
+	size_t numNormals;
+} ObjAttribs;
+
+typedef struct ObjChunk_s {
+	// The text to parse
+	const char *start;
+	const char *end;
+	
+	// Parsed; three corners per triangle
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+	std::vector<float> normals;
+	std::vector<ObjCorner> corners;
+	
+	// The number of each attribute in the chunks before this one
+	size_t positionBase;
+	size_t texCoordBase;
+	size_t normalBase;
+	const ObjAttribs *attribs;
+	
+	// Welded (submeshes' baseVertex and firstIndex are relative to this chunk)
+	std::vector<Vertex> vertices;
+	std::vector<GLushort> indices;
+	std::vector<ObjSubmesh> submeshes;
+	
+	// Each welded vertex's position index, or -1 if the OBJ gave it a normal
+	std::vector<int> vertexPositions;
+	
+	// The line an error was found at (NULL if none), and what it was
+	const char *errorLine;
+	const char *error;
+} ObjChunk;
+
+typedef struct ObjWeldEntry_s {
+	ObjCorner key;
+	unsigned int generation;
+	GLushort index;
+} ObjWeldEntry;
+
+static inline bool objIsSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char *objSkipSpace(const char *p, const char *end) {
+	while(p < end && objIsSpace(*p)) {
+		++p;
+	}
+	return p;
+}
+
+/** Parses a decimal float (with an optional exponent). Like std::from_chars(),
+ * this doesn't check the locale, or allocate.
+ * 
+ * @return const char* the character after the number (NULL if there wasn't one)
+ */
+
+static const char *objParseFloat(const char *p, const char *end, float *value) {
+	static const double powersOf10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	
+	p = objSkipSpace(p, end);
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+	
+	// Digits past what a uint64_t holds only move the exponent
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	int numDigits = 0;
+	for(; p < end && *p >= '0' && *p <= '9'; ++p, ++numDigits) {
+		if(mantissa < 100000000000000000ULL) {
+			mantissa = mantissa * 10 + (*p - '0');
+		}
+		else {
+			++exponent;
+		}
+	}
+	if(p < end && *p == '.') {
+		for(++p; p < end && *p >= '0' && *p <= '9'; ++p, ++numDigits) {
+			if(mantissa < 100000000000000000ULL) {
+				mantissa = mantissa * 10 + (*p - '0');
+				--exponent;
+			}
+		}
+	}
+	if(numDigits == 0) {
+		return NULL;
+	}
+	if(p < end && (*p == 'e' || *p == 'E')) {
+		const char *q = p + 1;
+		bool negativeExp = false;
+		if(q < end && (*q == '-' || *q == '+')) {
+			negativeExp = *q == '-';
+			++q;
+		}
+		if(q < end && *q >= '0' && *q <= '9') {
+			int exp = 0;
+			for(; q < end && *q >= '0' && *q <= '9'; ++q) {
+				exp = exp < 10000 ? exp * 10 + (*q - '0') : exp;
+			}
+			exponent += negativeExp ? -exp : exp;
+			p = q;
+		}
+	}
+	
+	double result = (double)mantissa;
+	if(exponent >= 0 && exponent <= 22) {
+		result *= powersOf10[exponent];
+	}
+	else if(exponent < 0 && exponent >= -22) {
+		result /= powersOf10[-exponent];
+	}
+	else {
+		result *= pow(10.0, exponent);
+	}
+	*value = (float)(negative ? -result : result);
+	
+	return p;
+}
+
+/** Parses a vertex index, and converts it to a 0-based one (see OBJ_RELATIVE_BIAS).
+ * 
+ * @param localCount the number of this attribute parsed in this chunk so far
+ * 
+ * @return const char* the character after the index (NULL if it isn't valid)
+ */
+
+static const char *objParseIndex(const char *p, const char *end, size_t localCount, int *index) {
+	bool negative = false;
+	if(p < end && *p == '-') {
+		negative = true;
+		++p;
+	}
+	if(p >= end || *p < '0' || *p > '9') {
+		return NULL;
+	}
+	long long value = 0;
+	for(; p < end && *p >= '0' && *p <= '9'; ++p) {
+		value = value * 10 + (*p - '0');
+		if(value >= OBJ_RELATIVE_BIAS) {
+			return NULL;
+		}
+	}
+	if(value == 0) {
+		return NULL;
+	}
+	*index = negative ? (int)((long long)localCount - value - OBJ_RELATIVE_BIAS) : (int)(value - 1);
+	
+	return p;
+}
+
+/** Parses the floats on a v, vt or vn line.
+ * 
+ * @param minCount the number of floats required
+ * @param count the number of floats to store (missing optional ones are 0)
+ * 
+ * @return bool true if successful
+ */
+
+static bool objParseFloats(const char *p, const char *end, int minCount, int count, std::vector<float> *out) {
+	for(int i = 0; i < count; ++i) {
+		float value = 0.0f;
+		const char *next = objParseFloat(p, end, &value);
+		if(!next) {
+			if(i < minCount) {
+				return false;
+			}
+			value = 0.0f;
+		}
+		else {
+			p = next;
+		}
+		out->push_back(value);
+	}
+	
+	return true;
+}
+
+/** Parses an f line's corners, and splits the polygon into a triangle fan.
+ * 
+ * @return const char* an error message (NULL if successful)
+ */
+
+static const char *objParseFace(ObjChunk *chunk, const char *p, const char *end, std::vector<ObjCorner> *polygon) {
+	size_t numPositions = chunk->positions.size() / 3;
+	size_t numTexCoords = chunk->texCoords.size() / 2;
+	size_t numNormals = chunk->normals.size() / 3;
+	
+	polygon->clear();
+	for(p = objSkipSpace(p, end); p < end; p = objSkipSpace(p, end)) {
+		ObjCorner corner = {-1, -1, -1};
+		p = objParseIndex(p, end, numPositions, &corner.position);
+		if(p && p < end && *p == '/') {
+			++p;
+			if(p < end && *p != '/') {
+				p = objParseIndex(p, end, numTexCoords, &corner.texCoord);
+			}
+			if(p && p < end && *p == '/') {
+				p = objParseIndex(p + 1, end, numNormals, &corner.normal);
+			}
+		}
+		if(!p || (p < end && !objIsSpace(*p))) {
+			return "Invalid face index";
+		}
+		polygon->push_back(corner);
+	}
+	if(polygon->size() < 3) {
+		return "Face with less than 3 corners";
+	}
+	
+	for(size_t i = 2; i < polygon->size(); ++i) {
+		chunk->corners.push_back((*polygon)[0]);
+		chunk->corners.push_back((*polygon)[i - 1]);
+		chunk->corners.push_back((*polygon)[i]);
+	}
+	
+	return NULL;
+}
+
+/** Parses a chunk's lines (thread function).
+ */
+
+static int objChunkParse(void *data) {
+	ObjChunk *chunk = (ObjChunk*)data;
+	std::vector<ObjCorner> polygon;
+	
+	for(const char *p = chunk->start; p < chunk->end && !chunk->errorLine;) {
+		const char *line = p;
+		const char *lineEnd = (const char*)memchr(p, '\n', chunk->end - p);
+		lineEnd = lineEnd ? lineEnd : chunk->end;
+		
+		p = objSkipSpace(p, lineEnd);
+		if(lineEnd - p >= 2 && p[0] == 'v' && objIsSpace(p[1])) {
+			if(!objParseFloats(p + 2, lineEnd, 3, 3, &chunk->positions)) {
+				chunk->error = "Invalid vertex position";
+			}
+		}
+		else if(lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && objIsSpace(p[2])) {
+			if(!objParseFloats(p + 3, lineEnd, 1, 2, &chunk->texCoords)) {
+				chunk->error = "Invalid texture coordinate";
+			}
+		}
+		else if(lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && objIsSpace(p[2])) {
+			if(!objParseFloats(p + 3, lineEnd, 3, 3, &chunk->normals)) {
+				chunk->error = "Invalid normal";
+			}
+		}
+		else if(lineEnd - p >= 2 && p[0] == 'f' && objIsSpace(p[1])) {
+			chunk->error = objParseFace(chunk, p + 2, lineEnd, &polygon);
+		}
+		if(chunk->error) {
+			chunk->errorLine = line;
+		}
+		p = lineEnd + 1;
+	}
+	
+	return 0;
+}
+
+/** Turns a chunk-local (or relative) index into an index into ObjAttribs.
+ * 
+ * @return bool true if it's in range (or -1, if optional)
+ */
+
+static inline bool objIndexResolve(int *index, size_t base, size_t count, bool optional) {
+	if(*index == -1) {
+		return optional;
+	}
+	long long resolved = *index < -1 ? (long long)*index + OBJ_RELATIVE_BIAS + (long long)base : *index;
+	if(resolved < 0 || resolved >= (long long)count) {
+		return false;
+	}
+	*index = (int)resolved;
+	
+	return true;
+}
+
+static inline unsigned int objCornerHash(const ObjCorner &corner) {
+	unsigned int hash = (unsigned int)corner.position * 0x9E3779B1u;
+	hash ^= (unsigned int)corner.texCoord * 0x85EBCA77u;
+	hash ^= (unsigned int)corner.normal * 0xC2B2AE3Du;
+	return hash ^ (hash >> 15);
+}
+
+/** Closes the current submesh (if it has anything in it), and starts the next.
+ */
+
+static void objSubmeshNext(ObjChunk *chunk, ObjSubmesh *submesh) {
+	if(submesh->numIndices > 0) {
+		chunk->submeshes.push_back(*submesh);
+	}
+	submesh->baseVertex = (GLuint)chunk->vertices.size();
+	submesh->numVertices = 0;
+	submesh->firstIndex = (GLuint)chunk->indices.size();
+	submesh->numIndices = 0;
+}
+
+/** Turns a chunk's corners into welded vertices and indices (thread function).
+ */
+
+static int objChunkWeld(void *data) {
+	ObjChunk *chunk = (ObjChunk*)data;
+	const ObjAttribs *attribs = chunk->attribs;
+	
+	// A new generation empties the table for the next submesh without clearing it
+	std::vector<ObjWeldEntry> table(OBJ_WELD_TABLE_SIZE);
+	for(ObjWeldEntry &entry : table) {
+		entry.generation = 0;
+	}
+	unsigned int generation = 1;
+	
+	ObjSubmesh submesh = {0, 0, 0, 0};
+	size_t numCorners = chunk->corners.size();
+	chunk->vertices.reserve(numCorners / 4);
+	chunk->indices.reserve(numCorners);
+	chunk->vertexPositions.reserve(numCorners / 4);
+	for(size_t t = 0; t < numCorners; t += 3) {
+		if(submesh.numVertices + 3 > OBJ_MAX_SUBMESH_VERTICES) {
+			objSubmeshNext(chunk, &submesh);
+			++generation;
+		}
+		
+		for(size_t c = 0; c < 3; ++c) {
+			ObjCorner corner = chunk->corners[t + c];
+			if(!objIndexResolve(&corner.position, chunk->positionBase, attribs->numPositions, false) ||
+					!objIndexResolve(&corner.texCoord, chunk->texCoordBase, attribs->numTexCoords, true) ||
+					!objIndexResolve(&corner.normal, chunk->normalBase, attribs->numNormals, true)) {
+				chunk->error = "Face index out of range";
+				return 0;
+			}
+			
+			unsigned int slot = objCornerHash(corner) & (OBJ_WELD_TABLE_SIZE - 1);
+			for(;; slot = (slot + 1) & (OBJ_WELD_TABLE_SIZE - 1)) {
+				ObjWeldEntry &entry = table[slot];
+				if(entry.generation != generation) {
+					entry.key = corner;
+					entry.generation = generation;
+					entry.index = (GLushort)submesh.numVertices++;
+					
+					Vertex vertex;
+					memcpy(vertex.position, &attribs->positions[(size_t)corner.position * 3], sizeof(vertex.position));
+					if(corner.texCoord >= 0) {
+						// OBJ's v goes up from the bottom, but textures' first row is the top
+						vertex.texCoord[0] = attribs->texCoords[(size_t)corner.texCoord * 2];
+						vertex.texCoord[1] = 1.0f - attribs->texCoords[(size_t)corner.texCoord * 2 + 1];
+					}
+					else {
+						vertex.texCoord[0] = vertex.texCoord[1] = 0.0f;
+					}
+					if(corner.normal >= 0) {
+						memcpy(vertex.normal, &attribs->normals[(size_t)corner.normal * 3], sizeof(vertex.normal));
+					}
+					else {
+						vertex.normal[0] = vertex.normal[1] = vertex.normal[2] = 0.0f;
+					}
+					chunk->vertices.push_back(vertex);
+					chunk->vertexPositions.push_back(corner.normal < 0 ? corner.position : -1);
+					break;
+				}
+				if(entry.key.position == corner.position && entry.key.texCoord == corner.texCoord &&
+						entry.key.normal == corner.normal) {
+					break;
+				}
+			}
+			chunk->indices.push_back(table[slot].index);
+		}
+		submesh.numIndices += 3;
+	}
+	objSubmeshNext(chunk, &submesh);
+	
+	return 0;
+}
+
+/** Generates the normals that the OBJ didn't give. Each face's normal is summed
+ * per position across the whole mesh, so vertices that were split between
+ * chunks or submeshes (or by texture coordinates) still get the same normal.
+ */
+
+static void objSmoothNormals(ObjMesh *mesh, const std::vector<ObjChunk> &chunks, size_t numPositions) {
+	std::vector<int> vertexPositions;
+	vertexPositions.reserve(mesh->numVertices);
+	for(const ObjChunk &chunk : chunks) {
+		vertexPositions.insert(vertexPositions.end(), chunk.vertexPositions.begin(), chunk.vertexPositions.end());
+	}
+	
+	// The cross product's length is twice the triangle's area, so larger triangles count for more
+	std::vector<float> positionNormals;
+	for(GLuint s = 0; s < mesh->numSubmeshes; ++s) {
+		const ObjSubmesh &submesh = mesh->submeshes[s];
+		const GLushort *indices = &mesh->indices[submesh.firstIndex];
+		for(GLuint i = 0; i < submesh.numIndices; i += 3) {
+			GLuint triangle[3] = {
+				submesh.baseVertex + indices[i],
+				submesh.baseVertex + indices[i + 1],
+				submesh.baseVertex + indices[i + 2]
+			};
+			if(vertexPositions[triangle[0]] < 0 && vertexPositions[triangle[1]] < 0 &&
+					vertexPositions[triangle[2]] < 0) {
+				continue;
+			}
+			if(positionNormals.empty()) {
+				positionNormals.resize(numPositions * 3, 0.0f);
+			}
+			
+			const float *p0 = mesh->vertices[triangle[0]].position;
+			const float *p1 = mesh->vertices[triangle[1]].position;
+			const float *p2 = mesh->vertices[triangle[2]].position;
+			float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+			float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+			float normal[3] = {
+				e1[1] * e2[2] - e1[2] * e2[1],
+				e1[2] * e2[0] - e1[0] * e2[2],
+				e1[0] * e2[1] - e1[1] * e2[0]
+			};
+			for(int c = 0; c < 3; ++c) {
+				int position = vertexPositions[triangle[c]];
+				if(position >= 0) {
+					float *n = &positionNormals[(size_t)position * 3];
+					n[0] += normal[0];
+					n[1] += normal[1];
+					n[2] += normal[2];
+				}
+			}
+		}
+	}
+	if(positionNormals.empty()) {
+		return;
+	}
+	
+	for(GLuint i = 0; i < mesh->numVertices; ++i) {
+		if(vertexPositions[i] >= 0) {
+			const float *sum = &positionNormals[(size_t)vertexPositions[i] * 3];
+			float *n = mesh->vertices[i].normal;
+			float length = sqrtf(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+			if(length > 0.0f) {
+				n[0] = sum[0] / length;
+				n[1] = sum[1] / length;
+				n[2] = sum[2] / length;
+			}
+			else {
+				n[2] = 1.0f;
+			}
+		}
+	}
+}
+
+/** Runs a thread function on every chunk, with this thread taking the first.
+ * If a thread can't be started, its chunk is done on this thread afterwards.
+ */
+
+static void objChunksRun(std::vector<ObjChunk> *chunks, SDL_ThreadFunction func) {
+	std::vector<SDL_Thread*> threads(chunks->size(), NULL);
+	for(size_t i = 1; i < chunks->size(); ++i) {
+		threads[i] = SDL_CreateThread(func, "ObjLoad", &(*chunks)[i]);
+	}
+	func(&(*chunks)[0]);
+	for(size_t i = 1; i < chunks->size(); ++i) {
+		if(threads[i]) {
+			SDL_WaitThread(threads[i], NULL);
+		}
+		else {
+			func(&(*chunks)[i]);
+		}
+	}
+}
+
+/** Prints the first chunk error (if any) with its line number.
+ * 
+ * @return bool true if there were no errors
+ */
+
+static bool objChunksCheck(const char *filename, const FileMap *file, const std::vector<ObjChunk> &chunks) {
+	for(const ObjChunk &chunk : chunks) {
+		if(chunk.error) {
+			if(chunk.errorLine) {
+				size_t lineNum = 1;
+				for(const char *p = file->data; p < chunk.errorLine; ++p) {
+					lineNum += *p == '\n' ? 1 : 0;
+				}
+				SDL_Log("%s in %s, line %u\n", chunk.error, filename, (unsigned int)lineNum);
+			}
+			else {
+				SDL_Log("%s in %s\n", chunk.error, filename);
+			}
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+bool objLoad(const char *filename, int numThreads, ObjMesh *mesh, ObjLoadStats *stats) {
+	
+	memset(mesh, 0, sizeof(ObjMesh));
+	FileMap *file = new FileMap;
+	if(!fileMap(filename, file)) {
+		delete file;
+		return false;
+	}
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	
+	// Split the file into chunks at line breaks
+	if(numThreads <= 0) {
+		numThreads = SDL_GetCPUCount();
+	}
+	size_t maxChunks = file->length / OBJ_MIN_CHUNK_SIZE;
+	size_t numChunks = (size_t)numThreads < maxChunks ? (size_t)numThreads : maxChunks;
+	numChunks = numChunks < 1 ? 1 : numChunks;
+	std::vector<ObjChunk> chunks(numChunks);
+	const char *fileEnd = file->data + file->length;
+	const char *chunkStart = file->data;
+	for(size_t i = 0; i < numChunks; ++i) {
+		ObjChunk &chunk = chunks[i];
+		const char *chunkEnd = fileEnd;
+		if(i + 1 < numChunks) {
+			chunkEnd = file->data + file->length / numChunks * (i + 1);
+			chunkEnd = chunkEnd > chunkStart ? chunkEnd : chunkStart;
+			const char *lineEnd = (const char*)memchr(chunkEnd, '\n', fileEnd - chunkEnd);
+			chunkEnd = lineEnd ? lineEnd + 1 : fileEnd;
+		}
+		chunk.start = chunkStart;
+		chunk.end = chunkEnd;
+		chunk.errorLine = NULL;
+		chunk.error = NULL;
+		chunkStart = chunkEnd;
+	}
+	objChunksRun(&chunks, objChunkParse);
+	bool success = objChunksCheck(filename, file, chunks);
+	
+	// Gather the attributes, so faces can refer to any chunk's
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+	std::vector<float> normals;
+	ObjAttribs attribs;
+	size_t numTriangles = 0;
+	if(success) {
+		size_t numPositions = 0;
+		size_t numTexCoords = 0;
+		size_t numNormals = 0;
+		for(ObjChunk &chunk : chunks) {
+			chunk.positionBase = numPositions;
+			chunk.texCoordBase = numTexCoords;
+			chunk.normalBase = numNormals;
+			chunk.attribs = &attribs;
+			numPositions += chunk.positions.size() / 3;
+			numTexCoords += chunk.texCoords.size() / 2;
+			numNormals += chunk.normals.size() / 3;
+			numTriangles += chunk.corners.size() / 3;
+		}
+		if(numChunks == 1) {
+			positions.swap(chunks[0].positions);
+			texCoords.swap(chunks[0].texCoords);
+			normals.swap(chunks[0].normals);
+		}
+		else {
+			positions.reserve(numPositions * 3);
+			texCoords.reserve(numTexCoords * 2);
+			normals.reserve(numNormals * 3);
+			for(ObjChunk &chunk : chunks) {
+				positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+				texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+				normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+				std::vector<float>().swap(chunk.positions);
+				std::vector<float>().swap(chunk.texCoords);
+				std::vector<float>().swap(chunk.normals);
+			}
+		}
+		attribs.positions = positions.empty() ? NULL : &positions[0];
+		attribs.numPositions = numPositions;
+		attribs.texCoords = texCoords.empty() ? NULL : &texCoords[0];
+		attribs.numTexCoords = numTexCoords;
+		attribs.normals = normals.empty() ? NULL : &normals[0];
+		attribs.numNormals = numNormals;
+		
+		if(numTriangles == 0) {
+			SDL_Log("%s has no faces\n", filename);
+			success = false;
+		}
+	}
+	Uint64 parsedTime = SDL_GetPerformanceCounter();
+	
+	if(success) {
+		objChunksRun(&chunks, objChunkWeld);
+		success = objChunksCheck(filename, file, chunks);
+	}
+	
+	// Concatenate the chunks, moving their submeshes along with them
+	if(success) {
+		size_t numVertices = 0;
+		size_t numIndices = 0;
+		size_t numSubmeshes = 0;
+		for(const ObjChunk &chunk : chunks) {
+			numVertices += chunk.vertices.size();
+			numIndices += chunk.indices.size();
+			numSubmeshes += chunk.submeshes.size();
+		}
+		mesh->vertices = new Vertex[numVertices];
+		mesh->indices = new GLushort[numIndices];
+		mesh->submeshes = new ObjSubmesh[numSubmeshes];
+		for(const ObjChunk &chunk : chunks) {
+			if(chunk.vertices.empty()) {
+				continue;
+			}
+			memcpy(&mesh->vertices[mesh->numVertices], &chunk.vertices[0], chunk.vertices.size() * sizeof(Vertex));
+			memcpy(&mesh->indices[mesh->numIndices], &chunk.indices[0], chunk.indices.size() * sizeof(GLushort));
+			for(ObjSubmesh submesh : chunk.submeshes) {
+				submesh.baseVertex += mesh->numVertices;
+				submesh.firstIndex += mesh->numIndices;
+				mesh->submeshes[mesh->numSubmeshes++] = submesh;
+			}
+			mesh->numVertices += (GLuint)chunk.vertices.size();
+			mesh->numIndices += (GLuint)chunk.indices.size();
+		}
+		objSmoothNormals(mesh, chunks, attribs.numPositions);
+	}
+	Uint64 endTime = SDL_GetPerformanceCounter();
+	
+	if(stats) {
+		stats->fileBytes = file->length;
+		stats->numThreads = (int)numChunks;
+		stats->numPositions = positions.size() / 3;
+		stats->numTexCoords = texCoords.size() / 2;
+		stats->numNormals = normals.size() / 3;
+		stats->numTriangles = numTriangles;
+		stats->parseMs = (parsedTime - startTime) * msPerTick;
+		stats->weldMs = (endTime - parsedTime) * msPerTick;
+	}
+	fileUnmap(file);
+	delete file;
+	
+	return success;
+}
+
+void objMeshAbsoluteIndices(const ObjMesh *mesh, GLuint *indices, MeshBinSubmesh *submeshes) {
+	for(GLuint i = 0; i < mesh->numSubmeshes; ++i) {
+		const ObjSubmesh &objSubmesh = mesh->submeshes[i];
+		for(GLuint j = objSubmesh.firstIndex; j < objSubmesh.firstIndex + objSubmesh.numIndices; ++j) {
+			indices[j] = mesh->indices[j] + objSubmesh.baseVertex;
+		}
+		if(submeshes) {
+			MeshBinSubmesh &submesh = submeshes[i];
+			submesh.firstIndex = objSubmesh.firstIndex;
+			submesh.numIndices = objSubmesh.numIndices;
+			submesh.minVertex = objSubmesh.baseVertex;
+			submesh.maxVertex = objSubmesh.baseVertex + objSubmesh.numVertices - 1;
+		}
+	}
+}
+
+void objMeshFree(ObjMesh *mesh) {
+	
+	delete[] mesh->vertices;
+	delete[] mesh->indices;
+	delete[] mesh->submeshes;
+	memset(mesh, 0, sizeof(ObjMesh));
+}
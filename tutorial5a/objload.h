@@ -0,0 +1,102 @@
+// objload.h
+
+#ifndef __OBJLOAD_H__
+#define __OBJLOAD_H__
+
+#include "meshbin.h"
+#include "vertex.h"
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+/** A part of an ObjMesh with up to 65536 vertices, so that it can be drawn
+ * with 16-bit indices.
+ */
+
+typedef struct ObjSubmesh_s {
+	// Its vertices are vertices[baseVertex] to vertices[baseVertex + numVertices - 1]
+	GLuint baseVertex;
+	GLuint numVertices;
+	
+	// Its indices are indices[firstIndex] onwards (relative to baseVertex)
+	GLuint firstIndex;
+	GLuint numIndices;
+} ObjSubmesh;
+
+/** A triangle mesh loaded from a Wavefront OBJ file.
+ * 
+ * Each submesh is ready for vboCreate(&vertices[baseVertex], numVertices)
+ * and iboCreate(&indices[firstIndex], numIndices) (or bufferArenaAlloc()).
+ */
+
+typedef struct ObjMesh_s {
+	Vertex *vertices;
+	GLuint numVertices;
+	
+	GLushort *indices;
+	GLuint numIndices;
+	
+	ObjSubmesh *submeshes;
+	GLuint numSubmeshes;
+} ObjMesh;
+
+/** What was in an OBJ file, and how long loading it took.
+ */
+
+typedef struct ObjLoadStats_s {
+	size_t fileBytes;
+	int numThreads;
+	
+	// The number of v, vt and vn lines, and triangles (after splitting polygons)
+	size_t numPositions;
+	size_t numTexCoords;
+	size_t numNormals;
+	size_t numTriangles;
+	
+	// The time spent parsing, and welding the vertices, in milliseconds
+	double parseMs;
+	double weldMs;
+} ObjLoadStats;
+
+/** Loads a triangle mesh from a Wavefront OBJ file.
+ * 
+ * The file is memory-mapped, and split into chunks (at line breaks) that are
+ * parsed on separate threads. Each chunk's faces are then turned into
+ * vertices (also in parallel), welding corners with the same
+ * position/texture coordinate/normal into one vertex through a hash map.
+ * Polygons are split into triangle fans. Faces without normals get smooth
+ * normals from the triangles around each vertex. Only v, vt, vn and f lines
+ * are read; everything else (groups, materials, etc.) is skipped.
+ * 
+ * NOTE: Vertices aren't shared between chunks or submeshes, so a few along
+ * their edges are duplicated.
+ * 
+ * This will print any errors to the console.
+ * 
+ * @param filename the OBJ file's name
+ * @param numThreads the number of threads (0 for one per CPU core)
+ * @param mesh where to write the mesh to (free it with objMeshFree())
+ * @param stats where to write the loading statistics to (may be NULL)
+ * 
+ * @return bool true if successful
+ */
+
+bool objLoad(const char *filename, int numThreads, ObjMesh *mesh, ObjLoadStats *stats);
+
+/** Converts a mesh's 16-bit, submesh-relative indices into 32-bit indices
+ * into all of its vertices (e.g., for meshBinCook() or meshopt.h).
+ * 
+ * @param mesh the mesh
+ * @param indices where to write the mesh->numIndices indices to
+ * @param submeshes where to write each submesh's index and vertex ranges to
+ * (mesh->numSubmeshes of them). May be NULL
+ */
+
+void objMeshAbsoluteIndices(const ObjMesh *mesh, GLuint *indices, MeshBinSubmesh *submeshes);
+
+/** Frees a mesh loaded by objLoad().
+ */
+
+void objMeshFree(ObjMesh *mesh);
+
+#endif
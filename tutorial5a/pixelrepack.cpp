@@ -0,0 +1,195 @@
+// pixelrepack.cpp
+//
+// See header file for details
+
+#include "pixelrepack.h"
+
+#include <cstdint>
+
+// SSSE3 isn't part of the x86-64 baseline, so unless the compiler's been told
+// it's there, the SSSE3 code is built for it separately and picked at runtime
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define REPACK_SSSE3
+#define REPACK_SSSE3_TARGET
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+#define REPACK_SSSE3
+#define REPACK_SSSE3_TARGET __attribute__((target("ssse3")))
+#define REPACK_SSSE3_RUNTIME_CHECK
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define REPACK_NEON
+#endif
+
+/** Gets which byte of a pixel an SDL colour channel is in.
+ * 
+ * @return int the byte offset, or -1 if the mask isn't a single byte
+ */
+
+static int pixelChannelByte(Uint32 mask, int bytesPerPixel) {
+	for(int i = 0; i < bytesPerPixel; ++i) {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+		Uint32 byteMask = 0xFFu << ((bytesPerPixel - 1 - i) * 8);
+#else
+		Uint32 byteMask = 0xFFu << (i * 8);
+#endif
+		if(mask == byteMask) {
+			return i;
+		}
+	}
+	
+	return -1;
+}
+
+bool pixelLayoutFromSDL(const SDL_PixelFormat *format, PixelLayout *layout) {
+	int bytesPerPixel = format->BytesPerPixel;
+	if(bytesPerPixel != 3 && bytesPerPixel != 4) {
+		return false;
+	}
+	layout->bytesPerPixel = bytesPerPixel;
+	layout->channelBytes[0] = pixelChannelByte(format->Rmask, bytesPerPixel);
+	layout->channelBytes[1] = pixelChannelByte(format->Gmask, bytesPerPixel);
+	layout->channelBytes[2] = pixelChannelByte(format->Bmask, bytesPerPixel);
+	layout->channelBytes[3] = format->Amask ? pixelChannelByte(format->Amask, bytesPerPixel) : -1;
+	
+	return layout->channelBytes[0] >= 0 && layout->channelBytes[1] >= 0 && layout->channelBytes[2] >= 0 &&
+		(layout->channelBytes[3] >= 0 || format->Amask == 0);
+}
+
+bool pixelLayoutIsGL(const PixelLayout *layout) {
+	const int *channelBytes = layout->channelBytes;
+	bool rgbOrder = channelBytes[0] == 0 && channelBytes[1] == 1 && channelBytes[2] == 2;
+	
+	// A 4th byte that isn't alpha would come out as garbage alpha
+	return rgbOrder && (layout->bytesPerPixel == 3 ? channelBytes[3] < 0 : channelBytes[3] == 3);
+}
+
+/** Builds the byte shuffle that repacks 4 pixels.
+ * 
+ * @param shuffle where to write the source byte for each destination byte
+ * (0x80 for none, i.e., alpha that has to be filled in)
+ */
+
+static void pixelShuffleBuild(const PixelLayout *srcLayout, int dstBytesPerPixel, uint8_t shuffle[16]) {
+	for(int i = 0; i < 16; ++i) {
+		shuffle[i] = 0x80;
+	}
+	for(int p = 0; p < 4; ++p) {
+		for(int c = 0; c < dstBytesPerPixel; ++c) {
+			int srcByte = srcLayout->channelBytes[c];
+			if(srcByte >= 0) {
+				shuffle[p * dstBytesPerPixel + c] = (uint8_t)(p * srcLayout->bytesPerPixel + srcByte);
+			}
+		}
+	}
+}
+
+/** Repacks the pixels the SIMD loops don't cover.
+ */
+
+static void pixelRepackScalar(const uint8_t *src, const PixelLayout *srcLayout, uint8_t *dst, int dstBytesPerPixel,
+		int numPixels) {
+	const int *channelBytes = srcLayout->channelBytes;
+	int srcBytesPerPixel = srcLayout->bytesPerPixel;
+	for(int x = 0; x < numPixels; ++x) {
+		dst[0] = src[channelBytes[0]];
+		dst[1] = src[channelBytes[1]];
+		dst[2] = src[channelBytes[2]];
+		if(dstBytesPerPixel == 4) {
+			dst[3] = channelBytes[3] >= 0 ? src[channelBytes[3]] : 0xFF;
+		}
+		src += srcBytesPerPixel;
+		dst += dstBytesPerPixel;
+	}
+}
+
+/** Gets how many pixels of a row the SIMD loops can do.
+ * 
+ * They load and store 16 bytes for every 4 pixels, so with 3-byte pixels,
+ * they have to stop early enough not to go past the end of the row.
+ */
+
+static int pixelSimdWidth(int width, int srcBytesPerPixel, int dstBytesPerPixel) {
+	int slack = srcBytesPerPixel == 3 || dstBytesPerPixel == 3 ? 2 : 0;
+	int simdWidth = width - slack;
+	
+	return simdWidth > 0 ? simdWidth & ~3 : 0;
+}
+
+#if defined(REPACK_SSSE3)
+REPACK_SSSE3_TARGET
+static void pixelRepackSSSE3(const uint8_t *src, int srcPitch, const PixelLayout *srcLayout, uint8_t *dst,
+		int dstPitch, int dstBytesPerPixel, int width, int height) {
+	uint8_t shuffleBytes[16];
+	pixelShuffleBuild(srcLayout, dstBytesPerPixel, shuffleBytes);
+	const __m128i shuffle = _mm_loadu_si128((const __m128i*)shuffleBytes);
+	const __m128i alpha = dstBytesPerPixel == 4 && srcLayout->channelBytes[3] < 0 ?
+		_mm_set1_epi32((int)0xFF000000) : _mm_setzero_si128();
+	int srcStep = srcLayout->bytesPerPixel * 4;
+	int dstStep = dstBytesPerPixel * 4;
+	int simdWidth = pixelSimdWidth(width, srcLayout->bytesPerPixel, dstBytesPerPixel);
+	
+	for(int y = 0; y < height; ++y) {
+		const uint8_t *srcRow = src + (size_t)y * srcPitch;
+		uint8_t *dstRow = dst + (size_t)y * dstPitch;
+		for(int x = 0; x < simdWidth; x += 4) {
+			__m128i pixels = _mm_loadu_si128((const __m128i*)(srcRow + x / 4 * srcStep));
+			pixels = _mm_or_si128(_mm_shuffle_epi8(pixels, shuffle), alpha);
+			_mm_storeu_si128((__m128i*)(dstRow + x / 4 * dstStep), pixels);
+		}
+		pixelRepackScalar(srcRow + simdWidth * srcLayout->bytesPerPixel, srcLayout,
+			dstRow + simdWidth * dstBytesPerPixel, dstBytesPerPixel, width - simdWidth);
+	}
+}
+#elif defined(REPACK_NEON)
+static void pixelRepackNEON(const uint8_t *src, int srcPitch, const PixelLayout *srcLayout, uint8_t *dst,
+		int dstPitch, int dstBytesPerPixel, int width, int height) {
+	uint8_t shuffleBytes[16];
+	pixelShuffleBuild(srcLayout, dstBytesPerPixel, shuffleBytes);
+	
+	// Out of range indices (0x80) give 0, like pshufb
+	const uint8x16_t shuffle = vld1q_u8(shuffleBytes);
+	const uint8x16_t alpha = vreinterpretq_u8_u32(vdupq_n_u32(
+		dstBytesPerPixel == 4 && srcLayout->channelBytes[3] < 0 ? 0xFF000000u : 0u));
+	int srcStep = srcLayout->bytesPerPixel * 4;
+	int dstStep = dstBytesPerPixel * 4;
+	int simdWidth = pixelSimdWidth(width, srcLayout->bytesPerPixel, dstBytesPerPixel);
+	
+	for(int y = 0; y < height; ++y) {
+		const uint8_t *srcRow = src + (size_t)y * srcPitch;
+		uint8_t *dstRow = dst + (size_t)y * dstPitch;
+		for(int x = 0; x < simdWidth; x += 4) {
+			uint8x16_t pixels = vld1q_u8(srcRow + x / 4 * srcStep);
+			vst1q_u8(dstRow + x / 4 * dstStep, vorrq_u8(vqtbl1q_u8(pixels, shuffle), alpha));
+		}
+		pixelRepackScalar(srcRow + simdWidth * srcLayout->bytesPerPixel, srcLayout,
+			dstRow + simdWidth * dstBytesPerPixel, dstBytesPerPixel, width - simdWidth);
+	}
+}
+#endif
+
+void pixelRepack(const void *src, int srcPitch, const PixelLayout *srcLayout, void *dst, int dstPitch,
+		int dstBytesPerPixel, int width, int height) {
+	const uint8_t *srcBytes = (const uint8_t*)src;
+	uint8_t *dstBytes = (uint8_t*)dst;
+
+#if defined(REPACK_SSSE3)
+#if defined(REPACK_SSSE3_RUNTIME_CHECK)
+	static const bool hasSSSE3 = SDL_HasSSSE3() == SDL_TRUE;
+	if(hasSSSE3)
+#endif
+	{
+		pixelRepackSSSE3(srcBytes, srcPitch, srcLayout, dstBytes, dstPitch, dstBytesPerPixel, width, height);
+		return;
+	}
+#elif defined(REPACK_NEON)
+	pixelRepackNEON(srcBytes, srcPitch, srcLayout, dstBytes, dstPitch, dstBytesPerPixel, width, height);
+	return;
+#endif
+	
+	for(int y = 0; y < height; ++y) {
+		pixelRepackScalar(srcBytes + (size_t)y * srcPitch, srcLayout, dstBytes + (size_t)y * dstPitch,
+			dstBytesPerPixel, width);
+	}
+}
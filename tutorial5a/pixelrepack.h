@@ -0,0 +1,59 @@
+// pixelrepack.h
+
+#ifndef __PIXELREPACK_H__
+#define __PIXELREPACK_H__
+
+#include <SDL.h>
+
+/** Where each colour channel is in a pixel, for formats with a whole byte
+ * per channel (e.g., 24-bit BGR, 32-bit ARGB).
+ */
+
+typedef struct PixelLayout_s {
+	// The number of bytes per pixel (3 or 4)
+	int bytesPerPixel;
+	
+	// The byte offsets of red, green, blue and alpha (-1 if there's no alpha;
+	// a 4th byte that isn't alpha is ignored)
+	int channelBytes[4];
+} PixelLayout;
+
+/** Gets an SDL pixel format's layout.
+ * 
+ * @param format the pixel format (e.g., surface->format)
+ * @param layout where to write the layout to
+ * 
+ * @return bool true if successful, false if the format doesn't have one byte
+ * per channel (e.g., 16-bit or paletted formats; convert those with
+ * SDL_ConvertSurfaceFormat() first)
+ */
+
+bool pixelLayoutFromSDL(const SDL_PixelFormat *format, PixelLayout *layout);
+
+/** Returns true if a layout is already R, G, B(, A) byte order, i.e.,
+ * pixels in it can be given to OpenGL as GL_RGB or GL_RGBA without
+ * repacking.
+ */
+
+bool pixelLayoutIsGL(const PixelLayout *layout);
+
+/** Converts pixels to tightly packed R, G, B(, A) byte order in one pass
+ * (e.g., BGR to RGB, or ARGB to RGBA).
+ * 
+ * Uses SSSE3 (pshufb) or AArch64 NEON (tbl) where available, 4 pixels at a
+ * time. Any source pitch works. Alpha is set to 255 when the source has none.
+ * 
+ * @param src the source pixels
+ * @param srcPitch the number of bytes per source row
+ * @param srcLayout the source's layout
+ * @param dst the destination (at least dstPitch * height bytes)
+ * @param dstPitch the number of bytes per destination row
+ * @param dstBytesPerPixel 4 for RGBA, 3 for RGB
+ * @param width the width in pixels
+ * @param height the height in pixels
+ */
+
+void pixelRepack(const void *src, int srcPitch, const PixelLayout *srcLayout, void *dst, int dstPitch,
+	int dstBytesPerPixel, int width, int height);
+
+#endif
@@ -0,0 +1,105 @@
+// samplercache.cpp
+//
+// See header file for details
+
+#include "samplercache.h"
+
+#include <SDL.h>
+#include <SDL_opengles2.h>
+#include <cstring>
+#include <vector>
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+typedef struct SamplerCacheEntry_s {
+	SamplerDesc desc;
+	GLuint sampler;
+} SamplerCacheEntry;
+
+// There are only ever a handful of samplers, so a linear search is fine
+static std::vector<SamplerCacheEntry> samplerEntries;
+
+/** Gets the driver's maximum anisotropy.
+ * 
+ * @return float the maximum, or 1 if anisotropic filtering isn't supported
+ */
+
+static float samplerMaxAnisotropy() {
+	
+	// Only needs checking once
+	static float maxAnisotropy = 0.0f;
+	if(maxAnisotropy > 0.0f) {
+		return maxAnisotropy;
+	}
+	
+	maxAnisotropy = 1.0f;
+	GLint numExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+	for(GLint i = 0; i < numExtensions; ++i) {
+		const char *extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if(extension && strcmp(extension, "GL_EXT_texture_filter_anisotropic") == 0) {
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+			maxAnisotropy = maxAnisotropy >= 1.0f ? maxAnisotropy : 1.0f;
+			break;
+		}
+	}
+	
+	return maxAnisotropy;
+}
+
+static bool samplerDescEqual(const SamplerDesc *a, const SamplerDesc *b) {
+	return a->minFilter == b->minFilter && a->magFilter == b->magFilter &&
+		a->wrapS == b->wrapS && a->wrapT == b->wrapT && a->maxAnisotropy == b->maxAnisotropy;
+}
+
+GLuint samplerCacheGet(const SamplerDesc *desc) {
+	
+	// Anisotropy beyond the driver's maximum would be the same sampler
+	SamplerDesc key = *desc;
+	float maxAnisotropy = samplerMaxAnisotropy();
+	key.maxAnisotropy = key.maxAnisotropy < 1.0f ? 1.0f : key.maxAnisotropy;
+	key.maxAnisotropy = key.maxAnisotropy > maxAnisotropy ? maxAnisotropy : key.maxAnisotropy;
+	for(const SamplerCacheEntry &entry : samplerEntries) {
+		if(samplerDescEqual(&entry.desc, &key)) {
+			return entry.sampler;
+		}
+	}
+	
+	GLuint sampler;
+	glGenSamplers(1, &sampler);
+	glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, key.minFilter);
+	glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, key.magFilter);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, key.wrapS);
+	glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, key.wrapT);
+	if(maxAnisotropy > 1.0f) {
+		glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, key.maxAnisotropy);
+	}
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Creating sampler failed, code %u\n", err);
+		glDeleteSamplers(1, &sampler);
+		return 0;
+	}
+	
+	SamplerCacheEntry entry = {key, sampler};
+	samplerEntries.push_back(entry);
+	
+	return sampler;
+}
+
+unsigned int samplerCacheSize() {
+	return (unsigned int)samplerEntries.size();
+}
+
+void samplerCacheShutdown() {
+	
+	for(const SamplerCacheEntry &entry : samplerEntries) {
+		glDeleteSamplers(1, &entry.sampler);
+	}
+	samplerEntries.clear();
+}
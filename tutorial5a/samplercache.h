@@ -0,0 +1,57 @@
+// samplercache.h
+
+#ifndef __SAMPLERCACHE_H__
+#define __SAMPLERCACHE_H__
+
+#include <GLES3/gl3.h>
+
+/** How a texture is sampled (filtering and wrapping).
+ * 
+ * Textures made by texture.h hold no sampling state of their own, so bind
+ * a sampler object from samplerCacheGet() to the texture unit (with
+ * glBindSampler()) when drawing with them. Any number of textures can share
+ * the same sampler.
+ */
+
+typedef struct SamplerDesc_s {
+	// GL_TEXTURE_MIN_FILTER (e.g., GL_LINEAR_MIPMAP_LINEAR for trilinear).
+	// Textures without mipmaps have a single level, so mipmap filters work
+	// with them too
+	GLenum minFilter;
+	
+	// GL_TEXTURE_MAG_FILTER (GL_LINEAR or GL_NEAREST)
+	GLenum magFilter;
+	
+	// GL_TEXTURE_WRAP_S/T (e.g., GL_REPEAT or GL_CLAMP_TO_EDGE)
+	GLenum wrapS;
+	GLenum wrapT;
+	
+	// The maximum anisotropy (1 for none). Needs
+	// GL_EXT_texture_filter_anisotropic; it's clamped to what the driver
+	// supports, and ignored if it isn't supported at all
+	float maxAnisotropy;
+} SamplerDesc;
+
+/** Gets a sampler object with the given state, creating it on first use.
+ * 
+ * Samplers are shared: asking for the same state twice returns the same
+ * sampler, so don't delete it (samplerCacheShutdown() does).
+ * 
+ * @param desc the sampler's state
+ * 
+ * @return GLuint the sampler's name, or 0 if failed
+ */
+
+GLuint samplerCacheGet(const SamplerDesc *desc);
+
+/** Gets the number of sampler objects in the cache.
+ */
+
+unsigned int samplerCacheSize();
+
+/** Deletes all sampler objects in the cache.
+ */
+
+void samplerCacheShutdown();
+
+#endif
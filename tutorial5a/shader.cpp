@@ -3,91 +3,501 @@
 // See header file for details
 
 #include "shader.h"
+#include "filemap.h"
+#include "shadercache.h"
+#include "shaderembed.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <SDL.h>
 #include <SDL_opengles2.h>
 
-#ifdef _MSC_VER
-#pragma warning(disable:4996) // Allows to use the portable fopen() function without warnings in in MVS
-#endif
+// glShaderSource() takes GLint lengths, so longer sources are passed in several pieces
+static const size_t shaderSrcMaxPiece = 0x7FFFFFFF;
+
+// Most shaders fit in this many pieces, without needing any heap allocation
+#define SHADER_SRC_LOCAL_PIECES 8
+
+/** Starts compiling a shader.
+ * 
+ * NOTE: This doesn't wait for the result, so that the driver can compile
+ * several shaders in parallel. Call shaderCompileCheck() to get it.
+ * 
+ * @param srcStrings the shader's source, as one or more strings (which don't
+ * have to be '\0' terminated)
+ * @param srcLengths the length of each string
+ * @param numStrings the number of strings
+ * @param shaderType the shader type (e.g., GL_VERTEX_SHADER)
+ * 
+ * @return GLuint the shader's ID
+ */
+static GLuint shaderCompileSubmit(const GLchar *const *srcStrings, const size_t *srcLengths,
+		size_t numStrings, GLenum shaderType) {
+	
+	// Split the strings into pieces that GLint can describe
+	size_t numPieces = 0;
+	for(size_t i = 0; i < numStrings; ++i) {
+		numPieces += srcLengths[i] > 0 ? (srcLengths[i] - 1) / shaderSrcMaxPiece + 1 : 0;
+	}
+	const GLchar *localPieces[SHADER_SRC_LOCAL_PIECES];
+	GLint localPieceLengths[SHADER_SRC_LOCAL_PIECES];
+	const GLchar **pieces = localPieces;
+	GLint *pieceLengths = localPieceLengths;
+	if(numPieces > SHADER_SRC_LOCAL_PIECES) {
+		pieces = (const GLchar**)malloc(sizeof(*pieces) * numPieces);
+		pieceLengths = (GLint*)malloc(sizeof(*pieceLengths) * numPieces);
+		if(!pieces || !pieceLengths) {
+			// Compiling an empty shader will fail, and report the error as usual
+			SDL_Log("Out of memory when passing the shader's source to GL\n");
+			numPieces = 0;
+		}
+	}
+	size_t piece = 0;
+	for(size_t i = 0; i < numStrings && piece < numPieces; ++i) {
+		for(size_t offset = 0; offset < srcLengths[i]; offset += shaderSrcMaxPiece) {
+			size_t remaining = srcLengths[i] - offset;
+			pieces[piece] = srcStrings[i] + offset;
+			pieceLengths[piece] = (GLint)(remaining < shaderSrcMaxPiece ? remaining : shaderSrcMaxPiece);
+			++piece;
+		}
+	}
+	
+	// Create the shader
+	GLuint shader = glCreateShader(shaderType);
+	glShaderSource(shader, (GLsizei)numPieces, pieces, pieceLengths);
+	if(pieces != localPieces) {
+		free(pieces);
+		free(pieceLengths);
+	}
+	
+	// Compile it
+	glCompileShader(shader);
+	
+	return shader;
+}
+
+/** Finds where extra #defines can go in a shader's source, which is right
+ * after the #version line (nothing but comments may come before it).
+ * 
+ * @param shaderSrc the shader's source
+ * @param length the source's length
+ * @param lineNum set to the line number of the line after #version
+ * 
+ * @return size_t the offset of the line after #version, or 0 if there's no
+ * #version line
+ */
+static size_t shaderSrcVersionEnd(const GLchar *shaderSrc, size_t length, unsigned int *lineNum) {
+	
+	unsigned int currLine = 1;
+	size_t lineStart = 0;
+	while(lineStart < length) {
+		size_t lineEnd = lineStart;
+		while(lineEnd < length && shaderSrc[lineEnd] != '\n') {
+			++lineEnd;
+		}
+		size_t next = lineEnd < length ? lineEnd + 1 : lineEnd;
+		
+		size_t i = lineStart;
+		while(i < lineEnd && (shaderSrc[i] == ' ' || shaderSrc[i] == '\t' || shaderSrc[i] == '\r')) {
+			++i;
+		}
+		if(lineEnd - i >= 8 && strncmp(&shaderSrc[i], "#version", 8) == 0) {
+			*lineNum = currLine + 1;
+			return next;
+		}
+		if(i < lineEnd && !(lineEnd - i >= 2 && strncmp(&shaderSrc[i], "//", 2) == 0)) {
+			// Code before any #version, so there isn't one
+			break;
+		}
+		
+		lineStart = next;
+		++currLine;
+	}
+	
+	*lineNum = 1;
+	return 0;
+}
 
-/** Gets the file's lenght.
+/** Gets a shader source file, either from the embedded shaders or from disk.
  * 
- * @param file the file
+ * @param filename the file's name
+ * @param embedded true to look the file up in the embedded shaders (or the
+ * override directory; see shaderEmbeddedOverride())
+ * @param src where to put the source (call fileUnmap() when done)
+ * @param path set to the file's path on disk, or "" if it was embedded (optional)
  * 
- * @return size_t the file's  
+ * @return bool true if successful
  */
 
-static size_t fileGetLength(FILE *file) {
+static bool shaderSrcGet(const char *filename, bool embedded, FileMap *src, std::string *path) {
 	
-	size_t length;
+	if(!embedded) {
+		if(path) {
+			*path = filename;
+		}
+		return fileMap(filename, src);
+	}
 	
-	size_t currPos = ftell(file);
+	const char *overrideDir = shaderEmbeddedOverrideDir();
+	if(overrideDir) {
+		std::string overridePath = std::string(overrideDir) + filename;
+		if(path) {
+			*path = overridePath;
+		}
+		return fileMap(overridePath.c_str(), src);
+	}
 	
-	// int fseek(FILE *stream, long offset, int whence); 
-	fseek(file, 0, SEEK_END);
-	// The ftell() function obtains the current value of the file
-	// position indicator for the stream pointed to by stream.
-	length = ftell(file);
+	const EmbeddedShader *embeddedShader = shaderEmbeddedFind(filename);
+	if(!embeddedShader) {
+		SDL_Log("No embedded shader named %s\n", filename);
+		return false;
+	}
+	if(path) {
+		path->clear();
+	}
 	
-	// Return the file to its previous position
-	fseek(file, currPos, SEEK_SET);
+	// Nothing is mapped, so fileUnmap() leaves this alone
+	src->data = embeddedShader->src;
+	src->length = embeddedShader->length;
+	src->mapped = false;
 	
-	return length;
+	return true;
 }
 
+/** An #include directive in a shader's source.
+ */
 
-/** Loads and compiles a shader from a file.
- * 
- * This will print any errors to the console
+typedef struct ShaderIncludeDirective_s {
+	// Where the directive's line starts and ends (the end is at its '\n')
+	size_t lineStart;
+	size_t lineEnd;
+	unsigned int lineNum;
+	
+	// The included file, relative to the shaders' directory
+	std::string filename;
+} ShaderIncludeDirective;
+
+/** An #include file, which is read and parsed once per process.
+ */
+
+typedef struct ShaderInclude_s {
+	std::string filename;
+	bool embedded;
+	
+	// Where the file was read from ("" if it was embedded)
+	std::string path;
+	
+	std::string src;
+	std::vector<ShaderIncludeDirective> directives;
+} ShaderInclude;
+
+// The #include files read so far, shared by all shaders. An include's GLSL
+// source string number (in #line directives and error messages) is its
+// index + 1, since 0 is the shader's own file
+// NOTE: A deque, so that adding includes never moves the existing ones
+static std::deque<ShaderInclude> includeCache;
+static std::unordered_map<std::string, size_t> includeCacheIndex;
+
+/** A shader's source as pieces, ready for shaderCompileSubmit(). The pieces
+ * point into the shader's own source, the defines, the include cache, and the
+ * generated #line directives.
+ */
+
+typedef struct ShaderSrcPieces_s {
+	std::vector<const GLchar*> strings;
+	std::vector<size_t> lengths;
+	
+	// NOTE: A deque, so that the strings never move
+	std::deque<std::string> lineDirectives;
+	
+	// The include cache indices of the files that were included, in order
+	std::vector<size_t> includes;
+} ShaderSrcPieces;
+
+static void shaderSrcPiecesAdd(ShaderSrcPieces *pieces, const GLchar *str, size_t length) {
+	
+	if(length > 0) {
+		pieces->strings.push_back(str);
+		pieces->lengths.push_back(length);
+	}
+}
+
+static void shaderSrcPiecesAddLine(ShaderSrcPieces *pieces, const char *format, unsigned int lineNum,
+		size_t srcNum) {
+	
+	char lineDirective[64];
+	snprintf(lineDirective, sizeof(lineDirective), format, lineNum, (unsigned int)srcNum);
+	pieces->lineDirectives.push_back(lineDirective);
+	const std::string &added = pieces->lineDirectives.back();
+	shaderSrcPiecesAdd(pieces, added.c_str(), added.length());
+}
+
+/** Resolves an #include's path, relative to the including file's directory.
+ */
+
+static std::string shaderIncludePath(const std::string &includer, const std::string &path) {
+	
+	std::string joined = path;
+	if(path.empty() || path[0] != '/') {
+		size_t slash = includer.find_last_of('/');
+		joined = (slash != std::string::npos ? includer.substr(0, slash + 1) : "") + path;
+	}
+	
+	// Remove "." and "dir/.." parts, so that each file has one name in the cache
+	std::vector<std::string> parts;
+	size_t partStart = 0;
+	while(partStart <= joined.length()) {
+		size_t partEnd = joined.find('/', partStart);
+		if(partEnd == std::string::npos) {
+			partEnd = joined.length();
+		}
+		std::string part = joined.substr(partStart, partEnd - partStart);
+		if(part == "..") {
+			if(!parts.empty() && !parts.back().empty() && parts.back() != "..") {
+				parts.pop_back();
+			}
+			else {
+				parts.push_back(part);
+			}
+		}
+		else if(part != "." && !(part.empty() && !parts.empty())) {
+			parts.push_back(part);
+		}
+		partStart = partEnd + 1;
+	}
+	std::string resolved;
+	for(size_t i = 0; i < parts.size(); ++i) {
+		resolved += (i > 0 ? "/" : "") + parts[i];
+	}
+	
+	return resolved;
+}
+
+/** Finds the #include "file" lines in a shader's source.
  * 
- * @param filename the shader's filename
- * @param shaderType the shader type (e.g., GL_VERTEX_SHADER)
+ * NOTE: This runs before the GLSL preprocessor, so #includes inside #if
+ * blocks are always included.
  * 
- * @return GLuint the shader's ID, or 0 if failed
+ * @return bool true if successful (false if an #include is malformed)
  */
-static GLuint shaderLoad(const char *filename, GLenum shaderType) {
+
+static bool shaderIncludeParse(const GLchar *src, size_t length, const std::string &filename,
+		std::vector<ShaderIncludeDirective> *directives) {
 	
-	FILE *file = fopen(filename, "r");
-	if(!file) {
-		SDL_Log("Can't open file: %s\n", filename);
+	unsigned int lineNum = 1;
+	size_t lineStart = 0;
+	while(lineStart < length) {
+		const GLchar *lineEndPtr = (const GLchar*)memchr(src + lineStart, '\n', length - lineStart);
+		size_t lineEnd = lineEndPtr ? (size_t)(lineEndPtr - src) : length;
+		
+		size_t i = lineStart;
+		while(i < lineEnd && (src[i] == ' ' || src[i] == '\t')) {
+			++i;
+		}
+		if(i < lineEnd && src[i] == '#') {
+			++i;
+			while(i < lineEnd && (src[i] == ' ' || src[i] == '\t')) {
+				++i;
+			}
+			if(lineEnd - i >= 7 && strncmp(&src[i], "include", 7) == 0) {
+				i += 7;
+				while(i < lineEnd && (src[i] == ' ' || src[i] == '\t')) {
+					++i;
+				}
+				const GLchar *nameEnd = i < lineEnd && src[i] == '"' ?
+					(const GLchar*)memchr(src + i + 1, '"', lineEnd - i - 1) : NULL;
+				if(!nameEnd) {
+					SDL_Log("%s:%u: Expected #include \"filename\"\n", filename.c_str(), lineNum);
+					return false;
+				}
+				
+				ShaderIncludeDirective directive;
+				directive.lineStart = lineStart;
+				directive.lineEnd = lineEnd;
+				directive.lineNum = lineNum;
+				directive.filename = shaderIncludePath(filename, std::string(src + i + 1, nameEnd));
+				directives->push_back(directive);
+			}
+		}
 		
-		return 0;
+		lineStart = lineEnd + 1;
+		++lineNum;
+	}
+	
+	return true;
+}
+
+/** Gets an #include file from the cache, reading and parsing it if this is
+ * the first time it's needed.
+ * 
+ * @return long the file's index in the include cache, or -1 if failed
+ */
+
+static long shaderIncludeGet(const std::string &filename, bool embedded) {
+	
+	std::string cacheName = (embedded ? "embedded:" : "") + filename;
+	auto found = includeCacheIndex.find(cacheName);
+	if(found != includeCacheIndex.end()) {
+		return (long)found->second;
 	}
 	
-	size_t length = fileGetLength(file);
+	ShaderInclude include;
+	include.filename = filename;
+	include.embedded = embedded;
+	FileMap src;
+	if(!shaderSrcGet(filename.c_str(), embedded, &src, &include.path)) {
+		return -1;
+	}
+	include.src.assign(src.data, src.length);
+	fileUnmap(&src);
+	if(!shaderIncludeParse(include.src.data(), include.src.length(), filename, &include.directives)) {
+		return -1;
+	}
+	
+	includeCache.push_back(include);
+	includeCacheIndex[cacheName] = includeCache.size() - 1;
 	
-	// Alloc space for the file (plus '\0' termination)
-	GLchar *shaderSrc = (GLchar*)calloc(length + 1, 1);
-	if(!shaderSrc){
-		SDL_Log("Out of memory when reading file: %s\n", filename);
-		fclose(file);
-		file = NULL;
+	return (long)includeCache.size() - 1;
+}
+
+/** Adds part of a source to the pieces, replacing its #include lines with the
+ * included files (recursively).
+ * 
+ * Each file is included at most once per shader, like with an include guard.
+ * #line directives around each included file keep compile errors pointing at
+ * the right file and line.
+ * 
+ * @param pieces the pieces to add to
+ * @param src the source
+ * @param start where to start in the source
+ * @param end where to end in the source
+ * @param directives the source's #include directives
+ * @param srcNum the source's GLSL source string number
+ * @param embedded true if the source's includes are embedded
+ * 
+ * @return bool true if successful
+ */
+
+static bool shaderSrcExpand(ShaderSrcPieces *pieces, const GLchar *src, size_t start, size_t end,
+		const std::vector<ShaderIncludeDirective> &directives, size_t srcNum, bool embedded) {
+	
+	size_t pos = start;
+	for(const ShaderIncludeDirective &directive : directives) {
+		if(directive.lineStart < start || directive.lineStart >= end) {
+			continue;
+		}
+		
+		shaderSrcPiecesAdd(pieces, src + pos, directive.lineStart - pos);
 		
-		return 0;
+		long includeIdx = shaderIncludeGet(directive.filename, embedded);
+		if(includeIdx < 0) {
+			SDL_Log("Couldn't load #include file %s (line %u)\n", directive.filename.c_str(), directive.lineNum);
+			return false;
+		}
+		
+		// Already included? Then just drop the #include line (keeping its
+		// '\n', so that the line numbers stay the same)
+		pos = directive.lineEnd;
+		bool included = false;
+		for(size_t includedIdx : pieces->includes) {
+			included |= includedIdx == (size_t)includeIdx;
+		}
+		if(included) {
+			continue;
+		}
+		pieces->includes.push_back(includeIdx);
+		
+		const ShaderInclude &include = includeCache[includeIdx];
+		shaderSrcPiecesAddLine(pieces, "#line %u %u\n", 1, includeIdx + 1);
+		if(!shaderSrcExpand(pieces, include.src.data(), 0, include.src.length(),
+				include.directives, includeIdx + 1, embedded)) {
+			return false;
+		}
+		shaderSrcPiecesAddLine(pieces, "\n#line %u %u\n", directive.lineNum + 1, srcNum);
+		pos = directive.lineEnd < end ? directive.lineEnd + 1 : end;
 	}
+	shaderSrcPiecesAdd(pieces, src + pos, end - pos);
 	
-	fread(shaderSrc, 1, length, file);
+	return true;
+}
+
+/** Builds a shader's source, with its #includes expanded, and extra #defines
+ * inserted after its #version line.
+ * 
+ * A #line directive follows the defines, so that error messages still refer
+ * to the file's own line numbers.
+ * 
+ * @param pieces the pieces to build
+ * @param src the shader's source
+ * @param filename the shader's filename
+ * @param embedded true if the shader and its includes are embedded
+ * @param defines the #define lines to insert (may be NULL)
+ * 
+ * @return bool true if successful
+ */
+
+static bool shaderSrcBuild(ShaderSrcPieces *pieces, const FileMap *src, const char *filename,
+		bool embedded, const char *defines) {
 	
-	// Done with the file
-	fclose(file);
-	file = NULL;
+	std::vector<ShaderIncludeDirective> directives;
+	if(!shaderIncludeParse(src->data, src->length, filename, &directives)) {
+		return false;
+	}
 	
-	// Create the shader
-	GLuint shader = glCreateShader(shaderType);
-	glShaderSource(shader, 1, (const GLchar**)&shaderSrc, NULL);
-	free(shaderSrc);
-	shaderSrc = NULL;
+	size_t start = 0;
+	if(defines && defines[0]) {
+		unsigned int lineNum = 1;
+		start = shaderSrcVersionEnd(src->data, src->length, &lineNum);
+		shaderSrcPiecesAdd(pieces, src->data, start);
+		shaderSrcPiecesAdd(pieces, defines, strlen(defines));
+		shaderSrcPiecesAddLine(pieces, "\n#line %u %u\n", lineNum, 0);
+	}
+	
+	return shaderSrcExpand(pieces, src->data, start, src->length, directives, 0, embedded);
+}
+
+/** Prints which file each GLSL source string number belongs to, for making
+ * sense of compile errors.
+ * 
+ * NOTE: Some drivers (e.g., Mesa) print 0 for every file, but still get the
+ * line numbers right.
+ */
+
+static void shaderIncludeLegendLog(const char *filename) {
+	
+	if(includeCache.empty()) {
+		return;
+	}
+	
+	std::string legend = std::string("Source string numbers: 0 = ") + filename;
+	for(size_t i = 0; i < includeCache.size(); ++i) {
+		legend += ", " + std::to_string(i + 1) + " = " + includeCache[i].filename;
+	}
+	SDL_Log("%s\n", legend.c_str());
+}
+
+/** Checks whether a shader compiled successfully (waiting for the compiler
+ * if necessary).
+ * 
+ * This will print any errors to the console
+ * 
+ * @param shader the shader's ID
+ * @param name the shader's name for error messages (e.g., its filename)
+ * 
+ * @return bool true if the shader compiled
+ */
+static bool shaderCompileCheck(GLuint shader, const char *name) {
 	
-	// Compile it
-	glCompileShader(shader);
 	GLint compileSucceeded = GL_FALSE;
 	glGetShaderiv(shader, GL_COMPILE_STATUS, &compileSucceeded);
 	if(!compileSucceeded) {
 		// Compilation failed. Print error info
-		SDL_Log("Compilation of shader %s failed:\n", filename);
+		SDL_Log("Compilation of shader %s failed:\n", name);
 		GLint logLength = 0;
 		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
 		GLchar *errLog = (GLchar*)malloc(logLength);
@@ -95,16 +505,14 @@ static GLuint shaderLoad(const char *filename, GLenum shaderType) {
 			glGetShaderInfoLog(shader, logLength, &logLength, errLog);
 			SDL_Log("%s\n", errLog);
 			free(errLog);
+			shaderIncludeLegendLog(name);
 		}
 		else {
 			SDL_Log("Couldn't get shader log; out of memory\n");
 		}
-		
-		glDeleteShader(shader);
-		shader = 0;
 	}
 	
-	return shader;
+	return compileSucceeded;
 }
 
 /** Destroys a shader.
@@ -115,63 +523,337 @@ static void shaderDestroy(GLuint shaderID) {
 	glDeleteShader(shaderID);
 }
 
-/** Loads,then link together a vertex shader and a fragment shader
+// GL_KHR_parallel_shader_compile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (GL_APIENTRYP ShaderMaxCompilerThreadsProc)(GLuint count);
+
+static bool parallelCompileChecked = false;
+static bool parallelCompileSupported = false;
+
+/** Detects GL_KHR_parallel_shader_compile, and lets the driver use as many
+ * compiler threads as it likes.
  */
 
-GLuint shaderProgLoad(const char *vertFilename, const char *fragFilename){
+static void parallelCompileInit() {
+	if(parallelCompileChecked) {
+		return;
+	}
+	parallelCompileChecked = true;
+	
+	GLint numExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+	for(GLint i = 0; i < numExtensions; ++i) {
+		const char *extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+		if(extension && strcmp(extension, "GL_KHR_parallel_shader_compile") == 0) {
+			parallelCompileSupported = true;
+			break;
+		}
+	}
+	
+	if(parallelCompileSupported) {
+		ShaderMaxCompilerThreadsProc maxShaderCompilerThreads =
+			(ShaderMaxCompilerThreadsProc)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+		if(maxShaderCompilerThreads) {
+			// 0xFFFFFFFF means "implementation-specific maximum"
+			maxShaderCompilerThreads(0xFFFFFFFF);
+		}
+	}
+}
+
+/** Gets the time since startTime in milliseconds.
+ */
+
+static double shaderElapsedMs(Uint64 startTime) {
 	
-	GLuint vertShader = shaderLoad(vertFilename, GL_VERTEX_SHADER);
-	if(!vertShader) {
-		SDL_Log("Couldn't load vertex shader: %s\n", vertFilename);
+	return (SDL_GetPerformanceCounter() - startTime) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+/** Waits for a shader to finish compiling (for timing it).
+ */
+
+static void shaderCompileWait(GLuint shader) {
+	
+	GLint compileSucceeded = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compileSucceeded);
+}
+
+/** Starts compiling and linking a job's shader program (or loads it from the
+ * program binary cache).
+ */
+
+static void shaderProgJobCompile(ShaderProgJob *job) {
+	
+	job->shaderProg = 0;
+	job->vertShader = 0;
+	job->fragShader = 0;
+	job->cacheKey = 0;
+	job->status = SHADER_PROG_FAILED;
+	
+	// The sources are passed to GL straight from the mapped files and the
+	// include cache (no copies)
+	FileMap vertSrc;
+	ShaderSrcPieces vertPieces;
+	if(!shaderSrcGet(job->vertFilename, job->embedded, &vertSrc, NULL)) {
+		SDL_Log("Couldn't load vertex shader: %s\n", job->vertFilename);
+		
+		return;
+	}
+	if(!shaderSrcBuild(&vertPieces, &vertSrc, job->vertFilename, job->embedded, job->defines)) {
+		SDL_Log("Couldn't load vertex shader: %s\n", job->vertFilename);
+		fileUnmap(&vertSrc);
 		
-		return 0;
+		return;
 	}
 	
-	GLuint fragShader = shaderLoad(fragFilename, GL_FRAGMENT_SHADER);
-	if(!fragShader) {
-		SDL_Log("Couldn't load fragent shader: %s\n", fragFilename);
-		shaderDestroy(vertShader);
-		vertShader = 0;
+	FileMap fragSrc;
+	ShaderSrcPieces fragPieces;
+	if(!shaderSrcGet(job->fragFilename, job->embedded, &fragSrc, NULL)) {
+		SDL_Log("Couldn't load fragent shader: %s\n", job->fragFilename);
+		fileUnmap(&vertSrc);
 		
-		return 0;
+		return;
+	}
+	if(!shaderSrcBuild(&fragPieces, &fragSrc, job->fragFilename, job->embedded, job->defines)) {
+		SDL_Log("Couldn't load fragent shader: %s\n", job->fragFilename);
+		fileUnmap(&vertSrc);
+		fileUnmap(&fragSrc);
+		
+		return;
 	}
 	
-	GLuint shaderProg = glCreateProgram();
-	if(shaderProg) {
-		glAttachShader(shaderProg, vertShader);
-		glAttachShader(shaderProg, fragShader);
+	if(shaderCacheEnabled()) {
+		job->cacheKey = shaderCacheKey(vertSrc.data, vertSrc.length,
+			fragSrc.data, fragSrc.length, job->defines);
 		
-		glLinkProgram(shaderProg);
+		// Editing an #include file must change the key too
+		for(size_t includeIdx : vertPieces.includes) {
+			const std::string &includeSrc = includeCache[includeIdx].src;
+			job->cacheKey = shaderCacheKeyAppend(job->cacheKey, includeSrc.data(), includeSrc.length());
+		}
+		for(size_t includeIdx : fragPieces.includes) {
+			const std::string &includeSrc = includeCache[includeIdx].src;
+			job->cacheKey = shaderCacheKeyAppend(job->cacheKey, includeSrc.data(), includeSrc.length());
+		}
+		job->shaderProg = shaderCacheLoad(job->cacheKey);
+	}
+	
+	if(job->timings) {
+		job->timings->vertCompileMs = 0.0;
+		job->timings->fragCompileMs = 0.0;
+		job->timings->linkMs = 0.0;
+		job->timings->cached = job->shaderProg != 0;
+	}
+	
+	if(job->shaderProg) {
+		job->status = SHADER_PROG_READY;
+	}
+	else {
+		Uint64 startTime = SDL_GetPerformanceCounter();
+		job->vertShader = shaderCompileSubmit(vertPieces.strings.data(), vertPieces.lengths.data(),
+			vertPieces.strings.size(), GL_VERTEX_SHADER);
+		if(job->timings) {
+			shaderCompileWait(job->vertShader);
+			job->timings->vertCompileMs = shaderElapsedMs(startTime);
+			startTime = SDL_GetPerformanceCounter();
+		}
+		job->fragShader = shaderCompileSubmit(fragPieces.strings.data(), fragPieces.lengths.data(),
+			fragPieces.strings.size(), GL_FRAGMENT_SHADER);
+		if(job->timings) {
+			shaderCompileWait(job->fragShader);
+			job->timings->fragCompileMs = shaderElapsedMs(startTime);
+		}
+		job->status = SHADER_PROG_PENDING;
+	}
+	
+	// The driver has its own copy of the sources
+	fileUnmap(&vertSrc);
+	fileUnmap(&fragSrc);
+}
+
+/** Starts linking a job's shader program.
+ */
+
+static void shaderProgJobLink(ShaderProgJob *job) {
+	
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	job->shaderProg = glCreateProgram();
+	if(!job->shaderProg) {
+		SDL_Log("Couldn't create shader program\n");
+		shaderDestroy(job->vertShader);
+		job->vertShader = 0;
+		shaderDestroy(job->fragShader);
+		job->fragShader = 0;
+		job->status = SHADER_PROG_FAILED;
 		
+		return;
+	}
+	
+	glAttachShader(job->shaderProg, job->vertShader);
+	glAttachShader(job->shaderProg, job->fragShader);
+	
+	if(shaderCacheEnabled()) {
+		// Ask the driver to keep the binary around, so it can be cached
+		glProgramParameteri(job->shaderProg, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	
+	// NOTE: Linking fails if either shader failed to compile, so the compile
+	// status is only checked afterwards
+	glLinkProgram(job->shaderProg);
+	
+	if(job->timings) {
+		// Wait for the link to finish
 		GLint linkingSucceeded = GL_FALSE;
-		glGetProgramiv(shaderProg, GL_LINK_STATUS, &linkingSucceeded);
-		if(!linkingSucceeded) {
+		glGetProgramiv(job->shaderProg, GL_LINK_STATUS, &linkingSucceeded);
+		job->timings->linkMs = shaderElapsedMs(startTime);
+	}
+}
+
+/** Collects a pending job's result (waiting for the driver if necessary).
+ * 
+ * This will print any errors to the console.
+ */
+
+static void shaderProgJobComplete(ShaderProgJob *job) {
+	
+	GLint linkingSucceeded = GL_FALSE;
+	glGetProgramiv(job->shaderProg, GL_LINK_STATUS, &linkingSucceeded);
+	if(linkingSucceeded) {
+		job->status = SHADER_PROG_READY;
+		shaderCacheStore(job->cacheKey, job->shaderProg);
+	}
+	else {
+		bool vertCompiled = shaderCompileCheck(job->vertShader, job->vertFilename);
+		bool fragCompiled = shaderCompileCheck(job->fragShader, job->fragFilename);
+		if(!vertCompiled) {
+			SDL_Log("Couldn't load vertex shader: %s\n", job->vertFilename);
+		}
+		else if(!fragCompiled) {
+			SDL_Log("Couldn't load fragent shader: %s\n", job->fragFilename);
+		}
+		else {
 			SDL_Log("Linking shader failed (vert. shader: %s, frag. shader: %s\n",
-				vertFilename, fragFilename);
+				job->vertFilename, job->fragFilename);
 			GLint logLength = 0;
-			glGetProgramiv(shaderProg, GL_INFO_LOG_LENGTH, &logLength);
+			glGetProgramiv(job->shaderProg, GL_INFO_LOG_LENGTH, &logLength);
 			GLchar *errLog = (GLchar*)malloc(logLength);
 			if(errLog) {
-				glGetProgramInfoLog(shaderProg, logLength, &logLength, errLog);
+				glGetProgramInfoLog(job->shaderProg, logLength, &logLength, errLog);
 				SDL_Log("%s\n", errLog);
 				free(errLog);
 			}
 			else {
 				SDL_Log("Couldn't get shader link log; out of memory\n");
 			}
-			glDeleteProgram(shaderProg);
-			shaderProg = 0;
 		}
-	}
-	else {
-		SDL_Log("Couldn't create shader program\n");
+		glDeleteProgram(job->shaderProg);
+		job->shaderProg = 0;
+		job->status = SHADER_PROG_FAILED;
 	}
 	
 	// Don't need those anymore
-	shaderDestroy(vertShader);
-	shaderDestroy(fragShader);
+	shaderDestroy(job->vertShader);
+	job->vertShader = 0;
+	shaderDestroy(job->fragShader);
+	job->fragShader = 0;
+}
+
+void shaderProgBatchSubmit(ShaderProgJob *jobs, size_t numJobs) {
+	
+	parallelCompileInit();
+	
+	// Queue up all compiles before any links, so that the driver can work on
+	// them in parallel
+	for(size_t i = 0; i < numJobs; ++i) {
+		shaderProgJobCompile(&jobs[i]);
+	}
+	for(size_t i = 0; i < numJobs; ++i) {
+		if(jobs[i].status == SHADER_PROG_PENDING) {
+			shaderProgJobLink(&jobs[i]);
+		}
+	}
+}
+
+ShaderProgStatus shaderProgJobPoll(ShaderProgJob *job) {
+	
+	if(job->status != SHADER_PROG_PENDING) {
+		return job->status;
+	}
+	
+	if(parallelCompileSupported) {
+		GLint completed = GL_FALSE;
+		glGetProgramiv(job->shaderProg, GL_COMPLETION_STATUS_KHR, &completed);
+		if(!completed) {
+			return SHADER_PROG_PENDING;
+		}
+	}
+	
+	shaderProgJobComplete(job);
+	
+	return job->status;
+}
+
+bool shaderProgBatchFinish(ShaderProgJob *jobs, size_t numJobs) {
+	
+	bool allReady = true;
+	for(size_t i = 0; i < numJobs; ++i) {
+		if(jobs[i].status == SHADER_PROG_PENDING) {
+			shaderProgJobComplete(&jobs[i]);
+		}
+		allReady &= jobs[i].status == SHADER_PROG_READY;
+	}
+	
+	return allReady;
+}
+
+GLuint shaderProgLoad(const char *vertFilename, const char *fragFilename){
+	
+	return shaderProgLoadDefines(vertFilename, fragFilename, NULL);
+}
+
+GLuint shaderProgLoadDefines(const char *vertFilename, const char *fragFilename, const char *defines) {
+	
+	return shaderProgLoadTimed(vertFilename, fragFilename, defines, NULL);
+}
+
+GLuint shaderProgLoadTimed(const char *vertFilename, const char *fragFilename, const char *defines,
+		ShaderProgTimings *timings) {
+	
+	ShaderProgJob job = {};
+	job.vertFilename = vertFilename;
+	job.fragFilename = fragFilename;
+	job.defines = defines;
+	job.timings = timings;
+	shaderProgBatchSubmit(&job, 1);
+	shaderProgBatchFinish(&job, 1);
+	
+	return job.shaderProg;
+}
+
+GLuint shaderProgLoadEmbedded(const char *name) {
+	
+	std::string vertFilename = std::string(name) + ".vert";
+	std::string fragFilename = std::string(name) + ".frag";
+	ShaderProgJob job = {};
+	job.vertFilename = vertFilename.c_str();
+	job.fragFilename = fragFilename.c_str();
+	job.embedded = true;
+	shaderProgBatchSubmit(&job, 1);
+	shaderProgBatchFinish(&job, 1);
+	
+	return job.shaderProg;
+}
+
+void shaderIncludeCacheClear() {
+	
+	includeCache.clear();
+	includeCacheIndex.clear();
+}
+
+const char *shaderIncludeFile(size_t index) {
 	
-	return shaderProg;
+	return index < includeCache.size() ? includeCache[index].path.c_str() : NULL;
 }
 
 void shaderProgDestroy(GLuint shaderProg) {
@@ -4,12 +4,17 @@
 #define __SHADER_H__
 
 #include <GLES3/gl3.h>
+#include <cstddef>
+#include <cstdint>
 
 /** Loads a vertex and fragment shader from disk and compiles (& links) them
  * into a shader program.
  * 
  * This will print any errors to the console.
  * 
+ * If the program binary cache is enabled (see shaderCacheInit()), then a
+ * previously cached binary is used instead of compiling the shaders.
+ * 
  * @param vertFilename filename for the vertex shader.
  * @param fragFilename filename for the shader's filename.
  * 
@@ -18,6 +23,170 @@
 
 GLuint shaderProgLoad(const char *vertFilename, const char *fragFilename);
 
+/** Loads a shader program like shaderProgLoad(), with extra preprocessor
+ * definitions.
+ * 
+ * The defines are inserted into both shaders, right after the #version line
+ * (e.g., "#define LIGHTING 1\n#define NUM_LIGHTS 2\n"). Error messages still
+ * refer to the files' own line numbers.
+ * 
+ * @param vertFilename filename for the vertex shader.
+ * @param fragFilename filename for the fragment shader.
+ * @param defines the #define lines (may be NULL)
+ * 
+ * @return GLuint the shader program's ID, or 0 if failed.
+ */
+
+GLuint shaderProgLoadDefines(const char *vertFilename, const char *fragFilename, const char *defines);
+
+/** Loads a shader program from the shaders embedded into the executable
+ * (see shaderembed.h), so there's no file I/O.
+ * 
+ * If an override directory is set (see shaderEmbeddedOverride()), the shaders
+ * are loaded from there instead, for development.
+ * 
+ * @param name the shaders' name, without the extension (e.g., "texture" for
+ * texture.vert and texture.frag)
+ * 
+ * @return GLuint the shader program's ID, or 0 if failed.
+ */
+
+GLuint shaderProgLoadEmbedded(const char *name);
+
+/** How long each stage of building a shader program took (see
+ * ShaderProgJob::timings).
+ */
+
+typedef struct ShaderProgTimings_s {
+	// Compiling each shader (including passing it its source)
+	double vertCompileMs;
+	double fragCompileMs;
+	
+	// Linking the program
+	double linkMs;
+	
+	// true if the program came from the program binary cache (nothing was
+	// compiled or linked)
+	bool cached;
+} ShaderProgTimings;
+
+/** Loads a shader program like shaderProgLoadDefines(), and measures how
+ * long compiling and linking took.
+ * 
+ * @param vertFilename filename for the vertex shader.
+ * @param fragFilename filename for the fragment shader.
+ * @param defines the #define lines (may be NULL)
+ * @param timings where to write the timings to
+ * 
+ * @return GLuint the shader program's ID, or 0 if failed.
+ */
+
+GLuint shaderProgLoadTimed(const char *vertFilename, const char *fragFilename, const char *defines,
+	ShaderProgTimings *timings);
+
+/** The state of a shader program that's being built in the background.
+ */
+
+typedef enum ShaderProgStatus_e {
+	SHADER_PROG_PENDING,
+	SHADER_PROG_READY,
+	SHADER_PROG_FAILED
+} ShaderProgStatus;
+
+/** A shader program to be built by shaderProgBatchSubmit().
+ * 
+ * Only the filenames (and optionally the defines) need to be set, e.g.:
+ * ShaderProgJob jobs[] = {{"a.vert", "a.frag"}, {"b.vert", "b.frag"}};
+ */
+
+typedef struct ShaderProgJob_s {
+	const char *vertFilename;
+	const char *fragFilename;
+	
+	// Extra #define lines (optional; see shaderProgLoadDefines())
+	const char *defines;
+	
+	// Take the sources from the embedded shaders, looking the filenames up
+	// with shaderEmbeddedFind() (optional; see shaderProgLoadEmbedded())
+	bool embedded;
+	
+	// Where to write the build's timings to (optional)
+	// NOTE: Each stage is waited for before starting the next, so timed jobs
+	// aren't built in parallel
+	ShaderProgTimings *timings;
+	
+	// The result (shaderProg is valid once status is SHADER_PROG_READY)
+	GLuint shaderProg;
+	ShaderProgStatus status;
+	
+	// Internal state
+	GLuint vertShader;
+	GLuint fragShader;
+	uint64_t cacheKey;
+} ShaderProgJob;
+
+/** Starts building a batch of shader programs.
+ * 
+ * All shaders are submitted for compilation before anything is linked, and
+ * no compile/link status is queried, so the driver is free to build the
+ * programs in parallel (GL_KHR_parallel_shader_compile is used when
+ * available). Programs found in the program binary cache are ready at once.
+ * 
+ * The filenames and defines must stay valid until each job is no longer
+ * pending.
+ * 
+ * @param jobs the jobs to start
+ * @param numJobs the number of jobs
+ */
+
+void shaderProgBatchSubmit(ShaderProgJob *jobs, size_t numJobs);
+
+/** Checks whether a job has finished, without blocking if possible.
+ * 
+ * With GL_KHR_parallel_shader_compile, this returns SHADER_PROG_PENDING
+ * until the driver is done. Without it, this waits for the result. Errors
+ * are printed to the console.
+ * 
+ * @param job the job
+ * 
+ * @return ShaderProgStatus the job's state
+ */
+
+ShaderProgStatus shaderProgJobPoll(ShaderProgJob *job);
+
+/** Waits for all jobs in a batch to finish.
+ * 
+ * Errors are printed to the console.
+ * 
+ * @param jobs the jobs
+ * @param numJobs the number of jobs
+ * 
+ * @return bool true if all programs were built successfully
+ */
+
+bool shaderProgBatchFinish(ShaderProgJob *jobs, size_t numJobs);
+
+/** Forgets the #include files read so far, so that they're read again the
+ * next time they're needed (e.g., after being edited).
+ * 
+ * NOTE: Shaders may #include "file" (relative to the including file). Each
+ * file is read and parsed once per process, and included at most once per
+ * shader.
+ */
+
+void shaderIncludeCacheClear();
+
+/** Gets where an #include file that's been read was loaded from (e.g., for
+ * watching it for changes).
+ * 
+ * @param index the file's index (0 to however many have been read)
+ * 
+ * @return const char* the file's path, "" if it was embedded, or NULL if
+ * index is past the last file
+ */
+
+const char *shaderIncludeFile(size_t index);
+
 /** Destroys a shader program.
  */
 
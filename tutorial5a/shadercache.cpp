@@ -0,0 +1,226 @@
+// shadercache.cpp
+//
+// See header file for details
+
+#include "shadercache.h"
+#include "cachefile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <SDL.h>
+#include <SDL_opengles2.h>
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996) // Allows to use the portable fopen() function without warnings in in MVS
+#endif
+
+// Cache file layout: ShaderCacheHeader, followed by binaryLength bytes of program binary
+static const char shaderCacheMagic[4] = {'G', 'L', 'P', 'B'};
+static const Uint32 shaderCacheVersion = 1;
+
+typedef struct ShaderCacheHeader_s {
+	char magic[4];
+	Uint32 version;
+	uint64_t key;
+	Uint32 binaryFormat;
+	Uint32 binaryLength;
+} ShaderCacheHeader;
+
+static const char shaderCacheExt[] = ".glpb";
+
+static bool cacheEnabled = false;
+static char *cacheDir = NULL;
+static uint64_t driverHash = 0;
+
+/** Hashes a NUL-terminated string, including the terminator (so that
+ * consecutive fields can't run into each other).
+ */
+
+static uint64_t hashString(uint64_t hash, const char *str) {
+	if(!str) {
+		str = "";
+	}
+	
+	return cacheHashBytes(hash, str, strlen(str) + 1);
+}
+
+bool shaderCacheInit(const char *dir) {
+	shaderCacheShutdown();
+	
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+	if(numFormats <= 0) {
+		SDL_Log("Program binary cache disabled; the driver has no program binary formats\n");
+		return false;
+	}
+	
+	cacheDir = strdup(dir);
+	if(!cacheDir) {
+		SDL_Log("Program binary cache disabled; out of memory\n");
+		return false;
+	}
+	
+	driverHash = CACHE_HASH_INIT;
+	driverHash = hashString(driverHash, (const char*)glGetString(GL_VENDOR));
+	driverHash = hashString(driverHash, (const char*)glGetString(GL_RENDERER));
+	driverHash = hashString(driverHash, (const char*)glGetString(GL_VERSION));
+	driverHash = hashString(driverHash, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+	
+	cacheEnabled = true;
+	return true;
+}
+
+void shaderCacheShutdown() {
+	cacheEnabled = false;
+	free(cacheDir);
+	cacheDir = NULL;
+}
+
+bool shaderCacheEnabled() {
+	return cacheEnabled;
+}
+
+uint64_t shaderCacheKey(const char *vertSrc, size_t vertLength,
+		const char *fragSrc, size_t fragLength, const char *defines) {
+	uint64_t hash = driverHash;
+	
+	// Lengths are hashed too, so that moving bytes between the two sources changes the key
+	uint64_t lengths[2] = {vertLength, fragLength};
+	hash = cacheHashBytes(hash, lengths, sizeof(lengths));
+	hash = cacheHashBytes(hash, vertSrc, vertLength);
+	hash = cacheHashBytes(hash, fragSrc, fragLength);
+	hash = hashString(hash, defines);
+	
+	return hash;
+}
+
+uint64_t shaderCacheKeyAppend(uint64_t key, const char *src, size_t length) {
+	uint64_t length64 = length;
+	key = cacheHashBytes(key, &length64, sizeof(length64));
+	key = cacheHashBytes(key, src, length);
+	
+	return key;
+}
+
+GLuint shaderCacheLoad(uint64_t key) {
+	if(!cacheEnabled) {
+		return 0;
+	}
+	
+	char *path = cacheFilePath(cacheDir, key, shaderCacheExt);
+	if(!path) {
+		return 0;
+	}
+	
+	FILE *file = fopen(path, "rb");
+	if(!file) {
+		// Not cached yet
+		free(path);
+		return 0;
+	}
+	
+	// The file's size, so that a corrupt header can't make us allocate more than it holds
+	long fileLength = -1;
+	if(fseek(file, 0, SEEK_END) == 0) {
+		fileLength = ftell(file);
+		rewind(file);
+	}
+	
+	ShaderCacheHeader header;
+	void *binary = NULL;
+	bool valid = fread(&header, sizeof(header), 1, file) == 1 &&
+		memcmp(header.magic, shaderCacheMagic, sizeof(header.magic)) == 0 &&
+		header.version == shaderCacheVersion && header.key == key &&
+		fileLength >= (long)sizeof(header) && header.binaryLength == (size_t)fileLength - sizeof(header);
+	if(valid) {
+		binary = malloc(header.binaryLength);
+		valid = binary && fread(binary, 1, header.binaryLength, file) == header.binaryLength;
+	}
+	fclose(file);
+	file = NULL;
+	
+	GLuint shaderProg = 0;
+	if(valid) {
+		shaderProg = glCreateProgram();
+		glProgramBinary(shaderProg, header.binaryFormat, binary, header.binaryLength);
+		
+		// The driver is allowed to reject binaries at any time (e.g., after an update)
+		GLint linkingSucceeded = GL_FALSE;
+		glGetProgramiv(shaderProg, GL_LINK_STATUS, &linkingSucceeded);
+		if(!linkingSucceeded) {
+			glDeleteProgram(shaderProg);
+			shaderProg = 0;
+		}
+	}
+	free(binary);
+	binary = NULL;
+	
+	if(!shaderProg) {
+		// Invalidate, so it'll be rebuilt and stored again
+		SDL_Log("Discarding stale program binary %s\n", path);
+		remove(path);
+	}
+	
+	free(path);
+	return shaderProg;
+}
+
+bool shaderCacheStore(uint64_t key, GLuint shaderProg) {
+	if(!cacheEnabled) {
+		return false;
+	}
+	
+	GLint binaryLength = 0;
+	glGetProgramiv(shaderProg, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if(binaryLength <= 0) {
+		return false;
+	}
+	
+	void *binary = malloc(binaryLength);
+	if(!binary) {
+		SDL_Log("Couldn't cache program binary; out of memory\n");
+		return false;
+	}
+	
+	ShaderCacheHeader header;
+	memcpy(header.magic, shaderCacheMagic, sizeof(header.magic));
+	header.version = shaderCacheVersion;
+	header.key = key;
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(shaderProg, binaryLength, &binaryLength, &binaryFormat, binary);
+	header.binaryFormat = binaryFormat;
+	header.binaryLength = binaryLength;
+	
+	// Write to a temporary file first, so that a crash can't leave a truncated binary behind
+	char *tmpPath = cacheFilePath(cacheDir, key, ".tmp");
+	char *path = cacheFilePath(cacheDir, key, shaderCacheExt);
+	bool success = false;
+	FILE *file = tmpPath && path ? fopen(tmpPath, "wb") : NULL;
+	if(file) {
+		success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+			fwrite(binary, 1, binaryLength, file) == (size_t)binaryLength;
+		success &= fclose(file) == 0;
+		file = NULL;
+		
+		remove(path);
+		success = success && rename(tmpPath, path) == 0;
+		if(!success) {
+			remove(tmpPath);
+		}
+	}
+	if(!success) {
+		SDL_Log("Couldn't write program binary to the cache (%s)\n", cacheDir);
+	}
+	
+	free(tmpPath);
+	free(path);
+	free(binary);
+	return success;
+}
+
+void shaderCacheClear() {
+	if(cacheDir) {
+		cacheDirClear(cacheDir, shaderCacheExt);
+	}
+}
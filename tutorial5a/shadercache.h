@@ -0,0 +1,101 @@
+// shadercache.h
+
+#ifndef __SHADERCACHE_H__
+#define __SHADERCACHE_H__
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+#include <cstdint>
+
+/** Enables the on-disk program binary cache.
+ * 
+ * Once enabled, shaderProgLoad() looks for a previously linked binary of the
+ * same program before compiling anything, and stores newly linked programs
+ * for the next launch. The cache stays disabled if the driver doesn't offer
+ * any program binary format.
+ * 
+ * NOTE: Must be called with a current GL context (the driver's vendor,
+ * renderer and version strings become part of every cache key).
+ * 
+ * @param cacheDir the directory to store the binaries in, including the
+ * trailing path separator (e.g., from SDL_GetPrefPath()). The directory must
+ * exist
+ * 
+ * @return bool true if the cache is active
+ */
+
+bool shaderCacheInit(const char *cacheDir);
+
+/** Disables the program binary cache.
+ * Cached binaries stay on disk.
+ */
+
+void shaderCacheShutdown();
+
+/** Returns true if the program binary cache is active.
+ */
+
+bool shaderCacheEnabled();
+
+/** Calculates a program's cache key.
+ * 
+ * The key is a hash of both shader sources, the defines they were compiled
+ * with, and the driver's identification strings. So, editing a shader or
+ * updating the driver automatically results in a cache miss.
+ * 
+ * @param vertSrc the vertex shader's source
+ * @param vertLength the vertex shader source's length
+ * @param fragSrc the fragment shader's source
+ * @param fragLength the fragment shader source's length
+ * @param defines extra preprocessor definitions (may be NULL)
+ * 
+ * @return uint64_t the cache key
+ */
+
+uint64_t shaderCacheKey(const char *vertSrc, size_t vertLength,
+	const char *fragSrc, size_t fragLength, const char *defines);
+
+/** Adds another source (e.g., an #include file) to a cache key.
+ * 
+ * @param key the key so far
+ * @param src the source
+ * @param length the source's length
+ * 
+ * @return uint64_t the new key
+ */
+
+uint64_t shaderCacheKeyAppend(uint64_t key, const char *src, size_t length);
+
+/** Creates a shader program from its cached binary.
+ * 
+ * If the driver rejects the binary (e.g., it was produced by a different
+ * driver build), then the stale file is removed so that the program gets
+ * compiled and cached afresh.
+ * 
+ * @param key the program's cache key
+ * 
+ * @return GLuint the shader program's ID, or 0 if it isn't in the cache
+ */
+
+GLuint shaderCacheLoad(uint64_t key);
+
+/** Writes a linked shader program's binary to the cache.
+ * 
+ * NOTE: The program should have been linked with
+ * GL_PROGRAM_BINARY_RETRIEVABLE_HINT set, or some drivers won't return a
+ * binary.
+ * 
+ * @param key the program's cache key
+ * @param shaderProg the shader program
+ * 
+ * @return bool true if successful
+ */
+
+bool shaderCacheStore(uint64_t key, GLuint shaderProg);
+
+/** Removes all cached binaries from the cache directory.
+ */
+
+void shaderCacheClear();
+
+#endif
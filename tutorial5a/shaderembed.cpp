@@ -0,0 +1,34 @@
+// shaderembed.cpp
+//
+// See header file for details
+
+#include "shaderembed.h"
+#include "embeddedshaders.h"
+
+#include <cstring>
+#include <string>
+
+static std::string overrideDir;
+static bool overrideEnabled = false;
+
+const EmbeddedShader *shaderEmbeddedFind(const char *name) {
+	
+	for(const EmbeddedShader &shader : embeddedShaders) {
+		if(strcmp(shader.name, name) == 0) {
+			return &shader;
+		}
+	}
+	
+	return NULL;
+}
+
+void shaderEmbeddedOverride(const char *dir) {
+	
+	overrideEnabled = dir != NULL;
+	overrideDir = dir ? dir : "";
+}
+
+const char *shaderEmbeddedOverrideDir() {
+	
+	return overrideEnabled ? overrideDir.c_str() : NULL;
+}
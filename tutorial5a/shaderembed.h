@@ -0,0 +1,48 @@
+// shaderembed.h
+
+#ifndef __SHADEREMBED_H__
+#define __SHADEREMBED_H__
+
+#include <cstddef>
+
+/** A shader source file compiled into the executable.
+ * 
+ * The table is generated at build time by tools/embedshaders.cpp (see
+ * embeddedshaders.h), so loading embedded shaders needs no file I/O and
+ * works from any working directory.
+ */
+
+typedef struct EmbeddedShader_s {
+	// The file's path, relative to the shaders' directory (e.g., "texture.vert"
+	// or "common/lighting.glsl")
+	const char *name;
+	
+	// The file's contents ('\0' terminated)
+	const char *src;
+	size_t length;
+} EmbeddedShader;
+
+/** Finds an embedded shader.
+ * 
+ * @param name the shader file's name (e.g., "texture.vert")
+ * 
+ * @return const EmbeddedShader* the shader, or NULL if it isn't embedded
+ */
+
+const EmbeddedShader *shaderEmbeddedFind(const char *name);
+
+/** Loads "embedded" shaders from a directory on disk instead, for
+ * development (so shader edits don't need a rebuild).
+ * 
+ * @param dir the directory, including the trailing path separator, or NULL
+ * to use the embedded shaders again
+ */
+
+void shaderEmbeddedOverride(const char *dir);
+
+/** Gets the override directory (NULL if none).
+ */
+
+const char *shaderEmbeddedOverrideDir();
+
+#endif
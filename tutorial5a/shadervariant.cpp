@@ -0,0 +1,115 @@
+// shadervariant.cpp
+//
+// See header file for details
+
+#include "shadervariant.h"
+#include "shader.h"
+
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+#include <SDL_opengles2.h>
+
+struct ShaderVariants_s {
+	std::string vertFilename;
+	std::string fragFilename;
+	std::vector<ShaderFeature> features;
+	
+	// Where each feature starts in the mask
+	std::vector<unsigned int> shifts;
+	
+	// The variants built so far (0 for those that failed)
+	std::unordered_map<uint32_t, GLuint> programs;
+};
+
+ShaderVariants *shaderVariantsCreate(const char *vertFilename, const char *fragFilename,
+		const ShaderFeature *features, size_t numFeatures) {
+	
+	unsigned int totalBits = 0;
+	for(size_t i = 0; i < numFeatures; ++i) {
+		// A zero-bit feature would be shifted by the full 32 bits if it came last
+		if(features[i].numBits == 0 || features[i].numBits > 32) {
+			SDL_Log("Shader feature %s for %s/%s has %u bits; it needs 1 to 32\n",
+				features[i].name, vertFilename, fragFilename, features[i].numBits);
+			return NULL;
+		}
+		totalBits += features[i].numBits;
+	}
+	if(totalBits > 32) {
+		SDL_Log("Shader features for %s/%s need %u bits; masks only have 32\n",
+			vertFilename, fragFilename, totalBits);
+		return NULL;
+	}
+	
+	ShaderVariants *variants = new ShaderVariants_s;
+	variants->vertFilename = vertFilename;
+	variants->fragFilename = fragFilename;
+	variants->features.assign(features, features + numFeatures);
+	unsigned int shift = 0;
+	for(size_t i = 0; i < numFeatures; ++i) {
+		variants->shifts.push_back(shift);
+		shift += features[i].numBits;
+	}
+	
+	return variants;
+}
+
+void shaderVariantsDestroy(ShaderVariants *variants) {
+	
+	for(auto &variant : variants->programs) {
+		if(variant.second) {
+			shaderProgDestroy(variant.second);
+		}
+	}
+	delete variants;
+}
+
+uint32_t shaderVariantMask(const ShaderVariants *variants, const unsigned int *values) {
+	
+	uint32_t mask = 0;
+	for(size_t i = 0; i < variants->features.size(); ++i) {
+		uint32_t valueMask = (uint32_t)((1ULL << variants->features[i].numBits) - 1);
+		mask |= (values[i] & valueMask) << variants->shifts[i];
+	}
+	
+	return mask;
+}
+
+/** Builds the #define lines for a variant.
+ */
+
+static std::string shaderVariantDefines(const ShaderVariants *variants, uint32_t mask) {
+	
+	std::string defines;
+	for(size_t i = 0; i < variants->features.size(); ++i) {
+		uint32_t valueMask = (uint32_t)((1ULL << variants->features[i].numBits) - 1);
+		char line[128];
+		snprintf(line, sizeof(line), "#define %s %u\n", variants->features[i].name,
+			(unsigned int)((mask >> variants->shifts[i]) & valueMask));
+		defines += line;
+	}
+	
+	return defines;
+}
+
+GLuint shaderVariantGet(ShaderVariants *variants, uint32_t mask) {
+	
+	auto found = variants->programs.find(mask);
+	if(found != variants->programs.end()) {
+		return found->second;
+	}
+	
+	// First request, so build it
+	std::string defines = shaderVariantDefines(variants, mask);
+	GLuint shaderProg = shaderProgLoadDefines(variants->vertFilename.c_str(),
+		variants->fragFilename.c_str(), defines.c_str());
+	if(!shaderProg) {
+		SDL_Log("Couldn't build shader variant 0x%08X of %s/%s\n", mask,
+			variants->vertFilename.c_str(), variants->fragFilename.c_str());
+	}
+	variants->programs[mask] = shaderProg;
+	
+	return shaderProg;
+}
@@ -0,0 +1,76 @@
+// shadervariant.h
+
+#ifndef __SHADERVARIANT_H__
+#define __SHADERVARIANT_H__
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+#include <cstdint>
+
+/** A compile-time shader feature, which is passed to the shaders as a
+ * #define (e.g., "#define NUM_LIGHTS 2").
+ */
+
+typedef struct ShaderFeature_s {
+	// The macro's name (must stay valid for the variant set's lifetime)
+	const char *name;
+	
+	// The number of bits the feature's value takes up in a variant mask (at least 1)
+	unsigned int numBits;
+} ShaderFeature;
+
+/** The variants of a shader program, built from the same vertex and
+ * fragment shaders with different feature values.
+ * 
+ * Each variant is compiled the first time it's requested, and kept in a
+ * hash map keyed by its feature bitmask. Specialized variants avoid paying
+ * for runtime branches on every fragment.
+ */
+
+typedef struct ShaderVariants_s ShaderVariants;
+
+/** Creates a set of shader variants. Nothing is compiled yet.
+ * 
+ * @param vertFilename filename for the vertex shader
+ * @param fragFilename filename for the fragment shader
+ * @param features the features, in the order they're packed into the mask
+ * (lowest bits first)
+ * @param numFeatures the number of features (their bits must add up to 32
+ * or less)
+ * 
+ * @return ShaderVariants* the variant set, or NULL if failed
+ */
+
+ShaderVariants *shaderVariantsCreate(const char *vertFilename, const char *fragFilename,
+	const ShaderFeature *features, size_t numFeatures);
+
+/** Destroys a variant set, including all of its shader programs.
+ */
+
+void shaderVariantsDestroy(ShaderVariants *variants);
+
+/** Packs feature values into a variant mask.
+ * 
+ * @param variants the variant set
+ * @param values one value per feature (each must fit in the feature's bits)
+ * 
+ * @return uint32_t the variant mask
+ */
+
+uint32_t shaderVariantMask(const ShaderVariants *variants, const unsigned int *values);
+
+/** Gets the shader program for a variant, compiling it if this is the first
+ * request.
+ * 
+ * Variants that fail to build are remembered too, so they aren't rebuilt on
+ * every request. This will print any errors to the console.
+ * 
+ * @param variants the variant set
+ * @param mask the variant's mask (see shaderVariantMask())
+ * 
+ * @return GLuint the shader program's ID, or 0 if failed
+ */
+
+GLuint shaderVariantGet(ShaderVariants *variants, uint32_t mask);
+
+#endif
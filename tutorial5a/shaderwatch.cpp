@@ -0,0 +1,400 @@
+// shaderwatch.cpp
+//
+// See header file for details
+
+#include "shaderwatch.h"
+#include "shader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <SDL.h>
+#include <SDL_opengles2.h>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+struct ShaderWatch_s {
+	char *vertFilename;
+	char *fragFilename;
+	
+	// The part of each filename after the directory (inotify reports names relative to the directory)
+	const char *vertBasename;
+	const char *fragBasename;
+	
+	// Watch descriptors for the directories containing the files
+	int vertDirWatch;
+	int fragDirWatch;
+	
+	// The program in use, and the one being built (if rebuilding)
+	GLuint shaderProg;
+	ShaderProgJob job;
+	bool rebuilding;
+	
+	// Set by the watcher thread when a file changes
+	SDL_atomic_t changed;
+	
+	ShaderWatch *next;
+};
+
+/** A watched #include file (see shaderIncludeFile()).
+ */
+
+typedef struct IncludeWatch_s {
+	int dirWatch;
+	char *basename;
+	IncludeWatch_s *next;
+} IncludeWatch;
+
+// The watcher thread's state. watchList and includeWatchList are protected by watchMutex
+static SDL_mutex *watchMutex = NULL;
+static SDL_Thread *watchThread = NULL;
+static ShaderWatch *watchList = NULL;
+static IncludeWatch *includeWatchList = NULL;
+
+// Set by the watcher thread when an #include file changes
+static SDL_atomic_t includeChanged;
+
+#ifdef __linux__
+
+static int inotifyFd = -1;
+static int wakePipe[2] = {-1, -1};
+
+/** Flags every watched program that uses the changed file.
+ */
+
+static void watchFileChanged(int dirWatch, const char *name) {
+	SDL_LockMutex(watchMutex);
+	
+	// Any program could be using an #include file, so they're all rebuilt
+	bool isInclude = false;
+	for(IncludeWatch *includeWatch = includeWatchList; includeWatch; includeWatch = includeWatch->next) {
+		isInclude |= dirWatch == includeWatch->dirWatch && strcmp(name, includeWatch->basename) == 0;
+	}
+	if(isInclude) {
+		SDL_AtomicSet(&includeChanged, 1);
+	}
+	
+	for(ShaderWatch *watch = watchList; watch; watch = watch->next) {
+		if(isInclude || (dirWatch == watch->vertDirWatch && strcmp(name, watch->vertBasename) == 0) ||
+				(dirWatch == watch->fragDirWatch && strcmp(name, watch->fragBasename) == 0)) {
+			SDL_AtomicSet(&watch->changed, 1);
+		}
+	}
+	SDL_UnlockMutex(watchMutex);
+}
+
+/** The watcher thread. Sleeps until inotify reports something, or until it's
+ * woken up to quit.
+ */
+
+static int watchThreadMain(void *data) {
+	(void)data;
+	
+	alignas(struct inotify_event) char buffer[4096];
+	struct pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+	while(true) {
+		if(poll(fds, 2, -1) < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			SDL_Log("Shader watcher stopped; poll() failed with error %d\n", errno);
+			break;
+		}
+		if(fds[1].revents) {
+			// Time to quit
+			break;
+		}
+		
+		ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+		if(length < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			SDL_Log("Shader watcher stopped; read() failed with error %d\n", errno);
+			break;
+		}
+		const struct inotify_event *event;
+		for(char *ptr = buffer; ptr < buffer + length; ptr += sizeof(struct inotify_event) + event->len) {
+			event = (const struct inotify_event*)ptr;
+			if(event->len > 0) {
+				watchFileChanged(event->wd, event->name);
+			}
+		}
+	}
+	
+	return 0;
+}
+
+static bool watchThreadStart() {
+	inotifyFd = inotify_init1(IN_CLOEXEC);
+	if(inotifyFd < 0) {
+		SDL_Log("Couldn't initialize inotify (error %d)\n", errno);
+		return false;
+	}
+	if(pipe(wakePipe) != 0) {
+		SDL_Log("Couldn't create the shader watcher's wake-up pipe (error %d)\n", errno);
+		close(inotifyFd);
+		inotifyFd = -1;
+		return false;
+	}
+	
+	watchThread = SDL_CreateThread(watchThreadMain, "ShaderWatch", NULL);
+	if(!watchThread) {
+		SDL_Log("Couldn't start the shader watcher thread: %s\n", SDL_GetError());
+		close(wakePipe[0]);
+		close(wakePipe[1]);
+		wakePipe[0] = wakePipe[1] = -1;
+		close(inotifyFd);
+		inotifyFd = -1;
+		return false;
+	}
+	
+	return true;
+}
+
+static void watchThreadStop() {
+	if(write(wakePipe[1], "q", 1) != 1) {
+		SDL_Log("Couldn't wake up the shader watcher thread (error %d)\n", errno);
+	}
+	SDL_WaitThread(watchThread, NULL);
+	watchThread = NULL;
+	
+	// Closing the inotify instance also removes all of its watches
+	close(wakePipe[0]);
+	close(wakePipe[1]);
+	wakePipe[0] = wakePipe[1] = -1;
+	close(inotifyFd);
+	inotifyFd = -1;
+}
+
+/** Watches the directory containing a file. Watching the directory (rather
+ * than the file) catches editors that save by writing a new file and renaming
+ * it over the old one.
+ * 
+ * @param filename the file's name
+ * @param basename set to the part of filename after the directory
+ * 
+ * @return int the directory's watch descriptor, or -1 if failed
+ */
+
+static int watchAddFile(const char *filename, const char **basename) {
+	const char *slash = strrchr(filename, '/');
+	*basename = slash ? slash + 1 : filename;
+	if(inotifyFd < 0) {
+		return -1;
+	}
+	
+	size_t dirLength = slash ? (size_t)(slash - filename) + 1 : 0;
+	char *dir = (char*)malloc(dirLength + 2);
+	if(!dir) {
+		return -1;
+	}
+	if(dirLength > 0) {
+		memcpy(dir, filename, dirLength);
+		dir[dirLength] = '\0';
+	}
+	else {
+		strcpy(dir, ".");
+	}
+	
+	// NOTE: Watching the same directory twice returns the same descriptor
+	int dirWatch = inotify_add_watch(inotifyFd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+	if(dirWatch < 0) {
+		SDL_Log("Couldn't watch directory %s (error %d)\n", dir, errno);
+	}
+	
+	free(dir);
+	return dirWatch;
+}
+
+#else
+
+static bool watchThreadStart() {
+	SDL_Log("Shader hot-reloading isn't supported on this platform\n");
+	return true;
+}
+
+static void watchThreadStop() {
+}
+
+static int watchAddFile(const char *filename, const char **basename) {
+	*basename = filename;
+	return -1;
+}
+
+#endif
+
+/** Watches all #include files read so far, that aren't watched yet.
+ * 
+ * NOTE: Call with watchMutex locked.
+ */
+
+static void watchAddIncludes() {
+	const char *path;
+	for(size_t i = 0; (path = shaderIncludeFile(i)) != NULL; ++i) {
+		if(!path[0]) {
+			// Embedded, so it can't change
+			continue;
+		}
+		
+		const char *basename = NULL;
+		int dirWatch = watchAddFile(path, &basename);
+		if(dirWatch < 0) {
+			continue;
+		}
+		bool watched = false;
+		for(IncludeWatch *includeWatch = includeWatchList; includeWatch; includeWatch = includeWatch->next) {
+			watched |= dirWatch == includeWatch->dirWatch && strcmp(basename, includeWatch->basename) == 0;
+		}
+		if(watched) {
+			continue;
+		}
+		
+		IncludeWatch *includeWatch = (IncludeWatch*)malloc(sizeof(IncludeWatch));
+		char *basenameCopy = strdup(basename);
+		if(!includeWatch || !basenameCopy) {
+			SDL_Log("Couldn't watch #include file %s; out of memory\n", path);
+			free(includeWatch);
+			free(basenameCopy);
+			continue;
+		}
+		includeWatch->dirWatch = dirWatch;
+		includeWatch->basename = basenameCopy;
+		includeWatch->next = includeWatchList;
+		includeWatchList = includeWatch;
+	}
+}
+
+static void watchRemoveIncludes() {
+	while(includeWatchList) {
+		IncludeWatch *includeWatch = includeWatchList;
+		includeWatchList = includeWatch->next;
+		free(includeWatch->basename);
+		free(includeWatch);
+	}
+}
+
+ShaderWatch *shaderWatchCreate(const char *vertFilename, const char *fragFilename) {
+	
+	GLuint shaderProg = shaderProgLoad(vertFilename, fragFilename);
+	if(!shaderProg) {
+		return NULL;
+	}
+	
+	ShaderWatch *watch = (ShaderWatch*)calloc(1, sizeof(ShaderWatch));
+	if(watch) {
+		watch->vertFilename = strdup(vertFilename);
+		watch->fragFilename = strdup(fragFilename);
+	}
+	if(!watch || !watch->vertFilename || !watch->fragFilename) {
+		SDL_Log("Couldn't watch shader program; out of memory\n");
+		if(watch) {
+			free(watch->vertFilename);
+			free(watch->fragFilename);
+			free(watch);
+		}
+		shaderProgDestroy(shaderProg);
+		return NULL;
+	}
+	watch->shaderProg = shaderProg;
+	
+	if(!watchMutex) {
+		watchMutex = SDL_CreateMutex();
+	}
+	if(!watchList && !watchThreadStart()) {
+		// Carry on without reloading
+		SDL_Log("Shader hot-reloading disabled\n");
+	}
+	
+	SDL_LockMutex(watchMutex);
+	watch->vertDirWatch = watchAddFile(watch->vertFilename, &watch->vertBasename);
+	watch->fragDirWatch = watchAddFile(watch->fragFilename, &watch->fragBasename);
+	watchAddIncludes();
+	watch->next = watchList;
+	watchList = watch;
+	SDL_UnlockMutex(watchMutex);
+	
+	return watch;
+}
+
+void shaderWatchDestroy(ShaderWatch *watch) {
+	
+	SDL_LockMutex(watchMutex);
+	for(ShaderWatch **curr = &watchList; *curr; curr = &(*curr)->next) {
+		if(*curr == watch) {
+			*curr = watch->next;
+			break;
+		}
+	}
+	bool lastWatch = watchList == NULL;
+	SDL_UnlockMutex(watchMutex);
+	
+	if(lastWatch && watchThread) {
+		watchThreadStop();
+	}
+	if(lastWatch) {
+		watchRemoveIncludes();
+	}
+	
+	if(watch->rebuilding) {
+		shaderProgBatchFinish(&watch->job, 1);
+		shaderProgDestroy(watch->job.shaderProg);
+	}
+	shaderProgDestroy(watch->shaderProg);
+	free(watch->vertFilename);
+	free(watch->fragFilename);
+	free(watch);
+}
+
+GLuint shaderWatchProg(ShaderWatch *watch) {
+	
+	return watch->shaderProg;
+}
+
+bool shaderWatchUpdate(ShaderWatch *watch) {
+	
+	if(watch->rebuilding) {
+		ShaderProgStatus status = shaderProgJobPoll(&watch->job);
+		if(status == SHADER_PROG_PENDING) {
+			return false;
+		}
+		watch->rebuilding = false;
+		
+		// The program may have #included new files
+		SDL_LockMutex(watchMutex);
+		watchAddIncludes();
+		SDL_UnlockMutex(watchMutex);
+		
+		if(status == SHADER_PROG_READY) {
+			SDL_Log("Reloaded shader program (vert. shader: %s, frag. shader: %s)\n",
+				watch->vertFilename, watch->fragFilename);
+			shaderProgDestroy(watch->shaderProg);
+			watch->shaderProg = watch->job.shaderProg;
+			return true;
+		}
+		
+		SDL_Log("Keeping the previous shader program (vert. shader: %s, frag. shader: %s)\n",
+			watch->vertFilename, watch->fragFilename);
+		return false;
+	}
+	
+	if(SDL_AtomicSet(&watch->changed, 0)) {
+		if(SDL_AtomicSet(&includeChanged, 0)) {
+			// Read the edited #include file again
+			shaderIncludeCacheClear();
+		}
+		
+		// Start the rebuild, and check on it next frame
+		memset(&watch->job, 0, sizeof(watch->job));
+		watch->job.vertFilename = watch->vertFilename;
+		watch->job.fragFilename = watch->fragFilename;
+		shaderProgBatchSubmit(&watch->job, 1);
+		watch->rebuilding = true;
+	}
+	
+	return false;
+}
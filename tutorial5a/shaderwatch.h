@@ -0,0 +1,58 @@
+// shaderwatch.h
+
+#ifndef __SHADERWATCH_H__
+#define __SHADERWATCH_H__
+
+#include <GLES3/gl3.h>
+
+/** A shader program that is rebuilt whenever its source files change
+ * (development mode).
+ * 
+ * The files are watched by a background thread (inotify on Linux), so
+ * there's no per-frame polling of the filesystem. Other platforms just never
+ * see any changes.
+ */
+
+typedef struct ShaderWatch_s ShaderWatch;
+
+/** Loads a shader program, and starts watching its source files.
+ * 
+ * This will print any errors to the console.
+ * 
+ * @param vertFilename filename for the vertex shader
+ * @param fragFilename filename for the fragment shader
+ * 
+ * @return ShaderWatch* the watched program, or NULL if the initial load failed
+ */
+
+ShaderWatch *shaderWatchCreate(const char *vertFilename, const char *fragFilename);
+
+/** Stops watching, and destroys the shader program.
+ */
+
+void shaderWatchDestroy(ShaderWatch *watch);
+
+/** Returns the current shader program.
+ */
+
+GLuint shaderWatchProg(ShaderWatch *watch);
+
+/** Rebuilds the shader program if its files have changed. Call this between
+ * frames.
+ * 
+ * The new program is built with shaderProgBatchSubmit(), and swapped in once
+ * it's ready, so the render loop doesn't wait for the compiler (unless the
+ * driver lacks GL_KHR_parallel_shader_compile). If the new version fails to
+ * build, then the previous program stays in use.
+ * 
+ * IMPORTANT: When this returns true the old program has been deleted. Call
+ * glUseProgram() with the new one, and set all of its uniforms again.
+ * 
+ * @param watch the watched program
+ * 
+ * @return bool true if a new shader program was swapped in
+ */
+
+bool shaderWatchUpdate(ShaderWatch *watch);
+
+#endif
@@ -3,131 +3,337 @@
 // See header file for details
 
 #include "texture.h"
+#include "etc2.h"
+#include "filemap.h"
+#include "ktx.h"
+#include "mipmap.h"
+#include "pixelrepack.h"
+#include "texturecache.h"
 
 #include <SDL.h>
 #include <SDL_image.h>
 #include <SDL_opengles2.h>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
 
-/** Sets the swizzling for a texture colour channel from an SDL colour mask.
+/** The ETC2 mipmap chain being encoded by texLoadCompressed().
+ */
+
+typedef struct TexEtc2Chain_s {
+	bool alpha;
+	std::vector<std::vector<unsigned char> > levels;
+} TexEtc2Chain;
+
+/** Where mipmapChainBuild() levels go (see texMipmapLevelUpload()).
+ */
+
+typedef struct TexLevelUpload_s {
+	GLenum format;
+	
+	// The number of levels that aren't in the texture (see texLoadReduced())
+	int skipLevels;
+	
+	// The last level the texture has, and whether it's been reached (so the
+	// rest of the chain isn't built)
+	int lastLevel;
+	bool complete;
+} TexLevelUpload;
+
+// The size and format of every texture created here (for texInfoGet())
+static std::unordered_map<GLuint, TexInfo> texInfos;
+
+/** Returns true if GL's unpack state can describe a row pitch (see texUnpackPitchSet()).
+ */
+
+static bool texUnpackPitchSupported(int pitch, int bytesPerPixel, int width) {
+	int packedPitch = (width * bytesPerPixel + 3) & ~3;
+	
+	return pitch == packedPitch || pitch % bytesPerPixel == 0;
+}
+
+/** Sets GL_UNPACK_ROW_LENGTH/ALIGNMENT so that glTexImage2D() reads rows
+ * that are pitch bytes apart.
  * 
- * @param channel the texture channel to set (e.g., GL_TEXTURE_SWIZZLE_R)
- * @param mask the SDL colour channel mask (e.g., texSurf->format->Rmask)
+ * @param pitch the number of bytes per row (0 to go back to the defaults,
+ * i.e., rows padded to 4 bytes)
+ * @param bytesPerPixel the number of bytes per pixel
+ * @param width the image's width in pixels
  */
 
-bool sdlToGLSwizzle(GLenum channel, Uint32 mask) {
-	GLint swizzle;
-	switch(mask) {
-		case 0x000000FF:
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-			swizzle = GL_ALPHA;
-#else
-			swizzle = GL_RED;
-#endif
-		break;
-		case 0x0000FF00:
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-			swizzle = GL_BLUE;
-#else
-			swizzle = GL_GREEN;
-#endif
-		break;
-		case 0x00FF0000:
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-			swizzle = GL_GREEN;
-#else
-			swizzle = GL_BLUE;
-#endif
-		break;
-		case 0xFF000000:
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-			swizzle = GL_ALPHA;
-#else
-			swizzle = GL_RED;
-#endif
-		break;
-		default:
-			SDL_Log("Unrecongnized colour channel mask 0x%08X", mask);
-			return false;
-	} //end switch(mask)
+static void texUnpackPitchSet(int pitch, int bytesPerPixel, int width) {
+	int packedPitch = (width * bytesPerPixel + 3) & ~3;
+	if(pitch == 0 || pitch == packedPitch) {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+	else {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch / bytesPerPixel);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	}
+}
+
+/** Uploads a mipmap level built by mipmapChainBuild() to the bound texture.
+ */
+
+static bool texMipmapLevelUpload(int level, int width, int height, const void *pixels, int pitch, void *userData) {
+	(void)pitch; // Rows are 4-byte aligned, which is what glTexSubImage2D() expects
+	TexLevelUpload *upload = (TexLevelUpload*)userData;
+	if(level < upload->skipLevels) {
+		return true;
+	}
+	glTexSubImage2D(GL_TEXTURE_2D, level - upload->skipLevels, 0, 0, width, height,
+		upload->format, GL_UNSIGNED_BYTE, pixels);
+	if(glGetError() != GL_NO_ERROR) {
+		return false;
+	}
 	
-	glTexParameteri(GL_TEXTURE_2D, channel, swizzle);
-	return true;
+	// Stop here if the texture has no more levels
+	upload->complete = level >= upload->lastLevel;
+	return !upload->complete;
 }
 
-GLuint texLoad(const char *filename) {
+bool texImageLoadersInit() {
+	
+	// Only needed once
+	static bool loadersReady = false;
+	if(loadersReady) {
+		return true;
+	}
 	
-	// Make sure the JPEG and PNG image loaders are present (don't know what file type we'll get).
 	int flags = IMG_INIT_JPG | IMG_INIT_PNG;
 	if((IMG_Init(flags) & flags) == 0) {
 		
 		// Failed :-(
 		SDL_Log("ERROR: Texture loading failed. Couldn't get JPEG and PNG loaders. \n");
+		return false;
+	}
+	
+	loadersReady = true;
+	return true;
+}
+
+/** ETC2 encodes a mipmap level (see mipmapChainBuild()).
+ */
+
+static bool texEtc2LevelEncode(int level, int width, int height, const void *pixels, int pitch, void *userData) {
+	TexEtc2Chain *chain = (TexEtc2Chain*)userData;
+	std::vector<unsigned char> &blocks = chain->levels[level];
+	blocks.resize(etc2EncodedSize(width, height, chain->alpha));
+	
+	return etc2Encode(pixels, width, height, pitch, chain->alpha, &blocks[0], 0);
+}
+
+/** Creates a texture from a KTX image, with immutable storage for exactly its levels.
+ * 
+ * @param image the image
+ * @param skipLevels the number of largest levels to leave out (at least
+ * one level is always kept)
+ * @param filename the image's name (for error messages)
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+static GLuint texKtxUpload(const KtxImage *image, int skipLevels, const char *filename) {
+	
+	GLenum storageFormat = ktxStorageFormat(image);
+	if(storageFormat == GL_NONE) {
+		SDL_Log("Texture %s has an unsupported format (0x%04X, type 0x%04X)\n",
+			filename, image->glFormat, image->glType);
 		return 0;
 	}
 	
-	// Load the image
-	SDL_Surface *texSurf = IMG_Load(filename);
-	if(!texSurf) {
-		SDL_Log("Loading image %s failed with error: %s", filename, IMG_GetError());
+	// Uncompressed levels are read without any size checks, so make sure they're all there
+	if(image->glFormat) {
+		int bytesPerPixel = ktxBytesPerPixel(image->glFormat, image->glType);
+		int width = image->width;
+		int height = image->height;
+		for(int level = 0; level < image->numLevels; ++level) {
+			size_t rowSize = ((size_t)width * bytesPerPixel + 3) & ~(size_t)3;
+			if(image->levelSizes[level] < rowSize * height) {
+				SDL_Log("Texture %s is missing data for mipmap level %d\n", filename, level);
+				return 0;
+			}
+			width = width > 1 ? width / 2 : 1;
+			height = height > 1 ? height / 2 : 1;
+		}
+	}
+	
+	// KTX rows are padded to 4 bytes, which is GL's default unpack alignment
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	
+	int firstLevel = skipLevels < image->numLevels ? skipLevels : image->numLevels - 1;
+	TexInfo info;
+	info.internalFormat = storageFormat;
+	info.width = image->width >> firstLevel > 0 ? image->width >> firstLevel : 1;
+	info.height = image->height >> firstLevel > 0 ? image->height >> firstLevel : 1;
+	info.numLevels = image->numLevels - firstLevel;
+	
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexStorage2D(GL_TEXTURE_2D, info.numLevels, storageFormat, info.width, info.height);
+	int width = info.width;
+	int height = info.height;
+	for(int level = firstLevel; level < image->numLevels; ++level) {
+		if(image->glFormat) {
+			glTexSubImage2D(GL_TEXTURE_2D, level - firstLevel, 0, 0, width, height,
+				image->glFormat, image->glType, image->levelData[level]);
+		}
+		else {
+			glCompressedTexSubImage2D(GL_TEXTURE_2D, level - firstLevel, 0, 0, width, height,
+				image->glInternalFormat, (GLsizei)image->levelSizes[level], image->levelData[level]);
+		}
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Creating texture %s failed, code %u\n", filename, err);
+		glDeleteTextures(1, &texture);
 		return 0;
 	}
+	texInfos[texture] = info;
 	
-	// Determine the format
-	// NOTE: Only supporting 24 and 32-bit images
-	GLenum format;
-	GLenum type = GL_UNSIGNED_BYTE;
-	switch (texSurf->format->BytesPerPixel) {
-		case 3:
-			format = GL_RGB;
-			break;
-		case 4:
-			format = GL_RGBA;
-			break;
-		default:
-			SDL_Log("Can't load image %s; it isn't a 24/32-bit image\n", filename);
-			SDL_FreeSurface(texSurf);
-			texSurf = NULL;
+	return texture;
+}
+
+bool texHasExtension(const char *filename, const char *ext) {
+	size_t length = strlen(filename);
+	size_t extLength = strlen(ext);
+	
+	return length > extLength && SDL_strcasecmp(filename + length - extLength, ext) == 0;
+}
+
+GLuint texLoad(const char *filename) {
+	
+	// KTX files are ready to upload as is
+	if(texHasExtension(filename, ".ktx")) {
+		return texLoadKtx(filename);
+	}
+	
+	return texLoadMipmapped(filename, TEX_MIPMAP_CPU);
+}
+
+/** Creates a texture from an SDL surface (see texCreateFromSurface()).
+ * 
+ * @param skipLevels the number of largest levels to leave out (TEX_MIPMAP_CPU
+ * only; at least one level is always kept)
+ * @param maxLevels the most levels to build, counting from level 0 (0 for
+ * the full chain)
+ */
+
+static GLuint texSurfaceUpload(SDL_Surface *surface, TexMipmapMode mipmapMode, int skipLevels, int maxLevels,
+		const char *name) {
+	
+	// Formats without a byte per channel (e.g., 16-bit or paletted) are converted by SDL first
+	PixelLayout layout;
+	SDL_Surface *convertedSurf = NULL;
+	if(!pixelLayoutFromSDL(surface->format, &layout)) {
+		convertedSurf = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+		if(!convertedSurf || !pixelLayoutFromSDL(convertedSurf->format, &layout)) {
+			SDL_Log("Couldn't convert image %s to RGBA: %s\n", name, SDL_GetError());
+			SDL_FreeSurface(convertedSurf);
 			return 0;
+		}
+		surface = convertedSurf;
 	}
 	
-	// Create the texture
+	// Upload the pixels where they are if GL can read them as is (R, G, B(, A)
+	// byte order, with a row pitch GL_UNPACK_ROW_LENGTH/ALIGNMENT can describe).
+	// Otherwise, repack them to RGBA8 in one pass (4-byte pixels upload faster
+	// than 3-byte ones on many drivers)
+	const void *pixels = surface->pixels;
+	int pitch = surface->pitch;
+	int bytesPerPixel = layout.bytesPerPixel;
+	std::vector<unsigned char> repacked;
+	if(!pixelLayoutIsGL(&layout) || !texUnpackPitchSupported(pitch, bytesPerPixel, surface->w)) {
+		bytesPerPixel = 4;
+		pitch = surface->w * 4;
+		repacked.resize((size_t)pitch * surface->h);
+		pixelRepack(surface->pixels, surface->pitch, &layout, &repacked[0], pitch, 4, surface->w, surface->h);
+		pixels = &repacked[0];
+	}
+	TexLevelUpload upload;
+	upload.format = bytesPerPixel == 4 ? GL_RGBA : GL_RGB;
+	
+	// Create the texture, with immutable storage for exactly the levels it'll
+	// have (only CPU-built levels can be left out, as level 0 isn't needed for them)
+	int numLevels = mipmapMode == TEX_MIPMAP_NONE ? 1 : mipmapLevelCount(surface->w, surface->h);
+	numLevels = maxLevels > 0 && maxLevels < numLevels ? maxLevels : numLevels;
+	upload.lastLevel = numLevels - 1;
+	upload.complete = false;
+	upload.skipLevels = mipmapMode != TEX_MIPMAP_CPU ? 0 : skipLevels < numLevels ? skipLevels : numLevels - 1;
+	TexInfo info;
+	info.internalFormat = bytesPerPixel == 4 ? GL_RGBA8 : GL_RGB8;
+	info.width = surface->w >> upload.skipLevels > 0 ? surface->w >> upload.skipLevels : 1;
+	info.height = surface->h >> upload.skipLevels > 0 ? surface->h >> upload.skipLevels : 1;
+	info.numLevels = numLevels - upload.skipLevels;
 	GLuint texture;
 	glGenTextures(1, &texture);
 	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexImage2D(GL_TEXTURE_2D, 0, format, texSurf->w,
-		texSurf->h, 0, format, type, texSurf->pixels); // what's the deal with 'type'???
+	glTexStorage2D(GL_TEXTURE_2D, info.numLevels, info.internalFormat, info.width, info.height);
+	if(upload.skipLevels == 0) {
+		texUnpackPitchSet(pitch, bytesPerPixel, surface->w);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, surface->w, surface->h, upload.format, GL_UNSIGNED_BYTE, pixels);
+		texUnpackPitchSet(0, bytesPerPixel, surface->w);
+	}
 	GLenum err = glGetError();
 	if (err != GL_NO_ERROR) {
 		
 		// Failed
-		glDeleteBuffers(1, &texture);
-		texture = 0;
-		SDL_FreeSurface(texSurf);
-		texSurf = NULL;
-		SDL_Log("Creating texture %s failed, code %u\n", filename, err);
+		glDeleteTextures(1, &texture);
+		SDL_FreeSurface(convertedSurf);
+		SDL_Log("Creating texture %s failed, code %u\n", name, err);
 		return 0;
 	}
 	
-	// Set up texture swizzling to match the image's channel order
-	bool success = sdlToGLSwizzle(GL_TEXTURE_SWIZZLE_R, texSurf->format->Rmask);
-	success &= sdlToGLSwizzle(GL_TEXTURE_SWIZZLE_G, texSurf->format->Gmask);
-	success &= sdlToGLSwizzle(GL_TEXTURE_SWIZZLE_G, texSurf->format->Bmask);
-	if(format == GL_RGBA) {
-		success &= sdlToGLSwizzle(GL_TEXTURE_SWIZZLE_G, texSurf->format->Amask);
+	// Build the mipmap chain
+	bool success = true;
+	switch(mipmapMode) {
+		case TEX_MIPMAP_GL:
+			glGenerateMipmap(GL_TEXTURE_2D);
+			success = glGetError() == GL_NO_ERROR;
+			break;
+		case TEX_MIPMAP_CPU:
+			if(numLevels > 1) {
+				success = mipmapChainBuild(pixels, surface->w, surface->h, pitch, bytesPerPixel,
+					bytesPerPixel == 4 ? 3 : -1, texMipmapLevelUpload, &upload) || upload.complete;
+			}
+			break;
+		default:
+			break;
 	}
+	SDL_FreeSurface(convertedSurf);
+	convertedSurf = NULL;
 	if(!success) {
-		SDL_Log("Couldn't set up swizzling for texture %s\n", filename);
-		glDeleteBuffers(1, &texture);
-		texture = 0;
-		SDL_FreeSurface(texSurf);
-		texSurf = NULL;
+		SDL_Log("Couldn't build the mipmaps for texture %s\n", name);
+		glDeleteTextures(1, &texture);
 		return 0;
 	}
+	texInfos[texture] = info;
+	
+	return texture;
+}
+
+/** Loads an image file (see texLoadMipmapped()), leaving out the largest
+ * skipLevels levels.
+ */
+
+static GLuint texImageLoad(const char *filename, TexMipmapMode mipmapMode, int skipLevels) {
 	
-	// Set up the filtering
-	// NOTE: Failure to do this may result in no texture
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	if(!texImageLoadersInit()) {
+		return 0;
+	}
+	
+	// Load the image
+	SDL_Surface *texSurf = IMG_Load(filename);
+	if(!texSurf) {
+		SDL_Log("Loading image %s failed with error: %s", filename, IMG_GetError());
+		return 0;
+	}
+	
+	GLuint texture = texSurfaceUpload(texSurf, mipmapMode, skipLevels, 0, filename);
 	
 	// Cleanup
 	SDL_FreeSurface(texSurf);
@@ -136,8 +342,277 @@ GLuint texLoad(const char *filename) {
 	return texture;
 }
 
+GLuint texLoadMipmapped(const char *filename, TexMipmapMode mipmapMode) {
+	return texImageLoad(filename, mipmapMode, 0);
+}
+
+GLuint texCreateFromSurface(SDL_Surface *surface, TexMipmapMode mipmapMode, const char *name) {
+	return texSurfaceUpload(surface, mipmapMode, 0, 0, name);
+}
+
+GLuint texCreateFromSurfaceLevels(SDL_Surface *surface, int numLevels, const char *name) {
+	return texSurfaceUpload(surface, TEX_MIPMAP_CPU, 0, numLevels > 0 ? numLevels : 1, name);
+}
+
+/** Loads an image file ETC2 compressed (see texLoadCompressed()), leaving
+ * out the largest skipLevels levels.
+ */
+
+static GLuint texCompressedLoad(const char *filename, int skipLevels) {
+	
+	FileMap srcMap;
+	if(!fileMap(filename, &srcMap)) {
+		return 0;
+	}
+	uint64_t key = texCacheKey(srcMap.data, srcMap.length, "etc2");
+	
+	// Use the cached copy if there is one (no decoding or encoding needed)
+	FileMap cacheMap;
+	KtxImage image;
+	if(texCacheLoad(key, &cacheMap, &image)) {
+		GLuint texture = texKtxUpload(&image, skipLevels, filename);
+		fileUnmap(&cacheMap);
+		if(texture) {
+			fileUnmap(&srcMap);
+			return texture;
+		}
+	}
+	
+	// Decode the file that's already in memory
+	if(!texImageLoadersInit()) {
+		fileUnmap(&srcMap);
+		return 0;
+	}
+	SDL_Surface *loadedSurf = IMG_Load_RW(SDL_RWFromConstMem(srcMap.data, (int)srcMap.length), 1);
+	fileUnmap(&srcMap);
+	if(!loadedSurf) {
+		SDL_Log("Loading image %s failed with error: %s", filename, IMG_GetError());
+		return 0;
+	}
+	
+	// The encoder takes R, G, B, A byte order (so no swizzling is needed either)
+	SDL_Surface *texSurf = SDL_ConvertSurfaceFormat(loadedSurf, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_FreeSurface(loadedSurf);
+	loadedSurf = NULL;
+	if(!texSurf) {
+		SDL_Log("Couldn't convert image %s to RGBA: %s\n", filename, SDL_GetError());
+		return 0;
+	}
+	
+	// Only keep the alpha channel if it's used (halves the size)
+	TexEtc2Chain chain;
+	chain.alpha = false;
+	for(int y = 0; y < texSurf->h && !chain.alpha; ++y) {
+		const Uint8 *row = (const Uint8*)texSurf->pixels + y * texSurf->pitch;
+		for(int x = 0; x < texSurf->w; ++x) {
+			chain.alpha |= row[x * 4 + 3] != 0xFF;
+		}
+	}
+	
+	// Encode level 0, and the mipmap levels as they're built
+	int numLevels = mipmapLevelCount(texSurf->w, texSurf->h);
+	bool success = numLevels <= KTX_MAX_LEVELS;
+	if(success) {
+		chain.levels.resize(numLevels);
+		success = texEtc2LevelEncode(0, texSurf->w, texSurf->h, texSurf->pixels, texSurf->pitch, &chain) &&
+			mipmapChainBuild(texSurf->pixels, texSurf->w, texSurf->h, texSurf->pitch, 4, 3,
+				texEtc2LevelEncode, &chain);
+	}
+	image.glInternalFormat = chain.alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+	image.glFormat = 0;
+	image.glType = 0;
+	image.width = texSurf->w;
+	image.height = texSurf->h;
+	image.numLevels = numLevels;
+	SDL_FreeSurface(texSurf);
+	texSurf = NULL;
+	if(!success) {
+		SDL_Log("Couldn't ETC2 encode texture %s\n", filename);
+		return 0;
+	}
+	for(int level = 0; level < numLevels; ++level) {
+		image.levelData[level] = &chain.levels[level][0];
+		image.levelSizes[level] = chain.levels[level].size();
+	}
+	
+	GLuint texture = texKtxUpload(&image, skipLevels, filename);
+	if(texture) {
+		texCacheStore(key, &image);
+	}
+	
+	return texture;
+}
+
+GLuint texLoadCompressed(const char *filename) {
+	return texCompressedLoad(filename, 0);
+}
+
+/** Loads a KTX file (see texLoadKtx()), leaving out the largest skipLevels levels.
+ */
+
+static GLuint texKtxLoad(const char *filename, int skipLevels) {
+	
+	// The level pointers point into the mapping, so GL reads the texels straight from the file
+	FileMap ktxMap;
+	if(!fileMap(filename, &ktxMap)) {
+		return 0;
+	}
+	KtxImage image;
+	GLuint texture = 0;
+	if(ktxParse(ktxMap.data, ktxMap.length, &image)) {
+		texture = texKtxUpload(&image, skipLevels, filename);
+	}
+	else {
+		SDL_Log("Couldn't load texture %s\n", filename);
+	}
+	fileUnmap(&ktxMap);
+	
+	return texture;
+}
+
+GLuint texLoadKtx(const char *filename) {
+	return texKtxLoad(filename, 0);
+}
+
+GLuint texLoadReduced(const char *filename, bool compress, int skipLevels) {
+	
+	skipLevels = skipLevels > 0 ? skipLevels : 0;
+	if(texHasExtension(filename, ".ktx")) {
+		return texKtxLoad(filename, skipLevels);
+	}
+	if(compress) {
+		return texCompressedLoad(filename, skipLevels);
+	}
+	
+	return texImageLoad(filename, TEX_MIPMAP_CPU, skipLevels);
+}
+
+/** Gets an image file's size, from the header if it's a PNG file.
+ * 
+ * @return bool true if successful
+ */
+
+static bool texImageSizeGet(const char *filename, int *width, int *height) {
+	
+	// PNG files start with an 8-byte signature, then the IHDR chunk's length,
+	// type, and the big-endian width and height
+	static const unsigned char pngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	FileMap imageMap;
+	if(!fileMap(filename, &imageMap)) {
+		return false;
+	}
+	const unsigned char *header = (const unsigned char*)imageMap.data;
+	bool isPng = imageMap.length >= 24 &&
+		memcmp(header, pngSignature, sizeof(pngSignature)) == 0 && memcmp(header + 12, "IHDR", 4) == 0;
+	if(isPng) {
+		*width = (int)((Uint32)header[16] << 24 | (Uint32)header[17] << 16 | (Uint32)header[18] << 8 | header[19]);
+		*height = (int)((Uint32)header[20] << 24 | (Uint32)header[21] << 16 | (Uint32)header[22] << 8 | header[23]);
+	}
+	fileUnmap(&imageMap);
+	if(isPng) {
+		return *width > 0 && *height > 0;
+	}
+	
+	// Anything else has to be decoded
+	if(!texImageLoadersInit()) {
+		return false;
+	}
+	SDL_Surface *surface = IMG_Load(filename);
+	if(!surface) {
+		SDL_Log("Loading image %s failed with error: %s", filename, IMG_GetError());
+		return false;
+	}
+	*width = surface->w;
+	*height = surface->h;
+	SDL_FreeSurface(surface);
+	
+	return true;
+}
+
+bool texFileInfoGet(const char *filename, bool compress, TexInfo *info) {
+	
+	// KTX files say exactly what they hold
+	if(texHasExtension(filename, ".ktx")) {
+		FileMap ktxMap;
+		if(!fileMap(filename, &ktxMap)) {
+			return false;
+		}
+		KtxImage image;
+		bool success = ktxParse(ktxMap.data, ktxMap.length, &image);
+		if(success) {
+			info->internalFormat = ktxStorageFormat(&image);
+			info->width = image.width;
+			info->height = image.height;
+			info->numLevels = image.numLevels;
+		}
+		else {
+			SDL_Log("Couldn't load texture %s\n", filename);
+		}
+		fileUnmap(&ktxMap);
+		return success;
+	}
+	
+	int width = 0;
+	int height = 0;
+	if(!texImageSizeGet(filename, &width, &height)) {
+		return false;
+	}
+	info->internalFormat = compress ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_RGBA8;
+	info->width = width;
+	info->height = height;
+	info->numLevels = mipmapLevelCount(width, height);
+	
+	return true;
+}
+
+bool texInfoGet(GLuint texture, TexInfo *info) {
+	
+	auto found = texInfos.find(texture);
+	if(found == texInfos.end()) {
+		return false;
+	}
+	*info = found->second;
+	
+	return true;
+}
+
+size_t texInfoFootprint(const TexInfo *info) {
+	
+	size_t footprint = 0;
+	int width = info->width;
+	int height = info->height;
+	for(int level = 0; level < info->numLevels; ++level) {
+		size_t blocksWide = ((size_t)width + 3) / 4;
+		size_t blocksHigh = ((size_t)height + 3) / 4;
+		switch(info->internalFormat) {
+			case GL_COMPRESSED_RGB8_ETC2:
+				footprint += blocksWide * blocksHigh * 8;
+				break;
+			case GL_COMPRESSED_RGBA8_ETC2_EAC:
+				footprint += blocksWide * blocksHigh * 16;
+				break;
+			case GL_R8:
+				footprint += (size_t)width * height;
+				break;
+			case GL_RG8:
+				footprint += (size_t)width * height * 2;
+				break;
+			default:
+				
+				// RGBA8, and RGB8 (which most GPUs pad to 4 bytes per texel)
+				footprint += (size_t)width * height * 4;
+				break;
+		}
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	
+	return footprint;
+}
+
 void texDestroy(GLuint texName) {
 	
+	texInfos.erase(texName);
 	glDeleteTextures(1, &texName);
 }
 
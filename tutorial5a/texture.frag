@@ -4,37 +4,82 @@
 precision highp float;
 #endif
 
+// Shader features. shaderProgLoadDefines() can override these defaults to
+// build specialized variants (see shadervariant.h)
+#ifndef LIGHTING
+#define LIGHTING 1 // Point lighting on/off
+#endif
+#ifndef NUM_LIGHTS
+#define NUM_LIGHTS 1 // Number of point lights
+#endif
+#ifndef TEXTURED
+#define TEXTURED 1 // Diffuse texture on/off
+#endif
+
+// UBER=1 turns the features into uniforms instead, for comparing runtime
+// branching against specialized variants
+#ifndef UBER
+#define UBER 0
+#endif
+
+#include "common/lighting.glsl"
+
+#if NUM_LIGHTS > MAX_LIGHTS
+#error "NUM_LIGHTS is more than FrameData has room for"
+#endif
+
+#if UBER
+uniform bool lighting;
+uniform int numLights;
+uniform bool textured;
+#define LIGHTING_ON lighting
+#define LIGHT_COUNT numLights
+#define TEXTURED_ON textured
+#else
+#define LIGHTING_ON (LIGHTING != 0)
+#define LIGHT_COUNT NUM_LIGHTS
+#define TEXTURED_ON (TEXTURED != 0)
+#endif
+
 in vec2 texCoord;
 in vec3 normal;
-in vec3 lightVec;
+in vec3 viewPos;
 
 out vec4 fragColour;
 
-uniform vec3 ambientCol; // The light and object's combined ambient colour
-uniform vec3 diffuseCol; // The light and object's combined diffuse colour
-
 uniform sampler2D texSampler;
 
 const float invRadiusSq = 0.00001;
 
 void main() {
 	// Base colour (from the diffuse texture)
-	vec4 colour = texture(texSampler, texCoord);
-	
-	// Ambient lighting
-	vec3 ambient = vec3(ambientCol * colour.xyz);
-	
-	// Calculate the lighting attenuation, and direction
-	float distSq = dot(lightVec, lightVec);
-	float attenuation = clamp(1.0 - invRadiusSq * sqrt(distSq), 0.0, 1.0);
-	attenuation *= attenuation;
-	vec3 lightDir = lightVec * inversesqrt(distSq);
+	vec4 colour = vec4(1.0);
+	if(TEXTURED_ON) {
+		colour = texture(texSampler, texCoord);
+	}
 	
-	// Diffuse lighting
-	vec3 diffuse = max(dot(lightDir, normal), 0.0) * diffuseCol * colour.xyz;
+	vec3 finalColour = colour.xyz;
+	if(LIGHTING_ON) {
+		// Ambient lighting (once, however many lights there are)
+		finalColour = ambientCol * colour.xyz;
+		for(int i = 0; i < LIGHT_COUNT; ++i) {
+			vec3 lightVec = lightPos[i] - viewPos;
+			
+			// Calculate the lighting attenuation, and direction
+			float distSq = dot(lightVec, lightVec);
+			float attenuation = clamp(1.0 - invRadiusSq * sqrt(distSq), 0.0, 1.0);
+			attenuation *= attenuation;
+			vec3 lightDir = lightVec * inversesqrt(distSq);
+			
+			// Diffuse lighting
+			vec3 diffuse = max(dot(lightDir, normal), 0.0) * diffuseCol * colour.xyz;
+			
+			// The light's contribution
+			finalColour += diffuse * attenuation;
+		}
+	}
 	
 	// The final colour
 	// NOTE: Alpha channel shouldn't be affected by lights
-	vec3 finalColour = (ambient + diffuse) * attenuation;
 	fragColour = vec4(finalColour, colour.w);	
 }
@@ -4,8 +4,32 @@
 #define __TEXTURE_H__
 
 #include <GLES3/gl3.h>
+#include <SDL.h>
+#include <cstddef>
 
-/** Loads a 2D texture from file.
+/** How a texture's mipmap chain is built.
+ * 
+ * NOTE: All textures are created with immutable storage (glTexStorage2D())
+ * for exactly the levels they have, and no sampling state of their own.
+ * Bind a sampler from samplerCacheGet() (see samplercache.h) to filter them
+ * (e.g., trilinearly); without one, GL's defaults apply.
+ */
+
+typedef enum TexMipmapMode_e {
+	// No mipmaps (level 0 only, sampled bilinearly)
+	TEX_MIPMAP_NONE,
+	
+	// The driver builds them (glGenerateMipmap())
+	TEX_MIPMAP_GL,
+	
+	// Built on the CPU, in linear light (see mipmapChainBuild())
+	TEX_MIPMAP_CPU
+} TexMipmapMode;
+
+/** Loads a 2D texture from file, with a full mipmap chain (built on the
+ * CPU).
+ * 
+ * Files ending in ".ktx" are loaded with texLoadKtx() instead.
  * 
  * @param filename name of the image file to load
  * 
@@ -14,6 +38,156 @@
 
 GLuint texLoad(const char *filename);
 
+/** Loads a 2D texture from file.
+ * 
+ * @param filename name of the image file to load
+ * @param mipmapMode how to build the mipmap chain
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+GLuint texLoadMipmapped(const char *filename, TexMipmapMode mipmapMode);
+
+/** Creates a 2D texture from an SDL surface (e.g., from IMG_Load()).
+ * 
+ * Pixels already in R, G, B(, A) byte order are uploaded straight from the
+ * surface, whatever its row pitch (using GL_UNPACK_ROW_LENGTH). Other layouts
+ * (e.g., BGR or ARGB) are repacked to RGBA8 in one pass (see pixelRepack()),
+ * so no swizzle state is needed.
+ * 
+ * @param surface the image
+ * @param mipmapMode how to build the mipmap chain
+ * @param name the image's name (for error messages)
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+GLuint texCreateFromSurface(SDL_Surface *surface, TexMipmapMode mipmapMode, const char *name);
+
+/** Creates a 2D texture from an SDL surface with only the first numLevels
+ * levels of its mipmap chain (built on the CPU), e.g., for an atlas whose
+ * smaller levels would blend neighbouring images together.
+ * 
+ * @param surface the image
+ * @param numLevels the number of levels, including level 0 (at least 1)
+ * @param name the image's name (for error messages)
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+GLuint texCreateFromSurfaceLevels(SDL_Surface *surface, int numLevels, const char *name);
+
+/** Makes sure SDL_image's JPEG and PNG loaders are present (don't know what
+ * file type we'll get). Only the first successful call does any work.
+ * 
+ * @return bool true if successful
+ */
+
+bool texImageLoadersInit();
+
+/** Returns true if a filename has the given extension (e.g., ".ktx"), ignoring case.
+ */
+
+bool texHasExtension(const char *filename, const char *ext);
+
+/** Loads a 2D texture from file, ETC2 compressed (with mipmaps).
+ * 
+ * Opaque images become GL_COMPRESSED_RGB8_ETC2 (half a byte per texel), and
+ * images with transparency GL_COMPRESSED_RGBA8_ETC2_EAC (one byte per texel).
+ * Encoding is slow, so the result is stored in the texture cache (if enabled;
+ * see texCacheInit()), keyed by a hash of the image file. Later loads of the
+ * same image then skip both decoding and encoding.
+ * 
+ * @param filename name of the image file to load
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+GLuint texLoadCompressed(const char *filename);
+
+/** Loads a 2D texture from a KTX file (e.g., made by tools/texconvert.cpp).
+ * 
+ * The file is memory-mapped, and its levels are passed to glTexImage2D() or
+ * glCompressedTexImage2D() as they are, so there's no decoding, swizzling or
+ * mipmap building, and no copy of the texels is made; loading time depends
+ * only on how many bytes are uploaded.
+ * 
+ * @param filename name of the KTX file to load
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+GLuint texLoadKtx(const char *filename);
+
+/** Loads a 2D texture from file without its largest mipmap levels (e.g.,
+ * to save memory; see textureresidency.h). Each level skipped halves the
+ * texture's width and height.
+ * 
+ * ".ktx" files are loaded like texLoadKtx(), other files like
+ * texLoadCompressed() or texLoadMipmapped() with TEX_MIPMAP_CPU. The levels
+ * that are left out are never uploaded.
+ * 
+ * @param filename name of the image or KTX file to load
+ * @param compress ETC2 compress the image (see texLoadCompressed())
+ * @param skipLevels the number of levels to leave out (at least one level
+ * is always kept)
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+GLuint texLoadReduced(const char *filename, bool compress, int skipLevels);
+
+/** A texture's storage (see texInfoGet()).
+ */
+
+typedef struct TexInfo_s {
+	// The sized internal format (e.g., GL_RGBA8, GL_COMPRESSED_RGB8_ETC2)
+	GLenum internalFormat;
+	
+	// Level 0's size in texels
+	int width;
+	int height;
+	
+	// The number of mipmap levels, including level 0
+	int numLevels;
+} TexInfo;
+
+/** Gets the storage of a texture created by the functions above.
+ * 
+ * @param texture the texture's name
+ * @param info where to write the info to
+ * 
+ * @return bool true if found, false if the texture wasn't created here (or
+ * was destroyed)
+ */
+
+bool texInfoGet(GLuint texture, TexInfo *info);
+
+/** Estimates how much GPU memory a texture takes up, from its format, size
+ * and number of levels (drivers may add padding and alignment on top).
+ * 
+ * @return size_t the estimate in bytes
+ */
+
+size_t texInfoFootprint(const TexInfo *info);
+
+/** Works out the storage texLoadReduced() would give a file at full size,
+ * without creating a texture (e.g., to make room for it first).
+ * 
+ * KTX files and PNG images only have their headers read. Other images are
+ * decoded to get their size. For images, the format is the largest one the
+ * texture could end up with (RGBA8, or RGBA8 ETC2 + EAC when compressing),
+ * so the footprint is never underestimated.
+ * 
+ * @param filename name of the image or KTX file
+ * @param compress ETC2 compress the image (see texLoadCompressed())
+ * @param info where to write the storage to
+ * 
+ * @return bool true if successful
+ */
+
+bool texFileInfoGet(const char *filename, bool compress, TexInfo *info);
+
 /** Deallocates a texture.
  */
 
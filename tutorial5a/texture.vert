@@ -1,33 +1,80 @@
 #version 300 es
 
+// The vertex format (see vertexformat.h). shaderProgLoadDefines() can
+// override this default to build variants for quantized vertices:
+// 0 = floats, 1 = normalized shorts and octahedral normals,
+// 2 = half floats and 10-bit normals
+#ifndef VERTEX_FORMAT
+#define VERTEX_FORMAT 0
+#endif
+
 layout(location = 0) in vec3 vertPos;
 layout(location = 1) in vec2 vertTexCoord;
+#if VERTEX_FORMAT == 1
+layout(location = 2) in vec2 vertNormal; // Octahedral
+#else
 layout(location = 2) in vec3 vertNormal;
+#endif
+
+#if VERTEX_FORMAT != 0
+// Quantized positions and texture coordinates are relative to the mesh's
+// bounds: value = quantized * scale + offset
+uniform vec3 posScale;
+uniform vec3 posOffset;
+uniform vec2 texCoordScale;
+uniform vec2 texCoordOffset;
+#endif
 
 out vec2 texCoord;
 out vec3 normal;
-out vec3 lightVec;
+out vec3 viewPos;
+
+#include "common/lighting.glsl"
 
-uniform mat4 mvMat;
-uniform mat4 normalMat;
-uniform mat4 projMat;
-uniform vec3 lightPos; // NOTE: position in view space ( so after being
-					   //transformed by its own MV matrix)
+// NOTE: Must match ObjectUniforms in main.cpp
+layout(std140) uniform ObjectData {
+	mat4 mvMat;
+	mat4 normalMat;
+};
+
+#if VERTEX_FORMAT == 1
+// Decodes an octahedral normal (must match vertexOctDecode() in vertexformat.cpp)
+vec3 octDecode(vec2 e) {
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+#endif
 
 void main() {
 	
+#if VERTEX_FORMAT != 0
+	// Dequantize the position and texture coordinate
+	vec3 position = vertPos * posScale + posOffset;
+	texCoord = vertTexCoord * texCoordScale + texCoordOffset;
+#else
+	vec3 position = vertPos;
+	
 	// Pass the texture coordinate
 	texCoord = vertTexCoord;
+#endif
+#if VERTEX_FORMAT == 1
+	vec3 vertNormal3 = octDecode(vertNormal);
+#else
+	vec3 vertNormal3 = vertNormal;
+#endif
 	
 	// Calc. the position in view space
-	vec4 viewPos = mvMat * vec4(vertPos, 1.0);
+	vec4 viewPos4 = mvMat * vec4(position, 1.0);
 	
 	// Calc. the position
-	gl_Position = projMat * viewPos;
+	gl_Position = projMat * viewPos4;
 	
 	// Transform the normal
-	normal = normalize((normalMat * vec4(vertNormal, 1.0)).xyz);
+	normal = normalize((normalMat * vec4(vertNormal3, 1.0)).xyz);
 	
-	// Calc. the light vector
-	lightVec = lightPos - viewPos.xyz;
+	// Pass the view space position on, for the light vectors
+	// NOTE: Calculated per fragment, since the number of lights varies
+	viewPos = viewPos4.xyz;
 }
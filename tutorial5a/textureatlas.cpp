@@ -0,0 +1,445 @@
+// textureatlas.cpp
+//
+// See header file for details
+
+#include "textureatlas.h"
+#include "pixelrepack.h"
+#include "texture.h"
+
+#include <SDL_image.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+typedef struct TexAtlasRect_s {
+	int x, y, width, height;
+} TexAtlasRect;
+
+typedef struct TexAtlasEntry_s {
+	// The image's pixels (RGBA8, tightly packed) until the atlas is built
+	std::vector<unsigned char> pixels;
+	int width, height;
+	
+	// The padding on the top/left sides (the bottom/right sides get the same,
+	// plus whatever's needed to make the slot's size a multiple of alignment)
+	int padding;
+	int alignment;
+	int mipLevels;
+	
+	// The image and its padding's place in the page
+	TexAtlasRect slot;
+	TexAtlasRegion region;
+} TexAtlasEntry;
+
+typedef struct TexAtlasPage_s {
+	// The page's empty space, as maximal (possibly overlapping) rectangles
+	std::vector<TexAtlasRect> freeRects;
+	int mipLevels;
+	GLuint texture;
+} TexAtlasPage;
+
+struct TexAtlas_s {
+	int pageWidth, pageHeight;
+	bool built;
+	std::vector<TexAtlasEntry> entries;
+	std::vector<TexAtlasPage> pages;
+};
+
+/** Rounds value up to a multiple of alignment (a power of two).
+ */
+
+static int texAtlasAlignUp(int value, int alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static bool texAtlasIsPowerOfTwo(int value) {
+	return value > 0 && (value & (value - 1)) == 0;
+}
+
+/** Returns true if rectangle a contains rectangle b.
+ */
+
+static bool texAtlasRectContains(const TexAtlasRect *a, const TexAtlasRect *b) {
+	return b->x >= a->x && b->y >= a->y &&
+		b->x + b->width <= a->x + a->width && b->y + b->height <= a->y + a->height;
+}
+
+static bool texAtlasRectsOverlap(const TexAtlasRect *a, const TexAtlasRect *b) {
+	return a->x < b->x + b->width && b->x < a->x + a->width &&
+		a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+/** Finds the best place for a slot in a page (the free rectangle that it
+ * fits in with the shortest leftover side).
+ * 
+ * @param page the page
+ * @param width the slot's width
+ * @param height the slot's height
+ * @param alignment what the slot's position must be a multiple of
+ * @param slot where to write the slot's position and size to
+ * 
+ * @return bool true if found, false if it doesn't fit
+ */
+
+static bool texAtlasPageFind(const TexAtlasPage *page, int width, int height, int alignment, TexAtlasRect *slot) {
+	bool found = false;
+	int bestShortSide = 0;
+	int bestLongSide = 0;
+	for(const TexAtlasRect &freeRect : page->freeRects) {
+		int x = texAtlasAlignUp(freeRect.x, alignment);
+		int y = texAtlasAlignUp(freeRect.y, alignment);
+		int leftoverWidth = freeRect.x + freeRect.width - (x + width);
+		int leftoverHeight = freeRect.y + freeRect.height - (y + height);
+		if(leftoverWidth < 0 || leftoverHeight < 0) {
+			continue;
+		}
+		int shortSide = std::min(leftoverWidth, leftoverHeight);
+		int longSide = std::max(leftoverWidth, leftoverHeight);
+		if(!found || shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+			found = true;
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+			slot->x = x;
+			slot->y = y;
+			slot->width = width;
+			slot->height = height;
+		}
+	}
+	
+	return found;
+}
+
+/** Takes a slot out of a page's free space.
+ */
+
+static void texAtlasPagePlace(TexAtlasPage *page, const TexAtlasRect *slot) {
+	
+	// Replace every free rectangle that the slot overlaps with the (up to 4)
+	// maximal rectangles around the slot
+	std::vector<TexAtlasRect> freeRects;
+	freeRects.reserve(page->freeRects.size() + 4);
+	for(const TexAtlasRect &freeRect : page->freeRects) {
+		if(!texAtlasRectsOverlap(&freeRect, slot)) {
+			freeRects.push_back(freeRect);
+			continue;
+		}
+		int freeRight = freeRect.x + freeRect.width;
+		int freeBottom = freeRect.y + freeRect.height;
+		int slotRight = slot->x + slot->width;
+		int slotBottom = slot->y + slot->height;
+		if(slot->x > freeRect.x) {
+			TexAtlasRect left = {freeRect.x, freeRect.y, slot->x - freeRect.x, freeRect.height};
+			freeRects.push_back(left);
+		}
+		if(slotRight < freeRight) {
+			TexAtlasRect right = {slotRight, freeRect.y, freeRight - slotRight, freeRect.height};
+			freeRects.push_back(right);
+		}
+		if(slot->y > freeRect.y) {
+			TexAtlasRect top = {freeRect.x, freeRect.y, freeRect.width, slot->y - freeRect.y};
+			freeRects.push_back(top);
+		}
+		if(slotBottom < freeBottom) {
+			TexAtlasRect bottom = {freeRect.x, slotBottom, freeRect.width, freeBottom - slotBottom};
+			freeRects.push_back(bottom);
+		}
+	}
+	
+	// Drop the rectangles that are inside others
+	for(int i = 0; i < (int)freeRects.size(); ++i) {
+		for(int j = i + 1; j < (int)freeRects.size(); ++j) {
+			if(texAtlasRectContains(&freeRects[j], &freeRects[i])) {
+				freeRects.erase(freeRects.begin() + i);
+				--i;
+				break;
+			}
+			if(texAtlasRectContains(&freeRects[i], &freeRects[j])) {
+				freeRects.erase(freeRects.begin() + j);
+				--j;
+			}
+		}
+	}
+	page->freeRects.swap(freeRects);
+}
+
+/** Copies an image into its page, and fills its padding with its edge texels.
+ * 
+ * @param entry the image
+ * @param pagePixels the page's pixels (RGBA8)
+ * @param pagePitch the number of bytes per row of the page
+ */
+
+static void texAtlasEntryBlit(const TexAtlasEntry *entry, unsigned char *pagePixels, int pagePitch) {
+	const TexAtlasRect *slot = &entry->slot;
+	const TexAtlasRegion *region = &entry->region;
+	size_t rowSize = (size_t)entry->width * 4;
+	
+	// The image's rows, extended left and right
+	for(int y = 0; y < entry->height; ++y) {
+		unsigned char *row = pagePixels + (size_t)(region->y + y) * pagePitch;
+		const unsigned char *srcRow = &entry->pixels[y * rowSize];
+		memcpy(row + region->x * 4, srcRow, rowSize);
+		for(int x = slot->x; x < region->x; ++x) {
+			memcpy(row + x * 4, srcRow, 4);
+		}
+		for(int x = region->x + entry->width; x < slot->x + slot->width; ++x) {
+			memcpy(row + x * 4, srcRow + rowSize - 4, 4);
+		}
+	}
+	
+	// The first and last rows, extended up and down
+	size_t slotRowSize = (size_t)slot->width * 4;
+	const unsigned char *firstRow = pagePixels + (size_t)region->y * pagePitch + slot->x * 4;
+	const unsigned char *lastRow = firstRow + (size_t)(entry->height - 1) * pagePitch;
+	for(int y = slot->y; y < region->y; ++y) {
+		memcpy(pagePixels + (size_t)y * pagePitch + slot->x * 4, firstRow, slotRowSize);
+	}
+	for(int y = region->y + entry->height; y < slot->y + slot->height; ++y) {
+		memcpy(pagePixels + (size_t)y * pagePitch + slot->x * 4, lastRow, slotRowSize);
+	}
+}
+
+/** Creates a page's texture from its images.
+ * 
+ * @return GLuint the texture's name, or 0 if failed
+ */
+
+static GLuint texAtlasPageCreate(const TexAtlas *atlas, int pageIdx) {
+	int pagePitch = atlas->pageWidth * 4;
+	std::vector<unsigned char> pixels((size_t)pagePitch * atlas->pageHeight, 0);
+	for(const TexAtlasEntry &entry : atlas->entries) {
+		if(entry.region.page == pageIdx) {
+			texAtlasEntryBlit(&entry, &pixels[0], pagePitch);
+		}
+	}
+	
+	SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom(&pixels[0], atlas->pageWidth, atlas->pageHeight,
+		32, pagePitch, SDL_PIXELFORMAT_RGBA32);
+	if(!surface) {
+		SDL_Log("Couldn't create atlas page %d: %s\n", pageIdx, SDL_GetError());
+		return 0;
+	}
+	char name[32];
+	snprintf(name, sizeof(name), "atlas page %d", pageIdx);
+	
+	// Levels below the images' mipLevels would blend neighbouring images together, so they aren't built
+	GLuint texture = texCreateFromSurfaceLevels(surface, atlas->pages[pageIdx].mipLevels + 1, name);
+	SDL_FreeSurface(surface);
+	surface = NULL;
+	
+	return texture;
+}
+
+TexAtlas *texAtlasCreate(int pageWidth, int pageHeight) {
+	
+	if(!texAtlasIsPowerOfTwo(pageWidth) || !texAtlasIsPowerOfTwo(pageHeight)) {
+		SDL_Log("Atlas pages must be a power of two in size (got %dx%d)\n", pageWidth, pageHeight);
+		return NULL;
+	}
+	
+	TexAtlas *atlas = new TexAtlas_s;
+	atlas->pageWidth = pageWidth;
+	atlas->pageHeight = pageHeight;
+	atlas->built = false;
+	
+	return atlas;
+}
+
+void texAtlasDestroy(TexAtlas *atlas) {
+	
+	if(!atlas) {
+		return;
+	}
+	for(TexAtlasPage &page : atlas->pages) {
+		if(page.texture) {
+			texDestroy(page.texture);
+		}
+	}
+	delete atlas;
+}
+
+int texAtlasAdd(TexAtlas *atlas, const char *filename, const TexAtlasEntryOptions *options) {
+	
+	if(!texImageLoadersInit()) {
+		return -1;
+	}
+	SDL_Surface *surface = IMG_Load(filename);
+	if(!surface) {
+		SDL_Log("Loading image %s failed with error: %s", filename, IMG_GetError());
+		return -1;
+	}
+	int entryIdx = texAtlasAddSurface(atlas, surface, options, filename);
+	SDL_FreeSurface(surface);
+	surface = NULL;
+	
+	return entryIdx;
+}
+
+int texAtlasAddSurface(TexAtlas *atlas, SDL_Surface *surface, const TexAtlasEntryOptions *options,
+		const char *name) {
+	
+	if(atlas->built) {
+		SDL_Log("Can't add image %s to an atlas that's already built\n", name);
+		return -1;
+	}
+	TexAtlasEntryOptions defaultOptions = {1, 0};
+	if(!options) {
+		options = &defaultOptions;
+	}
+	if(options->padding < 0 || options->mipLevels < 0 || options->mipLevels > 15) {
+		SDL_Log("Invalid atlas options for image %s (padding %d, mipLevels %d)\n",
+			name, options->padding, options->mipLevels);
+		return -1;
+	}
+	
+	// Work out the slot's size, and check that it fits on a page
+	TexAtlasEntry entry;
+	entry.width = surface->w;
+	entry.height = surface->h;
+	entry.mipLevels = options->mipLevels;
+	entry.alignment = 1 << options->mipLevels;
+	int minPadding = options->mipLevels > 0 ? entry.alignment : 0;
+	entry.padding = texAtlasAlignUp(std::max(options->padding, minPadding), entry.alignment);
+	entry.slot.x = 0;
+	entry.slot.y = 0;
+	entry.slot.width = texAtlasAlignUp(entry.width + entry.padding * 2, entry.alignment);
+	entry.slot.height = texAtlasAlignUp(entry.height + entry.padding * 2, entry.alignment);
+	if(entry.slot.width > atlas->pageWidth || entry.slot.height > atlas->pageHeight) {
+		SDL_Log("Image %s (%dx%d, padded to %dx%d) doesn't fit on a %dx%d atlas page\n", name, entry.width,
+			entry.height, entry.slot.width, entry.slot.height, atlas->pageWidth, atlas->pageHeight);
+		return -1;
+	}
+	
+	// Keep a copy of the pixels as RGBA8 (formats without a byte per channel are converted by SDL first)
+	PixelLayout layout;
+	SDL_Surface *convertedSurf = NULL;
+	if(!pixelLayoutFromSDL(surface->format, &layout)) {
+		convertedSurf = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+		if(!convertedSurf || !pixelLayoutFromSDL(convertedSurf->format, &layout)) {
+			SDL_Log("Couldn't convert image %s to RGBA: %s\n", name, SDL_GetError());
+			SDL_FreeSurface(convertedSurf);
+			return -1;
+		}
+		surface = convertedSurf;
+	}
+	entry.pixels.resize((size_t)entry.width * entry.height * 4);
+	pixelRepack(surface->pixels, surface->pitch, &layout, &entry.pixels[0], entry.width * 4, 4,
+		entry.width, entry.height);
+	SDL_FreeSurface(convertedSurf);
+	convertedSurf = NULL;
+	
+	memset(&entry.region, 0, sizeof(entry.region));
+	atlas->entries.push_back(entry);
+	
+	return (int)atlas->entries.size() - 1;
+}
+
+bool texAtlasBuild(TexAtlas *atlas) {
+	
+	if(atlas->built) {
+		return true;
+	}
+	
+	// Pack the biggest slots first (they're the hardest to fit)
+	std::vector<int> order(atlas->entries.size());
+	for(size_t i = 0; i < order.size(); ++i) {
+		order[i] = (int)i;
+	}
+	const std::vector<TexAtlasEntry> &entries = atlas->entries;
+	std::stable_sort(order.begin(), order.end(), [&entries](int a, int b) {
+		const TexAtlasRect &slotA = entries[a].slot;
+		const TexAtlasRect &slotB = entries[b].slot;
+		int longSideA = std::max(slotA.width, slotA.height);
+		int longSideB = std::max(slotB.width, slotB.height);
+		if(longSideA != longSideB) {
+			return longSideA > longSideB;
+		}
+		return slotA.width * slotA.height > slotB.width * slotB.height;
+	});
+	
+	// Put each one on the first page with room for it, or a new page
+	for(int entryIdx : order) {
+		TexAtlasEntry &entry = atlas->entries[entryIdx];
+		int pageIdx = 0;
+		TexAtlasRect slot;
+		for(; pageIdx < (int)atlas->pages.size(); ++pageIdx) {
+			if(texAtlasPageFind(&atlas->pages[pageIdx], entry.slot.width, entry.slot.height,
+					entry.alignment, &slot)) {
+				break;
+			}
+		}
+		if(pageIdx == (int)atlas->pages.size()) {
+			TexAtlasPage page;
+			TexAtlasRect wholePage = {0, 0, atlas->pageWidth, atlas->pageHeight};
+			page.freeRects.push_back(wholePage);
+			page.mipLevels = 0;
+			page.texture = 0;
+			atlas->pages.push_back(page);
+			
+			// Every slot fits on an empty page (texAtlasAddSurface() checked)
+			texAtlasPageFind(&atlas->pages[pageIdx], entry.slot.width, entry.slot.height, entry.alignment, &slot);
+		}
+		TexAtlasPage &page = atlas->pages[pageIdx];
+		texAtlasPagePlace(&page, &slot);
+		page.mipLevels = std::max(page.mipLevels, entry.mipLevels);
+		
+		entry.slot = slot;
+		TexAtlasRegion &region = entry.region;
+		region.page = pageIdx;
+		region.x = slot.x + entry.padding;
+		region.y = slot.y + entry.padding;
+		region.width = entry.width;
+		region.height = entry.height;
+		region.uvScale[0] = (float)entry.width / (float)atlas->pageWidth;
+		region.uvScale[1] = (float)entry.height / (float)atlas->pageHeight;
+		region.uvOffset[0] = (float)region.x / (float)atlas->pageWidth;
+		region.uvOffset[1] = (float)region.y / (float)atlas->pageHeight;
+	}
+	
+	// Create the pages' textures
+	bool success = true;
+	for(int pageIdx = 0; pageIdx < (int)atlas->pages.size() && success; ++pageIdx) {
+		TexAtlasPage &page = atlas->pages[pageIdx];
+		page.texture = texAtlasPageCreate(atlas, pageIdx);
+		page.freeRects.clear();
+		success = page.texture != 0;
+	}
+	
+	// The pixels are in the textures now
+	for(TexAtlasEntry &entry : atlas->entries) {
+		std::vector<unsigned char>().swap(entry.pixels);
+	}
+	atlas->built = true;
+	
+	return success;
+}
+
+int texAtlasNumPages(const TexAtlas *atlas) {
+	return (int)atlas->pages.size();
+}
+
+GLuint texAtlasPageTexture(const TexAtlas *atlas, int page) {
+	if(page < 0 || page >= (int)atlas->pages.size()) {
+		return 0;
+	}
+	
+	return atlas->pages[page].texture;
+}
+
+const TexAtlasRegion *texAtlasRegionGet(const TexAtlas *atlas, int entry) {
+	if(!atlas->built || entry < 0 || entry >= (int)atlas->entries.size()) {
+		return NULL;
+	}
+	
+	return &atlas->entries[entry].region;
+}
+
+void texAtlasRemapTexCoords(const TexAtlasRegion *region, float *texCoords, size_t numVertices, size_t stride) {
+	unsigned char *vertex = (unsigned char*)texCoords;
+	for(size_t i = 0; i < numVertices; ++i) {
+		float *texCoord = (float*)(vertex + i * stride);
+		texCoord[0] = texCoord[0] * region->uvScale[0] + region->uvOffset[0];
+		texCoord[1] = texCoord[1] * region->uvScale[1] + region->uvOffset[1];
+	}
+}
@@ -0,0 +1,151 @@
+// textureatlas.h
+
+#ifndef __TEXTUREATLAS_H__
+#define __TEXTUREATLAS_H__
+
+#include <GLES3/gl3.h>
+#include <SDL.h>
+#include <cstddef>
+
+/** Packs many small images into a few large textures (pages), so that
+ * objects using different images can share one texture bind, and be drawn
+ * in one batch.
+ * 
+ * Images are packed with the MaxRects algorithm (best short side fit,
+ * biggest first), opening a new page whenever one fills up. Each image is
+ * given a UV transform, which maps the image's own [0,1] texture coordinates
+ * to where it ended up in its page (see texAtlasRemapTexCoords()).
+ * 
+ * Usage:
+ * - texAtlasCreate()
+ * - texAtlasAdd() or texAtlasAddSurface() for each image
+ * - texAtlasBuild() (once GL is up)
+ * - texAtlasRegionGet() for each image's page and UV transform
+ * - texAtlasDestroy() when done
+ */
+
+typedef struct TexAtlas_s TexAtlas;
+
+/** How an image is placed in the atlas.
+ */
+
+typedef struct TexAtlasEntryOptions_s {
+	// The number of texels around the image, filled by repeating its edge
+	// texels (so that bilinear filtering doesn't pick up the neighbours)
+	int padding;
+	
+	// The number of mip levels (below level 0) in which the image mustn't
+	// bleed into its neighbours. The image is placed on a 2^mipLevels texel
+	// grid, with at least 2^mipLevels texels of padding, so that down to
+	// that level, every texel is either the image's or its padding's. The
+	// page's mipmap chain stops at the largest mipLevels of its images (no
+	// mipmaps if they're all 0)
+	int mipLevels;
+} TexAtlasEntryOptions;
+
+/** Where an image ended up in the atlas.
+ */
+
+typedef struct TexAtlasRegion_s {
+	// The page that the image is in (see texAtlasPageTexture())
+	int page;
+	
+	// The image's rectangle in the page, in texels (excluding padding)
+	int x, y, width, height;
+	
+	// Maps the image's texture coordinates to the page's:
+	// pageCoord = texCoord * uvScale + uvOffset
+	// (e.g., as a vec4 uniform, or applied to the vertices beforehand)
+	float uvScale[2];
+	float uvOffset[2];
+} TexAtlasRegion;
+
+/** Creates an empty texture atlas.
+ * 
+ * @param pageWidth the width of each page in texels (a power of two, so
+ * that mipmaps line up with the mip level grid)
+ * @param pageHeight the height of each page in texels (also a power of two)
+ * 
+ * @return TexAtlas* the atlas, or NULL if failed
+ */
+
+TexAtlas *texAtlasCreate(int pageWidth, int pageHeight);
+
+/** Destroys a texture atlas, and its pages' textures.
+ */
+
+void texAtlasDestroy(TexAtlas *atlas);
+
+/** Adds an image file to the atlas.
+ * 
+ * @param atlas the texture atlas (not built yet)
+ * @param filename name of the image file to load
+ * @param options how to place it (NULL for 1 texel of padding, and no mipmaps)
+ * 
+ * @return int the image's index (for texAtlasRegionGet()), or -1 if failed
+ * (e.g., the image doesn't fit on a page)
+ */
+
+int texAtlasAdd(TexAtlas *atlas, const char *filename, const TexAtlasEntryOptions *options);
+
+/** Adds an image to the atlas from an SDL surface (a copy of its pixels is made).
+ * 
+ * @param atlas the texture atlas (not built yet)
+ * @param surface the image
+ * @param options how to place it (NULL for 1 texel of padding, and no mipmaps)
+ * @param name the image's name (for error messages)
+ * 
+ * @return int the image's index (for texAtlasRegionGet()), or -1 if failed
+ */
+
+int texAtlasAddSurface(TexAtlas *atlas, SDL_Surface *surface, const TexAtlasEntryOptions *options,
+	const char *name);
+
+/** Packs the images into pages, and creates the pages' textures (RGBA8,
+ * with CPU-built mipmaps; see mipmapChainBuild()).
+ * 
+ * The images' pixels are freed afterwards, so nothing can be added to a
+ * built atlas.
+ * 
+ * @param atlas the texture atlas
+ * 
+ * @return bool true if successful
+ */
+
+bool texAtlasBuild(TexAtlas *atlas);
+
+/** Gets the number of pages (0 until texAtlasBuild()).
+ */
+
+int texAtlasNumPages(const TexAtlas *atlas);
+
+/** Gets a page's texture.
+ * 
+ * @return GLuint the texture's name, or 0 if there's no such page
+ */
+
+GLuint texAtlasPageTexture(const TexAtlas *atlas, int page);
+
+/** Gets where an image ended up (valid after texAtlasBuild()).
+ * 
+ * @param atlas the texture atlas
+ * @param entry the image's index (from texAtlasAdd() or texAtlasAddSurface())
+ * 
+ * @return const TexAtlasRegion* the image's region, or NULL if there's no such image
+ */
+
+const TexAtlasRegion *texAtlasRegionGet(const TexAtlas *atlas, int entry);
+
+/** Applies an image's UV transform to vertex texture coordinates, so that
+ * geometry textured with the image can be drawn with its atlas page instead.
+ * 
+ * @param region the image's region
+ * @param texCoords the first vertex's texture coordinates (u, v)
+ * @param numVertices the number of vertices
+ * @param stride the number of bytes from one vertex's texture coordinates
+ * to the next (e.g., sizeof(Vertex))
+ */
+
+void texAtlasRemapTexCoords(const TexAtlasRegion *region, float *texCoords, size_t numVertices, size_t stride);
+
+#endif
@@ -0,0 +1,104 @@
+// texturecache.cpp
+//
+// See header file for details
+
+#include "texturecache.h"
+#include "cachefile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <SDL.h>
+
+// Bump this whenever the encoders' output changes, so that old files aren't used
+static const Uint32 texCacheVersion = 1;
+
+static const char texCacheExt[] = ".ktx";
+
+static bool cacheEnabled = false;
+static char *cacheDir = NULL;
+
+bool texCacheInit(const char *dir) {
+	texCacheShutdown();
+	
+	cacheDir = strdup(dir);
+	if(!cacheDir) {
+		SDL_Log("Texture cache disabled; out of memory\n");
+		return false;
+	}
+	
+	cacheEnabled = true;
+	return true;
+}
+
+void texCacheShutdown() {
+	cacheEnabled = false;
+	free(cacheDir);
+	cacheDir = NULL;
+}
+
+bool texCacheEnabled() {
+	return cacheEnabled;
+}
+
+uint64_t texCacheKey(const void *fileData, size_t length, const char *options) {
+	uint64_t hash = cacheHashBytes(CACHE_HASH_INIT, &texCacheVersion, sizeof(texCacheVersion));
+	uint64_t length64 = length;
+	hash = cacheHashBytes(hash, &length64, sizeof(length64));
+	hash = cacheHashBytes(hash, fileData, length);
+	hash = cacheHashBytes(hash, options, strlen(options) + 1);
+	
+	return hash;
+}
+
+bool texCacheLoad(uint64_t key, FileMap *cacheMap, KtxImage *image) {
+	if(!cacheEnabled) {
+		return false;
+	}
+	
+	char *path = cacheFilePath(cacheDir, key, texCacheExt);
+	if(!path) {
+		return false;
+	}
+	
+	// Not cached yet?
+	FILE *file = fopen(path, "rb");
+	if(!file) {
+		free(path);
+		return false;
+	}
+	fclose(file);
+	
+	bool success = fileMap(path, cacheMap);
+	if(success && !ktxParse(cacheMap->data, cacheMap->length, image)) {
+		// Invalidate, so it'll be rebuilt and stored again
+		SDL_Log("Discarding corrupt cached texture %s\n", path);
+		fileUnmap(cacheMap);
+		remove(path);
+		success = false;
+	}
+	
+	free(path);
+	return success;
+}
+
+bool texCacheStore(uint64_t key, const KtxImage *image) {
+	if(!cacheEnabled) {
+		return false;
+	}
+	
+	char *path = cacheFilePath(cacheDir, key, texCacheExt);
+	bool success = path && ktxWrite(path, image);
+	if(!success) {
+		SDL_Log("Couldn't write texture to the cache (%s)\n", cacheDir);
+	}
+	
+	free(path);
+	return success;
+}
+
+void texCacheClear() {
+	if(cacheDir) {
+		cacheDirClear(cacheDir, texCacheExt);
+	}
+}
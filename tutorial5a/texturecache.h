@@ -0,0 +1,79 @@
+// texturecache.h
+
+#ifndef __TEXTURECACHE_H__
+#define __TEXTURECACHE_H__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "filemap.h"
+#include "ktx.h"
+
+/** Enables the on-disk cache of encoded (e.g., ETC2 compressed) textures.
+ * 
+ * Once enabled, texLoadCompressed() looks for a previously encoded copy of
+ * the image before decoding and encoding it, and stores newly encoded
+ * textures (as KTX files) for the next launch.
+ * 
+ * @param cacheDir the directory to store the textures in, including the
+ * trailing path separator (e.g., from SDL_GetPrefPath()). The directory must
+ * exist
+ * 
+ * @return bool true if the cache is active
+ */
+
+bool texCacheInit(const char *cacheDir);
+
+/** Disables the texture cache.
+ * Cached textures stay on disk.
+ */
+
+void texCacheShutdown();
+
+/** Returns true if the texture cache is active.
+ */
+
+bool texCacheEnabled();
+
+/** Calculates a texture's cache key.
+ * 
+ * The key is a hash of the source image file's contents and the encoding
+ * options, so editing the image (or changing how it's encoded) automatically
+ * results in a cache miss.
+ * 
+ * @param fileData the source image file's contents
+ * @param length the file's length in bytes
+ * @param options the encoder and its settings (e.g., "etc2")
+ * 
+ * @return uint64_t the cache key
+ */
+
+uint64_t texCacheKey(const void *fileData, size_t length, const char *options);
+
+/** Maps a cached texture.
+ * 
+ * @param key the texture's cache key
+ * @param cacheMap the mapping to set up (call fileUnmap() when done with image)
+ * @param image where to write the texture's details (pointing into cacheMap)
+ * 
+ * @return bool true if successful, false if it isn't in the cache
+ */
+
+bool texCacheLoad(uint64_t key, FileMap *cacheMap, KtxImage *image);
+
+/** Writes an encoded texture to the cache.
+ * 
+ * @param key the texture's cache key
+ * @param image the texture
+ * 
+ * @return bool true if successful
+ */
+
+bool texCacheStore(uint64_t key, const KtxImage *image);
+
+/** Removes all cached textures from the cache directory.
+ */
+
+void texCacheClear();
+
+#endif
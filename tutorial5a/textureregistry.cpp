@@ -0,0 +1,189 @@
+// textureregistry.cpp
+//
+// See header file for details
+
+#include "textureregistry.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <SDL.h>
+
+typedef struct TexRegistryEntry_s {
+	GLuint texture;
+	unsigned int refCount;
+} TexRegistryEntry;
+
+// The textures, by key, and each texture's key (for releasing by name)
+static std::unordered_map<std::string, TexRegistryEntry> registryEntries;
+static std::unordered_map<GLuint, std::string> registryKeys;
+
+static unsigned int registryHits = 0;
+static unsigned int registryMisses = 0;
+static unsigned int registryRefs = 0;
+
+/** Gets a file's canonical (absolute, with no "." or ".." parts or symlinks) path.
+ * 
+ * @return std::string the path, or filename as is if it can't be resolved
+ * (e.g., it doesn't exist)
+ */
+
+static std::string texRegistryCanonicalPath(const char *filename) {
+#ifdef _WIN32
+	char *path = _fullpath(NULL, filename, 0);
+#else
+	char *path = realpath(filename, NULL);
+#endif
+	if(!path) {
+		return filename;
+	}
+	std::string canonical(path);
+	free(path);
+	
+	return canonical;
+}
+
+/** Builds a texture's registry key.
+ * Only the options that texRegistryLoad() uses for the file are included, so
+ * that loads that would give the same texture share it.
+ */
+
+static std::string texRegistryKey(const char *filename, const TexLoadOptions *options) {
+	std::string key = texRegistryCanonicalPath(filename);
+	if(texHasExtension(filename, ".ktx")) {
+		return key;
+	}
+	if(options->compress) {
+		return key + "|etc2";
+	}
+	char optionStr[16];
+	snprintf(optionStr, sizeof(optionStr), "|mip%d", (int)options->mipmapMode);
+	
+	return key + optionStr;
+}
+
+/** Loads a texture with the given options.
+ */
+
+static GLuint texRegistryLoad(const char *filename, const TexLoadOptions *options) {
+	if(texHasExtension(filename, ".ktx")) {
+		return texLoadKtx(filename);
+	}
+	if(options->compress) {
+		return texLoadCompressed(filename);
+	}
+	
+	return texLoadMipmapped(filename, options->mipmapMode);
+}
+
+GLuint texRegistryAcquire(const char *filename, const TexLoadOptions *options) {
+	
+	// texLoad()'s defaults
+	TexLoadOptions defaultOptions = {TEX_MIPMAP_CPU, false};
+	if(!options) {
+		options = &defaultOptions;
+	}
+	
+	std::string key = texRegistryKey(filename, options);
+	auto found = registryEntries.find(key);
+	if(found != registryEntries.end()) {
+		++found->second.refCount;
+		++registryRefs;
+		++registryHits;
+		return found->second.texture;
+	}
+	
+	++registryMisses;
+	GLuint texture = texRegistryLoad(filename, options);
+	if(!texture) {
+		return 0;
+	}
+	TexRegistryEntry entry = {texture, 1};
+	registryEntries[key] = entry;
+	registryKeys[texture] = key;
+	++registryRefs;
+	
+	return texture;
+}
+
+/** Finds a texture's registry entry.
+ * 
+ * @return TexRegistryEntry* the entry, or NULL if it isn't in the registry
+ */
+
+static TexRegistryEntry *texRegistryFind(GLuint texture) {
+	auto key = registryKeys.find(texture);
+	if(key == registryKeys.end()) {
+		return NULL;
+	}
+	
+	return &registryEntries[key->second];
+}
+
+void texRegistryAddRef(GLuint texture) {
+	
+	TexRegistryEntry *entry = texRegistryFind(texture);
+	if(!entry) {
+		SDL_Log("Texture %u isn't in the texture registry\n", texture);
+		return;
+	}
+	++entry->refCount;
+	++registryRefs;
+}
+
+void texRegistryRelease(GLuint texture) {
+	
+	TexRegistryEntry *entry = texRegistryFind(texture);
+	if(!entry || entry->refCount == 0) {
+		SDL_Log("Released texture %u isn't referenced in the texture registry\n", texture);
+		return;
+	}
+	--entry->refCount;
+	--registryRefs;
+}
+
+unsigned int texRegistryPurge() {
+	
+	unsigned int numPurged = 0;
+	for(auto entry = registryEntries.begin(); entry != registryEntries.end();) {
+		if(entry->second.refCount > 0) {
+			++entry;
+			continue;
+		}
+		texDestroy(entry->second.texture);
+		registryKeys.erase(entry->second.texture);
+		entry = registryEntries.erase(entry);
+		++numPurged;
+	}
+	
+	return numPurged;
+}
+
+void texRegistryShutdown() {
+	
+	for(auto &entry : registryEntries) {
+		texDestroy(entry.second.texture);
+	}
+	registryEntries.clear();
+	registryKeys.clear();
+	registryRefs = 0;
+	texRegistryStatsReset();
+}
+
+TexRegistryStats texRegistryStatsGet() {
+	
+	TexRegistryStats stats;
+	stats.hits = registryHits;
+	stats.misses = registryMisses;
+	stats.numTextures = (unsigned int)registryEntries.size();
+	stats.numRefs = registryRefs;
+	
+	return stats;
+}
+
+void texRegistryStatsReset() {
+	
+	registryHits = 0;
+	registryMisses = 0;
+}
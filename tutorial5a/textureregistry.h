@@ -0,0 +1,94 @@
+// textureregistry.h
+
+#ifndef __TEXTUREREGISTRY_H__
+#define __TEXTUREREGISTRY_H__
+
+#include <GLES3/gl3.h>
+
+#include "texture.h"
+
+/** How a texture in the registry is loaded (part of its key, so the same
+ * file loaded two different ways is two textures). Options that don't change
+ * the result (mipmapMode when compressing, and both for ".ktx" files) are
+ * left out of the key.
+ */
+
+typedef struct TexLoadOptions_s {
+	// How the mipmap chain is built (uncompressed images only)
+	TexMipmapMode mipmapMode;
+	
+	// ETC2 compress the image (see texLoadCompressed())
+	bool compress;
+} TexLoadOptions;
+
+/** Counts of registry lookups, and what's resident.
+ */
+
+typedef struct TexRegistryStats_s {
+	// texRegistryAcquire() calls that found the texture already loaded
+	unsigned int hits;
+	
+	// texRegistryAcquire() calls that had to load it
+	unsigned int misses;
+	
+	// Textures in the registry (including unreferenced ones not purged yet)
+	unsigned int numTextures;
+	
+	// References held across all textures
+	unsigned int numRefs;
+} TexRegistryStats;
+
+/** Gets a texture, loading it only if it isn't in the registry already.
+ * 
+ * Textures are keyed by the file's canonical path (so "./a.png" and
+ * "a.png" are the same texture) and the load options, and shared by
+ * everyone who acquires them. Each successful call adds a reference.
+ * ".ktx" files are loaded with texLoadKtx() (the options don't matter).
+ * 
+ * @param filename the image or KTX file
+ * @param options how to load it (NULL for texLoad()'s defaults)
+ * 
+ * @return GLuint the texture's name, or 0 if failed (nothing's added)
+ */
+
+GLuint texRegistryAcquire(const char *filename, const TexLoadOptions *options);
+
+/** Adds a reference to a texture from the registry (e.g., when handing it
+ * to another object).
+ */
+
+void texRegistryAddRef(GLuint texture);
+
+/** Drops a reference to a texture from the registry.
+ * 
+ * Textures with no references stay resident (so acquiring them again is
+ * cheap) until texRegistryPurge().
+ */
+
+void texRegistryRelease(GLuint texture);
+
+/** Deletes all textures that have no references.
+ * 
+ * @return unsigned int the number of textures deleted
+ */
+
+unsigned int texRegistryPurge();
+
+/** Deletes all textures in the registry, referenced or not, and resets the
+ * statistics.
+ */
+
+void texRegistryShutdown();
+
+/** Gets the registry's statistics (hits and misses since the last
+ * texRegistryStatsReset()).
+ */
+
+TexRegistryStats texRegistryStatsGet();
+
+/** Resets the hit and miss counts.
+ */
+
+void texRegistryStatsReset();
+
+#endif
@@ -0,0 +1,355 @@
+// textureresidency.cpp
+//
+// See header file for details
+
+#include "textureresidency.h"
+#include "texture.h"
+
+#include <SDL.h>
+#include <list>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+struct TexResident_s {
+	std::string filename;
+	bool compress;
+	
+	// 0 while evicted
+	GLuint texture;
+	TexInfo info;
+	size_t footprint;
+	
+	// The number of mipmap levels dropped (0 at full size)
+	int skipLevels;
+	
+	// The footprint at full size (0 until it's been loaded at full size once)
+	size_t fullFootprint;
+	
+	// Used while reduced, so texResidencyUpdate() should restore it
+	bool wanted;
+	
+	// The texture's place in the LRU list (only while it's resident)
+	std::list<TexResident*>::iterator lruPos;
+};
+
+struct TexResidency_s {
+	size_t budgetBytes;
+	TexEvictMode evictMode;
+	int minSize;
+	
+	std::unordered_set<TexResident*> textures;
+	
+	// The resident textures, most recently used first
+	std::list<TexResident*> lru;
+	
+	size_t residentBytes;
+	size_t peakBytes;
+	unsigned int evictions;
+	unsigned int mipDrops;
+	unsigned int reloads;
+	double reloadStallMs;
+	unsigned int restores;
+	double restoreMs;
+};
+
+/** Deletes a texture (it stays in the manager, to be reloaded on next use).
+ */
+
+static void texResidentUnload(TexResidency *residency, TexResident *resident) {
+	if(!resident->texture) {
+		return;
+	}
+	texDestroy(resident->texture);
+	resident->texture = 0;
+	residency->residentBytes -= resident->footprint;
+	resident->footprint = 0;
+	resident->skipLevels = 0;
+	resident->wanted = false;
+	residency->lru.erase(resident->lruPos);
+}
+
+/** Loads (or reloads) a texture, replacing the one that's resident.
+ * The old texture is deleted first, so the two are never resident at once
+ * (the caller makes room for the difference).
+ * 
+ * @param skipLevels the number of mipmap levels to leave out
+ * 
+ * @return bool true if successful (the texture is left unloaded if not)
+ */
+
+static bool texResidentLoad(TexResidency *residency, TexResident *resident, int skipLevels) {
+	bool wasResident = resident->texture != 0;
+	if(wasResident) {
+		texDestroy(resident->texture);
+		resident->texture = 0;
+		residency->residentBytes -= resident->footprint;
+		resident->footprint = 0;
+	}
+	
+	GLuint texture = texLoadReduced(resident->filename.c_str(), resident->compress, skipLevels);
+	if(!texture) {
+		if(wasResident) {
+			resident->skipLevels = 0;
+			resident->wanted = false;
+			residency->lru.erase(resident->lruPos);
+		}
+		return false;
+	}
+	TexInfo info = {GL_NONE, 0, 0, 0};
+	texInfoGet(texture, &info);
+	
+	resident->texture = texture;
+	resident->info = info;
+	resident->footprint = texInfoFootprint(&info);
+	resident->skipLevels = skipLevels;
+	if(skipLevels == 0) {
+		resident->fullFootprint = resident->footprint;
+		resident->wanted = false;
+	}
+	residency->residentBytes += resident->footprint;
+	if(residency->residentBytes > residency->peakBytes) {
+		residency->peakBytes = residency->residentBytes;
+	}
+	if(!wasResident) {
+		residency->lru.push_front(resident);
+		resident->lruPos = residency->lru.begin();
+	}
+	
+	return true;
+}
+
+/** Works out how many more mipmap levels to drop from a texture to free
+ * excessBytes (each level dropped quarters its footprint), without going
+ * below the minimum size.
+ * 
+ * @return int the number of levels (0 if it's already as small as it can be)
+ */
+
+static int texResidentDropLevels(const TexResidency *residency, const TexResident *resident, size_t excessBytes) {
+	int levels = 0;
+	TexInfo info = resident->info;
+	size_t footprint = resident->footprint;
+	while(info.numLevels > 1 && info.width / 2 >= residency->minSize && info.height / 2 >= residency->minSize &&
+			resident->footprint - footprint < excessBytes) {
+		info.width /= 2;
+		info.height /= 2;
+		--info.numLevels;
+		footprint = texInfoFootprint(&info);
+		++levels;
+	}
+	
+	return levels;
+}
+
+/** Evicts the least recently used textures until the resident ones (plus
+ * extraBytes that are about to be loaded) are within the budget.
+ * 
+ * With TEX_EVICT_DROP_MIPS, textures are reduced first (oldest first, each
+ * by as many levels as needed), and only deleted if reducing all of them
+ * isn't enough.
+ * 
+ * @param keep a texture that mustn't be evicted (it's being used; may be NULL)
+ * @param extraBytes the bytes about to be loaded
+ */
+
+static void texResidencyEnforce(TexResidency *residency, const TexResident *keep, size_t extraBytes) {
+	int firstPass = residency->evictMode == TEX_EVICT_DROP_MIPS ? 0 : 1;
+	for(int pass = firstPass; pass < 2; ++pass) {
+		
+		// Evicting changes the list, so go through a copy of it (least recently used first)
+		std::vector<TexResident*> victims(residency->lru.rbegin(), residency->lru.rend());
+		for(TexResident *victim : victims) {
+			if(residency->residentBytes + extraBytes <= residency->budgetBytes) {
+				return;
+			}
+			if(victim == keep) {
+				continue;
+			}
+			if(pass == 0) {
+				size_t excessBytes = residency->residentBytes + extraBytes - residency->budgetBytes;
+				int levels = texResidentDropLevels(residency, victim, excessBytes);
+				if(levels > 0) {
+					
+					// If the reduced copy can't be loaded, the texture's been evicted anyway
+					if(texResidentLoad(residency, victim, victim->skipLevels + levels)) {
+						++residency->mipDrops;
+					}
+					else {
+						++residency->evictions;
+					}
+				}
+				continue;
+			}
+			texResidentUnload(residency, victim);
+			++residency->evictions;
+		}
+	}
+}
+
+TexResidency *texResidencyCreate(size_t budgetBytes, TexEvictMode evictMode, int minSize) {
+	
+	TexResidency *residency = new TexResidency_s;
+	residency->budgetBytes = budgetBytes;
+	residency->evictMode = evictMode;
+	residency->minSize = minSize > 1 ? minSize : 1;
+	residency->residentBytes = 0;
+	texResidencyStatsReset(residency);
+	
+	return residency;
+}
+
+void texResidencyDestroy(TexResidency *residency) {
+	
+	if(!residency) {
+		return;
+	}
+	for(TexResident *resident : residency->textures) {
+		if(resident->texture) {
+			texDestroy(resident->texture);
+		}
+		delete resident;
+	}
+	delete residency;
+}
+
+void texResidencySetBudget(TexResidency *residency, size_t budgetBytes) {
+	
+	residency->budgetBytes = budgetBytes;
+	texResidencyEnforce(residency, NULL, 0);
+}
+
+TexResident *texResidencyAdd(TexResidency *residency, const char *filename, bool compress) {
+	
+	TexResident *resident = new TexResident_s;
+	resident->filename = filename;
+	resident->compress = compress;
+	resident->texture = 0;
+	resident->footprint = 0;
+	resident->skipLevels = 0;
+	resident->fullFootprint = 0;
+	resident->wanted = false;
+	
+	// Make room for it before it's loaded, so the budget isn't exceeded even briefly
+	TexInfo info;
+	if(!texFileInfoGet(filename, compress, &info)) {
+		delete resident;
+		return NULL;
+	}
+	texResidencyEnforce(residency, NULL, texInfoFootprint(&info));
+	if(!texResidentLoad(residency, resident, 0)) {
+		delete resident;
+		return NULL;
+	}
+	residency->textures.insert(resident);
+	
+	return resident;
+}
+
+void texResidencyRemove(TexResidency *residency, TexResident *resident) {
+	
+	if(!resident) {
+		return;
+	}
+	texResidentUnload(residency, resident);
+	residency->textures.erase(resident);
+	delete resident;
+}
+
+/** Reloads a texture at full size, making room for it first (the full size
+ * is known from when it was added, so the budget isn't exceeded even briefly).
+ * 
+ * @return bool true if successful
+ */
+
+static bool texResidentRestore(TexResidency *residency, TexResident *resident) {
+	size_t extraBytes = resident->fullFootprint > resident->footprint ?
+		resident->fullFootprint - resident->footprint : 0;
+	texResidencyEnforce(residency, resident, extraBytes);
+	if(!texResidentLoad(residency, resident, 0)) {
+		SDL_Log("Couldn't reload texture %s\n", resident->filename.c_str());
+		return false;
+	}
+	
+	return true;
+}
+
+GLuint texResidencyUse(TexResidency *residency, TexResident *resident) {
+	
+	// Reduced textures are drawn with as they are, until texResidencyUpdate() restores them
+	if(resident->texture) {
+		residency->lru.splice(residency->lru.begin(), residency->lru, resident->lruPos);
+		resident->wanted = resident->skipLevels > 0;
+		return resident->texture;
+	}
+	
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	if(texResidentRestore(residency, resident)) {
+		residency->lru.splice(residency->lru.begin(), residency->lru, resident->lruPos);
+	}
+	++residency->reloads;
+	residency->reloadStallMs += (SDL_GetPerformanceCounter() - startTime) * 1000.0 /
+		(double)SDL_GetPerformanceFrequency();
+	
+	return resident->texture;
+}
+
+unsigned int texResidencyUpdate(TexResidency *residency, unsigned int maxRestores) {
+	
+	// Most recently used first (restoring one doesn't move it in the list)
+	std::vector<TexResident*> wanted;
+	for(TexResident *resident : residency->lru) {
+		if(resident->wanted && wanted.size() < maxRestores) {
+			wanted.push_back(resident);
+		}
+	}
+	
+	unsigned int numRestored = 0;
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	for(TexResident *resident : wanted) {
+		
+		// It may have been evicted to make room for another one
+		if(resident->texture && resident->skipLevels > 0 && texResidentRestore(residency, resident)) {
+			++numRestored;
+		}
+		resident->wanted = false;
+	}
+	residency->restores += numRestored;
+	residency->restoreMs += (SDL_GetPerformanceCounter() - startTime) * 1000.0 /
+		(double)SDL_GetPerformanceFrequency();
+	
+	return numRestored;
+}
+
+TexResidencyStats texResidencyStatsGet(const TexResidency *residency) {
+	
+	TexResidencyStats stats;
+	stats.residentBytes = residency->residentBytes;
+	stats.peakBytes = residency->peakBytes;
+	stats.budgetBytes = residency->budgetBytes;
+	stats.numTextures = (unsigned int)residency->textures.size();
+	stats.numResident = (unsigned int)residency->lru.size();
+	stats.numReduced = 0;
+	for(const TexResident *resident : residency->lru) {
+		stats.numReduced += resident->skipLevels > 0;
+	}
+	stats.evictions = residency->evictions;
+	stats.mipDrops = residency->mipDrops;
+	stats.reloads = residency->reloads;
+	stats.reloadStallMs = residency->reloadStallMs;
+	stats.restores = residency->restores;
+	stats.restoreMs = residency->restoreMs;
+	
+	return stats;
+}
+
+void texResidencyStatsReset(TexResidency *residency) {
+	
+	residency->peakBytes = residency->residentBytes;
+	residency->evictions = 0;
+	residency->mipDrops = 0;
+	residency->reloads = 0;
+	residency->reloadStallMs = 0.0;
+	residency->restores = 0;
+	residency->restoreMs = 0.0;
+}
@@ -0,0 +1,164 @@
+// textureresidency.h
+
+#ifndef __TEXTURERESIDENCY_H__
+#define __TEXTURERESIDENCY_H__
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+/** Keeps the textures in GPU memory within a budget.
+ * 
+ * Each texture's footprint is estimated from its format, size and number of
+ * mipmap levels (see texInfoFootprint()). When the resident textures go over
+ * the budget, the least recently used ones are evicted (deleted, or reloaded
+ * without their largest mipmap levels first; see TexEvictMode). Deleted
+ * textures are reloaded at full size the next time they're used, and reduced
+ * ones are restored by texResidencyUpdate(), so callers only ever deal with
+ * TexResident handles and texResidencyUse().
+ * 
+ * Usage:
+ * - texResidencyCreate() once GL is up
+ * - texResidencyAdd() for each texture
+ * - texResidencyUse() every time a texture is drawn with (bind what it returns)
+ * - texResidencyUpdate() once per frame
+ * - texResidencyRemove() when done with a texture
+ * 
+ * NOTE: Textures are reloaded (and reduced) from file, so reloading a
+ * deleted texture is a stall on the render thread (see TexResidencyStats).
+ * ETC2 compressed textures reload fastest, as they come straight from the
+ * texture cache (see texCacheInit()).
+ */
+
+typedef struct TexResidency_s TexResidency;
+
+/** A texture managed by a TexResidency.
+ */
+
+typedef struct TexResident_s TexResident;
+
+/** What happens to a texture that's evicted.
+ */
+
+typedef enum TexEvictMode_e {
+	// It's deleted
+	TEX_EVICT_UNLOAD,
+	
+	// It's reloaded without its largest mipmap levels (each level dropped
+	// quarters the memory), as many as are needed, down to the smallest size
+	// (see texResidencyCreate()). Textures are only deleted once they're all
+	// that small. So textures that haven't been used for a while get blurrier
+	// instead of disappearing, and are drawn with straight away when they're
+	// needed again (until texResidencyUpdate() restores them)
+	TEX_EVICT_DROP_MIPS
+} TexEvictMode;
+
+/** What's resident, and how much evicting and reloading has been done.
+ */
+
+typedef struct TexResidencyStats_s {
+	// The estimated GPU memory used by the resident textures
+	size_t residentBytes;
+	
+	// The most that residentBytes has been (since the last texResidencyStatsReset())
+	size_t peakBytes;
+	
+	// The budget
+	size_t budgetBytes;
+	
+	// Textures managed, and how many of them are resident (at full size, or reduced)
+	unsigned int numTextures;
+	unsigned int numResident;
+	unsigned int numReduced;
+	
+	// Textures deleted to get within the budget
+	unsigned int evictions;
+	
+	// Times a texture was reloaded without its largest mipmap levels
+	unsigned int mipDrops;
+	
+	// texResidencyUse() calls that had to reload a deleted texture before
+	// it could be drawn with, and the total time spent doing so in milliseconds
+	unsigned int reloads;
+	double reloadStallMs;
+	
+	// Reduced textures restored to full size by texResidencyUpdate(), and
+	// the total time spent doing so in milliseconds
+	unsigned int restores;
+	double restoreMs;
+} TexResidencyStats;
+
+/** Creates a texture residency manager.
+ * 
+ * @param budgetBytes the most GPU memory the textures should use
+ * @param evictMode what to do with textures that are evicted
+ * @param minSize TEX_EVICT_DROP_MIPS only: the size (width or height, in
+ * texels) below which a texture is deleted instead of reduced further
+ * 
+ * @return TexResidency* the manager
+ */
+
+TexResidency *texResidencyCreate(size_t budgetBytes, TexEvictMode evictMode, int minSize);
+
+/** Destroys a texture residency manager, and all of its textures.
+ */
+
+void texResidencyDestroy(TexResidency *residency);
+
+/** Changes the budget, evicting textures straight away if it's now exceeded.
+ */
+
+void texResidencySetBudget(TexResidency *residency, size_t budgetBytes);
+
+/** Adds a texture, and loads it (evicting others first if it won't fit in the budget).
+ * 
+ * @param residency the texture residency manager
+ * @param filename the image or KTX file
+ * @param compress ETC2 compress the image (see texLoadCompressed())
+ * 
+ * @return TexResident* the texture, or NULL if it couldn't be loaded
+ */
+
+TexResident *texResidencyAdd(TexResidency *residency, const char *filename, bool compress);
+
+/** Removes a texture (and deletes it).
+ */
+
+void texResidencyRemove(TexResidency *residency, TexResident *resident);
+
+/** Gets the texture to bind for a TexResident, and marks it as the most
+ * recently used.
+ * 
+ * If the texture was deleted, it's reloaded at full size first (evicting
+ * others if needed). If it was reduced, it's returned as it is, and
+ * texResidencyUpdate() restores it later.
+ * 
+ * @param residency the texture residency manager
+ * @param resident the texture
+ * 
+ * @return GLuint the texture's name (0 if it was evicted, and couldn't be reloaded)
+ */
+
+GLuint texResidencyUse(TexResidency *residency, TexResident *resident);
+
+/** Restores reduced textures that have been used since they were reduced to
+ * full size, most recently used first. Call this once per frame.
+ * 
+ * @param residency the texture residency manager
+ * @param maxRestores the most textures to restore (each one is a reload)
+ * 
+ * @return unsigned int the number of textures restored
+ */
+
+unsigned int texResidencyUpdate(TexResidency *residency, unsigned int maxRestores);
+
+/** Gets the manager's statistics.
+ */
+
+TexResidencyStats texResidencyStatsGet(const TexResidency *residency);
+
+/** Resets the eviction and reload counts, and the peak.
+ */
+
+void texResidencyStatsReset(TexResidency *residency);
+
+#endif
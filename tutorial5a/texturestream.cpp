@@ -0,0 +1,538 @@
+// texturestream.cpp
+//
+// See header file for details
+
+#include "texturestream.h"
+#include "filemap.h"
+#include "ktx.h"
+#include "mipmap.h"
+#include "texture.h"
+#include "workerpool.h"
+
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <SDL.h>
+#include <SDL_image.h>
+#include <SDL_opengles2.h>
+
+struct TexStream_s {
+	std::string filename;
+	
+	// Set by the render thread
+	TexStreamStatus status;
+	GLuint texture;
+	
+	// Set by texStreamRelease() while loading, so the workers can skip it
+	SDL_atomic_t cancelled;
+	
+	// The decoded levels (written by a worker; pointing into ktxMap or pixels)
+	bool decoded;
+	KtxImage image;
+	FileMap ktxMap;
+	bool mapped;
+	std::vector<unsigned char> pixels;
+	
+	// Upload progress (the real texture, and the next row to upload)
+	GLuint uploadTexture;
+	int level;
+	int row;
+};
+
+struct TexStreamer_s {
+	
+	// Decodes the streams (see texStreamDecodeJob())
+	WorkerPool *workers;
+	
+	// Render thread only
+	std::unordered_set<TexStream*> streams;
+	std::deque<TexStream*> uploadQueue;
+	size_t numPending;
+	GLuint placeholder;
+	
+	// The pixel unpack buffer ring, with a fence for each buffer's last upload
+	std::vector<GLuint> pbos;
+	std::vector<GLsync> fences;
+	size_t pboSize;
+	size_t nextPbo;
+	
+	// The per-frame upload budget (0 = no limit)
+	size_t maxBytes;
+	double maxMs;
+};
+
+/** The result of uploading part of a texture.
+ */
+
+typedef enum TexUploadResult_e {
+	TEX_UPLOAD_PROGRESS,
+	TEX_UPLOAD_DONE,
+	TEX_UPLOAD_BUSY, // All buffers are still in use by the GPU
+	TEX_UPLOAD_FAILED
+} TexUploadResult;
+
+/** Appends a mipmap level built by mipmapChainBuild() to the decoded levels.
+ */
+
+static bool texStreamLevelStore(int level, int width, int height, const void *pixels, int pitch, void *userData) {
+	(void)width; // RGBA rows are already 4-byte aligned, as GL expects
+	TexStream *stream = (TexStream*)userData;
+	if(level >= KTX_MAX_LEVELS) {
+		return false;
+	}
+	
+	size_t size = (size_t)pitch * height;
+	const unsigned char *bytes = (const unsigned char*)pixels;
+	stream->pixels.insert(stream->pixels.end(), bytes, bytes + size);
+	stream->image.levelSizes[level] = size;
+	
+	return true;
+}
+
+/** Reads and decodes a texture (on a worker thread).
+ * 
+ * @return bool true if successful
+ */
+
+static bool texStreamDecode(TexStream *stream) {
+	const char *filename = stream->filename.c_str();
+	
+	// KTX files are ready to go as is
+	if(texHasExtension(filename, ".ktx")) {
+		if(!fileMap(filename, &stream->ktxMap)) {
+			return false;
+		}
+		stream->mapped = true;
+		if(!ktxParse(stream->ktxMap.data, stream->ktxMap.length, &stream->image)) {
+			SDL_Log("Couldn't load texture %s\n", filename);
+			return false;
+		}
+		return true;
+	}
+	
+	FileMap srcMap;
+	if(!fileMap(filename, &srcMap)) {
+		return false;
+	}
+	SDL_Surface *loadedSurf = IMG_Load_RW(SDL_RWFromConstMem(srcMap.data, (int)srcMap.length), 1);
+	fileUnmap(&srcMap);
+	if(!loadedSurf) {
+		SDL_Log("Loading image %s failed with error: %s", filename, IMG_GetError());
+		return false;
+	}
+	
+	// R, G, B, A byte order, so no swizzling is needed
+	SDL_Surface *texSurf = SDL_ConvertSurfaceFormat(loadedSurf, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_FreeSurface(loadedSurf);
+	loadedSurf = NULL;
+	if(!texSurf) {
+		SDL_Log("Couldn't convert image %s to RGBA: %s\n", filename, SDL_GetError());
+		return false;
+	}
+	
+	// Store all levels one after the other (reserved up front, so nothing moves)
+	KtxImage *image = &stream->image;
+	image->glInternalFormat = GL_RGBA8;
+	image->glFormat = GL_RGBA;
+	image->glType = GL_UNSIGNED_BYTE;
+	image->width = texSurf->w;
+	image->height = texSurf->h;
+	image->numLevels = mipmapLevelCount(texSurf->w, texSurf->h);
+	if(image->numLevels > KTX_MAX_LEVELS) {
+		SDL_Log("Texture %s is too large\n", filename);
+		SDL_FreeSurface(texSurf);
+		return false;
+	}
+	size_t totalSize = 0;
+	for(int level = 0; level < image->numLevels; ++level) {
+		int width = texSurf->w >> level;
+		int height = texSurf->h >> level;
+		totalSize += (size_t)(width > 0 ? width : 1) * (height > 0 ? height : 1) * 4;
+	}
+	stream->pixels.reserve(totalSize);
+	for(int y = 0; y < texSurf->h; ++y) {
+		const unsigned char *row = (const unsigned char*)texSurf->pixels + (size_t)y * texSurf->pitch;
+		stream->pixels.insert(stream->pixels.end(), row, row + (size_t)texSurf->w * 4);
+	}
+	image->levelSizes[0] = (size_t)texSurf->w * texSurf->h * 4;
+	bool success = mipmapChainBuild(texSurf->pixels, texSurf->w, texSurf->h, texSurf->pitch, 4, 3,
+		texStreamLevelStore, stream);
+	SDL_FreeSurface(texSurf);
+	texSurf = NULL;
+	if(!success) {
+		SDL_Log("Couldn't build the mipmaps for texture %s\n", filename);
+		return false;
+	}
+	
+	size_t offset = 0;
+	for(int level = 0; level < image->numLevels; ++level) {
+		image->levelData[level] = &stream->pixels[offset];
+		offset += image->levelSizes[level];
+	}
+	
+	return true;
+}
+
+/** Decodes a stream unless it's been cancelled (on a worker thread; see WorkerPoolFunc).
+ */
+
+static void texStreamDecodeJob(void *job, void *userData) {
+	(void)userData;
+	TexStream *stream = (TexStream*)job;
+	stream->decoded = SDL_AtomicGet(&stream->cancelled) == 0 && texStreamDecode(stream);
+}
+
+/** Frees a stream's decoded levels.
+ */
+
+static void texStreamFreeData(TexStream *stream) {
+	if(stream->mapped) {
+		fileUnmap(&stream->ktxMap);
+		stream->mapped = false;
+	}
+	std::vector<unsigned char>().swap(stream->pixels);
+}
+
+/** Deletes a stream and its texture.
+ */
+
+static void texStreamDelete(TexStreamer *streamer, TexStream *stream) {
+	if(stream->uploadTexture) {
+		glDeleteTextures(1, &stream->uploadTexture);
+	}
+	texStreamFreeData(stream);
+	streamer->streams.erase(stream);
+	delete stream;
+}
+
+/** Marks a stream as no longer loading.
+ */
+
+static void texStreamFinish(TexStreamer *streamer, TexStream *stream, TexStreamStatus status) {
+	stream->status = status;
+	if(status == TEX_STREAM_READY) {
+		stream->texture = stream->uploadTexture;
+	}
+	else if(stream->uploadTexture) {
+		glDeleteTextures(1, &stream->uploadTexture);
+		stream->uploadTexture = 0;
+	}
+	texStreamFreeData(stream);
+	--streamer->numPending;
+}
+
+/** Creates a stream's texture, with storage for all of its levels.
+ * 
+ * @return bool true if successful
+ */
+
+static bool texStreamTextureCreate(TexStream *stream) {
+	const KtxImage *image = &stream->image;
+	GLenum storageFormat = ktxStorageFormat(image);
+	if(storageFormat == GL_NONE) {
+		SDL_Log("Texture %s has an unsupported format (0x%04X, type 0x%04X)\n",
+			stream->filename.c_str(), image->glFormat, image->glType);
+		return false;
+	}
+	
+	glGenTextures(1, &stream->uploadTexture);
+	glBindTexture(GL_TEXTURE_2D, stream->uploadTexture);
+	glTexStorage2D(GL_TEXTURE_2D, image->numLevels, storageFormat, image->width, image->height);
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Creating texture %s failed, code %u\n", stream->filename.c_str(), err);
+		return false;
+	}
+	
+	stream->level = 0;
+	stream->row = 0;
+	return true;
+}
+
+/** Uploads the next band of rows of a stream's texture, through the next
+ * pixel unpack buffer in the ring.
+ * 
+ * @param bytes where to write the number of bytes uploaded to
+ * 
+ * @return TexUploadResult the result
+ */
+
+static TexUploadResult texStreamUploadNext(TexStreamer *streamer, TexStream *stream, size_t *bytes) {
+	*bytes = 0;
+	const KtxImage *image = &stream->image;
+	if(!stream->uploadTexture && !texStreamTextureCreate(stream)) {
+		return TEX_UPLOAD_FAILED;
+	}
+	
+	// Wait for the GPU to finish with the buffer (without blocking)
+	GLsync &fence = streamer->fences[streamer->nextPbo];
+	if(fence) {
+		if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+			return TEX_UPLOAD_BUSY;
+		}
+		glDeleteSync(fence);
+		fence = 0;
+	}
+	
+	// Work out the level's rows (compressed formats have rows of 4x4 blocks)
+	bool compressed = image->glFormat == 0;
+	int width = image->width >> stream->level;
+	int height = image->height >> stream->level;
+	width = width > 0 ? width : 1;
+	height = height > 0 ? height : 1;
+	int rowHeight = compressed ? 4 : 1;
+	int numRows = (height + rowHeight - 1) / rowHeight;
+	size_t levelSize = image->levelSizes[stream->level];
+	size_t rowSize = compressed ? levelSize / numRows :
+		((size_t)width * ktxBytesPerPixel(image->glFormat, image->glType) + 3) & ~(size_t)3;
+	if(levelSize < rowSize * numRows || rowSize == 0) {
+		SDL_Log("Texture %s is missing data for mipmap level %d\n", stream->filename.c_str(), stream->level);
+		return TEX_UPLOAD_FAILED;
+	}
+	
+	// A band of rows that fits in the buffer (at least one row)
+	int firstRow = stream->row;
+	int bandRows = (int)(streamer->pboSize / rowSize);
+	bandRows = bandRows < 1 ? 1 : bandRows;
+	bandRows = bandRows < numRows - firstRow ? bandRows : numRows - firstRow;
+	size_t bandSize = rowSize * bandRows;
+	const unsigned char *src = (const unsigned char*)image->levelData[stream->level] + rowSize * firstRow;
+	
+	// Rows too big for the buffer go straight from memory
+	bool usePbo = bandSize <= streamer->pboSize;
+	const void *data = src;
+	if(usePbo) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamer->pbos[streamer->nextPbo]);
+		void *dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bandSize,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if(!dst) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			SDL_Log("Couldn't map a pixel unpack buffer for texture %s\n", stream->filename.c_str());
+			return TEX_UPLOAD_FAILED;
+		}
+		memcpy(dst, src, bandSize);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		data = (const void*)0; // Offset into the buffer
+	}
+	
+	int y = firstRow * rowHeight;
+	int bandHeight = bandRows * rowHeight;
+	bandHeight = y + bandHeight < height ? bandHeight : height - y;
+	glBindTexture(GL_TEXTURE_2D, stream->uploadTexture);
+	if(compressed) {
+		glCompressedTexSubImage2D(GL_TEXTURE_2D, stream->level, 0, y, width, bandHeight,
+			image->glInternalFormat, (GLsizei)bandSize, data);
+	}
+	else {
+		glTexSubImage2D(GL_TEXTURE_2D, stream->level, 0, y, width, bandHeight,
+			image->glFormat, image->glType, data);
+	}
+	if(usePbo) {
+		fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		streamer->nextPbo = (streamer->nextPbo + 1) % streamer->pbos.size();
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Uploading texture %s failed, code %u\n", stream->filename.c_str(), err);
+		return TEX_UPLOAD_FAILED;
+	}
+	*bytes = bandSize;
+	
+	// Next band
+	stream->row += bandRows;
+	if(stream->row >= numRows) {
+		stream->row = 0;
+		++stream->level;
+	}
+	
+	return stream->level < image->numLevels ? TEX_UPLOAD_PROGRESS : TEX_UPLOAD_DONE;
+}
+
+TexStreamer *texStreamerCreate(int numThreads, size_t pboSize, int numPbos) {
+	
+	// Must be done here, before any workers use SDL_image
+	if(!texImageLoadersInit()) {
+		return NULL;
+	}
+	
+	TexStreamer *streamer = new TexStreamer_s;
+	streamer->workers = NULL;
+	streamer->numPending = 0;
+	streamer->pboSize = pboSize;
+	streamer->nextPbo = 0;
+	streamer->maxBytes = 0;
+	streamer->maxMs = 0.0;
+	
+	// The placeholder (mid-grey)
+	static const unsigned char placeholderPixel[4] = {128, 128, 128, 255};
+	glGenTextures(1, &streamer->placeholder);
+	glBindTexture(GL_TEXTURE_2D, streamer->placeholder);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 1, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, placeholderPixel);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	
+	numPbos = numPbos > 0 ? numPbos : 1;
+	streamer->pbos.resize(numPbos);
+	streamer->fences.assign(numPbos, (GLsync)0);
+	glGenBuffers(numPbos, &streamer->pbos[0]);
+	for(int i = 0; i < numPbos; ++i) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, streamer->pbos[i]);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, pboSize, NULL, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Creating the texture streamer failed, code %u\n", err);
+		texStreamerDestroy(streamer);
+		return NULL;
+	}
+	
+	// Leave a core for the render thread
+	if(numThreads <= 0) {
+		numThreads = SDL_GetCPUCount() - 1;
+		numThreads = numThreads > 0 ? numThreads : 1;
+	}
+	streamer->workers = workerPoolCreate(numThreads, "TexStream", texStreamDecodeJob, NULL);
+	if(!streamer->workers) {
+		texStreamerDestroy(streamer);
+		return NULL;
+	}
+	
+	return streamer;
+}
+
+void texStreamerDestroy(TexStreamer *streamer) {
+	
+	// The streams are all in streamer->streams, so none need discarding here
+	workerPoolDestroy(streamer->workers, NULL);
+	
+	while(!streamer->streams.empty()) {
+		texStreamDelete(streamer, *streamer->streams.begin());
+	}
+	for(GLsync fence : streamer->fences) {
+		if(fence) {
+			glDeleteSync(fence);
+		}
+	}
+	if(!streamer->pbos.empty()) {
+		glDeleteBuffers((GLsizei)streamer->pbos.size(), &streamer->pbos[0]);
+	}
+	glDeleteTextures(1, &streamer->placeholder);
+	delete streamer;
+}
+
+void texStreamerSetBudget(TexStreamer *streamer, size_t maxBytes, double maxMs) {
+	
+	streamer->maxBytes = maxBytes;
+	streamer->maxMs = maxMs;
+}
+
+size_t texStreamerUpdate(TexStreamer *streamer) {
+	
+	// Collect the textures the workers have finished
+	TexStream *decoded;
+	while((decoded = (TexStream*)workerPoolNext(streamer->workers, false)) != NULL) {
+		if(SDL_AtomicGet(&decoded->cancelled)) {
+			--streamer->numPending;
+			texStreamDelete(streamer, decoded);
+		}
+		else if(!decoded->decoded) {
+			texStreamFinish(streamer, decoded, TEX_STREAM_FAILED);
+		}
+		else {
+			streamer->uploadQueue.push_back(decoded);
+		}
+	}
+	if(streamer->uploadQueue.empty()) {
+		return 0;
+	}
+	
+	// Upload until the budget's used up (but always make some progress)
+	GLint prevTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTexture);
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	size_t uploaded = 0;
+	while(!streamer->uploadQueue.empty()) {
+		if(uploaded > 0) {
+			double elapsedMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+			if((streamer->maxBytes > 0 && uploaded >= streamer->maxBytes) ||
+					(streamer->maxMs > 0.0 && elapsedMs >= streamer->maxMs)) {
+				break;
+			}
+		}
+		
+		TexStream *stream = streamer->uploadQueue.front();
+		if(SDL_AtomicGet(&stream->cancelled)) {
+			streamer->uploadQueue.pop_front();
+			--streamer->numPending;
+			texStreamDelete(streamer, stream);
+			continue;
+		}
+		
+		size_t bytes = 0;
+		TexUploadResult result = texStreamUploadNext(streamer, stream, &bytes);
+		uploaded += bytes;
+		if(result == TEX_UPLOAD_BUSY) {
+			break;
+		}
+		if(result == TEX_UPLOAD_DONE || result == TEX_UPLOAD_FAILED) {
+			streamer->uploadQueue.pop_front();
+			texStreamFinish(streamer, stream, result == TEX_UPLOAD_DONE ? TEX_STREAM_READY : TEX_STREAM_FAILED);
+		}
+	}
+	glBindTexture(GL_TEXTURE_2D, (GLuint)prevTexture);
+	
+	return uploaded;
+}
+
+size_t texStreamerPending(const TexStreamer *streamer) {
+	
+	return streamer->numPending;
+}
+
+TexStream *texStreamLoad(TexStreamer *streamer, const char *filename) {
+	
+	TexStream *stream = new TexStream_s;
+	stream->filename = filename;
+	stream->status = TEX_STREAM_LOADING;
+	stream->texture = streamer->placeholder;
+	SDL_AtomicSet(&stream->cancelled, 0);
+	stream->decoded = false;
+	memset(&stream->image, 0, sizeof(stream->image));
+	stream->mapped = false;
+	stream->uploadTexture = 0;
+	stream->level = 0;
+	stream->row = 0;
+	streamer->streams.insert(stream);
+	++streamer->numPending;
+	
+	void *job = stream;
+	workerPoolSubmit(streamer->workers, &job, 1);
+	
+	return stream;
+}
+
+TexStreamStatus texStreamStatus(const TexStream *stream) {
+	
+	return stream->status;
+}
+
+GLuint texStreamTexture(const TexStream *stream) {
+	
+	return stream->texture;
+}
+
+void texStreamRelease(TexStreamer *streamer, TexStream *stream) {
+	
+	// The workers or texStreamerUpdate() still have it; it's deleted when it comes back
+	if(stream->status == TEX_STREAM_LOADING) {
+		SDL_AtomicSet(&stream->cancelled, 1);
+		return;
+	}
+	
+	texStreamDelete(streamer, stream);
+}
@@ -0,0 +1,126 @@
+// texturestream.h
+
+#ifndef __TEXTURESTREAM_H__
+#define __TEXTURESTREAM_H__
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+/** Loads textures in the background, without stalling the render thread.
+ * 
+ * Files are read and decoded (with CPU-built mipmaps; see
+ * mipmapChainBuild()) on worker threads. The render thread then uploads a
+ * limited amount of texel data per frame in texStreamerUpdate(), through a
+ * ring of pixel unpack buffers (PBOs), so a level with hundreds of textures
+ * loads over several frames instead of in one long hitch.
+ * 
+ * Usage:
+ * - texStreamerCreate() once GL is up
+ * - texStreamLoad() for each texture; bind texStreamTexture() when drawing
+ *   (it's a 1x1 placeholder until the real texture is ready)
+ * - texStreamerUpdate() once per frame
+ * - texStreamRelease() when done with a texture
+ * 
+ * Image files (PNG/JPEG) and KTX files (see texLoadKtx()) are supported.
+ * NOTE: All functions must be called from the thread with the GL context.
+ */
+
+typedef struct TexStreamer_s TexStreamer;
+
+/** A streamed texture.
+ */
+
+typedef struct TexStream_s TexStream;
+
+/** A streamed texture's state.
+ */
+
+typedef enum TexStreamStatus_e {
+	// Being read/decoded, or waiting to be uploaded
+	TEX_STREAM_LOADING,
+	
+	// Uploaded; texStreamTexture() is the real texture
+	TEX_STREAM_READY,
+	
+	// Couldn't be loaded; texStreamTexture() stays the placeholder
+	TEX_STREAM_FAILED
+} TexStreamStatus;
+
+/** Creates a texture streamer.
+ * 
+ * @param numThreads the number of decoding threads (0 for one per CPU core, less one for the render thread)
+ * @param pboSize the size of each pixel unpack buffer in bytes. Larger
+ * levels are uploaded a band of rows at a time
+ * @param numPbos the number of pixel unpack buffers in the ring (e.g., 3,
+ * so uploads don't wait for the GPU to finish with a buffer)
+ * 
+ * @return TexStreamer* the streamer, or NULL if failed
+ */
+
+TexStreamer *texStreamerCreate(int numThreads, size_t pboSize, int numPbos);
+
+/** Destroys a texture streamer, and all of its textures.
+ * Waits for the worker threads to finish the file they're decoding.
+ */
+
+void texStreamerDestroy(TexStreamer *streamer);
+
+/** Limits how much texStreamerUpdate() uploads each frame.
+ * 
+ * Uploading stops when either limit is reached (it may go over by up to one
+ * buffer's worth). At least one buffer is uploaded per frame, so loading
+ * always makes progress.
+ * 
+ * @param streamer the texture streamer
+ * @param maxBytes the most bytes to upload per frame (0 for no limit)
+ * @param maxMs the most time to spend per frame in milliseconds (0 for no limit)
+ */
+
+void texStreamerSetBudget(TexStreamer *streamer, size_t maxBytes, double maxMs);
+
+/** Uploads decoded textures, within the budget (see texStreamerSetBudget()).
+ * Call this once per frame.
+ * 
+ * @param streamer the texture streamer
+ * 
+ * @return size_t the number of bytes uploaded
+ */
+
+size_t texStreamerUpdate(TexStreamer *streamer);
+
+/** Gets the number of textures that are still loading.
+ */
+
+size_t texStreamerPending(const TexStreamer *streamer);
+
+/** Starts loading a texture in the background.
+ * 
+ * @param streamer the texture streamer
+ * @param filename the image or KTX file to load
+ * 
+ * @return TexStream* the texture (release with texStreamRelease())
+ */
+
+TexStream *texStreamLoad(TexStreamer *streamer, const char *filename);
+
+/** Gets a streamed texture's status.
+ */
+
+TexStreamStatus texStreamStatus(const TexStream *stream);
+
+/** Gets the texture to bind for a streamed texture.
+ * 
+ * @return GLuint the real texture once it's ready; the 1x1 placeholder until then
+ */
+
+GLuint texStreamTexture(const TexStream *stream);
+
+/** Releases a streamed texture (and cancels loading it, if it's still loading).
+ * 
+ * @param streamer the texture streamer
+ * @param stream the texture to release
+ */
+
+void texStreamRelease(TexStreamer *streamer, TexStream *stream);
+
+#endif
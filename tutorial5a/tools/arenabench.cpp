@@ -0,0 +1,184 @@
+// arenabench.cpp
+//
+// Compares creating and drawing many small meshes (cubes) with a VBO and IBO
+// each against sub-allocating them from a buffer arena (see bufferarena.h).
+// Draws offscreen (see benchContextCreate()), so it runs without a window.
+//
+// Usage: arenabench [meshes]
+// Defaults to 2000 meshes, drawn for 100 frames each way. Run it from the
+// tutorial5a directory (it loads the shaders and crate1_diffuse.png).
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../bufferarena.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Sets up the vertex attributes to read Vertex structs from a VBO.
+ */
+
+static void vertexAttribsSet(GLuint vbo) {
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, texCoord));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, normal));
+}
+
+/** Compares creating and drawing many small meshes (cubes) with a VBO and
+ * IBO each (vboCreate()/iboCreate()) against sub-allocating them from a
+ * buffer arena (see bufferArenaCreate()), drawn one call per mesh, and with
+ * neighbouring meshes merged into one draw call. Then frees every other
+ * mesh, and the rest, to check that the arena's free ranges coalesce.
+ * NOTE: Expects the shader program, uniform blocks and a texture to be bound already.
+ * 
+ * @param cubeVertices the cube's vertices
+ * @param numCubeVertices the cube's number of vertices
+ * @param cubeIndices the cube's indices
+ * @param numCubeIndices the cube's number of indices
+ * @param numMeshes the number of cubes
+ * @param frames the number of frames to time each way
+ */
+
+static void bufferArenaBenchmark(const Vertex *cubeVertices, GLsizei numCubeVertices, const GLushort *cubeIndices,
+		GLsizei numCubeIndices, int numMeshes, int frames) {
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	// Lay the cubes out in a grid, each one a mesh of its own
+	int gridWidth = (int)ceilf(sqrtf((float)numMeshes));
+	float cubeSpacing = 160.0f / gridWidth;
+	float cubeScale = cubeSpacing * 0.6f / 100.0f;
+	std::vector<Vertex> meshVertices;
+	for (int i = 0; i < numMeshes; ++i) {
+		float offsetX = (i % gridWidth - (gridWidth - 1) / 2.0f) * cubeSpacing;
+		float offsetY = (i / gridWidth - (gridWidth - 1) / 2.0f) * cubeSpacing;
+		for (GLsizei v = 0; v < numCubeVertices; ++v) {
+			Vertex vertex = cubeVertices[v];
+			vertex.position[0] = vertex.position[0] * cubeScale + offsetX;
+			vertex.position[1] = vertex.position[1] * cubeScale + offsetY;
+			vertex.position[2] = vertex.position[2] * cubeScale;
+			meshVertices.push_back(vertex);
+		}
+	}
+	std::vector<GLushort> indices(cubeIndices, cubeIndices + numCubeIndices);
+	
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	std::vector<GLuint> vbos(numMeshes, 0);
+	std::vector<GLuint> ibos(numMeshes, 0);
+	bool success = true;
+	for (int i = 0; i < numMeshes && success; ++i) {
+		vbos[i] = benchBufferCreate(GL_ARRAY_BUFFER, &meshVertices[i * numCubeVertices], numCubeVertices * sizeof(Vertex));
+		ibos[i] = benchBufferCreate(GL_ELEMENT_ARRAY_BUFFER, &indices[0], numCubeIndices * sizeof(GLushort));
+		success = vbos[i] && ibos[i];
+	}
+	glFinish();
+	double ownCreateMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+	
+	startTime = SDL_GetPerformanceCounter();
+	BufferArena *arena = bufferArenaCreate(sizeof(Vertex), 65536, 98304);
+	std::vector<BufferArenaMesh> meshes(numMeshes);
+	for (int i = 0; i < numMeshes && success; ++i) {
+		success = bufferArenaAlloc(arena, &meshVertices[i * numCubeVertices], numCubeVertices,
+			&indices[0], numCubeIndices, &meshes[i]);
+	}
+	glFinish();
+	double arenaCreateMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+	BufferArenaStats stats = bufferArenaStatsGet(arena);
+	
+	if (success) {
+		SDL_Log("%d meshes: created with their own buffers in %.1f ms (%d buffer objects), "
+			"from the arena in %.1f ms (%u block(s), %.1f of %.1f KiB used)\n", numMeshes, ownCreateMs,
+			numMeshes * 2, arenaCreateMs, stats.numBlocks, stats.usedBytes / 1024.0, stats.reservedBytes / 1024.0);
+		
+		const char *wayNames[] = {"Own buffers", "Arena", "Arena, merged"};
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		for (int way = 0; way < 3; ++way) {
+			
+			// Frame 0 is a warm up
+			int drawCalls = 0;
+			int bufferBinds = 0;
+			Uint64 drawStartTime = 0;
+			for (int f = 0; f <= frames; ++f) {
+				if (f == 1) {
+					drawStartTime = SDL_GetPerformanceCounter();
+				}
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				drawCalls = 0;
+				bufferBinds = 0;
+				GLuint boundVBO = 0;
+				for (int i = 0; i < numMeshes; ++i) {
+					if (way == 0) {
+						vertexAttribsSet(vbos[i]);
+						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibos[i]);
+						glDrawElements(GL_TRIANGLES, numCubeIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+						bufferBinds += 2;
+						++drawCalls;
+						continue;
+					}
+					const BufferArenaMesh &mesh = meshes[i];
+					if (mesh.vbo != boundVBO) {
+						vertexAttribsSet(mesh.vbo);
+						glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+						boundVBO = mesh.vbo;
+						bufferBinds += 2;
+					}
+					
+					// Merge the following meshes while their indices carry on from this one's
+					GLuint numIndices = mesh.numIndices;
+					while (way == 2 && i + 1 < numMeshes && meshes[i + 1].block == mesh.block &&
+							meshes[i + 1].firstIndex == mesh.firstIndex + numIndices) {
+						numIndices += meshes[++i].numIndices;
+					}
+					glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT,
+						(GLvoid*)(mesh.firstIndex * sizeof(GLushort)));
+					++drawCalls;
+				}
+				glFinish();
+			}
+			double drawMs = (SDL_GetPerformanceCounter() - drawStartTime) * msPerTick / frames;
+			SDL_Log("  %s: %.2f ms/frame (%d draw calls, %d buffer binds)\n", wayNames[way], drawMs,
+				drawCalls, bufferBinds);
+		}
+		
+		for (int i = 1; i < numMeshes; i += 2) {
+			bufferArenaFree(arena, &meshes[i]);
+		}
+		stats = bufferArenaStatsGet(arena);
+		SDL_Log("  Every other mesh freed: %u meshes, %u free ranges\n", stats.numMeshes, stats.numFreeRanges);
+		for (int i = 0; i < numMeshes; i += 2) {
+			bufferArenaFree(arena, &meshes[i]);
+		}
+		stats = bufferArenaStatsGet(arena);
+		SDL_Log("  All freed: %u meshes, %u free ranges in %u block(s)\n", stats.numMeshes, stats.numFreeRanges,
+			stats.numBlocks);
+	}
+	bufferArenaDestroy(arena);
+	for (int i = 0; i < numMeshes; ++i) {
+		glDeleteBuffers(1, &vbos[i]);
+		glDeleteBuffers(1, &ibos[i]);
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	int numMeshes = argc > 1 ? atoi(argv[1]) : 2000;
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	
+	bufferArenaBenchmark(scene.vertices, CUBE_NUM_VERTICES, scene.indices, CUBE_NUM_INDICES,
+		numMeshes > 0 ? numMeshes : 1, 100);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
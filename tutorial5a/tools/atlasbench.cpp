@@ -0,0 +1,198 @@
+// atlasbench.cpp
+//
+// Compares drawing many cubes that each have their own texture (a bind and a
+// draw call per cube) with drawing them from a texture atlas (see
+// textureatlas.h). Draws offscreen (see benchContextCreate()), so it runs
+// without a window.
+//
+// Usage: atlasbench [cubes]
+// Defaults to 256 cubes, each drawn for 100 frames each way. Run it from the
+// tutorial5a directory (it loads the shaders).
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../texture.h"
+#include "../textureatlas.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Compares drawing many cubes that each have their own texture (a bind and
+ * a draw call per cube) with drawing them from a texture atlas (the cubes'
+ * texture coordinates remapped, and one bind and draw call per atlas page).
+ * NOTE: Expects the shader program and uniform blocks to be bound already.
+ * 
+ * @param cubeVertices the cube's vertices
+ * @param numCubeVertices the cube's number of vertices
+ * @param cubeIndices the cube's indices
+ * @param numCubeIndices the cube's number of indices
+ * @param numCubes the number of cubes (each with its own image)
+ * @param frames the number of frames to time each way
+ */
+
+static void textureAtlasBenchmark(const Vertex *cubeVertices, GLsizei numCubeVertices, const GLushort *cubeIndices,
+		GLsizei numCubeIndices, int numCubes, int frames) {
+	const int imageSize = 64;
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	// 16-bit indices limit how many cubes fit in one vertex buffer
+	int maxCubes = 65536 / numCubeVertices;
+	numCubes = numCubes < maxCubes ? numCubes : maxCubes;
+	
+	// Make an image for each cube, and put it in both a texture of its own and the atlas
+	TexAtlas *atlas = texAtlasCreate(1024, 1024);
+	if (!atlas) {
+		return;
+	}
+	std::vector<GLuint> textures(numCubes, 0);
+	std::vector<int> entries(numCubes, -1);
+	TexAtlasEntryOptions atlasOptions = {2, 2}; // 2 texels of padding, clean down to mip level 2
+	bool success = true;
+	for (int i = 0; i < numCubes && success; ++i) {
+		SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, imageSize, imageSize, 32, SDL_PIXELFORMAT_RGBA32);
+		if (!surface) {
+			success = false;
+			break;
+		}
+		Uint8 colour[3] = {(Uint8)(i * 97), (Uint8)(i * 57 + 80), (Uint8)(i * 31 + 160)};
+		for (int y = 0; y < imageSize; ++y) {
+			Uint8 *row = (Uint8*)surface->pixels + y * surface->pitch;
+			for (int x = 0; x < imageSize; ++x) {
+				bool dark = ((x / 8) ^ (y / 8)) & 1;
+				for (int c = 0; c < 3; ++c) {
+					row[x * 4 + c] = dark ? colour[c] / 2 : colour[c];
+				}
+				row[x * 4 + 3] = 0xFF;
+			}
+		}
+		char name[32];
+		snprintf(name, sizeof(name), "image %d", i);
+		textures[i] = texCreateFromSurface(surface, TEX_MIPMAP_CPU, name);
+		entries[i] = texAtlasAddSurface(atlas, surface, &atlasOptions, name);
+		SDL_FreeSurface(surface);
+		success = textures[i] && entries[i] >= 0;
+	}
+	success = success && texAtlasBuild(atlas);
+	
+	// Lay the cubes out in a grid, in atlas page order (so each page is one
+	// range of indices), once with their own texture coordinates, and once
+	// remapped to the atlas
+	std::vector<int> cubeOrder;
+	int numPages = success ? texAtlasNumPages(atlas) : 0;
+	std::vector<GLsizei> pageFirstIndex(numPages + 1, 0);
+	for (int page = 0; page < numPages; ++page) {
+		pageFirstIndex[page] = (GLsizei)cubeOrder.size() * numCubeIndices;
+		for (int i = 0; i < numCubes; ++i) {
+			if (texAtlasRegionGet(atlas, entries[i])->page == page) {
+				cubeOrder.push_back(i);
+			}
+		}
+	}
+	pageFirstIndex[numPages] = (GLsizei)cubeOrder.size() * numCubeIndices;
+	int gridWidth = (int)ceilf(sqrtf((float)numCubes));
+	float cubeSpacing = 160.0f / gridWidth;
+	float cubeScale = cubeSpacing * 0.6f / 100.0f;
+	std::vector<Vertex> ownVertices;
+	std::vector<Vertex> atlasVertices;
+	std::vector<GLushort> indices;
+	for (size_t n = 0; n < cubeOrder.size(); ++n) {
+		int i = cubeOrder[n];
+		GLushort baseVertex = (GLushort)ownVertices.size();
+		float offsetX = (i % gridWidth - (gridWidth - 1) / 2.0f) * cubeSpacing;
+		float offsetY = (i / gridWidth - (gridWidth - 1) / 2.0f) * cubeSpacing;
+		for (GLsizei v = 0; v < numCubeVertices; ++v) {
+			Vertex vertex = cubeVertices[v];
+			vertex.position[0] = vertex.position[0] * cubeScale + offsetX;
+			vertex.position[1] = vertex.position[1] * cubeScale + offsetY;
+			vertex.position[2] = vertex.position[2] * cubeScale;
+			ownVertices.push_back(vertex);
+		}
+		for (GLsizei j = 0; j < numCubeIndices; ++j) {
+			indices.push_back(baseVertex + cubeIndices[j]);
+		}
+	}
+	atlasVertices = ownVertices;
+	for (size_t n = 0; n < cubeOrder.size(); ++n) {
+		texAtlasRemapTexCoords(texAtlasRegionGet(atlas, entries[cubeOrder[n]]),
+			atlasVertices[n * numCubeVertices].texCoord, numCubeVertices, sizeof(Vertex));
+	}
+	
+	GLuint ownVBO = success ? benchBufferCreate(GL_ARRAY_BUFFER, &ownVertices[0], ownVertices.size() * sizeof(Vertex)) : 0;
+	GLuint atlasVBO = success ?
+		benchBufferCreate(GL_ARRAY_BUFFER, &atlasVertices[0], atlasVertices.size() * sizeof(Vertex)) : 0;
+	GLuint ibo = success ? benchBufferCreate(GL_ELEMENT_ARRAY_BUFFER, &indices[0], indices.size() * sizeof(GLushort)) : 0;
+	if (ownVBO && atlasVBO && ibo) {
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		double drawMs[2];
+		int drawCalls[2];
+		for (int useAtlas = 0; useAtlas < 2; ++useAtlas) {
+			glBindBuffer(GL_ARRAY_BUFFER, useAtlas ? atlasVBO : ownVBO);
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)0);
+			glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, texCoord));
+			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, normal));
+			
+			// Frame 0 is a warm up
+			Uint64 startTime = 0;
+			for (int f = 0; f <= frames; ++f) {
+				if (f == 1) {
+					startTime = SDL_GetPerformanceCounter();
+				}
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				drawCalls[useAtlas] = 0;
+				if (useAtlas) {
+					for (int page = 0; page < numPages; ++page) {
+						glBindTexture(GL_TEXTURE_2D, texAtlasPageTexture(atlas, page));
+						glDrawElements(GL_TRIANGLES, pageFirstIndex[page + 1] - pageFirstIndex[page],
+							GL_UNSIGNED_SHORT, (GLvoid*)(pageFirstIndex[page] * sizeof(GLushort)));
+						++drawCalls[useAtlas];
+					}
+				}
+				else {
+					for (size_t n = 0; n < cubeOrder.size(); ++n) {
+						glBindTexture(GL_TEXTURE_2D, textures[cubeOrder[n]]);
+						glDrawElements(GL_TRIANGLES, numCubeIndices, GL_UNSIGNED_SHORT,
+							(GLvoid*)(n * numCubeIndices * sizeof(GLushort)));
+						++drawCalls[useAtlas];
+					}
+				}
+				glFinish();
+			}
+			drawMs[useAtlas] = (SDL_GetPerformanceCounter() - startTime) * msPerTick / frames;
+		}
+		SDL_Log("%d cubes: own textures %.2f ms/frame (%d draw calls), atlas %.2f ms/frame "
+			"(%d draw call(s), %d page(s))\n", numCubes, drawMs[0], drawCalls[0], drawMs[1], drawCalls[1], numPages);
+	}
+	glDeleteBuffers(1, &ownVBO);
+	glDeleteBuffers(1, &atlasVBO);
+	glDeleteBuffers(1, &ibo);
+	for (int i = 0; i < numCubes; ++i) {
+		texDestroy(textures[i]);
+	}
+	texAtlasDestroy(atlas);
+}
+
+
+int main(int argc, char *argv[]) {
+	int numCubes = argc > 1 ? atoi(argv[1]) : 256;
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	
+	textureAtlasBenchmark(scene.vertices, CUBE_NUM_VERTICES, scene.indices, CUBE_NUM_INDICES,
+		numCubes > 0 ? numCubes : 1, 100);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
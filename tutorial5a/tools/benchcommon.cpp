@@ -0,0 +1,160 @@
+// benchcommon.cpp
+//
+// See header file for details
+
+#include "benchcommon.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <SDL.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+/** Creates colour and depth renderbuffers, and binds a framebuffer object
+ * that renders to them (the offscreen context has no default framebuffer).
+ * 
+ * @return bool true if successful
+ */
+
+static bool benchFramebufferCreate(int width, int height) {
+	GLuint framebuffer;
+	GLuint renderbuffers[2];
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	glGenRenderbuffers(2, renderbuffers);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[0]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers[0]);
+	glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers[1]);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers[1]);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		fprintf(stderr, "Couldn't create a %dx%d framebuffer\n", width, height);
+		return false;
+	}
+	glViewport(0, 0, width, height);
+	
+	return true;
+}
+
+bool benchContextCreate(int width, int height) {
+	EGLDisplay display = EGL_NO_DISPLAY;
+	bool surfaceless = false;
+	const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if(clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless") && getPlatformDisplay) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+		surfaceless = display != EGL_NO_DISPLAY;
+	}
+	if(!surfaceless) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	
+	EGLint major = 0;
+	EGLint minor = 0;
+	if(display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		fprintf(stderr, "Couldn't initialize EGL (error 0x%04X)\n", eglGetError());
+		return false;
+	}
+	eglBindAPI(EGL_OPENGL_ES_API);
+	
+	const EGLint configAttribs[] = {
+		EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT_KHR,
+		EGL_NONE
+	};
+	EGLConfig config = NULL;
+	EGLint numConfigs = 0;
+	if(!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs < 1) {
+		fprintf(stderr, "Couldn't find an OpenGL ES 3 EGL config\n");
+		return false;
+	}
+	
+	const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+	if(context == EGL_NO_CONTEXT) {
+		fprintf(stderr, "Couldn't create an OpenGL ES 3 context (error 0x%04X)\n", eglGetError());
+		return false;
+	}
+	
+	EGLSurface surface = EGL_NO_SURFACE;
+	if(!surfaceless) {
+		const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+		surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+		if(surface == EGL_NO_SURFACE) {
+			fprintf(stderr, "Couldn't create a pbuffer (error 0x%04X)\n", eglGetError());
+			return false;
+		}
+	}
+	if(!eglMakeCurrent(display, surface, surface, context)) {
+		fprintf(stderr, "Couldn't make the context current (error 0x%04X)\n", eglGetError());
+		return false;
+	}
+	
+	return width <= 0 || height <= 0 || benchFramebufferCreate(width, height);
+}
+
+std::string benchFilename(const char *name) {
+	char *prefPath = SDL_GetPrefPath("GLES3-SDL2-Demos", "tutorial5a");
+	std::string filename = std::string(prefPath ? prefPath : "") + name;
+	SDL_free(prefPath);
+	return filename;
+}
+
+bool benchSphereObjWrite(const char *filename, int gridSize) {
+	FILE *file = fopen(filename, "wb");
+	if(!file) {
+		SDL_Log("Couldn't create %s\n", filename);
+		return false;
+	}
+	fprintf(file, "# %dx%d UV sphere\n", gridSize, gridSize);
+	const float radius = 50.0f;
+	for(int j = 0; j < gridSize; ++j) {
+		float theta = (float)j / (gridSize - 1) * (float)M_PI;
+		for(int i = 0; i < gridSize; ++i) {
+			float phi = (float)i / (gridSize - 1) * 2.0f * (float)M_PI;
+			float normal[3] = {sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)};
+			fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+				normal[0] * radius, normal[1] * radius, normal[2] * radius,
+				(float)i / (gridSize - 1), 1.0f - (float)j / (gridSize - 1), normal[0], normal[1], normal[2]);
+		}
+	}
+	for(int j = 0; j + 1 < gridSize; ++j) {
+		for(int i = 0; i + 1 < gridSize; ++i) {
+			int a = j * gridSize + i + 1;
+			int b = a + gridSize;
+			fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, b + 1, b + 1, b + 1,
+				a + 1, a + 1, a + 1);
+		}
+	}
+	bool success = ferror(file) == 0;
+	success = fclose(file) == 0 && success;
+	if(!success) {
+		SDL_Log("Couldn't write %s\n", filename);
+	}
+	return success;
+}
+
+GLuint benchBufferCreate(GLenum target, const void *data, GLsizeiptr size) {
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(target, buffer);
+	glBufferData(target, size, data, GL_STATIC_DRAW);
+	glBindBuffer(target, 0);
+	
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		glDeleteBuffers(1, &buffer);
+		SDL_Log("Creating a buffer failed, code %u\n", err);
+		buffer = 0;
+	}
+	
+	return buffer;
+}
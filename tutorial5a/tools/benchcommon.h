@@ -0,0 +1,60 @@
+// benchcommon.h
+//
+// Helpers shared by the benchmark tools: an offscreen OpenGL ES 3 context
+// (so they run without a window, and on machines without a GPU), and test
+// files written to SDL's pref path.
+
+#ifndef __BENCHCOMMON_H__
+#define __BENCHCOMMON_H__
+
+#include <string>
+#include <GLES3/gl3.h>
+
+// The size of the offscreen framebuffer that drawing benchmarks render to
+const int BENCH_WIDTH = 640;
+const int BENCH_HEIGHT = 480;
+
+/** Creates an OpenGL ES 3 context without a window, and makes it current.
+ * 
+ * Tries Mesa's surfaceless platform first (no display server needed), and
+ * falls back to the default display with a 1x1 pbuffer. If width and height
+ * are given, a framebuffer object with colour and depth renderbuffers of
+ * that size is bound too, for benchmarks that draw.
+ * 
+ * @param width the framebuffer's width (0 for none)
+ * @param height the framebuffer's height (0 for none)
+ * 
+ * @return bool true if successful
+ */
+
+bool benchContextCreate(int width, int height);
+
+/** Gets a file's path in the pref path (or the current directory if there isn't one).
+ */
+
+std::string benchFilename(const char *name);
+
+/** Writes a UV sphere to an OBJ file, with its own texture coordinate and
+ * normal for every position (as scanners and most exporters do).
+ * 
+ * @param filename the file to write
+ * @param gridSize the number of positions along each side of the grid (600 gives a ~60 MB file)
+ * 
+ * @return bool true if successful
+ */
+
+bool benchSphereObjWrite(const char *filename, int gridSize);
+
+/** Creates a buffer object holding the given data (checking glGetError(),
+ * like the demo's vboCreate()/iboCreate()).
+ * 
+ * @param target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER
+ * @param data the data
+ * @param size the data's size in bytes
+ * 
+ * @return GLuint the buffer object, or 0 if failed
+ */
+
+GLuint benchBufferCreate(GLenum target, const void *data, GLsizeiptr size);
+
+#endif
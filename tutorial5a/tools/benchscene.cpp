@@ -0,0 +1,103 @@
+// benchscene.cpp
+//
+// See header file for details
+
+#include "benchscene.h"
+#include "benchcommon.h"
+#include "../samplercache.h"
+#include "../shader.h"
+#include "../texture.h"
+#include "../uniformblocks.h"
+
+#include <cmath>
+#include <cstddef>
+#include <SDL.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+bool benchSceneCreate(BenchScene *scene) {
+	scene->vbo = 0;
+	scene->ibo = 0;
+	scene->texture = 0;
+	scene->ubo = NULL;
+	scene->shaderProg = shaderProgLoad("texture.vert", "texture.frag");
+	if(!scene->shaderProg) {
+		return false;
+	}
+	glUseProgram(scene->shaderProg);
+	if(!uboBlockBind(scene->shaderProg, "FrameData", FRAME_BINDING) ||
+			!uboBlockBind(scene->shaderProg, "ObjectData", OBJECT_BINDING)) {
+		SDL_Log("ERROR: Couldn't find the FrameData and ObjectData uniform blocks.");
+		benchSceneDestroy(scene);
+		return false;
+	}
+	
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClearDepthf(1.0f);
+	
+	// The texture, on unit 0 with a trilinear sampler (texSampler defaults to unit 0)
+	scene->texture = texLoad("crate1_diffuse.png");
+	SamplerDesc samplerDesc = {GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT, GL_REPEAT, 1.0f};
+	GLuint sampler = samplerCacheGet(&samplerDesc);
+	if(!scene->texture || !sampler) {
+		benchSceneDestroy(scene);
+		return false;
+	}
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, scene->texture);
+	glBindSampler(0, sampler);
+	
+	// The cube
+	cubeCreate(100.0f, scene->vertices, scene->indices);
+	scene->vbo = benchBufferCreate(GL_ARRAY_BUFFER, scene->vertices, sizeof(scene->vertices));
+	scene->ibo = benchBufferCreate(GL_ELEMENT_ARRAY_BUFFER, scene->indices, sizeof(scene->indices));
+	if(!scene->vbo || !scene->ibo) {
+		benchSceneDestroy(scene);
+		return false;
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, scene->ibo);
+	glBindBuffer(GL_ARRAY_BUFFER, scene->vbo);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)0);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, texCoord));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const GLvoid*)offsetof(Vertex, normal));
+	glEnableVertexAttribArray(2);
+	
+	// The same pose, camera and light as the demo
+	scene->modelMat = glm::rotate(glm::mat4(1.0f), (float)M_PI / 4, glm::vec3(1.0f, 0.0f, 0.0f));
+	scene->modelMat = glm::rotate(scene->modelMat, (float)M_PI / 4, glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 viewMat = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -150.0f));
+	scene->mvMat = viewMat * scene->modelMat;
+	scene->projMat = glm::perspective(glm::radians(60.0f), (float)BENCH_WIDTH / (float)BENCH_HEIGHT, 1.0f, 1000.0f);
+	scene->lightPos = glm::vec3(50.0f, 80.0f, 150.0f);
+	scene->ambientCol = glm::vec3(0.15f, 0.15f, 0.15f);
+	scene->diffuseCol = glm::vec3(1.2f, 1.2f, 1.2f);
+	
+	scene->ubo = uboCreate(64 * 1024);
+	if(!scene->ubo || !uniformBlocksUpdate(scene->ubo, scene->projMat, &scene->lightPos, 1, scene->ambientCol,
+			scene->diffuseCol, scene->mvMat)) {
+		benchSceneDestroy(scene);
+		return false;
+	}
+	
+	return true;
+}
+
+void benchSceneDestroy(BenchScene *scene) {
+	glDeleteBuffers(1, &scene->vbo);
+	scene->vbo = 0;
+	glDeleteBuffers(1, &scene->ibo);
+	scene->ibo = 0;
+	if(scene->ubo) {
+		uboDestroy(scene->ubo);
+		scene->ubo = NULL;
+	}
+	texDestroy(scene->texture);
+	scene->texture = 0;
+	glBindSampler(0, 0);
+	samplerCacheShutdown();
+	shaderProgDestroy(scene->shaderProg);
+	scene->shaderProg = 0;
+}
@@ -0,0 +1,49 @@
+// benchscene.h
+//
+// The demo's scene (the textured, lit cube), set up for the benchmark tools
+// that draw it.
+
+#ifndef __BENCHSCENE_H__
+#define __BENCHSCENE_H__
+
+#include "../cube.h"
+#include "../uniformbuffer.h"
+
+#include <GLES3/gl3.h>
+#include <glm/glm.hpp>
+
+/** The cube and everything needed to draw it, as main.cpp sets it up.
+ */
+
+typedef struct BenchScene_s {
+	Vertex vertices[CUBE_NUM_VERTICES];
+	GLushort indices[CUBE_NUM_INDICES];
+	GLuint vbo;
+	GLuint ibo;
+	GLuint shaderProg;
+	GLuint texture;
+	UniformBuffer *ubo;
+	glm::mat4 modelMat;
+	glm::mat4 mvMat;
+	glm::mat4 projMat;
+	glm::vec3 lightPos;
+	glm::vec3 ambientCol;
+	glm::vec3 diffuseCol;
+} BenchScene;
+
+/** Creates the cube's buffers, shader program (texture.vert/.frag), texture
+ * and uniform blocks, and binds them all, ready for
+ * glDrawElements(GL_TRIANGLES, CUBE_NUM_INDICES, GL_UNSIGNED_SHORT, 0).
+ * NOTE: Needs a current context (see benchContextCreate()), and the shaders
+ * and crate1_diffuse.png in the current directory.
+ * 
+ * @param scene where to write the scene to (call benchSceneDestroy() when done)
+ * 
+ * @return bool true if successful
+ */
+
+bool benchSceneCreate(BenchScene *scene);
+
+void benchSceneDestroy(BenchScene *scene);
+
+#endif
@@ -0,0 +1,86 @@
+// decodebench.cpp
+//
+// Compares decoding many copies of an image one after the other with
+// IMG_Load() (as texLoad() does) and on an image decoding thread pool (see
+// imagedecode.h), from 1 thread up to one per CPU core. Needs no OpenGL
+// context.
+//
+// Usage: decodebench [images] [image]
+// Defaults to 64 copies of crate1_diffuse.png.
+
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include "../imagedecode.h"
+#include "../texture.h"
+
+/** Compares decoding many copies of an image one after the other on this
+ * thread (as texLoad() does) with decoding them on an image decoding thread
+ * pool (see imageDecodePoolCreate()), from 1 thread up to one per CPU core.
+ * 
+ * @param filename the image
+ * @param numImages the number of copies to decode
+ */
+
+static void imageDecodeBenchmark(const char *filename, int numImages) {
+	std::vector<const char*> filenames(numImages, filename);
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	if (!texImageLoadersInit()) {
+		return;
+	}
+	
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numImages; ++i) {
+		SDL_Surface *surface = IMG_Load(filename);
+		if (!surface) {
+			SDL_Log("Couldn't load %s\n", filename);
+			return;
+		}
+		SDL_FreeSurface(surface);
+	}
+	double serialMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+	SDL_Log("%d x %s: IMG_Load() on this thread %.1f ms (%.2f ms per image)\n",
+		numImages, filename, serialMs, serialMs / numImages);
+	
+	// 1, 2, 4, ... threads, and one per core
+	int numCores = SDL_GetCPUCount();
+	double oneThreadMs = 0.0;
+	for (int numThreads = 1; numThreads <= numCores; numThreads = numThreads < numCores && numThreads * 2 > numCores ?
+			numCores : numThreads * 2) {
+		ImageDecodePool *pool = imageDecodePoolCreate(numThreads, NULL, NULL);
+		if (!pool) {
+			return;
+		}
+		startTime = SDL_GetPerformanceCounter();
+		imageDecodeSubmit(pool, &filenames[0], filenames.size());
+		int numFailed = 0;
+		ImageDecodeResult result;
+		while (imageDecodeNext(pool, &result, true)) {
+			numFailed += result.surface == NULL;
+			SDL_FreeSurface(result.surface);
+		}
+		double totalMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+		imageDecodePoolDestroy(pool);
+		oneThreadMs = numThreads == 1 ? totalMs : oneThreadMs;
+		SDL_Log("  %2d thread(s): %.1f ms (%.2f ms per image), %.2fx one thread, %.2fx IMG_Load()%s\n",
+			numThreads, totalMs, totalMs / numImages, oneThreadMs / totalMs, serialMs / totalMs,
+			numFailed ? " (some failed)" : "");
+		if (numThreads == numCores) {
+			break;
+		}
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	int numImages = argc > 1 ? atoi(argv[1]) : 64;
+	const char *filename = argc > 2 ? argv[2] : "crate1_diffuse.png";
+	
+	imageDecodeBenchmark(filename, numImages > 0 ? numImages : 1);
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+// embedshaders.cpp
+//
+// Build step that turns shader source files into a constexpr string table,
+// so that shaderProgLoadEmbedded() can build programs without touching the
+// filesystem. Rerun it whenever a shader changes.
+//
+// Usage: embedshaders output.h files...
+// e.g.: embedshaders embeddedshaders.h texture.vert texture.frag
+//
+// Each file is stored under the path it's given by (with '/' separators), so
+// run this from the shaders' directory (e.g., "common/lighting.glsl" is
+// found by #include "common/lighting.glsl").
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996) // Allows to use the portable fopen() function without warnings in in MVS
+#endif
+
+/** Reads a whole file.
+ * 
+ * @return bool true if successful
+ */
+
+static bool fileRead(const char *filename, std::string *contents) {
+	FILE *file = fopen(filename, "rb");
+	if(!file) {
+		fprintf(stderr, "Can't open file: %s\n", filename);
+		return false;
+	}
+	
+	char buffer[4096];
+	size_t numRead;
+	while((numRead = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		contents->append(buffer, numRead);
+	}
+	bool success = !ferror(file);
+	fclose(file);
+	
+	return success;
+}
+
+/** Gets a path's file name (after the last directory separator).
+ */
+
+static const char *baseName(const char *path) {
+	const char *name = path;
+	for(const char *c = path; *c; ++c) {
+		if(*c == '/' || *c == '\\') {
+			name = c + 1;
+		}
+	}
+	
+	return name;
+}
+
+/** Gets the name a file is embedded under (its path, with '/' separators).
+ */
+
+static std::string embeddedName(const char *path) {
+	std::string name = path;
+	for(char &c : name) {
+		if(c == '\\') {
+			c = '/';
+		}
+	}
+	if(name.compare(0, 2, "./") == 0) {
+		name.erase(0, 2);
+	}
+	
+	return name;
+}
+
+/** Writes a file's contents as C++ string literals, one per line.
+ */
+
+static void stringLiteralWrite(FILE *out, const std::string &contents) {
+	fprintf(out, "\t\t\"");
+	char prev = '\0';
+	for(size_t i = 0; i < contents.length(); ++i) {
+		char c = contents[i];
+		if(prev == '\n') {
+			fprintf(out, "\n\t\t\"");
+		}
+		
+		switch(c) {
+			case '\\': fputs("\\\\", out); break;
+			case '"': fputs("\\\"", out); break;
+			case '\t': fputs("\\t", out); break;
+			case '\r': fputs("\\r", out); break;
+			case '\n': fputs("\\n\"", out); break;
+			case '?':
+				// Keep "??" from being read as a trigraph by older compilers
+				fputs(prev == '?' ? "\\?" : "?", out);
+				break;
+			default:
+				if((unsigned char)c < 0x20 || (unsigned char)c >= 0x7F) {
+					// Always three digits, so a following digit isn't taken as part of it
+					fprintf(out, "\\%03o", (unsigned char)c);
+				}
+				else {
+					fputc(c, out);
+				}
+		}
+		prev = c;
+	}
+	if(prev != '\n') {
+		fputc('"', out);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	if(argc < 3) {
+		fprintf(stderr, "Usage: embedshaders output.h files...\n");
+		return EXIT_FAILURE;
+	}
+	
+	// Write to a temporary file first, so that a failed run doesn't leave a
+	// half-written table behind
+	std::string outFilename = argv[1];
+	std::string tmpFilename = outFilename + ".tmp";
+	FILE *out = fopen(tmpFilename.c_str(), "wb");
+	if(!out) {
+		fprintf(stderr, "Can't open file: %s\n", tmpFilename.c_str());
+		return EXIT_FAILURE;
+	}
+	
+	fprintf(out, "// %s\n", baseName(argv[1]));
+	fprintf(out, "//\n// Generated by tools/embedshaders.cpp. Don't edit; rerun the tool instead.\n\n");
+	fprintf(out, "#ifndef __EMBEDDEDSHADERS_H__\n#define __EMBEDDEDSHADERS_H__\n\n");
+	fprintf(out, "#include \"shaderembed.h\"\n\n");
+	fprintf(out, "static constexpr EmbeddedShader embeddedShaders[] = {\n");
+	
+	bool success = true;
+	for(int i = 2; i < argc; ++i) {
+		std::string contents;
+		if(!fileRead(argv[i], &contents)) {
+			success = false;
+			break;
+		}
+		
+		fprintf(out, "\t{\"%s\",\n", embeddedName(argv[i]).c_str());
+		stringLiteralWrite(out, contents);
+		fprintf(out, ",\n\t\t%lu}%s\n", (unsigned long)contents.length(), i + 1 < argc ? "," : "");
+	}
+	
+	fprintf(out, "};\n\n#endif\n");
+	success &= !ferror(out);
+	success &= fclose(out) == 0;
+	
+	if(!success || rename(tmpFilename.c_str(), outFilename.c_str()) != 0) {
+		// NOTE: rename() won't replace an existing file on Windows
+		if(success && remove(outFilename.c_str()) == 0 &&
+				rename(tmpFilename.c_str(), outFilename.c_str()) == 0) {
+			return EXIT_SUCCESS;
+		}
+		fprintf(stderr, "Couldn't write %s\n", outFilename.c_str());
+		remove(tmpFilename.c_str());
+		return EXIT_FAILURE;
+	}
+	
+	return EXIT_SUCCESS;
+}
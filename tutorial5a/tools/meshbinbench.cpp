@@ -0,0 +1,113 @@
+// meshbinbench.cpp
+//
+// Compares loading a mesh from a Wavefront OBJ file (parsing, welding and
+// uploading each submesh) with loading it cooked by meshBinCook() (see
+// meshbin.h), in each vertex format, in an offscreen context (see
+// benchContextCreate()).
+//
+// Usage: meshbinbench [file.obj]
+// Without a file, writes a ~60 MB sphere to the pref path and uses that.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../meshbin.h"
+#include "../objload.h"
+#include "../vertexformat.h"
+#include "benchcommon.h"
+
+/** Compares loading a mesh from an OBJ file (parsing, welding and uploading
+ * each submesh) with loading it cooked (meshBinLoad()), in each vertex format.
+ * 
+ * @param filename the OBJ file (NULL to write a ~60 MB sphere to the pref path and use that)
+ * @param loads the number of times to load each
+ */
+
+static void meshBinBenchmark(const char *filename, int loads) {
+	std::string sphereFilename = benchFilename("sphere.obj");
+	if (!filename) {
+		filename = sphereFilename.c_str();
+		if (!benchSphereObjWrite(filename, 600)) {
+			return;
+		}
+	}
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	// The OBJ path, as a game would load it
+	ObjMesh mesh;
+	double objMs = 0.0;
+	for (int i = 0; i < loads; ++i) {
+		Uint64 startTime = SDL_GetPerformanceCounter();
+		if (!objLoad(filename, 0, &mesh, NULL)) {
+			return;
+		}
+		std::vector<GLuint> buffers;
+		for (GLuint j = 0; j < mesh.numSubmeshes; ++j) {
+			const ObjSubmesh &submesh = mesh.submeshes[j];
+			buffers.push_back(benchBufferCreate(GL_ARRAY_BUFFER, &mesh.vertices[submesh.baseVertex],
+				submesh.numVertices * sizeof(Vertex)));
+			buffers.push_back(benchBufferCreate(GL_ELEMENT_ARRAY_BUFFER, &mesh.indices[submesh.firstIndex],
+				submesh.numIndices * sizeof(GLushort)));
+		}
+		glFinish();
+		objMs += (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+		glDeleteBuffers((GLsizei)buffers.size(), &buffers[0]);
+		if (i + 1 < loads) {
+			objMeshFree(&mesh);
+		}
+	}
+	objMs /= loads;
+	SDL_Log("%s: %u vertices, %u indices; objLoad() + upload %.1f ms\n", filename, mesh.numVertices,
+		mesh.numIndices, objMs);
+	
+	// Cook it, with indices into all of the vertices
+	std::vector<GLuint> indices(mesh.numIndices);
+	std::vector<MeshBinSubmesh> submeshes(mesh.numSubmeshes);
+	objMeshAbsoluteIndices(&mesh, &indices[0], &submeshes[0]);
+	const VertexFormat formats[] = {VERTEX_FORMAT_FLOAT, VERTEX_FORMAT_SNORM16_OCT8, VERTEX_FORMAT_HALF_1010102};
+	const char *formatNames[] = {"float", "snorm16 + oct8 normals", "half + 10:10:10:2 normals"};
+	for (int f = 0; f < 3; ++f) {
+		std::string cookedFilename = benchFilename("sphere.mesh");
+		if (!meshBinCook(cookedFilename.c_str(), formats[f], mesh.vertices, mesh.numVertices, &indices[0],
+				mesh.numIndices, &submeshes[0], (GLuint)submeshes.size())) {
+			break;
+		}
+		
+		// Load it once first, so the file is in the OS's cache for both paths
+		MeshBinBuffers buffers;
+		double loadMs = 0.0;
+		size_t bufferBytes = 0;
+		for (int i = -1; i < loads; ++i) {
+			Uint64 startTime = SDL_GetPerformanceCounter();
+			if (!meshBinLoad(cookedFilename.c_str(), &buffers)) {
+				break;
+			}
+			glFinish();
+			loadMs += i >= 0 ? (SDL_GetPerformanceCounter() - startTime) * msPerTick : 0.0;
+			bufferBytes = (size_t)buffers.numVertices * vertexFormatSize(buffers.vertexFormat) +
+				buffers.numIndices * (buffers.indexType == GL_UNSIGNED_INT ? 4 : 2);
+			meshBinBuffersFree(&buffers);
+		}
+		loadMs /= loads;
+		SDL_Log("  Cooked, %s: %.1f MB of buffer data, meshBinLoad() %.1f ms (%.0f MB/s, %.1fx faster)\n",
+			formatNames[f], bufferBytes / 1.0e6, loadMs, bufferBytes / (loadMs * 1000.0), objMs / loadMs);
+		remove(cookedFilename.c_str());
+	}
+	objMeshFree(&mesh);
+}
+
+
+int main(int argc, char *argv[]) {
+	if(!benchContextCreate(0, 0)) {
+		return EXIT_FAILURE;
+	}
+	
+	meshBinBenchmark(argc > 1 ? argv[1] : NULL, 5);
+	
+	return EXIT_SUCCESS;
+}
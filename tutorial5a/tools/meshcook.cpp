@@ -0,0 +1,140 @@
+// meshcook.cpp
+//
+// Offline mesh cooker. Converts a Wavefront OBJ file (see objLoad()), or the
+// demo's cube, to the cooked binary format that meshBinLoad() memory-maps and
+// uploads as is (see meshbin.h).
+//
+// Formats (-f):
+//   float    32-byte vertices, as in Vertex
+//   snorm16  16-byte vertices; normalized shorts and octahedral normals
+//   half     16-byte vertices; half floats and 10:10:10:2 normals
+//
+// Usage: meshcook [-f float|snorm16|half] [-j threads] [-O] input.obj|-cube output.mesh
+//   -f     the vertex format (default: float)
+//   -j     the number of OBJ parser threads (default: one per CPU core)
+//   -O     reorder the triangles and vertices for the vertex cache, overdraw
+//          and vertex fetches (see meshopt.h)
+//   -cube  cook the demo's cube (see cubeCreate()) instead of an OBJ file
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../cube.h"
+#include "../meshbin.h"
+#include "../meshopt.h"
+#include "../objload.h"
+
+int main(int argc, char *argv[]) {
+	VertexFormat format = VERTEX_FORMAT_FLOAT;
+	int numThreads = 0;
+	bool cube = false;
+	bool optimize = false;
+	bool badArgs = false;
+	const char *inFilename = NULL;
+	const char *outFilename = NULL;
+	for(int i = 1; i < argc; ++i) {
+		if(strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			++i;
+			if(strcmp(argv[i], "float") == 0) {
+				format = VERTEX_FORMAT_FLOAT;
+			}
+			else if(strcmp(argv[i], "snorm16") == 0) {
+				format = VERTEX_FORMAT_SNORM16_OCT8;
+			}
+			else if(strcmp(argv[i], "half") == 0) {
+				format = VERTEX_FORMAT_HALF_1010102;
+			}
+			else {
+				badArgs = true;
+			}
+		}
+		else if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			numThreads = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-O") == 0) {
+			optimize = true;
+		}
+		else if(strcmp(argv[i], "-cube") == 0 && !inFilename) {
+			cube = true;
+			inFilename = "cube";
+		}
+		else if(!inFilename) {
+			inFilename = argv[i];
+		}
+		else {
+			outFilename = argv[i];
+		}
+	}
+	if(badArgs || !inFilename || !outFilename) {
+		fprintf(stderr, "Usage: meshcook [-f float|snorm16|half] [-j threads] [-O] input.obj|-cube output.mesh\n");
+		return EXIT_FAILURE;
+	}
+	
+	// Gather the vertices, with indices into all of them (OBJ submeshes' are relative to their baseVertex)
+	std::vector<Vertex> vertices;
+	std::vector<GLuint> indices;
+	std::vector<MeshBinSubmesh> submeshes;
+	if(cube) {
+		Vertex cubeVertices[CUBE_NUM_VERTICES];
+		GLushort cubeIndices[CUBE_NUM_INDICES];
+		cubeCreate(100.0f, cubeVertices, cubeIndices);
+		vertices.assign(cubeVertices, cubeVertices + CUBE_NUM_VERTICES);
+		indices.assign(cubeIndices, cubeIndices + CUBE_NUM_INDICES);
+		MeshBinSubmesh submesh = {0, CUBE_NUM_INDICES, 0, CUBE_NUM_VERTICES - 1};
+		submeshes.push_back(submesh);
+	}
+	else {
+		ObjMesh mesh;
+		if(!objLoad(inFilename, numThreads, &mesh, NULL)) {
+			return EXIT_FAILURE;
+		}
+		vertices.assign(mesh.vertices, mesh.vertices + mesh.numVertices);
+		indices.resize(mesh.numIndices);
+		submeshes.resize(mesh.numSubmeshes);
+		objMeshAbsoluteIndices(&mesh, &indices[0], &submeshes[0]);
+		objMeshFree(&mesh);
+	}
+	
+	// Each submesh is reordered on its own, then the vertices are put in the order they're first used
+	if(optimize) {
+		MeshOptStats before = meshOptAnalyze(&indices[0], indices.size(), vertices.size(), MESH_OPT_CACHE_SIZE);
+		for(const MeshBinSubmesh &submesh : submeshes) {
+			// Only pass the submesh's own vertices, or every submesh would cost as much as the whole mesh
+			GLuint *submeshIndices = &indices[submesh.firstIndex];
+			size_t numSubmeshVertices = submesh.maxVertex - submesh.minVertex + 1;
+			for(GLuint i = 0; i < submesh.numIndices; ++i) {
+				submeshIndices[i] -= submesh.minVertex;
+			}
+			meshOptVertexCache(submeshIndices, submesh.numIndices, numSubmeshVertices, MESH_OPT_CACHE_SIZE);
+			meshOptOverdraw(submeshIndices, submesh.numIndices, vertices[submesh.minVertex].position, sizeof(Vertex),
+				numSubmeshVertices, MESH_OPT_CACHE_SIZE, 1.05f);
+			for(GLuint i = 0; i < submesh.numIndices; ++i) {
+				submeshIndices[i] += submesh.minVertex;
+			}
+		}
+		vertices.resize(meshOptVertexFetch(&indices[0], indices.size(), &vertices[0], vertices.size(),
+			sizeof(Vertex)));
+		MeshOptStats after = meshOptAnalyze(&indices[0], indices.size(), vertices.size(), MESH_OPT_CACHE_SIZE);
+		printf("Optimized: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f (%d-entry FIFO cache)\n", before.acmr, after.acmr,
+			before.atvr, after.atvr, MESH_OPT_CACHE_SIZE);
+	}
+	
+	if(!meshBinCook(outFilename, format, &vertices[0], (GLuint)vertices.size(), &indices[0], (GLuint)indices.size(),
+			&submeshes[0], (GLuint)submeshes.size())) {
+		return EXIT_FAILURE;
+	}
+	
+	size_t vertexSize = vertexFormatSize(format);
+	size_t indexSize = vertices.size() > 65536 ? sizeof(GLuint) : sizeof(GLushort);
+	printf("%s: %u vertices (%u bytes each), %u %d-bit indices, %u submesh(es), %lu bytes of buffer data\n",
+		outFilename, (unsigned int)vertices.size(), (unsigned int)vertexSize, (unsigned int)indices.size(),
+		(int)indexSize * 8, (unsigned int)submeshes.size(),
+		(unsigned long)(vertices.size() * vertexSize + indices.size() * indexSize));
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+// meshoptbench.cpp
+//
+// Measures how many vertex shader runs meshOptVertexCache(), meshOptOverdraw()
+// and meshOptVertexFetch() save (see meshopt.h), on a mesh in its authoring
+// order and with its triangles shuffled, and on the cube. Draws offscreen
+// (see benchContextCreate()), so it runs without a window.
+//
+// Usage: meshoptbench [file.obj]
+// Without a file, writes a ~60 MB sphere to the pref path and uses that.
+// Run it from the tutorial5a directory (it loads the shaders).
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../meshopt.h"
+#include "../objload.h"
+#include "../shadervariant.h"
+#include "../uniformblocks.h"
+#include "../vertexformat.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Times drawing a mesh's triangles with the vertex shader only (the
+ * rasterizer discards them). NOTE: Expects the mesh's buffers to be bound,
+ * and a program using them.
+ * 
+ * @return double the average time per draw, in milliseconds
+ */
+
+static double meshDrawTime(GLsizei numIndices, int draws) {
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	glEnable(GL_RASTERIZER_DISCARD);
+	glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, (const GLvoid*)0); // Warm up
+	glFinish();
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	for (int d = 0; d < draws; ++d) {
+		glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, (const GLvoid*)0);
+	}
+	glFinish();
+	glDisable(GL_RASTERIZER_DISCARD);
+	return (SDL_GetPerformanceCounter() - startTime) * msPerTick / draws;
+}
+
+/** Measures how many vertex shader runs meshOptVertexCache(), meshOptOverdraw()
+ * and meshOptVertexFetch() save, on a mesh in its authoring order and with
+ * its triangles shuffled (as scanned meshes often are), and on the cube.
+ * 
+ * @param filename the OBJ file (NULL to write a ~60 MB sphere to the pref path and use that)
+ * @param draws the number of times to draw each order
+ */
+
+static void meshOptBenchmark(const char *filename, int draws) {
+	std::string sphereFilename = benchFilename("sphere.obj");
+	if (!filename) {
+		filename = sphereFilename.c_str();
+		if (!benchSphereObjWrite(filename, 600)) {
+			return;
+		}
+	}
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	// The cube's sides share no vertices, so there's nothing for the cache to reuse
+	Vertex cubeVertices[CUBE_NUM_VERTICES];
+	GLushort cubeIndices[CUBE_NUM_INDICES];
+	cubeCreate(100.0f, cubeVertices, cubeIndices);
+	std::vector<GLuint> indices(cubeIndices, cubeIndices + CUBE_NUM_INDICES);
+	MeshOptStats before = meshOptAnalyze(&indices[0], indices.size(), CUBE_NUM_VERTICES, MESH_OPT_CACHE_SIZE);
+	meshOptVertexCache(&indices[0], indices.size(), CUBE_NUM_VERTICES, MESH_OPT_CACHE_SIZE);
+	meshOptOverdraw(&indices[0], indices.size(), cubeVertices[0].position, sizeof(Vertex), CUBE_NUM_VERTICES,
+		MESH_OPT_CACHE_SIZE, 1.05f);
+	MeshOptStats after = meshOptAnalyze(&indices[0], indices.size(), CUBE_NUM_VERTICES, MESH_OPT_CACHE_SIZE);
+	SDL_Log("Cube: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+	
+	// The mesh, with indices into all of the vertices
+	ObjMesh mesh;
+	if (!objLoad(filename, 0, &mesh, NULL)) {
+		return;
+	}
+	std::vector<Vertex> meshVertices(mesh.vertices, mesh.vertices + mesh.numVertices);
+	std::vector<GLuint> meshIndices(mesh.numIndices);
+	objMeshAbsoluteIndices(&mesh, &meshIndices[0], NULL);
+	objMeshFree(&mesh);
+	
+	const ShaderFeature features[] = {{"VERTEX_FORMAT", 2}};
+	ShaderVariants *variants = shaderVariantsCreate("texture.vert", "texture.frag", features, 1);
+	if (!variants) {
+		return;
+	}
+	unsigned int values[1] = {VERTEX_FORMAT_FLOAT};
+	GLuint shaderProg = shaderVariantGet(variants, shaderVariantMask(variants, values));
+	glUseProgram(shaderProg);
+	uboBlockBind(shaderProg, "FrameData", FRAME_BINDING);
+	uboBlockBind(shaderProg, "ObjectData", OBJECT_BINDING);
+	GLuint buffers[2];
+	glGenBuffers(2, buffers);
+	glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+	
+	const char *orderNames[] = {"authoring order", "shuffled triangles"};
+	for (int order = 0; order < 2; ++order) {
+		std::vector<Vertex> vertices = meshVertices;
+		indices = meshIndices;
+		if (order == 1) {
+			srand(1);
+			for (size_t t = indices.size() / 3 - 1; t > 0; --t) {
+				size_t other = ((size_t)rand() * ((size_t)RAND_MAX + 1) + rand()) % (t + 1);
+				for (int c = 0; c < 3; ++c) {
+					std::swap(indices[t * 3 + c], indices[other * 3 + c]);
+				}
+			}
+		}
+		
+		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+		vertexFormatAttribsSet(VERTEX_FORMAT_FLOAT, 0, 1, 2, 0);
+		double beforeMs = meshDrawTime((GLsizei)indices.size(), draws);
+		before = meshOptAnalyze(&indices[0], indices.size(), vertices.size(), MESH_OPT_CACHE_SIZE);
+		
+		Uint64 startTime = SDL_GetPerformanceCounter();
+		meshOptVertexCache(&indices[0], indices.size(), vertices.size(), MESH_OPT_CACHE_SIZE);
+		Uint64 cacheTime = SDL_GetPerformanceCounter();
+		MeshOptStats cacheOnly = meshOptAnalyze(&indices[0], indices.size(), vertices.size(), MESH_OPT_CACHE_SIZE);
+		meshOptOverdraw(&indices[0], indices.size(), vertices[0].position, sizeof(Vertex), vertices.size(),
+			MESH_OPT_CACHE_SIZE, 1.05f);
+		Uint64 overdrawTime = SDL_GetPerformanceCounter();
+		size_t numVertices = meshOptVertexFetch(&indices[0], indices.size(), &vertices[0], vertices.size(),
+			sizeof(Vertex));
+		Uint64 endTime = SDL_GetPerformanceCounter();
+		after = meshOptAnalyze(&indices[0], indices.size(), numVertices, MESH_OPT_CACHE_SIZE);
+		
+		glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
+		double afterMs = meshDrawTime((GLsizei)indices.size(), draws);
+		
+		SDL_Log("%s, %s: %u triangles; optimized in %.1f ms (cache %.1f, overdraw %.1f, fetch %.1f)\n", filename,
+			orderNames[order], (unsigned int)(indices.size() / 3), (endTime - startTime) * msPerTick,
+			(cacheTime - startTime) * msPerTick, (overdrawTime - cacheTime) * msPerTick,
+			(endTime - overdrawTime) * msPerTick);
+		SDL_Log("  ACMR %.3f -> %.3f (%.3f before the overdraw pass), ATVR %.3f -> %.3f\n", before.acmr,
+			after.acmr, cacheOnly.acmr, before.atvr, after.atvr);
+		SDL_Log("  Vertex shader runs (%d-entry FIFO): %u -> %u (%.0f%% saved); draw %.2f ms -> %.2f ms\n",
+			MESH_OPT_CACHE_SIZE, (unsigned int)before.vertexShaderRuns, (unsigned int)after.vertexShaderRuns,
+			100.0 * (1.0 - (double)after.vertexShaderRuns / before.vertexShaderRuns), beforeMs, afterMs);
+	}
+	
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glDeleteBuffers(2, buffers);
+	shaderVariantsDestroy(variants);
+}
+
+
+int main(int argc, char *argv[]) {
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	
+	// For its uniform blocks
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	
+	meshOptBenchmark(argc > 1 ? argv[1] : NULL, 10);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+// mipbench.cpp
+//
+// Compares drawing a heavily minified texture with no mipmaps, with
+// glGenerateMipmap()'s, and with the CPU-built chain (mipmapChainBuild()),
+// and how long loading the texture takes each way. Draws offscreen (see
+// benchContextCreate()), so it runs without a window.
+//
+// Usage: mipbench [frames]
+// Defaults to 100 frames for each texture. Run it from the tutorial5a
+// directory (it loads the shaders and crate1_diffuse.png).
+
+#include <cmath>
+#include <cstdlib>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../texture.h"
+#include "../uniformblocks.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Compares drawing a heavily minified texture with and without mipmaps, and
+ * how long loading the texture takes with each way of building them.
+ * 
+ * The screen is filled with a grid of far-away cubes (each about 30 pixels
+ * across, so the texture is minified about 16 times), drawn several times
+ * over each frame with depth testing off. NOTE: Expects the cube's buffers,
+ * vertex attributes and shader program to be bound already.
+ * 
+ * @param numIndices the cube's number of indices
+ * @param frames the number of frames to time for each texture
+ */
+
+static void textureMipmapBenchmark(GLsizei numIndices, const glm::mat4 &modelMat, const glm::vec3 &lightPos,
+		const glm::vec3 &ambientCol, const glm::vec3 &diffuseCol, int frames) {
+	const TexMipmapMode modes[] = {TEX_MIPMAP_NONE, TEX_MIPMAP_GL, TEX_MIPMAP_CPU};
+	const char *modeNames[] = {"No mipmaps", "glGenerateMipmap()", "CPU mipmaps"};
+	const int numModes = sizeof(modes) / sizeof(modes[0]);
+	const int loads = 10;
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	// Time loading (the difference from "No mipmaps" is the cost of building the chain)
+	GLuint textures[numModes];
+	double loadMs[numModes];
+	for (int m = 0; m < numModes; ++m) {
+		textures[m] = 0;
+		Uint64 startTime = SDL_GetPerformanceCounter();
+		for (int i = 0; i < loads; ++i) {
+			texDestroy(textures[m]);
+			textures[m] = texLoadMipmapped("crate1_diffuse.png", modes[m]);
+			glFinish();
+		}
+		loadMs[m] = (SDL_GetPerformanceCounter() - startTime) * msPerTick / loads;
+	}
+	
+	// Set up the grid of cubes, with all of their uniform blocks in one upload
+	const int gridWidth = 20;
+	const int gridHeight = 15;
+	const float cubeSpacing = 100.0f;
+	const float distance = cubeSpacing * gridHeight / 2.0f / tanf(glm::radians(30.0f));
+	UniformBuffer *ubo = uboCreate(256 * 1024);
+	if (!ubo) {
+		for (int m = 0; m < numModes; ++m) {
+			texDestroy(textures[m]);
+		}
+		return;
+	}
+	uboBegin(ubo);
+	GLintptr frameOffset = 0;
+	FrameUniforms *frame = (FrameUniforms*)uboAlloc(ubo, sizeof(FrameUniforms), &frameOffset);
+	GLintptr objectOffsets[gridWidth * gridHeight];
+	bool allocated = frame != NULL;
+	if (frame) {
+		frame->projMat = glm::perspective(glm::radians(60.0f), (float)BENCH_WIDTH / (float)BENCH_HEIGHT,
+			1.0f, distance * 2.0f);
+		frame->lightPos[0] = glm::vec4(lightPos, 1.0f);
+		for (int i = 1; i < MAX_LIGHTS; ++i) {
+			frame->lightPos[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		}
+		frame->ambientCol = glm::vec4(ambientCol, 0.0f);
+		frame->diffuseCol = glm::vec4(diffuseCol, 0.0f);
+	}
+	for (int y = 0; y < gridHeight && allocated; ++y) {
+		for (int x = 0; x < gridWidth; ++x) {
+			ObjectUniforms *object = (ObjectUniforms*)uboAlloc(ubo, sizeof(ObjectUniforms),
+				&objectOffsets[y * gridWidth + x]);
+			if (!object) {
+				allocated = false;
+				break;
+			}
+			glm::vec3 pos((x - (gridWidth - 1) / 2.0f) * cubeSpacing, (y - (gridHeight - 1) / 2.0f) * cubeSpacing,
+				-distance);
+			object->mvMat = glm::translate(glm::mat4(1.0f), pos) * modelMat;
+			object->normalMat = glm::inverseTranspose(object->mvMat);
+		}
+	}
+	if (allocated) {
+		uboUpload(ubo);
+		uboBindRange(ubo, FRAME_BINDING, frameOffset, sizeof(FrameUniforms));
+		
+		const int layers = 4;
+		glDisable(GL_DEPTH_TEST);
+		for (int m = 0; m < numModes; ++m) {
+			if (!textures[m]) {
+				continue;
+			}
+			glBindTexture(GL_TEXTURE_2D, textures[m]);
+			
+			// Warm up
+			glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+			glFinish();
+			
+			Uint64 startTime = SDL_GetPerformanceCounter();
+			for (int f = 0; f < frames; ++f) {
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				for (int l = 0; l < layers; ++l) {
+					for (GLintptr objectOffset : objectOffsets) {
+						uboBindRange(ubo, OBJECT_BINDING, objectOffset, sizeof(ObjectUniforms));
+						glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+					}
+				}
+				glFinish();
+			}
+			double frameMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick / frames;
+			
+			SDL_Log("%s: load %.3f ms, draw %.3f ms/frame\n", modeNames[m], loadMs[m], frameMs);
+		}
+		glEnable(GL_DEPTH_TEST);
+	}
+	
+	uboDestroy(ubo);
+	for (int m = 0; m < numModes; ++m) {
+		texDestroy(textures[m]);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	int frames = argc > 1 ? atoi(argv[1]) : 100;
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	
+	textureMipmapBenchmark(CUBE_NUM_INDICES, scene.modelMat, scene.lightPos, scene.ambientCol, scene.diffuseCol,
+		frames > 0 ? frames : 1);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+// objbench.cpp
+//
+// Times loading a Wavefront OBJ file with objLoad() on 1, 2, 4, ... threads
+// (up to one per CPU core), and uploading its submeshes, in an offscreen
+// context (see benchContextCreate()).
+//
+// Usage: objbench [file.obj]
+// Without a file, writes a ~60 MB sphere to the pref path and loads that.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../objload.h"
+#include "benchcommon.h"
+
+/** Loads an OBJ file with 1, 2, 4, ... threads (up to one per core), and
+ * uploads its submeshes.
+ * 
+ * @param filename the OBJ file (NULL to write a ~60 MB sphere to the pref path and load that)
+ */
+
+static void objLoadBenchmark(const char *filename) {
+	std::string sphereFilename = benchFilename("sphere.obj");
+	if (!filename) {
+		filename = sphereFilename.c_str();
+		if (!benchSphereObjWrite(filename, 600)) {
+			return;
+		}
+	}
+	
+	int numCores = SDL_GetCPUCount();
+	double oneThreadMs = 0.0;
+	for (int numThreads = 1; numThreads <= numCores; numThreads = numThreads < numCores && numThreads * 2 > numCores ?
+			numCores : numThreads * 2) {
+		ObjMesh mesh;
+		ObjLoadStats stats;
+		if (!objLoad(filename, numThreads, &mesh, &stats)) {
+			return;
+		}
+		double totalMs = stats.parseMs + stats.weldMs;
+		oneThreadMs = numThreads == 1 ? totalMs : oneThreadMs;
+		SDL_Log("%2d thread(s) (%d chunks): %.1f MB in %.1f ms (parse %.1f ms, weld %.1f ms), %.0f MB/s, "
+			"%.2fx one thread\n", numThreads, stats.numThreads, stats.fileBytes / 1.0e6, totalMs, stats.parseMs,
+			stats.weldMs, stats.fileBytes / (totalMs * 1000.0), oneThreadMs / totalMs);
+		
+		if (numThreads == 1) {
+			SDL_Log("  %u positions, %u texCoords, %u normals, %u triangles -> %u vertices, %u indices, "
+				"%u submeshes\n", (unsigned int)stats.numPositions, (unsigned int)stats.numTexCoords,
+				(unsigned int)stats.numNormals, (unsigned int)stats.numTriangles, mesh.numVertices,
+				mesh.numIndices, mesh.numSubmeshes);
+			
+			Uint64 startTime = SDL_GetPerformanceCounter();
+			std::vector<GLuint> buffers;
+			for (GLuint i = 0; i < mesh.numSubmeshes; ++i) {
+				const ObjSubmesh &submesh = mesh.submeshes[i];
+				buffers.push_back(benchBufferCreate(GL_ARRAY_BUFFER, &mesh.vertices[submesh.baseVertex],
+					submesh.numVertices * sizeof(Vertex)));
+				buffers.push_back(benchBufferCreate(GL_ELEMENT_ARRAY_BUFFER, &mesh.indices[submesh.firstIndex],
+					submesh.numIndices * sizeof(GLushort)));
+			}
+			glFinish();
+			SDL_Log("  Uploading the submeshes took %.1f ms\n",
+				(SDL_GetPerformanceCounter() - startTime) * 1000.0 / (double)SDL_GetPerformanceFrequency());
+			glDeleteBuffers((GLsizei)buffers.size(), &buffers[0]);
+		}
+		objMeshFree(&mesh);
+		if (numThreads == numCores) {
+			break;
+		}
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	if(!benchContextCreate(0, 0)) {
+		return EXIT_FAILURE;
+	}
+	
+	objLoadBenchmark(argc > 1 ? argv[1] : NULL);
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+// registrybench.cpp
+//
+// Compares loading a texture for many objects with texLoad() (a copy each)
+// and with the texture registry (one shared copy; see textureregistry.h), in
+// an offscreen context (see benchContextCreate()).
+//
+// Usage: registrybench [objects] [image]
+// Defaults to 100 objects using crate1_diffuse.png.
+
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../texture.h"
+#include "../textureregistry.h"
+#include "benchcommon.h"
+
+/** Compares loading a texture for many objects with texLoad() (a copy each)
+ * and with the texture registry (one shared copy).
+ * 
+ * @param filename the image to load
+ * @param numObjects the number of objects that use it
+ */
+
+static void textureRegistryBenchmark(const char *filename, int numObjects) {
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	std::vector<GLuint> textures(numObjects, 0);
+	
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numObjects; ++i) {
+		textures[i] = texLoad(filename);
+	}
+	glFinish();
+	double loadMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+	for (int i = 0; i < numObjects; ++i) {
+		texDestroy(textures[i]);
+	}
+	
+	texRegistryStatsReset();
+	startTime = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numObjects; ++i) {
+		textures[i] = texRegistryAcquire(filename, NULL);
+	}
+	glFinish();
+	double registryMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+	TexRegistryStats stats = texRegistryStatsGet();
+	for (int i = 0; i < numObjects; ++i) {
+		texRegistryRelease(textures[i]);
+	}
+	unsigned int numPurged = texRegistryPurge();
+	
+	SDL_Log("%d objects using %s: texLoad() %.1f ms (%d textures), registry %.1f ms "
+		"(%u texture(s), %u refs, %u hits, %u misses; %u purged)\n",
+		numObjects, filename, loadMs, numObjects, registryMs, stats.numTextures, stats.numRefs,
+		stats.hits, stats.misses, numPurged);
+}
+
+
+int main(int argc, char *argv[]) {
+	int numObjects = argc > 1 ? atoi(argv[1]) : 100;
+	const char *filename = argc > 2 ? argv[2] : "crate1_diffuse.png";
+	if(!benchContextCreate(0, 0)) {
+		return EXIT_FAILURE;
+	}
+	
+	textureRegistryBenchmark(filename, numObjects > 0 ? numObjects : 1);
+	texRegistryShutdown();
+	
+	return EXIT_SUCCESS;
+}
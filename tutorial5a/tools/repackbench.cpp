@@ -0,0 +1,125 @@
+// repackbench.cpp
+//
+// Compares texCreateFromSurface() (repacking to RGBA8 with pixelRepack() where
+// needed) with uploading SDL surfaces' pixels as they are and fixing the
+// channel order with swizzles, for common SDL pixel layouts, in an offscreen
+// context (see benchContextCreate()).
+//
+// Usage: repackbench [loads]
+// Defaults to 20 uploads of each layout.
+
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../pixelrepack.h"
+#include "../texture.h"
+#include "benchcommon.h"
+
+/** Compares texCreateFromSurface() (repacking to RGBA8 where needed, or
+ * uploading as is using GL_UNPACK_ROW_LENGTH) with the old path (uploading
+ * the surface's pixels as they are, and fixing the channel order with
+ * GL_TEXTURE_SWIZZLE_*), for common SDL pixel layouts. The images are
+ * 1023 pixels wide, so 24-bit rows are padded.
+ * 
+ * @param loads the number of times to upload each
+ */
+
+static void textureRepackBenchmark(int loads) {
+	typedef struct RepackBenchFormat_s {
+		const char *name;
+		int depth;
+		Uint32 masks[4];
+	} RepackBenchFormat;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	const RepackBenchFormat formats[] = {
+		{"RGB24", 24, {0xFF0000, 0x00FF00, 0x0000FF, 0}},
+		{"BGR24", 24, {0x0000FF, 0x00FF00, 0xFF0000, 0}},
+		{"RGBA32", 32, {0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF}},
+		{"BGRA32", 32, {0x0000FF00, 0x00FF0000, 0xFF000000, 0x000000FF}},
+		{"XRGB32", 32, {0x00FF0000, 0x0000FF00, 0x000000FF, 0}}
+	};
+#else
+	const RepackBenchFormat formats[] = {
+		{"RGB24", 24, {0x0000FF, 0x00FF00, 0xFF0000, 0}},
+		{"BGR24", 24, {0xFF0000, 0x00FF00, 0x0000FF, 0}},
+		{"RGBA32", 32, {0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000}},
+		{"BGRA32", 32, {0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000}},
+		{"XRGB32", 32, {0x0000FF00, 0x00FF0000, 0xFF000000, 0}}
+	};
+#endif
+	const int numFormats = sizeof(formats) / sizeof(formats[0]);
+	const int width = 1023;
+	const int height = 1024;
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	for (int f = 0; f < numFormats; ++f) {
+		const RepackBenchFormat *format = &formats[f];
+		SDL_Surface *surf = SDL_CreateRGBSurface(0, width, height, format->depth,
+			format->masks[0], format->masks[1], format->masks[2], format->masks[3]);
+		if (!surf) {
+			continue;
+		}
+		for (int y = 0; y < height; ++y) {
+			Uint8 *row = (Uint8*)surf->pixels + y * surf->pitch;
+			for (int x = 0; x < width * surf->format->BytesPerPixel; ++x) {
+				row[x] = (Uint8)(x * 7 + y * 13);
+			}
+		}
+		
+		// Old: upload the pixels as they are, and fix the channel order with swizzles
+		GLenum glFormat = surf->format->BytesPerPixel == 4 ? GL_RGBA : GL_RGB;
+		Uint64 startTime = SDL_GetPerformanceCounter();
+		for (int i = 0; i < loads; ++i) {
+			GLuint texture;
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glTexImage2D(GL_TEXTURE_2D, 0, glFormat, width, height, 0, glFormat, GL_UNSIGNED_BYTE, surf->pixels);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_RED);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_GREEN);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_BLUE);
+			glFinish();
+			texDestroy(texture);
+		}
+		double oldMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick / loads;
+		
+		// New: repack (or not) and upload
+		startTime = SDL_GetPerformanceCounter();
+		for (int i = 0; i < loads; ++i) {
+			GLuint texture = texCreateFromSurface(surf, TEX_MIPMAP_NONE, format->name);
+			glFinish();
+			texDestroy(texture);
+		}
+		double newMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick / loads;
+		
+		// The repack on its own
+		PixelLayout layout;
+		std::vector<unsigned char> repacked((size_t)width * height * 4);
+		double repackMs = 0.0;
+		if (pixelLayoutFromSDL(surf->format, &layout)) {
+			startTime = SDL_GetPerformanceCounter();
+			for (int i = 0; i < loads; ++i) {
+				pixelRepack(surf->pixels, surf->pitch, &layout, &repacked[0], width * 4, 4, width, height);
+			}
+			repackMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick / loads;
+		}
+		
+		SDL_Log("%s %dx%d: as is + swizzle %.2f ms, texCreateFromSurface() %.2f ms (%s; repack alone %.2f ms)\n",
+			format->name, width, height, oldMs, newMs, pixelLayoutIsGL(&layout) ? "as is" : "repacked", repackMs);
+		SDL_FreeSurface(surf);
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	int loads = argc > 1 ? atoi(argv[1]) : 20;
+	if(!benchContextCreate(0, 0)) {
+		return EXIT_FAILURE;
+	}
+	
+	textureRepackBenchmark(loads > 0 ? loads : 1);
+	
+	return EXIT_SUCCESS;
+}
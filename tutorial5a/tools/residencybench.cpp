@@ -0,0 +1,118 @@
+// residencybench.cpp
+//
+// Draws with more textures than fit in a GPU memory budget, through a
+// TexResidency (see textureresidency.h), with each eviction mode. Draws
+// offscreen (see benchContextCreate()), so it runs without a window.
+//
+// Usage: residencybench [budgetKiB]
+// Defaults to a quarter of what the 32 textures need. Run it from the
+// tutorial5a directory (it loads the shaders and crate1_diffuse.png). The
+// ETC2 compressed texture is cached in the pref path, like the demo's.
+
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../texture.h"
+#include "../texturecache.h"
+#include "../textureresidency.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Draws with more textures than fit in a GPU memory budget, through a
+ * TexResidency, with each eviction mode. A sliding window of textures is
+ * used each frame (like a camera moving through a level), so old textures
+ * have to make way for new ones.
+ * NOTE: Expects the cube's buffers, vertex attributes, uniform blocks and
+ * shader program to be bound already.
+ * 
+ * @param numIndices the cube's number of indices
+ * @param numTextures the number of textures
+ * @param budgetBytes the budget (0 for a quarter of what all the textures need)
+ */
+
+static void textureResidencyBenchmark(GLsizei numIndices, int numTextures, size_t budgetBytes) {
+	const char *filename = "crate1_diffuse.png";
+	const int numFrames = 200;
+	const int windowSize = 6; // Textures used per frame
+	const int framesPerStep = 4; // Frames before the window moves on by one texture
+	const TexEvictMode modes[] = {TEX_EVICT_UNLOAD, TEX_EVICT_DROP_MIPS};
+	const char *modeNames[] = {"Unload", "Drop mips"};
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	// What they'd all take up without a budget (they're all the same image,
+	// ETC2 compressed, but each is its own texture)
+	GLuint texture = texLoadCompressed(filename);
+	TexInfo info;
+	if (!texture || !texInfoGet(texture, &info)) {
+		texDestroy(texture);
+		return;
+	}
+	texDestroy(texture);
+	size_t totalBytes = texInfoFootprint(&info) * numTextures;
+	budgetBytes = budgetBytes > 0 ? budgetBytes : totalBytes / 4;
+	SDL_Log("%d textures: %.1f KiB if all resident, budget %.1f KiB\n", numTextures,
+		totalBytes / 1024.0, budgetBytes / 1024.0);
+	
+	for (int m = 0; m < 2; ++m) {
+		TexResidency *residency = texResidencyCreate(budgetBytes, modes[m], 64);
+		std::vector<TexResident*> residents(numTextures, NULL);
+		for (int i = 0; i < numTextures; ++i) {
+			residents[i] = texResidencyAdd(residency, filename, true);
+		}
+		texResidencyStatsReset(residency);
+		
+		double maxFrameMs = 0.0;
+		Uint64 startTime = SDL_GetPerformanceCounter();
+		for (int f = 0; f < numFrames; ++f) {
+			Uint64 frameStart = SDL_GetPerformanceCounter();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			for (int i = 0; i < windowSize; ++i) {
+				TexResident *resident = residents[(f / framesPerStep + i) % numTextures];
+				if (resident) {
+					glBindTexture(GL_TEXTURE_2D, texResidencyUse(residency, resident));
+					glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+				}
+			}
+			texResidencyUpdate(residency, 1);
+			glFinish(); // In place of swapping the buffers
+			double frameMs = (SDL_GetPerformanceCounter() - frameStart) * msPerTick;
+			maxFrameMs = frameMs > maxFrameMs ? frameMs : maxFrameMs;
+		}
+		glFinish();
+		double totalMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+		
+		TexResidencyStats stats = texResidencyStatsGet(residency);
+		SDL_Log("%s: %.1f ms/frame (longest %.1f ms), peak %.1f KiB, %u/%u resident (%u reduced), "
+			"%u evictions, %u mip drops, %u reloads (%.1f ms stalled), %u restores (%.1f ms)\n",
+			modeNames[m], totalMs / numFrames, maxFrameMs, stats.peakBytes / 1024.0, stats.numResident,
+			stats.numTextures, stats.numReduced, stats.evictions, stats.mipDrops, stats.reloads,
+			stats.reloadStallMs, stats.restores, stats.restoreMs);
+		texResidencyDestroy(residency);
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	int budgetKiB = argc > 1 ? atoi(argv[1]) : 0;
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	char *prefPath = SDL_GetPrefPath("GLES3-SDL2-Demos", "tutorial5a");
+	if(prefPath) {
+		texCacheInit(prefPath);
+		SDL_free(prefPath);
+	}
+	
+	textureResidencyBenchmark(CUBE_NUM_INDICES, 32, budgetKiB > 0 ? (size_t)budgetKiB * 1024 : 0);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
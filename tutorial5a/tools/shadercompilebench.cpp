@@ -0,0 +1,254 @@
+// shadercompilebench.cpp
+//
+// Headless benchmark of shader compile and link times. Creates an offscreen
+// OpenGL ES 3 context with EGL (see benchContextCreate()), finds every
+// .vert/.frag pair (same name, same directory) under the given directories,
+// and builds each one through shaderProgLoadTimed() (i.e., the same code
+// path as shaderProgLoad()).
+//
+// Prints min/median/p99/mean milliseconds per stage (vertex compile,
+// fragment compile, link and total) as JSON, for tracking regressions. Works
+// on Mesa's software renderers (llvmpipe/softpipe), so it runs on machines
+// without a GPU, e.g.:
+//   ./shadercompilebench -n 50 .. > compile-times.json
+//
+// Usage: shadercompilebench [-n iterations] [-o output.json] [directories...]
+// Defaults to 20 iterations over the current directory, printing to stdout.
+//
+// NOTE: Every iteration gets a unique #define, so that the driver's shader
+// cache can't skip the work. Mesa's on-disk cache is also disabled (unless
+// MESA_SHADER_CACHE_DISABLE is already set).
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../shader.h"
+#include "benchcommon.h"
+
+/** A vertex and fragment shader with the same name.
+ */
+
+typedef struct ShaderPair_s {
+	std::string vertFilename;
+	std::string fragFilename;
+} ShaderPair;
+
+/** Min/median/p99/mean of a set of timings.
+ */
+
+typedef struct TimingStats_s {
+	double minMs;
+	double medianMs;
+	double p99Ms;
+	double meanMs;
+} TimingStats;
+
+static bool hasSuffix(const std::string &str, const char *suffix) {
+	size_t suffixLength = strlen(suffix);
+	return str.length() >= suffixLength &&
+		str.compare(str.length() - suffixLength, suffixLength, suffix) == 0;
+}
+
+/** Finds all .vert files with a matching .frag file, in dir and its subdirectories.
+ */
+
+static void shaderPairsFind(const std::string &dir, std::vector<ShaderPair> *pairs) {
+	DIR *dirHandle = opendir(dir.c_str());
+	if(!dirHandle) {
+		fprintf(stderr, "Couldn't open directory %s\n", dir.c_str());
+		return;
+	}
+	
+	std::vector<std::string> entries;
+	struct dirent *entry;
+	while((entry = readdir(dirHandle)) != NULL) {
+		if(entry->d_name[0] != '.') {
+			entries.push_back(entry->d_name);
+		}
+	}
+	closedir(dirHandle);
+	
+	// Sorted, so the output order is stable between runs
+	std::sort(entries.begin(), entries.end());
+	for(const std::string &name : entries) {
+		std::string path = dir + "/" + name;
+		struct stat pathStat;
+		if(stat(path.c_str(), &pathStat) != 0) {
+			continue;
+		}
+		if(S_ISDIR(pathStat.st_mode)) {
+			shaderPairsFind(path, pairs);
+		}
+		else if(hasSuffix(name, ".vert")) {
+			ShaderPair pair;
+			pair.vertFilename = path;
+			pair.fragFilename = path.substr(0, path.length() - 5) + ".frag";
+			if(stat(pair.fragFilename.c_str(), &pathStat) == 0) {
+				pairs->push_back(pair);
+			}
+		}
+	}
+}
+
+/** Calculates the stats (sorts the timings).
+ */
+
+static TimingStats timingStatsCalc(std::vector<double> &timings) {
+	TimingStats stats = {0.0, 0.0, 0.0, 0.0};
+	if(timings.empty()) {
+		return stats;
+	}
+	
+	std::sort(timings.begin(), timings.end());
+	size_t n = timings.size();
+	stats.minMs = timings[0];
+	stats.medianMs = n % 2 ? timings[n / 2] : (timings[n / 2 - 1] + timings[n / 2]) / 2.0;
+	
+	// Nearest-rank percentile
+	size_t p99Rank = (n * 99 + 99) / 100;
+	stats.p99Ms = timings[p99Rank - 1];
+	
+	double sum = 0.0;
+	for(double timing : timings) {
+		sum += timing;
+	}
+	stats.meanMs = sum / n;
+	
+	return stats;
+}
+
+/** Prints a string as a JSON string literal.
+ */
+
+static void jsonStringPrint(FILE *out, const char *str) {
+	fputc('"', out);
+	for(const char *c = str; *c; ++c) {
+		if(*c == '"' || *c == '\\') {
+			fprintf(out, "\\%c", *c);
+		}
+		else if((unsigned char)*c < 0x20) {
+			fprintf(out, "\\u%04x", (unsigned char)*c);
+		}
+		else {
+			fputc(*c, out);
+		}
+	}
+	fputc('"', out);
+}
+
+static void jsonStatsPrint(FILE *out, const char *name, const TimingStats &stats, bool last) {
+	fprintf(out, "      \"%s\": {\"min\": %.4f, \"median\": %.4f, \"p99\": %.4f, \"mean\": %.4f}%s\n",
+		name, stats.minMs, stats.medianMs, stats.p99Ms, stats.meanMs, last ? "" : ",");
+}
+
+int main(int argc, char *argv[]) {
+	int iterations = 20;
+	const char *outFilename = NULL;
+	std::vector<std::string> dirs;
+	for(int i = 1; i < argc; ++i) {
+		if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+			iterations = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			outFilename = argv[++i];
+		}
+		else {
+			dirs.push_back(argv[i]);
+		}
+	}
+	if(iterations <= 0) {
+		iterations = 1;
+	}
+	if(dirs.empty()) {
+		dirs.push_back(".");
+	}
+	
+	// Make Mesa really compile every time (the unique #defines take care of
+	// its in-memory cache)
+	setenv("MESA_SHADER_CACHE_DISABLE", "true", 0);
+	
+	if(!benchContextCreate(0, 0)) {
+		return EXIT_FAILURE;
+	}
+	
+	std::vector<ShaderPair> pairs;
+	for(const std::string &dir : dirs) {
+		shaderPairsFind(dir, &pairs);
+	}
+	if(pairs.empty()) {
+		fprintf(stderr, "No .vert/.frag pairs found\n");
+		return EXIT_FAILURE;
+	}
+	
+	FILE *out = stdout;
+	if(outFilename) {
+		out = fopen(outFilename, "w");
+		if(!out) {
+			fprintf(stderr, "Couldn't open %s for writing\n", outFilename);
+			return EXIT_FAILURE;
+		}
+	}
+	
+	fprintf(out, "{\n  \"renderer\": ");
+	jsonStringPrint(out, (const char*)glGetString(GL_RENDERER));
+	fprintf(out, ",\n  \"version\": ");
+	jsonStringPrint(out, (const char*)glGetString(GL_VERSION));
+	fprintf(out, ",\n  \"iterations\": %d,\n  \"programs\": [\n", iterations);
+	
+	bool allBuilt = true;
+	for(size_t p = 0; p < pairs.size(); ++p) {
+		const ShaderPair &pair = pairs[p];
+		std::vector<double> vertMs;
+		std::vector<double> fragMs;
+		std::vector<double> linkMs;
+		std::vector<double> totalMs;
+		bool built = true;
+		for(int i = 0; i < iterations && built; ++i) {
+			char defines[64];
+			snprintf(defines, sizeof(defines), "#define SHADER_COMPILE_BENCH_ITERATION %d\n", i);
+			ShaderProgTimings timings;
+			GLuint shaderProg = shaderProgLoadTimed(pair.vertFilename.c_str(),
+				pair.fragFilename.c_str(), defines, &timings);
+			if(!shaderProg) {
+				built = false;
+				break;
+			}
+			shaderProgDestroy(shaderProg);
+			
+			vertMs.push_back(timings.vertCompileMs);
+			fragMs.push_back(timings.fragCompileMs);
+			linkMs.push_back(timings.linkMs);
+			totalMs.push_back(timings.vertCompileMs + timings.fragCompileMs + timings.linkMs);
+		}
+		allBuilt &= built;
+		
+		fprintf(out, "    {\n      \"vert\": ");
+		jsonStringPrint(out, pair.vertFilename.c_str());
+		fprintf(out, ",\n      \"frag\": ");
+		jsonStringPrint(out, pair.fragFilename.c_str());
+		fprintf(out, ",\n      \"built\": %s%s\n", built ? "true" : "false", built ? "," : "");
+		if(built) {
+			jsonStatsPrint(out, "vertCompileMs", timingStatsCalc(vertMs), false);
+			jsonStatsPrint(out, "fragCompileMs", timingStatsCalc(fragMs), false);
+			jsonStatsPrint(out, "linkMs", timingStatsCalc(linkMs), false);
+			jsonStatsPrint(out, "totalMs", timingStatsCalc(totalMs), true);
+		}
+		fprintf(out, "    }%s\n", p + 1 < pairs.size() ? "," : "");
+	}
+	fprintf(out, "  ]\n}\n");
+	
+	if(out != stdout) {
+		fclose(out);
+	}
+	
+	return allBuilt ? EXIT_SUCCESS : EXIT_FAILURE;
+}
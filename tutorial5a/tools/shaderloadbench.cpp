@@ -0,0 +1,122 @@
+// shaderloadbench.cpp
+//
+// Microbenchmark comparing the old shader source loading path (fopen, two
+// fseek()s and an ftell() to get the length, calloc(), fread(), free()) with
+// fileMap() (open, fstat, one read into the FileMap, close for small files;
+// open, fstat, mmap, close, munmap for large ones; no heap allocation either way).
+//
+// Usage: shaderloadbench [iterations] [files...]
+// Defaults to 10000 iterations over texture.vert and texture.frag.
+
+#include <cstdio>
+#include <cstdlib>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../filemap.h"
+
+#ifdef _MSC_VER
+#pragma warning(disable:4996) // Allows to use the portable fopen() function without warnings in in MVS
+#endif
+
+/** Sums the bytes, so that every page really gets read (as glShaderSource() would).
+ */
+
+static unsigned int checksum(const char *data, size_t length) {
+	unsigned int sum = 0;
+	for(size_t i = 0; i < length; ++i) {
+		sum += (unsigned char)data[i];
+	}
+	
+	return sum;
+}
+
+/** Loads a file the way shaderLoad() used to.
+ */
+
+static unsigned int loadWithStdio(const char *filename) {
+	FILE *file = fopen(filename, "rb");
+	if(!file) {
+		return 0;
+	}
+	
+	long currPos = ftell(file);
+	fseek(file, 0, SEEK_END);
+	size_t length = ftell(file);
+	fseek(file, currPos, SEEK_SET);
+	
+	char *src = (char*)calloc(length + 1, 1);
+	if(!src) {
+		fclose(file);
+		return 0;
+	}
+	length = fread(src, 1, length, file);
+	fclose(file);
+	
+	unsigned int sum = checksum(src, length);
+	free(src);
+	
+	return sum;
+}
+
+/** Loads a file with fileMap().
+ */
+
+static unsigned int loadWithFileMap(const char *filename) {
+	FileMap src;
+	if(!fileMap(filename, &src)) {
+		return 0;
+	}
+	
+	unsigned int sum = checksum(src.data, src.length);
+	fileUnmap(&src);
+	
+	return sum;
+}
+
+int main(int argc, char *argv[]) {
+	int iterations = argc > 1 ? atoi(argv[1]) : 10000;
+	if(iterations <= 0) {
+		iterations = 1;
+	}
+	
+	const char *defaultFiles[] = {"texture.vert", "texture.frag"};
+	const char **files = defaultFiles;
+	int numFiles = 2;
+	if(argc > 2) {
+		files = (const char**)&argv[2];
+		numFiles = argc - 2;
+	}
+	
+	double nsPerTick = 1.0e9 / (double)SDL_GetPerformanceFrequency();
+	unsigned int stdioSum = 0;
+	unsigned int mapSum = 0;
+	
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	for(int i = 0; i < iterations; ++i) {
+		for(int j = 0; j < numFiles; ++j) {
+			stdioSum += loadWithStdio(files[j]);
+		}
+	}
+	double stdioNs = (SDL_GetPerformanceCounter() - startTime) * nsPerTick;
+	
+	startTime = SDL_GetPerformanceCounter();
+	for(int i = 0; i < iterations; ++i) {
+		for(int j = 0; j < numFiles; ++j) {
+			mapSum += loadWithFileMap(files[j]);
+		}
+	}
+	double mapNs = (SDL_GetPerformanceCounter() - startTime) * nsPerTick;
+	
+	if(stdioSum != mapSum) {
+		printf("ERROR: The two loaders read different data\n");
+		return EXIT_FAILURE;
+	}
+	
+	double loads = (double)iterations * numFiles;
+	printf("stdio + calloc: %.0f ns per file\n", stdioNs / loads);
+	printf("fileMap:        %.0f ns per file\n", mapNs / loads);
+	
+	return EXIT_SUCCESS;
+}
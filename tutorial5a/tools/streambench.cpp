@@ -0,0 +1,106 @@
+// streambench.cpp
+//
+// Compares loading many textures with texLoad() (all at once, on the render
+// thread) and streaming them in with a TexStreamer (see texturestream.h),
+// while drawing the cube. Draws offscreen (see benchContextCreate()), so it
+// runs without a window.
+//
+// Usage: streambench [count]
+// Defaults to 200 textures. Run it from the tutorial5a directory (it loads
+// the shaders and crate1_diffuse.png).
+
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../texture.h"
+#include "../texturestream.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Compares loading many textures with texLoad() (all at once, on the render
+ * thread) and streaming them in with a TexStreamer, while drawing the cube.
+ * NOTE: Expects the cube's buffers, vertex attributes, uniform blocks and
+ * shader program to be bound already.
+ * 
+ * @param numIndices the cube's number of indices
+ * @param numTextures the number of textures to load
+ */
+
+static void textureStreamBenchmark(GLsizei numIndices, int numTextures) {
+	const char *filename = "crate1_diffuse.png";
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	std::vector<GLuint> textures(numTextures, 0);
+	
+	// Synchronous: the whole load is one long frame
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numTextures; ++i) {
+		textures[i] = texLoad(filename);
+	}
+	glFinish();
+	double syncMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+	
+	// Warm up (some drivers build shader variants on the first draw with a texture)
+	glBindTexture(GL_TEXTURE_2D, textures[0]);
+	glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+	glFinish();
+	for (int i = 0; i < numTextures; ++i) {
+		texDestroy(textures[i]);
+	}
+	SDL_Log("texLoad() x %d: %.1f ms in a single frame\n", numTextures, syncMs);
+	
+	// Streamed: 4 MiB buffers, and at most 8 MiB or 4 ms of uploads per frame
+	TexStreamer *streamer = texStreamerCreate(0, 4 * 1024 * 1024, 3);
+	if (!streamer) {
+		return;
+	}
+	texStreamerSetBudget(streamer, 8 * 1024 * 1024, 4.0);
+	std::vector<TexStream*> streams(numTextures);
+	startTime = SDL_GetPerformanceCounter();
+	for (int i = 0; i < numTextures; ++i) {
+		streams[i] = texStreamLoad(streamer, filename);
+	}
+	int frames = 0;
+	double maxFrameMs = 0.0;
+	while (texStreamerPending(streamer) > 0) {
+		Uint64 frameStart = SDL_GetPerformanceCounter();
+		texStreamerUpdate(streamer);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glBindTexture(GL_TEXTURE_2D, texStreamTexture(streams[frames % numTextures]));
+		glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+		glFinish(); // In place of swapping the buffers
+		double frameMs = (SDL_GetPerformanceCounter() - frameStart) * msPerTick;
+		maxFrameMs = frameMs > maxFrameMs ? frameMs : maxFrameMs;
+		++frames;
+	}
+	glFinish();
+	double streamMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+	int numReady = 0;
+	for (int i = 0; i < numTextures; ++i) {
+		numReady += texStreamStatus(streams[i]) == TEX_STREAM_READY;
+		texStreamRelease(streamer, streams[i]);
+	}
+	texStreamerDestroy(streamer);
+	SDL_Log("Streamed x %d (%d loaded): %.1f ms over %d frames, longest frame %.1f ms\n",
+		numTextures, numReady, streamMs, frames, maxFrameMs);
+}
+
+
+int main(int argc, char *argv[]) {
+	int numTextures = argc > 1 ? atoi(argv[1]) : 200;
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	
+	textureStreamBenchmark(CUBE_NUM_INDICES, numTextures > 0 ? numTextures : 1);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+// texconvert.cpp
+//
+// Offline texture converter. Decodes a PNG/JPEG image, builds its mipmap
+// chain (see mipmapChainBuild()), and writes the result as a KTX file that
+// texLoadKtx() can memory-map and upload as is. The texels are stored in R, G,
+// B(, A) byte order, so no swizzling is needed when loading either.
+//
+// Formats (-f):
+//   raw   uncompressed; GL_RGB8 for opaque images, GL_RGBA8 with transparency
+//   etc2  compressed on all CPU cores (the same as texLoadCompressed()'s cache);
+//         GL_COMPRESSED_RGB8_ETC2, or GL_COMPRESSED_RGBA8_ETC2_EAC with transparency
+//
+// Usage: texconvert [-f raw|etc2] [-j threads] [-a] [-n] input.png output.ktx
+//   -f  the format (default: raw)
+//   -j  the number of encoder threads (default: one per CPU core)
+//   -a  always keep the alpha channel
+//   -n  no mipmaps (level 0 only)
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include "../etc2.h"
+#include "../ktx.h"
+#include "../mipmap.h"
+
+/** The mipmap chain being converted.
+ */
+
+typedef struct ConvertJob_s {
+	bool compress;
+	bool alpha;
+	int numThreads;
+	std::vector<std::vector<unsigned char> > levels;
+} ConvertJob;
+
+/** Stores a mipmap level (see mipmapChainBuild()); ETC2 encoded, or with
+ * KTX's 4-byte row padding.
+ */
+
+static bool levelConvert(int level, int width, int height, const void *pixels, int pitch, void *userData) {
+	ConvertJob *job = (ConvertJob*)userData;
+	std::vector<unsigned char> &data = job->levels[level];
+	if(job->compress) {
+		data.resize(etc2EncodedSize(width, height, job->alpha));
+		return etc2Encode(pixels, width, height, pitch, job->alpha, &data[0], job->numThreads);
+	}
+	
+	// Drop the alpha channel if it isn't needed
+	int bytesPerPixel = job->alpha ? 4 : 3;
+	size_t rowSize = ((size_t)width * bytesPerPixel + 3) & ~(size_t)3;
+	data.assign(rowSize * height, 0);
+	for(int y = 0; y < height; ++y) {
+		const unsigned char *src = (const unsigned char*)pixels + (size_t)y * pitch;
+		unsigned char *dst = &data[rowSize * y];
+		if(job->alpha) {
+			memcpy(dst, src, (size_t)width * 4);
+			continue;
+		}
+		for(int x = 0; x < width; ++x) {
+			dst[x * 3 + 0] = src[x * 4 + 0];
+			dst[x * 3 + 1] = src[x * 4 + 1];
+			dst[x * 3 + 2] = src[x * 4 + 2];
+		}
+	}
+	
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	ConvertJob job;
+	job.compress = false;
+	job.alpha = false;
+	job.numThreads = 0;
+	bool forceAlpha = false;
+	bool mipmaps = true;
+	bool badArgs = false;
+	const char *inFilename = NULL;
+	const char *outFilename = NULL;
+	for(int i = 1; i < argc; ++i) {
+		if(strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+			++i;
+			job.compress = strcmp(argv[i], "etc2") == 0;
+			badArgs |= !job.compress && strcmp(argv[i], "raw") != 0;
+		}
+		else if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			job.numThreads = atoi(argv[++i]);
+		}
+		else if(strcmp(argv[i], "-a") == 0) {
+			forceAlpha = true;
+		}
+		else if(strcmp(argv[i], "-n") == 0) {
+			mipmaps = false;
+		}
+		else if(!inFilename) {
+			inFilename = argv[i];
+		}
+		else {
+			outFilename = argv[i];
+		}
+	}
+	if(badArgs || !inFilename || !outFilename) {
+		fprintf(stderr, "Usage: texconvert [-f raw|etc2] [-j threads] [-a] [-n] input.png output.ktx\n");
+		return EXIT_FAILURE;
+	}
+	
+	int flags = IMG_INIT_JPG | IMG_INIT_PNG;
+	if((IMG_Init(flags) & flags) == 0) {
+		fprintf(stderr, "Couldn't get the JPEG and PNG loaders\n");
+		return EXIT_FAILURE;
+	}
+	SDL_Surface *loadedSurf = IMG_Load(inFilename);
+	if(!loadedSurf) {
+		fprintf(stderr, "Loading image %s failed with error: %s\n", inFilename, IMG_GetError());
+		return EXIT_FAILURE;
+	}
+	SDL_Surface *surf = SDL_ConvertSurfaceFormat(loadedSurf, SDL_PIXELFORMAT_RGBA32, 0);
+	SDL_FreeSurface(loadedSurf);
+	if(!surf) {
+		fprintf(stderr, "Couldn't convert %s to RGBA: %s\n", inFilename, SDL_GetError());
+		return EXIT_FAILURE;
+	}
+	
+	job.alpha = forceAlpha;
+	for(int y = 0; y < surf->h && !job.alpha; ++y) {
+		const Uint8 *row = (const Uint8*)surf->pixels + y * surf->pitch;
+		for(int x = 0; x < surf->w; ++x) {
+			job.alpha |= row[x * 4 + 3] != 0xFF;
+		}
+	}
+	
+	int numLevels = mipmaps ? mipmapLevelCount(surf->w, surf->h) : 1;
+	if(numLevels > KTX_MAX_LEVELS) {
+		fprintf(stderr, "%s is too large\n", inFilename);
+		return EXIT_FAILURE;
+	}
+	job.levels.resize(numLevels);
+	Uint64 startTime = SDL_GetPerformanceCounter();
+	bool success = levelConvert(0, surf->w, surf->h, surf->pixels, surf->pitch, &job);
+	if(success && mipmaps) {
+		success = mipmapChainBuild(surf->pixels, surf->w, surf->h, surf->pitch, 4, 3, levelConvert, &job);
+	}
+	double convertMs = (SDL_GetPerformanceCounter() - startTime) * 1000.0 / SDL_GetPerformanceFrequency();
+	if(!success) {
+		fprintf(stderr, "Couldn't convert %s\n", inFilename);
+		return EXIT_FAILURE;
+	}
+	
+	KtxImage image;
+	const char *formatName;
+	if(job.compress) {
+		image.glInternalFormat = job.alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+		image.glFormat = 0;
+		image.glType = 0;
+		formatName = job.alpha ? "RGBA8_ETC2_EAC" : "RGB8_ETC2";
+	}
+	else {
+		image.glInternalFormat = job.alpha ? GL_RGBA8 : GL_RGB8;
+		image.glFormat = job.alpha ? GL_RGBA : GL_RGB;
+		image.glType = GL_UNSIGNED_BYTE;
+		formatName = job.alpha ? "RGBA8" : "RGB8";
+	}
+	image.width = surf->w;
+	image.height = surf->h;
+	image.numLevels = numLevels;
+	size_t convertedSize = 0;
+	size_t uncompressedSize = 0;
+	int width = surf->w;
+	int height = surf->h;
+	for(int level = 0; level < numLevels; ++level) {
+		image.levelData[level] = &job.levels[level][0];
+		image.levelSizes[level] = job.levels[level].size();
+		convertedSize += job.levels[level].size();
+		uncompressedSize += (size_t)width * height * 4;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+	if(!ktxWrite(outFilename, &image)) {
+		return EXIT_FAILURE;
+	}
+	
+	printf("%s: %dx%d, %d level(s), %s, %lu bytes (RGBA8 would be %lu; %.1fx smaller), converted in %.1f ms\n",
+		outFilename, surf->w, surf->h, numLevels, formatName,
+		(unsigned long)convertedSize, (unsigned long)uncompressedSize,
+		(double)uncompressedSize / convertedSize, convertMs);
+	SDL_FreeSurface(surf);
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,61 @@
+// texloadbench.cpp
+//
+// Compares loading a texture from a PNG (decode, swizzle and build the
+// mipmaps) with loading a KTX file made from it by tools/texconvert.cpp
+// (memory-mapped and uploaded as is), in an offscreen context (see
+// benchContextCreate()).
+//
+// Usage: texloadbench [loads] [image.png image.ktx]
+// Defaults to 20 loads of crate1_diffuse.png and crate1_diffuse.ktx.
+
+#include <cstdlib>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../texture.h"
+#include "benchcommon.h"
+
+/** Compares loading a texture from a PNG (decode, swizzle and build the
+ * mipmaps) with loading a KTX file made from it by tools/texconvert.cpp
+ * (memory-mapped and uploaded as is).
+ * 
+ * @param pngFilename the source image
+ * @param ktxFilename the converted KTX file
+ * @param loads the number of times to load each
+ */
+
+static void textureLoadBenchmark(const char *pngFilename, const char *ktxFilename, int loads) {
+	const char *filenames[] = {pngFilename, ktxFilename};
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	for (int f = 0; f < 2; ++f) {
+		double totalMs = 0.0;
+		for (int i = 0; i < loads; ++i) {
+			Uint64 startTime = SDL_GetPerformanceCounter();
+			GLuint texture = texLoad(filenames[f]);
+			glFinish();
+			totalMs += (SDL_GetPerformanceCounter() - startTime) * msPerTick;
+			if (!texture) {
+				SDL_Log("Couldn't load %s (make it with tools/texconvert.cpp)\n", filenames[f]);
+				return;
+			}
+			texDestroy(texture);
+		}
+		SDL_Log("texLoad(\"%s\") over %d loads: %.3f ms\n", filenames[f], loads, totalMs / loads);
+	}
+}
+
+
+int main(int argc, char *argv[]) {
+	int loads = argc > 1 ? atoi(argv[1]) : 20;
+	const char *pngFilename = argc > 3 ? argv[2] : "crate1_diffuse.png";
+	const char *ktxFilename = argc > 3 ? argv[3] : "crate1_diffuse.ktx";
+	if(!benchContextCreate(0, 0)) {
+		return EXIT_FAILURE;
+	}
+	
+	textureLoadBenchmark(pngFilename, ktxFilename, loads > 0 ? loads : 1);
+	
+	return EXIT_SUCCESS;
+}
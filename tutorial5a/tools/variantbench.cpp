@@ -0,0 +1,130 @@
+// variantbench.cpp
+//
+// Compares the fragment throughput of specialized shader variants (see
+// shaderVariantGet()) with the uber shader, which branches on uniforms at
+// runtime. Draws offscreen (see benchContextCreate()), so it runs without a
+// window.
+//
+// Usage: variantbench [frames]
+// Defaults to 100 frames for each shader. Run it from the tutorial5a
+// directory (it loads the shaders and crate1_diffuse.png).
+
+#include <cstdlib>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+#include <glm/glm.hpp>
+
+#include "../shadervariant.h"
+#include "../uniformblocks.h"
+#include "../uniforms.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Compares the fragment throughput of specialized shader variants against
+ * the uber shader (which branches on uniforms at runtime).
+ * 
+ * The cube is drawn many times over each frame with depth testing off, so
+ * that every layer gets shaded. NOTE: Expects the cube's buffers, vertex
+ * attributes and texture to be bound already.
+ * 
+ * @param numIndices the cube's number of indices
+ * @param frames the number of frames to time for each shader
+ */
+
+static void shaderVariantBenchmark(GLsizei numIndices, UniformBuffer *ubo, const glm::mat4 &mvMat,
+		const glm::mat4 &projMat, const glm::vec3 &lightPos, const glm::vec3 &ambientCol,
+		const glm::vec3 &diffuseCol, int frames) {
+	const ShaderFeature features[] = {{"LIGHTING", 1}, {"NUM_LIGHTS", 3}, {"TEXTURED", 1}, {"UBER", 1}};
+	const size_t numFeatures = sizeof(features) / sizeof(features[0]);
+	ShaderVariants *variants = shaderVariantsCreate("texture.vert", "texture.frag", features, numFeatures);
+	if (!variants) {
+		return;
+	}
+	
+	// Use all lights the shaders have room for; spread them out a little
+	glm::vec3 lightPositions[MAX_LIGHTS];
+	for (int i = 0; i < MAX_LIGHTS; ++i) {
+		lightPositions[i] = lightPos - glm::vec3(40.0f * i, 0.0f, 0.0f);
+	}
+	if (!uniformBlocksUpdate(ubo, projMat, lightPositions, MAX_LIGHTS, ambientCol, diffuseCol, mvMat)) {
+		shaderVariantsDestroy(variants);
+		return;
+	}
+	
+	// LIGHTING, NUM_LIGHTS, TEXTURED
+	const unsigned int configs[][3] = {{1, 1, 1}, {1, 4, 1}, {1, 2, 0}, {0, 0, 1}};
+	const unsigned int uberValues[numFeatures] = {0, 0, 0, 1};
+	const int layers = 64;
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	glDisable(GL_DEPTH_TEST);
+	for (const unsigned int *config : configs) {
+		unsigned int specValues[numFeatures] = {config[0], config[1], config[2], 0};
+		GLuint shaderProgs[2] = {
+			shaderVariantGet(variants, shaderVariantMask(variants, specValues)),
+			shaderVariantGet(variants, shaderVariantMask(variants, uberValues))
+		};
+		double frameMs[2] = {0.0, 0.0};
+		
+		for (int p = 0; p < 2; ++p) {
+			GLuint shaderProg = shaderProgs[p];
+			if (!shaderProg) {
+				continue;
+			}
+			glUseProgram(shaderProg);
+			uboBlockBind(shaderProg, "FrameData", FRAME_BINDING);
+			uboBlockBind(shaderProg, "ObjectData", OBJECT_BINDING);
+			
+			// Specialized variants lack some of these, which is fine (their IDs are -1)
+			ShaderUniforms *uniforms = uniformsCreate(shaderProg);
+			if (!uniforms) {
+				continue;
+			}
+			uniformSet1i(uniforms, uniformsFind(uniforms, "texSampler"), 0);
+			uniformSet1i(uniforms, uniformsFind(uniforms, "lighting"), config[0]);
+			uniformSet1i(uniforms, uniformsFind(uniforms, "numLights"), config[1]);
+			uniformSet1i(uniforms, uniformsFind(uniforms, "textured"), config[2]);
+			uniformsDestroy(uniforms);
+			
+			// Warm up (some drivers finish compiling on first use)
+			glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+			glFinish();
+			
+			Uint64 startTime = SDL_GetPerformanceCounter();
+			for (int f = 0; f < frames; ++f) {
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				for (int l = 0; l < layers; ++l) {
+					glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_SHORT, (GLvoid*)0);
+				}
+				glFinish();
+			}
+			frameMs[p] = (SDL_GetPerformanceCounter() - startTime) * msPerTick / frames;
+		}
+		
+		SDL_Log("LIGHTING=%u NUM_LIGHTS=%u TEXTURED=%u: specialized %.3f ms/frame, uber %.3f ms/frame\n",
+			config[0], config[1], config[2], frameMs[0], frameMs[1]);
+	}
+	glEnable(GL_DEPTH_TEST);
+	
+	shaderVariantsDestroy(variants);
+}
+
+
+int main(int argc, char *argv[]) {
+	int frames = argc > 1 ? atoi(argv[1]) : 100;
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	
+	shaderVariantBenchmark(CUBE_NUM_INDICES, scene.ubo, scene.mvMat, scene.projMat, scene.lightPos,
+		scene.ambientCol, scene.diffuseCol, frames > 0 ? frames : 1);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
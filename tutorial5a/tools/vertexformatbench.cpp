@@ -0,0 +1,148 @@
+// vertexformatbench.cpp
+//
+// Compares the vertex fetch speed of each vertex format (see vertexformat.h)
+// on a large sphere mesh, after checking that quantizing it stays within
+// error bounds. Draws offscreen (see benchContextCreate()), so it runs
+// without a window.
+//
+// Usage: vertexformatbench [vertices]
+// Defaults to a million vertices, drawn 20 times in each format. Run it from
+// the tutorial5a directory (it loads the shaders).
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#define SDL_MAIN_HANDLED // This tool has a plain main()
+#include <SDL.h>
+
+#include "../shadervariant.h"
+#include "../uniformblocks.h"
+#include "../uniforms.h"
+#include "../vertexformat.h"
+#include "benchcommon.h"
+#include "benchscene.h"
+
+/** Compares the vertex fetch speed of each vertex format (see vertexformat.h)
+ * on a large sphere mesh, after checking that quantizing it stays within
+ * error bounds. Each vertex is drawn once as a point, with rasterization
+ * turned off, so only vertex fetch and the vertex shader are timed.
+ * 
+ * @param numVertices the mesh's number of vertices (rounded up to a square grid)
+ * @param draws the number of times to draw the mesh in each format
+ */
+
+static void vertexFormatBenchmark(int numVertices, int draws) {
+	double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	
+	// A UV sphere
+	int gridSize = (int)ceilf(sqrtf((float)numVertices));
+	gridSize = gridSize > 2 ? gridSize : 2;
+	numVertices = gridSize * gridSize;
+	const float radius = 50.0f;
+	std::vector<Vertex> vertices(numVertices);
+	for (int j = 0; j < gridSize; ++j) {
+		float v = (float)j / (gridSize - 1);
+		float theta = v * (float)M_PI;
+		for (int i = 0; i < gridSize; ++i) {
+			float u = (float)i / (gridSize - 1);
+			float phi = u * 2.0f * (float)M_PI;
+			Vertex &vertex = vertices[j * gridSize + i];
+			vertex.normal[0] = sinf(theta) * cosf(phi);
+			vertex.normal[1] = cosf(theta);
+			vertex.normal[2] = sinf(theta) * sinf(phi);
+			for (int c = 0; c < 3; ++c) {
+				vertex.position[c] = vertex.normal[c] * radius;
+			}
+			vertex.texCoord[0] = u;
+			vertex.texCoord[1] = v;
+		}
+	}
+	
+	const ShaderFeature features[] = {{"VERTEX_FORMAT", 2}};
+	ShaderVariants *variants = shaderVariantsCreate("texture.vert", "texture.frag", features, 1);
+	if (!variants) {
+		return;
+	}
+	
+	// A thousandth of the radius, a sixteenth of a texel on a 4096 texture, and a degree and a half
+	const VertexQuantError maxError = {radius * 0.001f, 1.0f / 4096.0f / 16.0f, 1.5f};
+	const VertexFormat formats[] = {VERTEX_FORMAT_FLOAT, VERTEX_FORMAT_SNORM16_OCT8, VERTEX_FORMAT_HALF_1010102};
+	const char *formatNames[] = {"float", "snorm16 + oct8 normals", "half + 10:10:10:2 normals"};
+	double floatMs = 0.0;
+	glEnable(GL_RASTERIZER_DISCARD);
+	for (int f = 0; f < 3; ++f) {
+		VertexFormat format = formats[f];
+		size_t vertexSize = vertexFormatSize(format);
+		std::vector<unsigned char> encoded(vertexSize * numVertices);
+		VertexQuantParams params;
+		VertexQuantError error;
+		if (!vertexQuantize(format, vertices[0].position, vertices[0].texCoord, vertices[0].normal, sizeof(Vertex),
+				numVertices, &encoded[0], &params, &error, &maxError)) {
+			SDL_Log("%s: quantizing failed\n", formatNames[f]);
+			continue;
+		}
+		
+		unsigned int values[1] = {(unsigned int)format};
+		GLuint shaderProg = shaderVariantGet(variants, shaderVariantMask(variants, values));
+		ShaderUniforms *uniforms = shaderProg ? uniformsCreate(shaderProg) : NULL;
+		if (!uniforms) {
+			continue;
+		}
+		glUseProgram(shaderProg);
+		uboBlockBind(shaderProg, "FrameData", FRAME_BINDING);
+		uboBlockBind(shaderProg, "ObjectData", OBJECT_BINDING);
+		VertexQuantUniforms quantUniforms;
+		vertexQuantUniformsFind(uniforms, &quantUniforms);
+		vertexQuantParamsSet(uniforms, &quantUniforms, &params);
+		
+		GLuint vbo;
+		glGenBuffers(1, &vbo);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo);
+		glBufferData(GL_ARRAY_BUFFER, encoded.size(), &encoded[0], GL_STATIC_DRAW);
+		vertexFormatAttribsSet(format, 0, 1, 2, 0);
+		
+		// Warm up
+		glDrawArrays(GL_POINTS, 0, numVertices);
+		glFinish();
+		
+		Uint64 startTime = SDL_GetPerformanceCounter();
+		for (int d = 0; d < draws; ++d) {
+			glDrawArrays(GL_POINTS, 0, numVertices);
+		}
+		glFinish();
+		double drawMs = (SDL_GetPerformanceCounter() - startTime) * msPerTick / draws;
+		floatMs = format == VERTEX_FORMAT_FLOAT ? drawMs : floatMs;
+		SDL_Log("%s: %d bytes/vertex (%.1f MiB), %.2f ms/draw (%.2fx float, %.2f GB/s); max error: position %g, "
+			"texCoord %g, normal %.3f degrees\n", formatNames[f], (int)vertexSize, encoded.size() / (1024.0 * 1024.0),
+			drawMs, floatMs / drawMs, encoded.size() / (drawMs * 1.0e6), error.position, error.texCoord,
+			error.normalDegrees);
+		
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glDeleteBuffers(1, &vbo);
+		uniformsDestroy(uniforms);
+	}
+	glDisable(GL_RASTERIZER_DISCARD);
+	
+	shaderVariantsDestroy(variants);
+}
+
+
+int main(int argc, char *argv[]) {
+	int numVertices = argc > 1 ? atoi(argv[1]) : 1000000;
+	if(!benchContextCreate(BENCH_WIDTH, BENCH_HEIGHT)) {
+		return EXIT_FAILURE;
+	}
+	
+	// For its uniform blocks
+	BenchScene scene;
+	if(!benchSceneCreate(&scene)) {
+		return EXIT_FAILURE;
+	}
+	
+	vertexFormatBenchmark(numVertices > 0 ? numVertices : 1, 20);
+	
+	benchSceneDestroy(&scene);
+	
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,35 @@
+// uniformblocks.cpp
+//
+// See header file for details
+
+#include "uniformblocks.h"
+
+#include <glm/gtc/matrix_inverse.hpp>
+
+bool uniformBlocksUpdate(UniformBuffer *ubo, const glm::mat4 &projMat, const glm::vec3 *lightPos,
+		int numLights, const glm::vec3 &ambientCol, const glm::vec3 &diffuseCol, const glm::mat4 &mvMat) {
+	uboBegin(ubo);
+	
+	GLintptr frameOffset = 0;
+	FrameUniforms *frame = (FrameUniforms*)uboAlloc(ubo, sizeof(FrameUniforms), &frameOffset);
+	GLintptr objectOffset = 0;
+	ObjectUniforms *object = (ObjectUniforms*)uboAlloc(ubo, sizeof(ObjectUniforms), &objectOffset);
+	if(!frame || !object) {
+		return false;
+	}
+	
+	frame->projMat = projMat;
+	for(int i = 0; i < MAX_LIGHTS; ++i) {
+		frame->lightPos[i] = glm::vec4(i < numLights ? lightPos[i] : glm::vec3(0.0f), 1.0f);
+	}
+	frame->ambientCol = glm::vec4(ambientCol, 0.0f);
+	frame->diffuseCol = glm::vec4(diffuseCol, 0.0f);
+	object->mvMat = mvMat;
+	object->normalMat = glm::inverseTranspose(mvMat);
+	
+	uboUpload(ubo);
+	uboBindRange(ubo, FRAME_BINDING, frameOffset, sizeof(FrameUniforms));
+	uboBindRange(ubo, OBJECT_BINDING, objectOffset, sizeof(ObjectUniforms));
+	
+	return true;
+}
@@ -0,0 +1,47 @@
+// uniformblocks.h
+
+#ifndef __UNIFORMBLOCKS_H__
+#define __UNIFORMBLOCKS_H__
+
+#include "uniformbuffer.h"
+
+#include <GLES3/gl3.h>
+#include <glm/glm.hpp>
+
+// The uniform buffer binding points for the shaders' uniform blocks
+const GLuint FRAME_BINDING = 0;
+const GLuint OBJECT_BINDING = 1;
+const int MAX_LIGHTS = 4;
+
+/** The per-frame uniform block, in std140 layout.
+ * Must match FrameData in common/lighting.glsl.
+ */
+typedef struct FrameUniforms_s {
+	glm::mat4 projMat;
+	glm::vec4 lightPos[MAX_LIGHTS]; // std140 pads each vec3 to 16 bytes
+	glm::vec4 ambientCol;
+	glm::vec4 diffuseCol;
+} FrameUniforms;
+
+/** The per-object uniform block, in std140 layout.
+ * Must match the vertex shader's ObjectData.
+ */
+typedef struct ObjectUniforms_s {
+	glm::mat4 mvMat;
+	glm::mat4 normalMat;
+} ObjectUniforms;
+
+/** Writes the per-frame and per-object uniform blocks, uploads them in a
+ * single write, and binds them.
+ * 
+ * @param ubo the uniform buffer
+ * @param lightPos the light positions (in view space)
+ * @param numLights the number of lights (up to MAX_LIGHTS)
+ * 
+ * @return bool true if successful
+ */
+
+bool uniformBlocksUpdate(UniformBuffer *ubo, const glm::mat4 &projMat, const glm::vec3 *lightPos,
+		int numLights, const glm::vec3 &ambientCol, const glm::vec3 &diffuseCol, const glm::mat4 &mvMat);
+
+#endif
@@ -0,0 +1,109 @@
+// uniformbuffer.cpp
+//
+// See header file for details
+
+#include "uniformbuffer.h"
+
+#include <cstdlib>
+#include <SDL.h>
+#include <SDL_opengles2.h>
+
+struct UniformBuffer_s {
+	GLuint buffer;
+	GLsizeiptr capacity;
+	GLintptr alignment;
+	
+	// The blocks are written here first, and then uploaded in one go
+	unsigned char *staging;
+	GLsizeiptr used;
+};
+
+UniformBuffer *uboCreate(GLsizeiptr capacity) {
+	
+	UniformBuffer *ubo = (UniformBuffer*)calloc(1, sizeof(UniformBuffer));
+	if(!ubo) {
+		SDL_Log("Couldn't create uniform buffer; out of memory\n");
+		return NULL;
+	}
+	ubo->staging = (unsigned char*)malloc(capacity);
+	if(!ubo->staging) {
+		SDL_Log("Couldn't allocate %ld bytes for the uniform buffer\n", (long)capacity);
+		free(ubo);
+		return NULL;
+	}
+	ubo->capacity = capacity;
+	
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	ubo->alignment = alignment > 0 ? alignment : 256;
+	
+	glGenBuffers(1, &ubo->buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, ubo->buffer);
+	glBufferData(GL_UNIFORM_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	
+	// Check for problems
+	GLenum err = glGetError();
+	if(err != GL_NO_ERROR) {
+		SDL_Log("Creating uniform buffer failed, code %u\n", err);
+		uboDestroy(ubo);
+		return NULL;
+	}
+	
+	return ubo;
+}
+
+void uboDestroy(UniformBuffer *ubo) {
+	
+	glDeleteBuffers(1, &ubo->buffer);
+	free(ubo->staging);
+	free(ubo);
+}
+
+void uboBegin(UniformBuffer *ubo) {
+	
+	ubo->used = 0;
+}
+
+void *uboAlloc(UniformBuffer *ubo, GLsizeiptr size, GLintptr *offset) {
+	
+	GLintptr start = (ubo->used + ubo->alignment - 1) / ubo->alignment * ubo->alignment;
+	if(start + size > ubo->capacity) {
+		SDL_Log("Uniform buffer full (%ld bytes); couldn't allocate %ld bytes\n",
+			(long)ubo->capacity, (long)size);
+		return NULL;
+	}
+	ubo->used = start + size;
+	
+	*offset = start;
+	return ubo->staging + start;
+}
+
+void uboUpload(UniformBuffer *ubo) {
+	
+	if(ubo->used == 0) {
+		return;
+	}
+	
+	// No glGetError() here, as it can stall every frame; uboCreate() checks the buffer once
+	glBindBuffer(GL_UNIFORM_BUFFER, ubo->buffer);
+	glBufferData(GL_UNIFORM_BUFFER, ubo->capacity, NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, ubo->used, ubo->staging);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void uboBindRange(UniformBuffer *ubo, GLuint binding, GLintptr offset, GLsizeiptr size) {
+	
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, ubo->buffer, offset, size);
+}
+
+bool uboBlockBind(GLuint shaderProg, const char *blockName, GLuint binding) {
+	
+	GLuint blockIdx = glGetUniformBlockIndex(shaderProg, blockName);
+	if(blockIdx == GL_INVALID_INDEX) {
+		return false;
+	}
+	glUniformBlockBinding(shaderProg, blockIdx, binding);
+	
+	return true;
+}
@@ -0,0 +1,89 @@
+// uniformbuffer.h
+
+#ifndef __UNIFORMBUFFER_H__
+#define __UNIFORMBUFFER_H__
+
+#include <GLES3/gl3.h>
+
+/** A large Uniform Buffer Object (UBO) that uniform blocks are sub-allocated
+ * from every frame.
+ * 
+ * Usage per frame:
+ * - uboBegin() to start over
+ * - uboAlloc() for each block (e.g., one per-frame block, one per object),
+ *   and fill it in (with std140 layout)
+ * - uboUpload() to send everything to the GPU in a single write
+ * - uboBindRange() before each draw call, to point the shader's blocks at
+ *   their data
+ * 
+ * Allocations are aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, as
+ * glBindBufferRange() requires.
+ */
+
+typedef struct UniformBuffer_s UniformBuffer;
+
+/** Creates a uniform buffer.
+ * 
+ * @param capacity the buffer's size in bytes
+ * 
+ * @return UniformBuffer* the buffer, or NULL if failed
+ */
+
+UniformBuffer *uboCreate(GLsizeiptr capacity);
+
+/** Destroys a uniform buffer.
+ */
+
+void uboDestroy(UniformBuffer *ubo);
+
+/** Frees all allocations, ready for the next frame.
+ */
+
+void uboBegin(UniformBuffer *ubo);
+
+/** Allocates space for a uniform block.
+ * 
+ * @param ubo the uniform buffer
+ * @param size the block's size in bytes
+ * @param offset where to write the block's offset within the buffer to (for
+ * uboBindRange())
+ * 
+ * @return void* where to write the block's data to (valid until uboUpload()),
+ * or NULL if the buffer is full
+ */
+
+void *uboAlloc(UniformBuffer *ubo, GLsizeiptr size, GLintptr *offset);
+
+/** Uploads all blocks allocated since uboBegin().
+ * 
+ * The buffer is orphaned first, so this doesn't wait for draw calls that are
+ * still using last frame's data.
+ */
+
+void uboUpload(UniformBuffer *ubo);
+
+/** Binds a block's data to a uniform buffer binding point.
+ * 
+ * @param ubo the uniform buffer
+ * @param binding the binding point (see uboBlockBind())
+ * @param offset the block's offset (from uboAlloc())
+ * @param size the block's size in bytes
+ */
+
+void uboBindRange(UniformBuffer *ubo, GLuint binding, GLintptr offset, GLsizeiptr size);
+
+/** Connects a shader program's uniform block to a binding point.
+ * 
+ * NOTE: GLSL ES 3.00 has no layout(binding = N), so this must be done for
+ * every program after it's linked.
+ * 
+ * @param shaderProg the shader program
+ * @param blockName the uniform block's name
+ * @param binding the binding point
+ * 
+ * @return bool true if the program has the block
+ */
+
+bool uboBlockBind(GLuint shaderProg, const char *blockName, GLuint binding);
+
+#endif
@@ -0,0 +1,291 @@
+// uniforms.cpp
+//
+// See header file for details
+
+#include "uniforms.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SDL.h>
+#include <SDL_opengles2.h>
+
+/** Which setter a uniform type belongs to.
+ */
+
+typedef enum UniformCategory_e {
+	UNIFORM_CATEGORY_INT,
+	UNIFORM_CATEGORY_UINT,
+	UNIFORM_CATEGORY_FLOAT,
+	UNIFORM_CATEGORY_MATRIX
+} UniformCategory;
+
+typedef struct UniformInfo_s {
+	GLint location;
+	GLenum type;
+	UniformCategory category;
+	
+	// The number of array elements, and 32-bit components per element
+	GLsizei size;
+	GLsizei components;
+	
+	// Where the last uploaded value is in the shadow buffer, and whether there is one yet
+	size_t shadowOffset;
+	bool shadowValid;
+} UniformInfo;
+
+struct ShaderUniforms_s {
+	std::vector<UniformInfo> uniforms;
+	std::unordered_map<std::string, UniformID> ids;
+	
+	// The last value uploaded to each uniform
+	std::vector<GLuint> shadow;
+};
+
+static UniformStats uniformStats = {0, 0};
+
+/** Gets a uniform type's setter category, and its number of components.
+ * 
+ * @return bool false if the type isn't known
+ */
+
+static bool uniformTypeInfo(GLenum type, UniformCategory *category, GLsizei *components) {
+	switch(type) {
+		case GL_INT:
+		case GL_BOOL:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_CUBE_SHADOW:
+		case GL_INT_SAMPLER_2D:
+		case GL_INT_SAMPLER_3D:
+		case GL_INT_SAMPLER_CUBE:
+		case GL_INT_SAMPLER_2D_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_3D:
+		case GL_UNSIGNED_INT_SAMPLER_CUBE:
+		case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+			*category = UNIFORM_CATEGORY_INT; *components = 1; return true;
+		case GL_INT_VEC2: case GL_BOOL_VEC2:
+			*category = UNIFORM_CATEGORY_INT; *components = 2; return true;
+		case GL_INT_VEC3: case GL_BOOL_VEC3:
+			*category = UNIFORM_CATEGORY_INT; *components = 3; return true;
+		case GL_INT_VEC4: case GL_BOOL_VEC4:
+			*category = UNIFORM_CATEGORY_INT; *components = 4; return true;
+		case GL_UNSIGNED_INT:
+			*category = UNIFORM_CATEGORY_UINT; *components = 1; return true;
+		case GL_UNSIGNED_INT_VEC2:
+			*category = UNIFORM_CATEGORY_UINT; *components = 2; return true;
+		case GL_UNSIGNED_INT_VEC3:
+			*category = UNIFORM_CATEGORY_UINT; *components = 3; return true;
+		case GL_UNSIGNED_INT_VEC4:
+			*category = UNIFORM_CATEGORY_UINT; *components = 4; return true;
+		case GL_FLOAT:
+			*category = UNIFORM_CATEGORY_FLOAT; *components = 1; return true;
+		case GL_FLOAT_VEC2:
+			*category = UNIFORM_CATEGORY_FLOAT; *components = 2; return true;
+		case GL_FLOAT_VEC3:
+			*category = UNIFORM_CATEGORY_FLOAT; *components = 3; return true;
+		case GL_FLOAT_VEC4:
+			*category = UNIFORM_CATEGORY_FLOAT; *components = 4; return true;
+		case GL_FLOAT_MAT2:
+			*category = UNIFORM_CATEGORY_MATRIX; *components = 4; return true;
+		case GL_FLOAT_MAT3:
+			*category = UNIFORM_CATEGORY_MATRIX; *components = 9; return true;
+		case GL_FLOAT_MAT4:
+			*category = UNIFORM_CATEGORY_MATRIX; *components = 16; return true;
+		case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2:
+			*category = UNIFORM_CATEGORY_MATRIX; *components = 6; return true;
+		case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2:
+			*category = UNIFORM_CATEGORY_MATRIX; *components = 8; return true;
+		case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3:
+			*category = UNIFORM_CATEGORY_MATRIX; *components = 12; return true;
+		default:
+			return false;
+	}
+}
+
+ShaderUniforms *uniformsCreate(GLuint shaderProg) {
+	
+	GLint numUniforms = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(shaderProg, GL_ACTIVE_UNIFORMS, &numUniforms);
+	glGetProgramiv(shaderProg, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+	
+	GLchar *name = (GLchar*)malloc(maxNameLength > 0 ? maxNameLength : 1);
+	if(!name) {
+		SDL_Log("Couldn't get the shader program's uniforms; out of memory\n");
+		return NULL;
+	}
+	
+	ShaderUniforms *uniforms = new ShaderUniforms_s;
+	size_t shadowLength = 0;
+	for(GLint i = 0; i < numUniforms; ++i) {
+		GLsizei nameLength = 0;
+		UniformInfo info;
+		glGetActiveUniform(shaderProg, i, maxNameLength, &nameLength, &info.size, &info.type, name);
+		
+		// Uniform block members have no location; they're set via their buffer
+		info.location = glGetUniformLocation(shaderProg, name);
+		if(info.location < 0) {
+			continue;
+		}
+		if(!uniformTypeInfo(info.type, &info.category, &info.components)) {
+			SDL_Log("Uniform %s has unknown type 0x%04X; it can't be set\n", name, info.type);
+			continue;
+		}
+		
+		// Arrays are reported as "name[0]"
+		if(nameLength > 3 && strcmp(&name[nameLength - 3], "[0]") == 0) {
+			name[nameLength - 3] = '\0';
+		}
+		
+		info.shadowOffset = shadowLength;
+		info.shadowValid = false;
+		shadowLength += (size_t)info.size * info.components;
+		
+		uniforms->ids[name] = (UniformID)uniforms->uniforms.size();
+		uniforms->uniforms.push_back(info);
+	}
+	uniforms->shadow.resize(shadowLength);
+	
+	free(name);
+	return uniforms;
+}
+
+void uniformsDestroy(ShaderUniforms *uniforms) {
+	
+	delete uniforms;
+}
+
+UniformID uniformsFind(const ShaderUniforms *uniforms, const char *name) {
+	
+	auto found = uniforms->ids.find(name);
+	
+	return found != uniforms->ids.end() ? found->second : -1;
+}
+
+/** Checks a new value against the shadow copy, and updates the copy.
+ * 
+ * @return UniformInfo* the uniform if it needs uploading, or NULL if it's
+ * unchanged (or can't be set)
+ */
+
+static UniformInfo *uniformUpdate(ShaderUniforms *uniforms, UniformID id, UniformCategory category,
+		GLsizei count, const void *value) {
+	
+	if(id < 0 || (size_t)id >= uniforms->uniforms.size()) {
+		return NULL;
+	}
+	
+	UniformInfo *info = &uniforms->uniforms[id];
+	if(info->category != category) {
+		SDL_Log("Uniform type mismatch (uniform type: 0x%04X)\n", info->type);
+		return NULL;
+	}
+	if(count < 0 || count > info->size) {
+		SDL_Log("Uniform count %d is out of range (array size: %d)\n", (int)count, (int)info->size);
+		return NULL;
+	}
+	
+	GLuint *shadow = &uniforms->shadow[info->shadowOffset];
+	size_t length = sizeof(GLuint) * info->components * count;
+	if(info->shadowValid && memcmp(shadow, value, length) == 0) {
+		++uniformStats.skipped;
+		return NULL;
+	}
+	
+	// NOTE: A partial array upload leaves the shadow's other elements stale,
+	// so they're compared against the new value next time (which is safe)
+	memcpy(shadow, value, length);
+	info->shadowValid = true;
+	++uniformStats.issued;
+	return info;
+}
+
+void uniformSet1i(ShaderUniforms *uniforms, UniformID id, GLint value) {
+	
+	uniformSetiv(uniforms, id, 1, &value);
+}
+
+void uniformSet1f(ShaderUniforms *uniforms, UniformID id, GLfloat value) {
+	
+	uniformSetfv(uniforms, id, 1, &value);
+}
+
+void uniformSetiv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLint *value) {
+	
+	UniformInfo *info = uniformUpdate(uniforms, id, UNIFORM_CATEGORY_INT, count, value);
+	if(!info) {
+		return;
+	}
+	switch(info->components) {
+		case 1: glUniform1iv(info->location, count, value); break;
+		case 2: glUniform2iv(info->location, count, value); break;
+		case 3: glUniform3iv(info->location, count, value); break;
+		case 4: glUniform4iv(info->location, count, value); break;
+	}
+}
+
+void uniformSetuiv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLuint *value) {
+	
+	UniformInfo *info = uniformUpdate(uniforms, id, UNIFORM_CATEGORY_UINT, count, value);
+	if(!info) {
+		return;
+	}
+	switch(info->components) {
+		case 1: glUniform1uiv(info->location, count, value); break;
+		case 2: glUniform2uiv(info->location, count, value); break;
+		case 3: glUniform3uiv(info->location, count, value); break;
+		case 4: glUniform4uiv(info->location, count, value); break;
+	}
+}
+
+void uniformSetfv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLfloat *value) {
+	
+	UniformInfo *info = uniformUpdate(uniforms, id, UNIFORM_CATEGORY_FLOAT, count, value);
+	if(!info) {
+		return;
+	}
+	switch(info->components) {
+		case 1: glUniform1fv(info->location, count, value); break;
+		case 2: glUniform2fv(info->location, count, value); break;
+		case 3: glUniform3fv(info->location, count, value); break;
+		case 4: glUniform4fv(info->location, count, value); break;
+	}
+}
+
+void uniformSetMatrixfv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLfloat *value) {
+	
+	UniformInfo *info = uniformUpdate(uniforms, id, UNIFORM_CATEGORY_MATRIX, count, value);
+	if(!info) {
+		return;
+	}
+	switch(info->type) {
+		case GL_FLOAT_MAT2: glUniformMatrix2fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT3: glUniformMatrix3fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT4: glUniformMatrix4fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT2x3: glUniformMatrix2x3fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT3x2: glUniformMatrix3x2fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT2x4: glUniformMatrix2x4fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT4x2: glUniformMatrix4x2fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT3x4: glUniformMatrix3x4fv(info->location, count, GL_FALSE, value); break;
+		case GL_FLOAT_MAT4x3: glUniformMatrix4x3fv(info->location, count, GL_FALSE, value); break;
+	}
+}
+
+UniformStats uniformStatsGet() {
+	
+	return uniformStats;
+}
+
+void uniformStatsReset() {
+	
+	uniformStats.issued = 0;
+	uniformStats.skipped = 0;
+}
@@ -0,0 +1,102 @@
+// uniforms.h
+
+#ifndef __UNIFORMS_H__
+#define __UNIFORMS_H__
+
+#include <GLES3/gl3.h>
+
+/** A shader program's uniforms, found once with glGetActiveUniform().
+ * 
+ * The setters keep a shadow copy of each uniform's last value, and skip the
+ * glUniform*() call if the new value is the same. So, it's cheap to simply
+ * set every uniform every frame.
+ * 
+ * IMPORTANT: The program must be in use (glUseProgram()) when calling the
+ * setters.
+ */
+
+typedef struct ShaderUniforms_s ShaderUniforms;
+
+/** Identifies a uniform within its ShaderUniforms (-1 if the program
+ * doesn't have it; setting that is silently ignored, like location -1 is).
+ */
+
+typedef int UniformID;
+
+/** Counts of glUniform*() calls made and skipped.
+ */
+
+typedef struct UniformStats_s {
+	unsigned int issued;
+	unsigned int skipped;
+} UniformStats;
+
+/** Finds all active uniforms of a shader program.
+ * 
+ * @param shaderProg the shader program
+ * 
+ * @return ShaderUniforms* the uniforms, or NULL if failed
+ */
+
+ShaderUniforms *uniformsCreate(GLuint shaderProg);
+
+/** Destroys a ShaderUniforms (the shader program itself isn't touched).
+ */
+
+void uniformsDestroy(ShaderUniforms *uniforms);
+
+/** Looks up a uniform by name. Do this once, and keep the ID.
+ * 
+ * @param uniforms the program's uniforms
+ * @param name the uniform's name (arrays are found by their plain name,
+ * e.g., "lightPos" rather than "lightPos[0]")
+ * 
+ * @return UniformID the uniform's ID, or -1 if the program has no such uniform
+ */
+
+UniformID uniformsFind(const ShaderUniforms *uniforms, const char *name);
+
+/** Sets an int, bool or sampler uniform.
+ */
+
+void uniformSet1i(ShaderUniforms *uniforms, UniformID id, GLint value);
+
+/** Sets a float uniform.
+ */
+
+void uniformSet1f(ShaderUniforms *uniforms, UniformID id, GLfloat value);
+
+/** Typed setters for all uniform types. The number of components per
+ * element comes from the uniform's type (e.g., 3 for a vec3, 16 for a mat4).
+ * A type mismatch, or a count that's negative or larger than the array, is
+ * printed to the console, and nothing is uploaded.
+ * 
+ * - uniformSetiv(): int, bool, ivec*, bvec* and samplers
+ * - uniformSetuiv(): uint and uvec*
+ * - uniformSetfv(): float and vec*
+ * - uniformSetMatrixfv(): mat* (column-major, not transposed)
+ * 
+ * @param uniforms the program's uniforms
+ * @param id the uniform's ID
+ * @param count the number of array elements to set (1 for non-arrays, and
+ * no more than the array's size)
+ * @param value the values
+ */
+
+void uniformSetiv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLint *value);
+void uniformSetuiv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLuint *value);
+void uniformSetfv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLfloat *value);
+void uniformSetMatrixfv(ShaderUniforms *uniforms, UniformID id, GLsizei count, const GLfloat *value);
+
+/** Gets the number of uniform uploads issued and skipped (across all
+ * programs) since the last uniformStatsReset().
+ */
+
+UniformStats uniformStatsGet();
+
+/** Resets the upload counts (e.g., at the start of every frame).
+ */
+
+void uniformStatsReset();
+
+#endif
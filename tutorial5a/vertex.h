@@ -0,0 +1,15 @@
+// vertex.h
+
+#ifndef __VERTEX_H__
+#define __VERTEX_H__
+
+/** Encapsulates the data for a single vertex.
+ * Must match the vertex shader's input.
+ */
+typedef struct Vertex_s {
+	float position[3];
+	float texCoord[2];
+	float normal[3];
+}Vertex;
+
+#endif
@@ -0,0 +1,328 @@
+// vertexformat.cpp
+//
+// See header file for details
+
+#include "vertexformat.h"
+
+#include <SDL.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/** Gets a source attribute's values for a vertex.
+ */
+
+static const float *vertexSrcAttrib(const float *first, size_t srcStride, size_t i) {
+	return (const float*)((const char*)first + i * srcStride);
+}
+
+static float vertexClamp(float value, float minVal, float maxVal) {
+	return value < minVal ? minVal : (value > maxVal ? maxVal : value);
+}
+
+/** Quantizes a value in -1..1 to a normalized signed integer with the given maximum (e.g., 32767).
+ */
+
+static int vertexSnormEncode(float value, int maxVal) {
+	return (int)lrintf(vertexClamp(value, -1.0f, 1.0f) * maxVal);
+}
+
+/** Decodes a normalized signed integer the way GLES 3.0 does.
+ */
+
+static float vertexSnormDecode(int value, int maxVal) {
+	float decoded = (float)value / maxVal;
+	return decoded > -1.0f ? decoded : -1.0f;
+}
+
+/** Converts a float to a half float (rounding to nearest even).
+ */
+
+static uint16_t vertexHalfEncode(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+	int exponent = (int)((bits >> 23) & 0xFF) - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	if(((bits >> 23) & 0xFF) == 0xFF) {
+		return sign | 0x7C00 | (mantissa ? 0x200 : 0); // Inf or NaN
+	}
+	if(exponent >= 31) {
+		return sign | 0x7C00; // Too large
+	}
+	if(exponent <= 0) {
+		if(exponent < -10) {
+			return sign; // Too small (zero)
+		}
+		
+		// Denormal
+		mantissa |= 0x800000;
+		int shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+		uint32_t rest = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if(rest > halfway || (rest == halfway && (half & 1))) {
+			++half;
+		}
+		return sign | (uint16_t)half;
+	}
+	
+	// Rounding may carry into the exponent, which is still correct
+	uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+	uint32_t rest = mantissa & 0x1FFF;
+	if(rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+		++half;
+	}
+	return sign | (uint16_t)(half < 0x7C00 ? half : 0x7C00);
+}
+
+static float vertexHalfDecode(uint16_t half) {
+	int exponent = (half >> 10) & 0x1F;
+	int mantissa = half & 0x3FF;
+	float value;
+	if(exponent == 0) {
+		value = ldexpf((float)mantissa, -24);
+	}
+	else if(exponent == 31) {
+		value = mantissa ? NAN : INFINITY;
+	}
+	else {
+		value = ldexpf((float)(mantissa | 0x400), exponent - 25);
+	}
+	
+	return (half & 0x8000) ? -value : value;
+}
+
+/** Decodes an octahedral normal, the same way as octDecode() in texture.vert.
+ */
+
+static void vertexOctDecode(float x, float y, float normal[3]) {
+	float z = 1.0f - fabsf(x) - fabsf(y);
+	float t = z < 0.0f ? -z : 0.0f;
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+	float length = sqrtf(x * x + y * y + z * z);
+	normal[0] = x / length;
+	normal[1] = y / length;
+	normal[2] = z / length;
+}
+
+/** Encodes a unit normal as octahedral coordinates in normalized bytes.
+ * Of the four ways of rounding, it picks the one that decodes closest to the normal.
+ */
+
+static void vertexOctEncode(const float normal[3], int8_t encoded[2]) {
+	float l1 = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+	if(l1 == 0.0f) {
+		encoded[0] = encoded[1] = 0;
+		return;
+	}
+	float x = normal[0] / l1;
+	float y = normal[1] / l1;
+	if(normal[2] < 0.0f) {
+		float foldedX = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		float foldedY = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = foldedX;
+		y = foldedY;
+	}
+	
+	float bestDot = -2.0f;
+	for(int i = 0; i < 4; ++i) {
+		int qx = (int)(i & 1 ? ceilf(x * 127.0f) : floorf(x * 127.0f));
+		int qy = (int)(i & 2 ? ceilf(y * 127.0f) : floorf(y * 127.0f));
+		qx = qx < -127 ? -127 : (qx > 127 ? 127 : qx);
+		qy = qy < -127 ? -127 : (qy > 127 ? 127 : qy);
+		float decoded[3];
+		vertexOctDecode(vertexSnormDecode(qx, 127), vertexSnormDecode(qy, 127), decoded);
+		float dot = decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2];
+		if(dot > bestDot) {
+			bestDot = dot;
+			encoded[0] = (int8_t)qx;
+			encoded[1] = (int8_t)qy;
+		}
+	}
+}
+
+/** Works out the scale and offset that map an attribute's values to -1..1.
+ */
+
+static void vertexRangeGet(const float *first, size_t srcStride, size_t numVertices, int numComponents,
+		float *scale, float *offset) {
+	for(int c = 0; c < numComponents; ++c) {
+		float minVal = INFINITY;
+		float maxVal = -INFINITY;
+		for(size_t i = 0; i < numVertices; ++i) {
+			float value = vertexSrcAttrib(first, srcStride, i)[c];
+			minVal = value < minVal ? value : minVal;
+			maxVal = value > maxVal ? value : maxVal;
+		}
+		offset[c] = numVertices ? (minVal + maxVal) * 0.5f : 0.0f;
+		scale[c] = numVertices ? (maxVal - minVal) * 0.5f : 0.0f;
+		scale[c] = scale[c] > 0.0f ? scale[c] : 1.0f;
+	}
+}
+
+/** Returns the angle between two unit vectors, in degrees.
+ */
+
+static float vertexAngleDegrees(const float a[3], const float b[3]) {
+	float length = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+	if(length == 0.0f) {
+		return 0.0f;
+	}
+	float dot = (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) / length;
+	
+	return acosf(vertexClamp(dot, -1.0f, 1.0f)) * (180.0f / (float)M_PI);
+}
+
+size_t vertexFormatSize(VertexFormat format) {
+	return format == VERTEX_FORMAT_FLOAT ? 32 : 16;
+}
+
+bool vertexQuantize(VertexFormat format, const float *positions, const float *texCoords, const float *normals,
+		size_t srcStride, size_t numVertices, void *dest, VertexQuantParams *params, VertexQuantError *error,
+		const VertexQuantError *maxError) {
+	
+	VertexQuantError maxFound = {0.0f, 0.0f, 0.0f};
+	if(format == VERTEX_FORMAT_FLOAT) {
+		for(int c = 0; c < 3; ++c) {
+			params->posScale[c] = 1.0f;
+			params->posOffset[c] = 0.0f;
+		}
+		for(int c = 0; c < 2; ++c) {
+			params->texCoordScale[c] = 1.0f;
+			params->texCoordOffset[c] = 0.0f;
+		}
+	}
+	else {
+		vertexRangeGet(positions, srcStride, numVertices, 3, params->posScale, params->posOffset);
+		vertexRangeGet(texCoords, srcStride, numVertices, 2, params->texCoordScale, params->texCoordOffset);
+	}
+	
+	unsigned char *out = (unsigned char*)dest;
+	size_t vertexSize = vertexFormatSize(format);
+	for(size_t i = 0; i < numVertices; ++i, out += vertexSize) {
+		const float *position = vertexSrcAttrib(positions, srcStride, i);
+		const float *texCoord = vertexSrcAttrib(texCoords, srcStride, i);
+		const float *normal = vertexSrcAttrib(normals, srcStride, i);
+		if(format == VERTEX_FORMAT_FLOAT) {
+			memcpy(out, position, 3 * sizeof(float));
+			memcpy(out + 12, texCoord, 2 * sizeof(float));
+			memcpy(out + 20, normal, 3 * sizeof(float));
+			continue;
+		}
+		
+		// Positions (at 0; 8 bytes including padding)
+		float decodedPos[3];
+		int16_t *outPos = (int16_t*)out;
+		for(int c = 0; c < 3; ++c) {
+			float relative = (position[c] - params->posOffset[c]) / params->posScale[c];
+			float decoded;
+			if(format == VERTEX_FORMAT_SNORM16_OCT8) {
+				outPos[c] = (int16_t)vertexSnormEncode(relative, 32767);
+				decoded = vertexSnormDecode(outPos[c], 32767);
+			}
+			else {
+				uint16_t half = vertexHalfEncode(relative);
+				memcpy(&outPos[c], &half, sizeof(half));
+				decoded = vertexHalfDecode(half);
+			}
+			decodedPos[c] = decoded * params->posScale[c] + params->posOffset[c];
+		}
+		outPos[3] = 0;
+		
+		// Texture coordinates (at 8)
+		int16_t *outTexCoord = (int16_t*)(out + 8);
+		for(int c = 0; c < 2; ++c) {
+			float relative = (texCoord[c] - params->texCoordOffset[c]) / params->texCoordScale[c];
+			outTexCoord[c] = (int16_t)vertexSnormEncode(relative, 32767);
+			float decoded = vertexSnormDecode(outTexCoord[c], 32767) * params->texCoordScale[c] +
+				params->texCoordOffset[c];
+			float texCoordError = fabsf(decoded - texCoord[c]);
+			maxFound.texCoord = texCoordError > maxFound.texCoord ? texCoordError : maxFound.texCoord;
+		}
+		
+		// Normals (at 12)
+		float decodedNormal[3];
+		if(format == VERTEX_FORMAT_SNORM16_OCT8) {
+			int8_t *outNormal = (int8_t*)(out + 12);
+			vertexOctEncode(normal, outNormal);
+			outNormal[2] = outNormal[3] = 0;
+			vertexOctDecode(vertexSnormDecode(outNormal[0], 127), vertexSnormDecode(outNormal[1], 127),
+				decodedNormal);
+		}
+		else {
+			uint32_t packed = 0;
+			float length = 0.0f;
+			for(int c = 0; c < 3; ++c) {
+				int component = vertexSnormEncode(normal[c], 511);
+				packed |= ((uint32_t)component & 0x3FF) << (10 * c);
+				decodedNormal[c] = vertexSnormDecode(component, 511);
+				length += decodedNormal[c] * decodedNormal[c];
+			}
+			memcpy(out + 12, &packed, sizeof(packed));
+			
+			// texture.vert normalizes it
+			length = sqrtf(length);
+			for(int c = 0; c < 3 && length > 0.0f; ++c) {
+				decodedNormal[c] /= length;
+			}
+		}
+		
+		for(int c = 0; c < 3; ++c) {
+			float posError = fabsf(decodedPos[c] - position[c]);
+			maxFound.position = posError > maxFound.position ? posError : maxFound.position;
+		}
+		float normalError = vertexAngleDegrees(normal, decodedNormal);
+		maxFound.normalDegrees = normalError > maxFound.normalDegrees ? normalError : maxFound.normalDegrees;
+	}
+	
+	if(error) {
+		*error = maxFound;
+	}
+	if(maxError && (maxFound.position > maxError->position || maxFound.texCoord > maxError->texCoord ||
+			maxFound.normalDegrees > maxError->normalDegrees)) {
+		SDL_Log("Quantized vertices are off by up to %g (positions), %g (texture coordinates) and %g degrees "
+			"(normals); allowed %g, %g and %g\n", maxFound.position, maxFound.texCoord, maxFound.normalDegrees,
+			maxError->position, maxError->texCoord, maxError->normalDegrees);
+		return false;
+	}
+	
+	return true;
+}
+
+void vertexFormatAttribsSet(VertexFormat format, GLuint positionIdx, GLuint texCoordIdx, GLuint normalIdx,
+		size_t offset) {
+	switch(format) {
+	case VERTEX_FORMAT_FLOAT:
+		glVertexAttribPointer(positionIdx, 3, GL_FLOAT, GL_FALSE, 32, (const GLvoid*)offset);
+		glVertexAttribPointer(texCoordIdx, 2, GL_FLOAT, GL_FALSE, 32, (const GLvoid*)(offset + 12));
+		glVertexAttribPointer(normalIdx, 3, GL_FLOAT, GL_FALSE, 32, (const GLvoid*)(offset + 20));
+		break;
+	case VERTEX_FORMAT_SNORM16_OCT8:
+		glVertexAttribPointer(positionIdx, 3, GL_SHORT, GL_TRUE, 16, (const GLvoid*)offset);
+		glVertexAttribPointer(texCoordIdx, 2, GL_SHORT, GL_TRUE, 16, (const GLvoid*)(offset + 8));
+		glVertexAttribPointer(normalIdx, 2, GL_BYTE, GL_TRUE, 16, (const GLvoid*)(offset + 12));
+		break;
+	case VERTEX_FORMAT_HALF_1010102:
+		glVertexAttribPointer(positionIdx, 3, GL_HALF_FLOAT, GL_FALSE, 16, (const GLvoid*)offset);
+		glVertexAttribPointer(texCoordIdx, 2, GL_SHORT, GL_TRUE, 16, (const GLvoid*)(offset + 8));
+		glVertexAttribPointer(normalIdx, 4, GL_INT_2_10_10_10_REV, GL_TRUE, 16, (const GLvoid*)(offset + 12));
+		break;
+	}
+}
+
+void vertexQuantUniformsFind(const ShaderUniforms *uniforms, VertexQuantUniforms *quantUniforms) {
+	quantUniforms->posScale = uniformsFind(uniforms, "posScale");
+	quantUniforms->posOffset = uniformsFind(uniforms, "posOffset");
+	quantUniforms->texCoordScale = uniformsFind(uniforms, "texCoordScale");
+	quantUniforms->texCoordOffset = uniformsFind(uniforms, "texCoordOffset");
+}
+
+void vertexQuantParamsSet(ShaderUniforms *uniforms, const VertexQuantUniforms *quantUniforms,
+		const VertexQuantParams *params) {
+	uniformSetfv(uniforms, quantUniforms->posScale, 1, params->posScale);
+	uniformSetfv(uniforms, quantUniforms->posOffset, 1, params->posOffset);
+	uniformSetfv(uniforms, quantUniforms->texCoordScale, 1, params->texCoordScale);
+	uniformSetfv(uniforms, quantUniforms->texCoordOffset, 1, params->texCoordOffset);
+}
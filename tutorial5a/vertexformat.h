@@ -0,0 +1,131 @@
+// vertexformat.h
+
+#ifndef __VERTEXFORMAT_H__
+#define __VERTEXFORMAT_H__
+
+#include "uniforms.h"
+
+#include <GLES3/gl3.h>
+#include <cstddef>
+
+/** Vertex layouts for positions, texture coordinates and normals.
+ * 
+ * The quantized formats take half the memory (and vertex fetch bandwidth) of
+ * floats. Positions and texture coordinates are stored relative to the
+ * mesh's bounds (in -1..1), and the vertex shader scales them back (see
+ * VertexQuantParams). texture.vert decodes a format when it's built with
+ * VERTEX_FORMAT set to the format's value (e.g., with shaderVariantsCreate()).
+ */
+
+typedef enum VertexFormat_e {
+	// 32 bytes: float positions (3), texture coordinates (2) and normals (3),
+	// as in Vertex (see vertex.h)
+	VERTEX_FORMAT_FLOAT = 0,
+	
+	// 16 bytes: normalized short positions (3, plus padding) and texture
+	// coordinates (2), and octahedral normals in 2 normalized bytes (plus padding)
+	VERTEX_FORMAT_SNORM16_OCT8 = 1,
+	
+	// 16 bytes: half float positions (3, plus padding), normalized short
+	// texture coordinates (2), and normals in GL_INT_2_10_10_10_REV
+	VERTEX_FORMAT_HALF_1010102 = 2
+} VertexFormat;
+
+/** How to get a mesh's positions and texture coordinates back from a quantized
+ * format: value = quantized * scale + offset.
+ */
+
+typedef struct VertexQuantParams_s {
+	float posScale[3];
+	float posOffset[3];
+	float texCoordScale[2];
+	float texCoordOffset[2];
+} VertexQuantParams;
+
+/** The largest error of each attribute, after quantizing and decoding.
+ */
+
+typedef struct VertexQuantError_s {
+	// The largest difference in any position component
+	float position;
+	
+	// The largest difference in any texture coordinate component
+	float texCoord;
+	
+	// The largest angle between a normal and its decoded one, in degrees
+	float normalDegrees;
+} VertexQuantError;
+
+/** Gets the size of a vertex in the given format, in bytes.
+ */
+
+size_t vertexFormatSize(VertexFormat format);
+
+/** Encodes vertices in the given format, and checks the error against the originals.
+ * 
+ * The source attributes are read from float arrays that share a stride (e.g.,
+ * &vertices[0].position[0], &vertices[0].texCoord[0] and
+ * &vertices[0].normal[0] with a stride of sizeof(Vertex)). Every vertex is
+ * decoded again the way texture.vert does, to measure the actual error.
+ * 
+ * This will print any errors to the console.
+ * 
+ * @param format the format to encode in
+ * @param positions the first vertex's position (3 floats)
+ * @param texCoords the first vertex's texture coordinate (2 floats)
+ * @param normals the first vertex's normal (3 floats, unit length)
+ * @param srcStride the distance between vertices in the source arrays, in bytes
+ * @param numVertices the number of vertices
+ * @param dest where to write the vertices to (numVertices * vertexFormatSize(format) bytes)
+ * @param params where to write the mesh's dequantization parameters to
+ * @param error where to write the largest errors to (may be NULL)
+ * @param maxError the largest errors allowed (NULL to not check)
+ * 
+ * @return bool true if successful (and within maxError)
+ */
+
+bool vertexQuantize(VertexFormat format, const float *positions, const float *texCoords, const float *normals,
+	size_t srcStride, size_t numVertices, void *dest, VertexQuantParams *params, VertexQuantError *error,
+	const VertexQuantError *maxError);
+
+/** Sets up the vertex attribute pointers for a format, reading from the
+ * currently bound GL_ARRAY_BUFFER.
+ * 
+ * @param format the vertex format
+ * @param positionIdx the position's attribute index
+ * @param texCoordIdx the texture coordinate's attribute index
+ * @param normalIdx the normal's attribute index
+ * @param offset the byte offset of the first vertex in the buffer
+ */
+
+void vertexFormatAttribsSet(VertexFormat format, GLuint positionIdx, GLuint texCoordIdx, GLuint normalIdx,
+	size_t offset);
+
+/** texture.vert's dequantization uniforms (posScale, posOffset,
+ * texCoordScale and texCoordOffset). Programs built for VERTEX_FORMAT_FLOAT
+ * don't have them (their IDs are -1), so setting them does nothing.
+ */
+
+typedef struct VertexQuantUniforms_s {
+	UniformID posScale;
+	UniformID posOffset;
+	UniformID texCoordScale;
+	UniformID texCoordOffset;
+} VertexQuantUniforms;
+
+/** Finds a shader program's dequantization uniforms. Do this once per program.
+ */
+
+void vertexQuantUniformsFind(const ShaderUniforms *uniforms, VertexQuantUniforms *quantUniforms);
+
+/** Uploads a mesh's dequantization parameters.
+ * 
+ * @param uniforms the shader program's uniforms (the program must be in use)
+ * @param quantUniforms the program's dequantization uniforms
+ * @param params the mesh's dequantization parameters
+ */
+
+void vertexQuantParamsSet(ShaderUniforms *uniforms, const VertexQuantUniforms *quantUniforms,
+	const VertexQuantParams *params);
+
+#endif
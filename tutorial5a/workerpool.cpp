@@ -0,0 +1,148 @@
+// workerpool.cpp
+//
+// See header file for details
+
+#include "workerpool.h"
+
+#include <deque>
+#include <vector>
+#include <SDL.h>
+
+struct WorkerPool_s {
+	WorkerPoolFunc func;
+	void *userData;
+	
+	// The worker threads' queues (guarded by mutex)
+	std::vector<SDL_Thread*> threads;
+	SDL_mutex *mutex;
+	SDL_cond *workAvailable;
+	SDL_cond *jobFinished;
+	std::deque<void*> queue;
+	std::deque<void*> finished;
+	bool quit;
+};
+
+static int workerPoolWorker(void *data) {
+	WorkerPool *pool = (WorkerPool*)data;
+	
+	SDL_LockMutex(pool->mutex);
+	while(true) {
+		while(!pool->quit && pool->queue.empty()) {
+			SDL_CondWait(pool->workAvailable, pool->mutex);
+		}
+		if(pool->quit) {
+			break;
+		}
+		void *job = pool->queue.front();
+		pool->queue.pop_front();
+		SDL_UnlockMutex(pool->mutex);
+		
+		pool->func(job, pool->userData);
+		
+		SDL_LockMutex(pool->mutex);
+		pool->finished.push_back(job);
+		SDL_CondSignal(pool->jobFinished);
+	}
+	SDL_UnlockMutex(pool->mutex);
+	
+	return 0;
+}
+
+WorkerPool *workerPoolCreate(int numThreads, const char *threadName, WorkerPoolFunc func, void *userData) {
+	
+	WorkerPool *pool = new WorkerPool_s;
+	pool->func = func;
+	pool->userData = userData;
+	pool->mutex = SDL_CreateMutex();
+	pool->workAvailable = SDL_CreateCond();
+	pool->jobFinished = SDL_CreateCond();
+	pool->quit = false;
+	if(!pool->mutex || !pool->workAvailable || !pool->jobFinished) {
+		SDL_Log("Creating the %s worker pool failed: %s\n", threadName, SDL_GetError());
+		workerPoolDestroy(pool, NULL);
+		return NULL;
+	}
+	
+	for(int i = 0; i < numThreads; ++i) {
+		SDL_Thread *thread = SDL_CreateThread(workerPoolWorker, threadName, pool);
+		if(!thread) {
+			SDL_Log("Couldn't start a %s thread: %s\n", threadName, SDL_GetError());
+			break;
+		}
+		pool->threads.push_back(thread);
+	}
+	if(pool->threads.empty()) {
+		workerPoolDestroy(pool, NULL);
+		return NULL;
+	}
+	
+	return pool;
+}
+
+void workerPoolDestroy(WorkerPool *pool, WorkerPoolFunc discard) {
+	
+	if(!pool) {
+		return;
+	}
+	if(pool->mutex) {
+		SDL_LockMutex(pool->mutex);
+		pool->quit = true;
+		SDL_CondBroadcast(pool->workAvailable);
+		SDL_UnlockMutex(pool->mutex);
+	}
+	for(SDL_Thread *thread : pool->threads) {
+		SDL_WaitThread(thread, NULL);
+	}
+	
+	if(discard) {
+		for(void *job : pool->queue) {
+			discard(job, pool->userData);
+		}
+		for(void *job : pool->finished) {
+			discard(job, pool->userData);
+		}
+	}
+	if(pool->jobFinished) {
+		SDL_DestroyCond(pool->jobFinished);
+	}
+	if(pool->workAvailable) {
+		SDL_DestroyCond(pool->workAvailable);
+	}
+	if(pool->mutex) {
+		SDL_DestroyMutex(pool->mutex);
+	}
+	delete pool;
+}
+
+int workerPoolThreads(const WorkerPool *pool) {
+	return (int)pool->threads.size();
+}
+
+void workerPoolSubmit(WorkerPool *pool, void *const *jobs, size_t numJobs) {
+	
+	SDL_LockMutex(pool->mutex);
+	pool->queue.insert(pool->queue.end(), jobs, jobs + numJobs);
+	if(numJobs == 1) {
+		SDL_CondSignal(pool->workAvailable);
+	}
+	else {
+		SDL_CondBroadcast(pool->workAvailable);
+	}
+	SDL_UnlockMutex(pool->mutex);
+}
+
+void *workerPoolNext(WorkerPool *pool, bool wait) {
+	
+	SDL_LockMutex(pool->mutex);
+	while(wait && pool->finished.empty()) {
+		SDL_CondWait(pool->jobFinished, pool->mutex);
+	}
+	void *job = NULL;
+	if(!pool->finished.empty()) {
+		job = pool->finished.front();
+		pool->finished.pop_front();
+	}
+	SDL_UnlockMutex(pool->mutex);
+	
+	return job;
+}
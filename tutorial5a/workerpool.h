@@ -0,0 +1,83 @@
+// workerpool.h
+
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include <cstddef>
+
+/** A pool of worker threads that run the same function on queued jobs.
+ * 
+ * Jobs are opaque pointers. Each one is handed to the pool's function on a
+ * worker thread, and then comes back out of workerPoolNext() (in the order
+ * they finish, not the order they were submitted).
+ * 
+ * Usage:
+ * - workerPoolCreate()
+ * - workerPoolSubmit() jobs
+ * - workerPoolNext() to take finished jobs
+ * - workerPoolDestroy()
+ * 
+ * NOTE: Only one thread should submit to, and take jobs from, a pool.
+ */
+
+typedef struct WorkerPool_s WorkerPool;
+
+/** Does a job (on a worker thread), or disposes of one (see workerPoolDestroy()).
+ * 
+ * @param job the job
+ * @param userData the userData passed to workerPoolCreate()
+ */
+
+typedef void (*WorkerPoolFunc)(void *job, void *userData);
+
+/** Creates a worker thread pool.
+ * 
+ * @param numThreads the number of worker threads
+ * @param threadName the worker threads' name
+ * @param func the function to run on each job
+ * @param userData passed to func
+ * 
+ * @return WorkerPool* the pool, or NULL if failed (e.g., not a single
+ * thread could be started)
+ */
+
+WorkerPool *workerPoolCreate(int numThreads, const char *threadName, WorkerPoolFunc func, void *userData);
+
+/** Destroys a worker thread pool.
+ * Waits for the worker threads to finish the job they're doing.
+ * 
+ * @param pool the pool (may be NULL)
+ * @param discard called for every job that's still queued, or finished but
+ * not taken with workerPoolNext() (may be NULL)
+ */
+
+void workerPoolDestroy(WorkerPool *pool, WorkerPoolFunc discard);
+
+/** Gets the number of threads in the pool.
+ */
+
+int workerPoolThreads(const WorkerPool *pool);
+
+/** Queues jobs.
+ * 
+ * @param pool the worker thread pool
+ * @param jobs the jobs
+ * @param numJobs the number of jobs
+ */
+
+void workerPoolSubmit(WorkerPool *pool, void *const *jobs, size_t numJobs);
+
+/** Takes the next finished job, in the order they finish.
+ * 
+ * NOTE: Only wait if a submitted job hasn't been taken yet, or this will
+ * never return.
+ * 
+ * @param pool the worker thread pool
+ * @param wait wait for a job to finish if none have yet
+ * 
+ * @return void* the job, or NULL if none have finished
+ */
+
+void *workerPoolNext(WorkerPool *pool, bool wait);
+
+#endif